@@ -0,0 +1,240 @@
+// Benchmark suite for the public TPS55289 driver functions
+//
+// Every function runs TPS55289_BENCH_RUNS times against a loopback transport that stores register writes
+// and models the wire time of each transaction instead of waiting for it. CPU time is measured with the
+// RP2040 timer on target and CLOCK_MONOTONIC on the host; bus time is the modelled wire time. Results are
+// printed as one JSON object per line (min/median/p99 in ns) so runs can be diffed or fed to a script.
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_log.h"
+#include "TPS55289_protection.h"
+
+#if PICO_ON_DEVICE
+#define BENCH_PLATFORM          "rp2040"
+#else
+#include <time.h>
+#define BENCH_PLATFORM          "host"
+#endif
+
+#ifndef TPS55289_BENCH_RUNS
+#define TPS55289_BENCH_RUNS     200
+#endif
+
+#ifndef TPS55289_BENCH_BUS_HZ
+#define TPS55289_BENCH_BUS_HZ   400000
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Clock
+
+static uint64_t benchClockNs(void){
+#if PICO_ON_DEVICE
+    return time_us_64() * 1000;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Loopback Transport
+
+typedef struct {
+    uint8_t  registers[8];
+    uint8_t  pointer;
+    uint64_t busNs;                      // Modelled wire time
+    uint32_t transactions;
+} BENCH_LOOPBACK;
+
+static uint64_t loopbackWireNs(size_t bytes){
+    return (((uint64_t)bytes * 9 + 2) * 1000000000ull) / TPS55289_BENCH_BUS_HZ;
+}
+
+static int loopbackWrite(void *context, uint8_t address, const uint8_t *src, size_t len, _Bool nostop){
+    BENCH_LOOPBACK *bus = (BENCH_LOOPBACK *)context;
+    (void)address; (void)nostop;
+    bus->pointer = src[0] & 0x07;
+    for (size_t i = 1; i < len; i++){
+        bus->registers[bus->pointer] = src[i];
+        bus->pointer = (bus->pointer + 1) & 0x07;
+    }
+    bus->busNs += loopbackWireNs(1 + len);
+    bus->transactions++;
+    return (int)len;
+}
+
+static int loopbackRead(void *context, uint8_t address, uint8_t *dst, size_t len, _Bool nostop){
+    BENCH_LOOPBACK *bus = (BENCH_LOOPBACK *)context;
+    (void)address; (void)nostop;
+    for (size_t i = 0; i < len; i++){
+        dst[i] = bus->registers[bus->pointer];
+        bus->pointer = (bus->pointer + 1) & 0x07;
+    }
+    bus->busNs += loopbackWireNs(1 + len);
+    bus->transactions++;
+    return (int)len;
+}
+
+static BENCH_LOOPBACK benchBus;
+static const TPS55289_TRANSPORT benchTransport = {
+    .write      = loopbackWrite,
+    .read       = loopbackRead,
+    .context    = &benchBus,
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Operations
+
+static TPS55289_PROTECTION benchProtection;
+static const TPS55289_PROTECTION_SAMPLE benchSample = { 12000, 5000, 2500, 1400, true };
+
+static _Bool opInit(TPS55289 *d)                     { return TPS55289Init(d); }
+static _Bool opSetOutputVoltage(TPS55289 *d)         { return setOutputVoltage(d, 5.0); }
+static _Bool opEnableOutputCurrentLimit(TPS55289 *d) { return enableOutputCurrentLimit(d); }
+static _Bool opDisableOutputCurrentLimit(TPS55289 *d){ return disableOutputCurrentLimit(d); }
+static _Bool opSetOutputCurrentLimit(TPS55289 *d)    { return setOutputCurrentLimit(d, 3.0); }
+static _Bool opSetOCPResponseTime(TPS55289 *d)       { return setOCPResponseTime(d, 0x01); }
+static _Bool opSetSlewRate(TPS55289 *d)              { return setSlewRate(d, 0x02); }
+static _Bool opSetFBMechanism(TPS55289 *d)           { return setFBMechanism(d, 0); }
+static _Bool opSetStepSize(TPS55289 *d)              { return setStepSize(d, 0x01); }
+static _Bool opEnableSCIndication(TPS55289 *d)       { return enableSCIndication(d); }
+static _Bool opDisableSCIndication(TPS55289 *d)      { return disableSCIndication(d); }
+static _Bool opEnableOCPIndication(TPS55289 *d)      { return enableOCPIndication(d); }
+static _Bool opDisableOCPIndication(TPS55289 *d)     { return disableOCPIndication(d); }
+static _Bool opEnableOVPIndication(TPS55289 *d)      { return enableOVPIndication(d); }
+static _Bool opDisableOVPIndication(TPS55289 *d)     { return disableOVPIndication(d); }
+static _Bool opSetCDCOption(TPS55289 *d)             { return setCDCOption(d, 0); }
+static _Bool opSetCDCComp(TPS55289 *d)               { return setCDCComp(d, 0x03); }
+static _Bool opEnableDevice(TPS55289 *d)             { return enableDevice(d); }
+static _Bool opDisableDevice(TPS55289 *d)            { return disableDevice(d); }
+static _Bool opFSWDoubling(TPS55289 *d)              { return FSWDoubling(d, 1); }
+static _Bool opEnableHiccupMode(TPS55289 *d)         { return enableHiccupMode(d); }
+static _Bool opDisableHiccupMode(TPS55289 *d)        { return disableHiccupMode(d); }
+static _Bool opEnableVOUTDSCHG(TPS55289 *d)          { return enableVOUTDSCHG(d); }
+static _Bool opDisableVOUTDSCHG(TPS55289 *d)         { return disableVOUTDSCHG(d); }
+static _Bool opFSWOpMode(TPS55289 *d)                { return FSWOpMode(d, 1); }
+static _Bool opReadStatusRegister(TPS55289 *d)       { return readStatusRegister(d); }
+
+static _Bool opProtectionEvaluate(TPS55289 *d){
+    TPS55289ProtectionEvaluate(&benchProtection, d->TPS55289_STATUS.STATUS, &benchSample);
+    return true;
+}
+
+typedef _Bool (*benchOp)(TPS55289 *device);
+
+static const struct {
+    const char *name;
+    benchOp op;
+} benchOps[] = {
+    { "TPS55289Init",               opInit },
+    { "setOutputVoltage",           opSetOutputVoltage },
+    { "enableOutputCurrentLimit",   opEnableOutputCurrentLimit },
+    { "disableOutputCurrentLimit",  opDisableOutputCurrentLimit },
+    { "setOutputCurrentLimit",      opSetOutputCurrentLimit },
+    { "setOCPResponseTime",         opSetOCPResponseTime },
+    { "setSlewRate",                opSetSlewRate },
+    { "setFBMechanism",             opSetFBMechanism },
+    { "setStepSize",                opSetStepSize },
+    { "enableSCIndication",         opEnableSCIndication },
+    { "disableSCIndication",        opDisableSCIndication },
+    { "enableOCPIndication",        opEnableOCPIndication },
+    { "disableOCPIndication",       opDisableOCPIndication },
+    { "enableOVPIndication",        opEnableOVPIndication },
+    { "disableOVPIndication",       opDisableOVPIndication },
+    { "setCDCOption",               opSetCDCOption },
+    { "setCDCComp",                 opSetCDCComp },
+    { "enableDevice",               opEnableDevice },
+    { "disableDevice",              opDisableDevice },
+    { "FSWDoubling",                opFSWDoubling },
+    { "enableHiccupMode",           opEnableHiccupMode },
+    { "disableHiccupMode",          opDisableHiccupMode },
+    { "enableVOUTDSCHG",            opEnableVOUTDSCHG },
+    { "disableVOUTDSCHG",           opDisableVOUTDSCHG },
+    { "FSWOpMode",                  opFSWOpMode },
+    { "readStatusRegister",         opReadStatusRegister },
+    { "protectionEvaluate",         opProtectionEvaluate },
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Statistics
+
+static uint32_t cpuSamples[TPS55289_BENCH_RUNS];
+static uint32_t busSamples[TPS55289_BENCH_RUNS];
+
+static void sortSamples(uint32_t *samples, uint32_t count){
+    for (uint32_t i = 1; i < count; i++){
+        uint32_t value = samples[i];
+        uint32_t j = i;
+        while ((j > 0) && (samples[j - 1] > value)){
+            samples[j] = samples[j - 1];
+            j--;
+        }
+        samples[j] = value;
+    }
+}
+
+static void printStats(const char *label, uint32_t *samples, uint32_t count){
+    sortSamples(samples, count);
+    printf("\"%s\":{\"min\":%u,\"median\":%u,\"p99\":%u}", label,
+           (unsigned int)samples[0], (unsigned int)samples[count / 2], (unsigned int)samples[(count * 99) / 100]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int main(void)
+{
+#if PICO_ON_DEVICE
+    stdio_init_all();
+    sleep_ms(3000);         // Give the host time to open the console
+#endif
+    TPS55289LogInit();
+
+    TPS55289 device = {0};
+    device.transport = &benchTransport;
+    TPS55289ProtectionInit(&benchProtection, 3000);
+    TPS55289Init(&device);
+
+    for (uint32_t i = 0; i < sizeof(benchOps) / sizeof(benchOps[0]); i++){
+        uint32_t failures = 0;
+        uint32_t transactions = 0;
+
+        // One untimed call to warm caches and settle the device state
+        benchOps[i].op(&device);
+        TPS55289LogDiscard();
+
+        for (uint32_t n = 0; n < TPS55289_BENCH_RUNS; n++){
+            benchBus.busNs = 0;
+            benchBus.transactions = 0;
+
+            uint64_t start = benchClockNs();
+            _Bool ok = benchOps[i].op(&device);
+            uint64_t elapsed = benchClockNs() - start;
+
+            cpuSamples[n] = (uint32_t)elapsed;
+            busSamples[n] = (uint32_t)benchBus.busNs;
+            transactions = benchBus.transactions;
+            failures += ok ? 0 : 1;
+            TPS55289LogDiscard();
+        }
+
+        printf("{\"bench\":\"TPS55289\",\"platform\":\"%s\",\"operation\":\"%s\",\"runs\":%u,\"bus_hz\":%u,"
+               "\"transactions\":%u,\"failures\":%u,",
+               BENCH_PLATFORM, benchOps[i].name, TPS55289_BENCH_RUNS, TPS55289_BENCH_BUS_HZ,
+               (unsigned int)transactions, (unsigned int)failures);
+        printStats("cpu_ns", cpuSamples, TPS55289_BENCH_RUNS);
+        printf(",");
+        printStats("bus_ns", busSamples, TPS55289_BENCH_RUNS);
+        printf("}\n");
+    }
+
+#if PICO_ON_DEVICE
+    for (;;){
+        tight_loop_contents();
+    }
+#endif
+    return 0;
+}
@@ -0,0 +1,83 @@
+// Driver call latency under inline printf logging vs deferred logging
+//
+// Built twice from CMake: TPS55289_LogBench_Printf (TPS55289_LOG_MODE_PRINTF) and
+// TPS55289_LogBench_Deferred (TPS55289_LOG_MODE_DEFERRED). Run both and compare the CSV lines.
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+
+#include "TPS55289.h"
+#include "TPS55289_log.h"
+
+#define BENCH_ITERATIONS    200
+#define BENCH_I2C_SDA       4
+#define BENCH_I2C_SCL       5
+
+#if TPS55289_LOG_MODE == TPS55289_LOG_MODE_DEFERRED
+#define BENCH_MODE_NAME     "deferred"
+#else
+#define BENCH_MODE_NAME     "printf"
+#endif
+
+typedef _Bool (*benchOp)(TPS55289 *device);
+
+static _Bool opSetOutputVoltage(TPS55289 *device)       { return setOutputVoltage(device, 5.0); }
+static _Bool opSetOutputCurrentLimit(TPS55289 *device)  { return setOutputCurrentLimit(device, 3.0); }
+static _Bool opSetStepSize(TPS55289 *device)            { return setStepSize(device, 0x01); }
+static _Bool opEnableOCPIndication(TPS55289 *device)    { return enableOCPIndication(device); }
+static _Bool opEnableDevice(TPS55289 *device)           { return enableDevice(device); }
+
+static const struct {
+    const char *name;
+    benchOp op;
+} benchOps[] = {
+    { "setOutputVoltage",       opSetOutputVoltage },
+    { "setOutputCurrentLimit",  opSetOutputCurrentLimit },
+    { "setStepSize",            opSetStepSize },
+    { "enableOCPIndication",    opEnableOCPIndication },
+    { "enableDevice",           opEnableDevice },
+};
+
+int main()
+{
+    stdio_init_all();
+    TPS55289LogInit();
+
+    TPS55289I2CInit();          // Controller locks: the device below uses the default I2C0 transport
+    i2c_init(i2c0, 400 * 1000);
+    gpio_set_function(BENCH_I2C_SDA, GPIO_FUNC_I2C);
+    gpio_set_function(BENCH_I2C_SCL, GPIO_FUNC_I2C);
+    gpio_pull_up(BENCH_I2C_SDA);
+    gpio_pull_up(BENCH_I2C_SCL);
+
+    // Give the host time to open the console
+    sleep_ms(3000);
+
+    TPS55289 device = {0};
+    TPS55289Init(&device);
+    TPS55289LogFlush(0);
+
+    printf("bench,mode,operation,iterations,mean_us,max_us\n");
+    for (uint32_t i = 0; i < sizeof(benchOps) / sizeof(benchOps[0]); i++){
+        uint64_t total = 0;
+        uint32_t worst = 0;
+        for (uint32_t n = 0; n < BENCH_ITERATIONS; n++){
+            uint32_t start = time_us_32();
+            benchOps[i].op(&device);
+            uint32_t elapsed = time_us_32() - start;
+            total += elapsed;
+            if (elapsed > worst){
+                worst = elapsed;
+            }
+            // Formatting happens here in deferred mode, outside the timed region
+            TPS55289LogFlush(0);
+        }
+        printf("log_bench,%s,%s,%u,%u,%u\n", BENCH_MODE_NAME, benchOps[i].name, BENCH_ITERATIONS,
+               (unsigned int)(total / BENCH_ITERATIONS), (unsigned int)worst);
+    }
+
+    for (;;){
+        tight_loop_contents();
+    }
+}
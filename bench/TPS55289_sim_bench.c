@@ -0,0 +1,253 @@
+// Virtual bus time per driver operation against the TPS55289 simulator
+//
+// Prints one CSV line per operation and bus speed. Virtual bus time is deterministic, so any change in
+// the numbers between two runs is a change in the driver's bus traffic. A second table shows the setpoint
+// error of a simulated board with gain/offset errors before and after per-unit calibration, and a third the
+// simulator's current-limit fold-back into a resistive load. Returns non-zero if an operation failed, the
+// calibration did not improve both setpoints, or the fold-back is off.
+#include <math.h>
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_calibration.h"
+#include "TPS55289_protection.h"
+#include "TPS55289_sim.h"
+
+typedef _Bool (*benchOp)(TPS55289 *device, TPS55289_SIM *sim);
+
+static TPS55289_PROTECTION protection;
+
+static _Bool opInit(TPS55289 *device, TPS55289_SIM *sim)                 { (void)sim; return TPS55289Init(device); }
+static _Bool opSetOutputVoltage(TPS55289 *device, TPS55289_SIM *sim)     { (void)sim; return setOutputVoltage(device, 5.0); }
+static _Bool opSetOutputCurrentLimit(TPS55289 *device, TPS55289_SIM *sim){ (void)sim; return setOutputCurrentLimit(device, 3.0); }
+static _Bool opSetSlewRate(TPS55289 *device, TPS55289_SIM *sim)          { (void)sim; return setSlewRate(device, 0x03); }
+static _Bool opEnableOCPIndication(TPS55289 *device, TPS55289_SIM *sim)  { (void)sim; return enableOCPIndication(device); }
+static _Bool opReadStatus(TPS55289 *device, TPS55289_SIM *sim)           { (void)sim; return readStatusRegister(device); }
+
+static _Bool opProtectionTick(TPS55289 *device, TPS55289_SIM *sim){
+    TPS55289SimUpdate(sim);
+    TPS55289_PROTECTION_SAMPLE sample = {
+        .VIN             = (uint16_t)sim->VIN,
+        .VOUT            = (uint16_t)sim->VOUT,
+        .IOUT            = (uint16_t)TPS55289SimIOUT(sim),
+        .thermistor      = 1400,
+        .thermistorValid = true,
+    };
+    return TPS55289ProtectionTick(device, &protection, &sample);
+}
+
+static const struct {
+    const char *name;
+    benchOp op;
+} benchOps[] = {
+    { "TPS55289Init",           opInit },
+    { "setOutputVoltage",       opSetOutputVoltage },
+    { "setOutputCurrentLimit",  opSetOutputCurrentLimit },
+    { "setSlewRate",            opSetSlewRate },
+    { "enableOCPIndication",    opEnableOCPIndication },
+    { "readStatusRegister",     opReadStatus },
+    { "protectionTick",         opProtectionTick },
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Calibration
+
+#define CAL_SETTLE_MS           50
+#define CAL_LOAD_OHMS           0.5         // Holds the output in current limit at 5V for every setting
+
+static uint32_t measureVOUT(void *context){
+    TPS55289_SIM *sim = (TPS55289_SIM *)context;
+    TPS55289SimUpdate(sim);
+    return (uint32_t)(sim->VOUT + 0.5f);
+}
+
+static uint32_t measureIOUT(void *context){
+    TPS55289_SIM *sim = (TPS55289_SIM *)context;
+    TPS55289SimUpdate(sim);
+    return (uint32_t)(TPS55289SimIOUT(sim) + 0.5f);
+}
+
+// Largest |VOUT - setpoint| in mV over 1V - 15V (INTFB 0.0752 full scale) with the output unloaded
+static float voutError(TPS55289 *device, TPS55289_SIM *sim){
+    float worst = 0;
+    sim->loadOhms = 0;
+    for (int mV = 1000; mV <= 15000; mV += 500){
+        setOutputVoltage(device, mV / 1000.0f);
+        sleep_ms(CAL_SETTLE_MS);
+        TPS55289SimUpdate(sim);
+        worst = fmaxf(worst, fabsf(sim->VOUT - mV));
+    }
+    return worst;
+}
+
+// Largest |IOUT - limit| in mA over 0.5A - 6A with the output held in current limit
+static float ilimError(TPS55289 *device, TPS55289_SIM *sim){
+    float worst = 0;
+    sim->loadOhms = CAL_LOAD_OHMS;
+    setOutputVoltage(device, 5.0);
+    enableOutputCurrentLimit(device);
+    for (int mA = 500; mA <= 6000; mA += 250){
+        setOutputCurrentLimit(device, mA / 1000.0f);
+        sleep_ms(CAL_SETTLE_MS);
+        TPS55289SimUpdate(sim);
+        worst = fmaxf(worst, fabsf(TPS55289SimIOUT(sim) - mA));
+    }
+    return worst;
+}
+
+static uint32_t calibrationBench(void){
+    TPS55289_SIM sim;
+    TPS55289SimInit(&sim, TPS55289_SIM_BUS_FAST);
+    sim.VIN        = 20000;
+    sim.voutGain   = 1.03;
+    sim.voutOffset = -40;
+    sim.ilimGain   = 0.94;
+    sim.ilimOffset = 60;
+
+    TPS55289 device = {0};
+    device.transport = &sim.transport;
+    TPS55289Init(&device);
+    setStepSize(&device, 0x02);
+
+    float voutBefore = voutError(&device, &sim);
+    float ilimBefore = ilimError(&device, &sim);
+
+    TPS55289_CALIBRATION calibration;
+    TPS55289CalibrationReset(&calibration);
+    sim.loadOhms = 0;
+    _Bool ok = TPS55289CalibrationRunVOUT(&device, &calibration, measureVOUT, &sim, CAL_SETTLE_MS);
+    setOutputVoltage(&device, 5.0);
+    sim.loadOhms = CAL_LOAD_OHMS;
+    ok = ok && TPS55289CalibrationRunILIM(&device, &calibration, measureIOUT, &sim, CAL_SETTLE_MS);
+    device.calibration = &calibration;
+
+    float voutAfter = voutError(&device, &sim);
+    float ilimAfter = ilimError(&device, &sim);
+
+    printf("bench,quantity,calibrated,record_valid,max_error_uncalibrated,max_error_calibrated,unit\n");
+    printf("calibration,VOUT,%d,%d,%.1f,%.1f,mV\n", ok, TPS55289CalibrationValid(&calibration), voutBefore, voutAfter);
+    printf("calibration,IOUT_LIMIT,%d,%d,%.1f,%.1f,mA\n", ok, TPS55289CalibrationValid(&calibration), ilimBefore, ilimAfter);
+    return (ok && TPS55289CalibrationValid(&calibration) && (voutAfter < voutBefore) && (ilimAfter < ilimBefore)) ? 0 : 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Current Limit Fold-back
+
+#define FOLDBACK_SETPOINT_MV    12000
+#define FOLDBACK_LIMIT_MA       3000
+#define FOLDBACK_TOLERANCE_MV   1
+
+// A 2 Ohm load would draw 6 A at 12 V; a 3 A limit must hold VOUT at 3 A * 2 Ohm = 6 V and latch OCP
+static uint32_t foldbackBench(void){
+    static const float loads[] = { 2.0f, 3.0f, 10.0f };
+    uint32_t failures = 0;
+    printf("\nbench,load_ohms,vout_mv,iout_ma,expected_mv,ocp\n");
+    for (uint32_t i = 0; i < sizeof(loads) / sizeof(loads[0]); i++){
+        TPS55289_SIM sim;
+        TPS55289SimInit(&sim, TPS55289_SIM_BUS_FAST);
+        sim.VIN = 20000;
+        TPS55289 device = {0};
+        device.transport = &sim.transport;
+        TPS55289Init(&device);
+        setStepSize(&device, 0x02);
+        setOutputCurrentLimit(&device, FOLDBACK_LIMIT_MA / 1000.0f);
+        enableOutputCurrentLimit(&device);
+        setOutputVoltage(&device, FOLDBACK_SETPOINT_MV / 1000.0f);
+        sleep_ms(CAL_SETTLE_MS);
+        TPS55289SimUpdate(&sim);
+        float open = sim.VOUT;
+
+        sim.loadOhms = loads[i];
+        sleep_ms(CAL_SETTLE_MS);
+        TPS55289SimUpdate(&sim);
+        TPS55289_STATUS_REG status = { .regValue = sim.registers[TPS55289_STATUS_ADDR] };
+        float expected = fminf(open, FOLDBACK_LIMIT_MA * loads[i]);
+        _Bool limited = (FOLDBACK_LIMIT_MA * loads[i] < open);
+        printf("foldback,%.1f,%.0f,%.0f,%.0f,%u\n", loads[i], sim.VOUT, TPS55289SimIOUT(&sim), expected,
+               (unsigned int)status.OCP);
+        if ((fabsf(sim.VOUT - expected) > FOLDBACK_TOLERANCE_MV) || (status.OCP != limited)){
+            failures++;
+        }
+    }
+    return failures;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Status Dispatch
+
+/*
+    Reading STATUS clears the latched flags, so readStatusRegister must act on them itself. Each flag is
+    latched in the simulator after a clean TPS55289Init, which must leave the output on; one read has to
+    turn the output off. With no flag latched the read must leave it on in every converter mode, which
+    STATUS reports in the bits next to the flags.
+*/
+static uint32_t statusDispatchBench(void){
+    static const struct { const char *name; uint8_t bit; float VIN; } flags[] = {
+        { "SCP", TPS55289_SIM_STATUS_SCP, 12000 },
+        { "OCP", TPS55289_SIM_STATUS_OCP, 12000 },
+        { "OVP", TPS55289_SIM_STATUS_OVP, 12000 },
+        { "none_buck",       0, 12000 },
+        { "none_boost",      0, 500 },
+        { "none_buck_boost", 0, 800 },      // Init leaves VOUT at the 45mV REF floor, about 0.8V
+    };
+    uint32_t failures = 0;
+    printf("\nbench,flag,on_after_init,on_after_read\n");
+    for (uint32_t i = 0; i < sizeof(flags) / sizeof(flags[0]); i++){
+        TPS55289_SIM sim;
+        TPS55289SimInit(&sim, TPS55289_SIM_BUS_FAST);
+        sim.VIN = flags[i].VIN;
+        TPS55289 device = {0};
+        device.transport = &sim.transport;
+        TPS55289Init(&device);
+
+        TPS55289_MODE_REG mode = { .regValue = sim.registers[TPS55289_MODE_ADDR] };
+        uint32_t onAfterInit = mode.OE;
+        sim.registers[TPS55289_STATUS_ADDR] |= flags[i].bit;
+        readStatusRegister(&device);
+        mode.regValue = sim.registers[TPS55289_MODE_ADDR];
+        printf("status_dispatch,%s,%u,%u\n", flags[i].name, (unsigned int)onAfterInit, (unsigned int)mode.OE);
+        failures += ((onAfterInit == 1) && (mode.OE == ((flags[i].bit != 0) ? 0 : 1))) ? 0 : 1;
+    }
+    return failures;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const uint32_t benchBusSpeeds[] = {
+    TPS55289_SIM_BUS_STANDARD,
+    TPS55289_SIM_BUS_FAST,
+    TPS55289_SIM_BUS_FAST_PLUS,
+};
+
+int main(void)
+{
+    uint32_t failures = 0;
+    printf("bench,bus_hz,operation,ok,transactions,bytes,register_writes,bus_us\n");
+    for (uint32_t b = 0; b < sizeof(benchBusSpeeds) / sizeof(benchBusSpeeds[0]); b++){
+        TPS55289_SIM sim;
+        TPS55289SimInit(&sim, benchBusSpeeds[b]);
+        sim.loadOhms = 10;
+
+        TPS55289 device = {0};
+        device.transport = &sim.transport;
+        TPS55289ProtectionInit(&protection, 3000);
+
+        for (uint32_t i = 0; i < sizeof(benchOps) / sizeof(benchOps[0]); i++){
+            TPS55289SimResetStats(&sim);
+            _Bool ok = benchOps[i].op(&device, &sim);
+            printf("sim_bench,%u,%s,%d,%u,%u,%u,%llu\n", (unsigned int)sim.busHz, benchOps[i].name, ok,
+                   (unsigned int)sim.transactions, (unsigned int)sim.bytes, (unsigned int)sim.writes,
+                   (unsigned long long)sim.busTimeUs);
+            failures += ok ? 0 : 1;
+        }
+    }
+    printf("\n");
+    failures += calibrationBench();
+    failures += foldbackBench();
+    failures += statusDispatchBench();
+
+    printf("\nfailed_checks,%u\n", (unsigned int)failures);
+    return (failures == 0) ? 0 : 1;
+}
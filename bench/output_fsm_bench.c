@@ -0,0 +1,435 @@
+// Output state machine benchmark (host build)
+//
+// Drives every (state, event) pair of the output state machine against the TPS55289 simulator. Each pair
+// starts from a fresh device brought to the state by a fixed event path; after the event the bench checks
+// the next state against its own copy of the intended table, the simulator's MODE/VOUT_SR against the
+// state's register image, the driver cache against the simulator, and that the bus writes equal the
+// register bytes that actually changed. Prints:
+//   matrix      next state and register writes per (state, event); '-' where the event is ignored
+//   scenarios   writes and bus time for the same operation through the legacy driver calls and the machine;
+//               latched faults must cost the legacy path one MODE write and leave the machine FAULTED
+//   lifecycle   soft start into 12 V, a short that clears during the first retry, then a persistent short
+//               through the hiccup retries to FAULTED
+//   concurrent  a request made while another thread is stalled inside a transition must not return until
+//               its own event has been applied, and must report that event's outcome
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_log.h"
+#include "TPS55289_output.h"
+#include "TPS55289_sim.h"
+
+#define BENCH_VOUT                      5.0f
+#define BENCH_SETPOINT_CODE             0x123       // REF code differing from BENCH_VOUT in both bytes
+#define BENCH_USER_SLEW_RATE            0x02        // 5 mV/us, so soft start visibly changes VOUT_SR
+#define BENCH_STEP_US                   1000
+#define BENCH_SHORT_TIMEOUT_US          2000000
+#define BENCH_STALL_NS                  20000000ull     // Host time a stalled write waits for an early return
+
+#define IGN                             0xFF
+
+static const char *stateNames[TPS55289_OUTPUT_STATES] = {
+    "off", "soft_start", "regulating", "limiting", "faulted", "hiccup", "discharge"
+};
+
+static const char *eventNames[TPS55289_OUTPUT_EVENTS] = {
+    "enable", "disable", "setpoint", "ss_done", "ocp", "ocp_clear", "limit_to", "scp", "fault", "retry",
+    "exhausted", "discharged", "clear"
+};
+
+// Intended behaviour, written out independently of the table in TPS55289_output.c
+static const uint8_t expected[TPS55289_OUTPUT_STATES][TPS55289_OUTPUT_EVENTS] = {
+    [TPS55289_OUTPUT_OFF]        = { 1,   0, 0,   IGN, IGN, IGN, IGN, IGN, 4, IGN, IGN, IGN, 0   },
+    [TPS55289_OUTPUT_SOFT_START] = { 1,   6, 1,   2,   3,   IGN, IGN, 5,   4, IGN, IGN, IGN, IGN },
+    [TPS55289_OUTPUT_REGULATING] = { 2,   6, 2,   IGN, 3,   IGN, IGN, 5,   4, IGN, IGN, IGN, IGN },
+    [TPS55289_OUTPUT_LIMITING]   = { 3,   6, 3,   IGN, 3,   2,   5,   5,   4, IGN, IGN, IGN, IGN },
+    [TPS55289_OUTPUT_FAULTED]    = { IGN, 4, 4,   IGN, IGN, IGN, IGN, IGN, 4, IGN, IGN, IGN, 0   },
+    [TPS55289_OUTPUT_HICCUP]     = { IGN, 6, 5,   IGN, IGN, IGN, IGN, IGN, 4, 1,   4,   IGN, IGN },
+    [TPS55289_OUTPUT_DISCHARGE]  = { 1,   6, 6,   IGN, IGN, IGN, IGN, IGN, 4, IGN, IGN, 0,   IGN },
+};
+
+// OE, DISCHG and VOUT_SR.SR (0xFF: whatever it was) expected in the simulator after entering each state
+static const uint8_t expectedImage[TPS55289_OUTPUT_STATES][3] = {
+    { 0, 0, 0xFF }, { 1, 0, 0x00 }, { 1, 0, BENCH_USER_SLEW_RATE }, { 1, 0, BENCH_USER_SLEW_RATE },
+    { 0, 1, 0xFF }, { 0, 0, 0xFF }, { 0, 1, 0xFF },
+};
+
+// Event path from OFF to each state
+static const uint8_t paths[TPS55289_OUTPUT_STATES][3] = {
+    [TPS55289_OUTPUT_OFF]        = { IGN },
+    [TPS55289_OUTPUT_SOFT_START] = { TPS55289_OUTPUT_EVENT_ENABLE, IGN },
+    [TPS55289_OUTPUT_REGULATING] = { TPS55289_OUTPUT_EVENT_ENABLE, TPS55289_OUTPUT_EVENT_SOFT_START_DONE, IGN },
+    [TPS55289_OUTPUT_LIMITING]   = { TPS55289_OUTPUT_EVENT_ENABLE, TPS55289_OUTPUT_EVENT_SOFT_START_DONE,
+                                     TPS55289_OUTPUT_EVENT_OCP },
+    [TPS55289_OUTPUT_FAULTED]    = { TPS55289_OUTPUT_EVENT_FAULT, IGN },
+    [TPS55289_OUTPUT_HICCUP]     = { TPS55289_OUTPUT_EVENT_ENABLE, TPS55289_OUTPUT_EVENT_SCP, IGN },
+    [TPS55289_OUTPUT_DISCHARGE]  = { TPS55289_OUTPUT_EVENT_ENABLE, TPS55289_OUTPUT_EVENT_DISABLE, IGN },
+};
+
+typedef struct {
+    TPS55289_SIM sim;
+    TPS55289 device;
+    TPS55289_OUTPUT output;
+} BENCH_RIG;
+
+// Fresh simulator and driver with the output off; the machine is attached only if asked
+static void benchSetup(BENCH_RIG *rig, _Bool attach){
+    memset(rig, 0, sizeof(*rig));
+    TPS55289SimInit(&rig->sim, TPS55289_SIM_BUS_FAST);
+    rig->device.transport = &rig->sim.transport;
+    TPS55289Init(&rig->device);
+    setStepSize(&rig->device, 0x02);
+    setSlewRate(&rig->device, BENCH_USER_SLEW_RATE);
+    setOutputVoltage(&rig->device, BENCH_VOUT);
+    disableDevice(&rig->device);
+    if (attach){
+        TPS55289OutputInit(&rig->output, &rig->device);
+    }
+    TPS55289SimResetStats(&rig->sim);
+}
+
+// STATUS read over the bus, latches cleared by the read as on the part
+static uint8_t benchReadStatus(BENCH_RIG *rig){
+    const TPS55289_TRANSPORT *transport = &rig->sim.transport;
+    uint8_t address = TPS55289_STATUS_ADDR;
+    uint8_t status = 0;
+    transport->write(transport->context, rig->device.I2C_ADDRESS, &address, 1, true);
+    transport->read(transport->context, rig->device.I2C_ADDRESS, &status, 1, false);
+    return status;
+}
+
+// Registers the machine owns must read back as cached
+static _Bool benchCoherent(const BENCH_RIG *rig){
+    const TPS55289 *device = &rig->device;
+    const uint8_t *registers = rig->sim.registers;
+    return (registers[TPS55289_MODE_ADDR] == device->TPS55289_MODE.regValue) &&
+           (registers[TPS55289_VOUT_SR_ADDR] == device->TPS55289_VOUT_SR.regValue) &&
+           (registers[TPS55289_REF_VOLTAGE_LSB_ADDR] == device->TPS55289_REF_VOLTAGE.VREF_LSB) &&
+           (registers[TPS55289_REF_VOLTAGE_MSB_ADDR] == device->TPS55289_REF_VOLTAGE.VREF_MSB);
+}
+
+/*
+    One (state, event) pair
+
+    Returns the number of failed checks; writes holds the register writes the event cost.
+*/
+static uint32_t benchTransition(uint8_t state, uint8_t event, uint32_t *writes){
+    static BENCH_RIG rig;
+    uint32_t failures = 0;
+    benchSetup(&rig, true);
+
+    for (uint32_t i = 0; (i < sizeof(paths[state])) && (paths[state][i] != IGN); i++){
+        TPS55289OutputPost(&rig.output, paths[state][i]);
+    }
+    TPS55289OutputProcess(&rig.device);
+    if (rig.output.state != state){
+        printf("# path to %s ended in %s\n", stateNames[state], stateNames[rig.output.state]);
+        return 1;
+    }
+
+    uint8_t before[TPS55289_SIM_REGISTERS];
+    memcpy(before, rig.sim.registers, sizeof(before));
+    TPS55289SimResetStats(&rig.sim);
+    rig.output.pendingCode = BENCH_SETPOINT_CODE;
+    TPS55289OutputPost(&rig.output, event);
+    TPS55289OutputProcess(&rig.device);
+    *writes = rig.sim.writes;
+
+    uint8_t next = (expected[state][event] == IGN) ? state : expected[state][event];
+    TPS55289_MODE_REG mode = { .regValue = rig.sim.registers[TPS55289_MODE_ADDR] };
+    TPS55289_VOUT_SR_REG sr = { .regValue = rig.sim.registers[TPS55289_VOUT_SR_ADDR] };
+    uint32_t changed = 0;
+    for (uint32_t i = 0; i < TPS55289_STATUS_ADDR; i++){
+        changed += (before[i] != rig.sim.registers[i]);
+    }
+
+    if (rig.output.state != next){
+        printf("# %s + %s: state %s, expected %s\n", stateNames[state], eventNames[event],
+               stateNames[rig.output.state], stateNames[next]);
+        failures++;
+    }
+    if ((mode.OE != expectedImage[next][0]) || (mode.DISCHG != expectedImage[next][1]) ||
+        ((expectedImage[next][2] != 0xFF) && (sr.SR != expectedImage[next][2]))){
+        printf("# %s + %s: OE %u DISCHG %u SR %u do not match %s\n", stateNames[state], eventNames[event],
+               mode.OE, mode.DISCHG, sr.SR, stateNames[next]);
+        failures++;
+    }
+    if (rig.sim.writes != changed){
+        printf("# %s + %s: %u writes for %u changed registers\n", stateNames[state], eventNames[event],
+               (unsigned int)rig.sim.writes, (unsigned int)changed);
+        failures++;
+    }
+    if (!benchCoherent(&rig)){
+        printf("# %s + %s: driver cache differs from the device\n", stateNames[state], eventNames[event]);
+        failures++;
+    }
+    if ((expected[state][event] == IGN) && (rig.output.stats.ignored == 0)){
+        printf("# %s + %s: accepted, expected ignored\n", stateNames[state], eventNames[event]);
+        failures++;
+    }
+    return failures;
+}
+
+static void benchScenario(const char *name, BENCH_RIG *legacy, BENCH_RIG *machine){
+    printf("%s,%u,%llu,%u,%llu\n", name,
+           (unsigned int)legacy->sim.writes, (unsigned long long)legacy->sim.busTimeUs,
+           (unsigned int)machine->sim.writes, (unsigned long long)machine->sim.busTimeUs);
+}
+
+static uint32_t benchScenarios(void){
+    static BENCH_RIG legacy, machine;
+    uint32_t failures = 0;
+    printf("\nscenario,legacy_writes,legacy_bus_us,machine_writes,machine_bus_us\n");
+
+    // Setpoint change on a live output: the legacy path cycles OE around the REF write
+    benchSetup(&legacy, false);
+    enableDevice(&legacy.device);
+    benchSetup(&machine, true);
+    TPS55289OutputRequest(&machine.device, TPS55289_OUTPUT_EVENT_ENABLE);
+    TPS55289OutputRequest(&machine.device, TPS55289_OUTPUT_EVENT_SOFT_START_DONE);
+    TPS55289SimResetStats(&legacy.sim);
+    TPS55289SimResetStats(&machine.sim);
+    setOutputVoltage(&legacy.device, 12.0f);
+    setOutputVoltage(&machine.device, 12.0f);
+    benchScenario("vout_5v_to_12v_live", &legacy, &machine);
+
+    // Small trim inside one REF byte
+    TPS55289SimResetStats(&legacy.sim);
+    TPS55289SimResetStats(&machine.sim);
+    setOutputVoltage(&legacy.device, 12.02f);
+    setOutputVoltage(&machine.device, 12.02f);
+    benchScenario("vout_trim_20mv", &legacy, &machine);
+
+    // SCP, OCP and OVP all latched in the device: the legacy path writes MODE once, the machine faults
+    TPS55289_STATUS_REG status = { .regValue = 0 };
+    status.SCP = status.OCP = status.OVP = 1;
+    TPS55289SimResetStats(&legacy.sim);
+    TPS55289SimResetStats(&machine.sim);
+    legacy.sim.registers[TPS55289_STATUS_ADDR] |= status.regValue;
+    machine.sim.registers[TPS55289_STATUS_ADDR] |= status.regValue;
+    operateOnStatusRegister(&legacy.device);
+    operateOnStatusRegister(&machine.device);
+    benchScenario("status_scp_ocp_ovp", &legacy, &machine);
+    if (legacy.sim.writes != 1){
+        printf("# status_scp_ocp_ovp: legacy path wrote %u registers, expected MODE once\n",
+               (unsigned int)legacy.sim.writes);
+        failures++;
+    }
+    if (machine.output.state != TPS55289_OUTPUT_FAULTED){
+        printf("# status_scp_ocp_ovp: machine ended in %s, expected faulted\n", stateNames[machine.output.state]);
+        failures++;
+    }
+
+    // Ten disables in a row from a running output
+    benchSetup(&legacy, false);
+    enableDevice(&legacy.device);
+    benchSetup(&machine, true);
+    TPS55289OutputRequest(&machine.device, TPS55289_OUTPUT_EVENT_ENABLE);
+    TPS55289SimResetStats(&legacy.sim);
+    TPS55289SimResetStats(&machine.sim);
+    for (uint32_t i = 0; i < 10; i++){
+        disableDevice(&legacy.device);
+        disableDevice(&machine.device);
+    }
+    benchScenario("disable_x10", &legacy, &machine);
+    return failures;
+}
+
+/*
+    Lifecycle
+
+    Soft start into 12 V with a tick every ms. A short that is gone by the first retry must leave the
+    machine regulating with its retry count cleared, so a later short gets the full run of retries. Then
+    a short that never clears: the machine must retry TPS55289_OUTPUT_MAX_RETRIES times and latch FAULTED.
+*/
+static uint32_t benchLifecycle(void){
+    static BENCH_RIG rig;
+    uint32_t failures = 0;
+    benchSetup(&rig, true);
+    setOutputVoltage(&rig.device, 12.0f);
+    TPS55289SimResetStats(&rig.sim);
+
+    printf("\nphase,duration_us,writes,bus_us,vout_mv,retries,final_state\n");
+    uint64_t start = time_us_64();
+    enableDevice(&rig.device);
+    while (rig.output.state == TPS55289_OUTPUT_SOFT_START){
+        hostAdvanceTime(BENCH_STEP_US);
+        TPS55289OutputStatus(&rig.device, benchReadStatus(&rig));
+        TPS55289OutputTick(&rig.device);
+    }
+    TPS55289SimUpdate(&rig.sim);
+    printf("soft_start,%llu,%u,%llu,%.0f,%u,%s\n", (unsigned long long)(time_us_64() - start),
+           (unsigned int)rig.sim.writes, (unsigned long long)rig.sim.busTimeUs, rig.sim.VOUT,
+           rig.output.retries, stateNames[rig.output.state]);
+    if ((rig.output.state != TPS55289_OUTPUT_REGULATING) || (rig.sim.VOUT < 11900.0f)){
+        failures++;
+    }
+
+    TPS55289SimResetStats(&rig.sim);
+    rig.sim.shortCircuit = true;
+    start = time_us_64();
+    while ((rig.output.state != TPS55289_OUTPUT_REGULATING || rig.sim.shortCircuit) &&
+           (time_us_64() - start < BENCH_SHORT_TIMEOUT_US)){
+        hostAdvanceTime(BENCH_STEP_US);
+        TPS55289OutputStatus(&rig.device, benchReadStatus(&rig));
+        TPS55289OutputTick(&rig.device);
+        if (rig.output.state == TPS55289_OUTPUT_HICCUP){
+            rig.sim.shortCircuit = false;
+        }
+    }
+    TPS55289SimUpdate(&rig.sim);
+    printf("recovered_short,%llu,%u,%llu,%.0f,%u,%s\n", (unsigned long long)(time_us_64() - start),
+           (unsigned int)rig.sim.writes, (unsigned long long)rig.sim.busTimeUs, rig.sim.VOUT,
+           rig.output.retries, stateNames[rig.output.state]);
+    if ((rig.output.state != TPS55289_OUTPUT_REGULATING) || (rig.output.retries != 0)){
+        failures++;
+    }
+
+    TPS55289SimResetStats(&rig.sim);
+    rig.sim.shortCircuit = true;
+    start = time_us_64();
+    uint32_t softStarts = 0;
+    uint8_t last = rig.output.state;
+    while ((rig.output.state != TPS55289_OUTPUT_FAULTED) && (time_us_64() - start < BENCH_SHORT_TIMEOUT_US)){
+        hostAdvanceTime(BENCH_STEP_US);
+        TPS55289OutputStatus(&rig.device, benchReadStatus(&rig));
+        TPS55289OutputTick(&rig.device);
+        softStarts += (rig.output.state == TPS55289_OUTPUT_SOFT_START) && (last != TPS55289_OUTPUT_SOFT_START);
+        last = rig.output.state;
+    }
+    printf("persistent_short,%llu,%u,%llu,%.0f,%u,%s\n", (unsigned long long)(time_us_64() - start),
+           (unsigned int)rig.sim.writes, (unsigned long long)rig.sim.busTimeUs, rig.sim.VOUT,
+           (unsigned int)softStarts, stateNames[rig.output.state]);
+    if ((rig.output.state != TPS55289_OUTPUT_FAULTED) || (softStarts != TPS55289_OUTPUT_MAX_RETRIES)){
+        failures++;
+    }
+
+    // Latched: enable is refused until the fault is cleared
+    if (enableDevice(&rig.device) || (rig.output.state != TPS55289_OUTPUT_FAULTED)){
+        failures++;
+    }
+    rig.sim.shortCircuit = false;
+    TPS55289OutputRequest(&rig.device, TPS55289_OUTPUT_EVENT_CLEAR);
+    if (!enableDevice(&rig.device) || (rig.output.state != TPS55289_OUTPUT_SOFT_START)){
+        failures++;
+    }
+    return failures;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Concurrent Request
+
+static BENCH_RIG concurrentRig;
+static TPS55289_TRANSPORT stallTransport;
+static atomic_int stallState;           // 0 off, 1 armed, 2 writer stalled, 3 released
+static atomic_int requestDone;
+static _Bool requestResult;
+static uint8_t requestState;
+
+static uint64_t benchClockNs(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+// The simulator's write, held at the first call once armed until released
+static int benchStallWrite(void *context, uint8_t address, const uint8_t *src, size_t len, _Bool nostop){
+    int armed = 1;
+    if (atomic_compare_exchange_strong(&stallState, &armed, 2)){
+        while (atomic_load(&stallState) != 3){
+        }
+    }
+    return concurrentRig.sim.transport.write(context, address, src, len, nostop);
+}
+
+static void *benchProcessor(void *param){
+    (void)param;
+    TPS55289OutputPost(&concurrentRig.output, TPS55289_OUTPUT_EVENT_ENABLE);
+    TPS55289OutputProcess(&concurrentRig.device);
+    return NULL;
+}
+
+static void *benchRequester(void *param){
+    (void)param;
+    requestResult = TPS55289OutputRequest(&concurrentRig.device, TPS55289_OUTPUT_EVENT_DISABLE);
+    requestState  = concurrentRig.output.state;
+    atomic_store(&requestDone, 1);
+    return NULL;
+}
+
+/*
+    Concurrent Request
+
+    One thread processes an ENABLE and stalls on its MODE write; another requests DISABLE meanwhile. The
+    request must wait for the ENABLE, then apply DISABLE itself: it returns in DISCHARGE, never while the
+    write is still stalled.
+*/
+static uint32_t benchConcurrent(void){
+    BENCH_RIG *rig = &concurrentRig;
+    pthread_t processor;
+    pthread_t requester;
+    benchSetup(rig, true);
+    stallTransport       = rig->sim.transport;
+    stallTransport.write = benchStallWrite;
+    rig->device.transport = &stallTransport;
+    atomic_store(&requestDone, 0);
+    atomic_store(&stallState, 1);
+
+    pthread_create(&processor, NULL, benchProcessor, NULL);
+    while (atomic_load(&stallState) != 2){
+    }
+    pthread_create(&requester, NULL, benchRequester, NULL);
+    uint64_t deadline = benchClockNs() + BENCH_STALL_NS;
+    while ((atomic_load(&requestDone) == 0) && (benchClockNs() < deadline)){
+    }
+    _Bool early = atomic_load(&requestDone);
+    atomic_store(&stallState, 3);
+    pthread_join(processor, NULL);
+    pthread_join(requester, NULL);
+
+    printf("\nconcurrent,returned_during_stall,result,state_on_return\n");
+    printf("request_disable,%u,%u,%s\n", (unsigned int)early, (unsigned int)requestResult,
+           stateNames[requestState]);
+    return (early || !requestResult || (requestState != TPS55289_OUTPUT_DISCHARGE)) ? 1 : 0;
+}
+
+int main(void)
+{
+    uint32_t failures = 0;
+    uint32_t histogram[4] = { 0 };
+
+    printf("state");
+    for (uint32_t e = 0; e < TPS55289_OUTPUT_EVENTS; e++){
+        printf(",%s", eventNames[e]);
+    }
+    printf("\n");
+    for (uint32_t s = 0; s < TPS55289_OUTPUT_STATES; s++){
+        printf("%s", stateNames[s]);
+        for (uint32_t e = 0; e < TPS55289_OUTPUT_EVENTS; e++){
+            uint32_t writes = 0;
+            failures += benchTransition((uint8_t)s, (uint8_t)e, &writes);
+            if (expected[s][e] == IGN){
+                printf(",-");
+            } else {
+                printf(",%s/%u", stateNames[expected[s][e]], (unsigned int)writes);
+            }
+            histogram[(writes < 3) ? writes : 3]++;
+        }
+        printf("\n");
+    }
+    printf("\nwrites_per_event,0,1,2,3+\ncount,%u,%u,%u,%u\n", (unsigned int)histogram[0],
+           (unsigned int)histogram[1], (unsigned int)histogram[2], (unsigned int)histogram[3]);
+
+    failures += benchScenarios();
+    failures += benchLifecycle();
+    failures += benchConcurrent();
+
+    printf("\nfailed_checks,%u\n", (unsigned int)failures);
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+// Front panel rendering benchmark (host build)
+//
+// Replays 60 s of readings at the 20 fps frame rate through two panels: one redrawing the whole screen
+// every frame, one redrawing only damaged rectangles. Both render into framebuffers that are compared
+// after every frame, so the damage path is checked pixel for pixel against the full redraw. Prints CSV:
+//   mode, frames, CPU time per frame (mean/max, host), pixels and blits per frame, and the SPI wire time
+//   those pixels would take on the target's 24 MHz bus.
+// Optional argument: path of a PPM snapshot of the last frame. Returns non-zero if any frame differs between
+// the two panels, a panel skipped a frame, or the damage path drew more pixels than a full redraw.
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "panel.h"
+#include "panel_fb.h"
+
+#define BENCH_FRAMES                    1200        // 60 s at 20 fps
+#define BENCH_SPI_HZ                    24000000    // clk_peri / 2
+#define BENCH_BLIT_OVERHEAD_BITS        (11 * 8)    // CASET, RASET, RAMWR with their parameters
+
+static uint64_t benchClockNs(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static uint32_t noiseState = 1;
+
+static int32_t noise(int32_t amplitude){
+    noiseState = noiseState * 1664525u + 1013904223u;
+    return (int32_t)((noiseState >> 16) % (uint32_t)(2 * amplitude + 1)) - amplitude;
+}
+
+/*
+    Scripted session (frame = 50 ms):
+      0-10 s    5 V output, 1.2 A load, readings jitter in the last digits
+      10-20 s   encoder selects VOUT and turns it up to 12 V, one detent per frame
+      20-30 s   steady at 12 V, 2 A
+      30-32 s   OCP flagged
+      32-45 s   limit edited down, then selection cleared
+      45-60 s   output off
+*/
+static void benchReading(uint32_t frame, PANEL_READING *reading){
+    static uint16_t setVOUT = 5000;
+    uint32_t ms = frame * 50;
+    TPS55289_STATUS_REG status = { .regValue = 0 };
+
+    memset(reading, 0, sizeof(*reading));
+    reading->valid    = PANEL_VALID_VIN | PANEL_VALID_VOUT | PANEL_VALID_IOUT | PANEL_VALID_STATUS;
+    reading->output   = (ms < 45000);
+    reading->setILIM  = (ms < 32000) ? 3000 : (uint16_t)(3000 - ((ms < 40000 ? ms : 40000) - 32000) / 50 * 10);
+    reading->selected = ((ms >= 10000) && (ms < 20000)) ? PANEL_SELECT_VOUT :
+                        (((ms >= 32000) && (ms < 40000)) ? PANEL_SELECT_ILIM : PANEL_SELECT_NONE);
+    if ((ms >= 10000) && (ms < 20000) && (setVOUT < 12000)){
+        setVOUT = (uint16_t)(setVOUT + 100);
+    }
+    reading->setVOUT = setVOUT;
+    reading->VIN     = (uint16_t)(12000 + noise(8));
+    reading->VOUT    = reading->output ? (uint16_t)(setVOUT + noise(3)) : 0;
+    reading->IOUT    = reading->output ? (uint16_t)(((ms < 20000) ? 1200 : 2000) + noise(6)) : 0;
+
+    status.STATUS = (setVOUT < 10800) ? 0b01 : ((setVOUT > 13200) ? 0b00 : 0b10);
+    status.OCP    = (ms >= 30000) && (ms < 32000);
+    reading->status = status.regValue;
+}
+
+typedef struct {
+    const char *name;
+    _Bool full;                         // Invalidate before every frame
+    PANEL panel;
+    PANEL_FB fb;
+    uint64_t cpuNs;
+    uint64_t cpuMaxNs;
+    uint32_t maxPixels;
+} BENCH_MODE;
+
+static void benchFrame(BENCH_MODE *mode, const PANEL_READING *reading){
+    uint32_t before = mode->panel.stats.pixels;
+    uint64_t start = benchClockNs();
+    if (mode->full){
+        panelInvalidate(&mode->panel);
+    }
+    panelUpdate(&mode->panel, reading);
+    panelRender(&mode->panel, &mode->fb.display);
+    uint64_t ns = benchClockNs() - start;
+    uint32_t pixels = mode->panel.stats.pixels - before;
+
+    mode->cpuNs += ns;
+    mode->cpuMaxNs = (ns > mode->cpuMaxNs) ? ns : mode->cpuMaxNs;
+    mode->maxPixels = (pixels > mode->maxPixels) ? pixels : mode->maxPixels;
+}
+
+int main(int argc, char **argv)
+{
+    static BENCH_MODE modes[] = {
+        { .name = "full_redraw", .full = true },
+        { .name = "damage_rects", .full = false },
+    };
+    uint32_t count = sizeof(modes) / sizeof(modes[0]);
+    uint32_t mismatchedFrames = 0;
+
+    for (uint32_t m = 0; m < count; m++){
+        panelInit(&modes[m].panel);
+        panelFbInit(&modes[m].fb);
+    }
+    for (uint32_t frame = 0; frame < BENCH_FRAMES; frame++){
+        PANEL_READING reading;
+        benchReading(frame, &reading);
+        for (uint32_t m = 0; m < count; m++){
+            benchFrame(&modes[m], &reading);
+        }
+        if (memcmp(modes[0].fb.pixels, modes[1].fb.pixels, sizeof(modes[0].fb.pixels)) != 0){
+            mismatchedFrames++;
+        }
+    }
+
+    printf("mode,frames,cpu_us_per_frame,cpu_max_us,pixels_per_frame,max_pixels,blits_per_frame,spi_us_per_frame,spi_busy_pct\n");
+    for (uint32_t m = 0; m < count; m++){
+        const BENCH_MODE *mode = &modes[m];
+        const PANEL_STATS *stats = &mode->panel.stats;
+        double pixels = (double)stats->pixels / stats->frames;
+        double blits = (double)stats->blits / stats->frames;
+        double spiUs = (pixels * 16 + blits * BENCH_BLIT_OVERHEAD_BITS) * 1e6 / BENCH_SPI_HZ;
+        printf("%s,%u,%.2f,%.2f,%.0f,%u,%.1f,%.1f,%.2f\n", mode->name, (unsigned int)stats->frames,
+               mode->cpuNs / 1000.0 / stats->frames, mode->cpuMaxNs / 1000.0, pixels,
+               (unsigned int)mode->maxPixels, blits, spiUs, spiUs / 50000.0 * 100);
+    }
+    uint32_t failures = mismatchedFrames;
+    for (uint32_t m = 0; m < count; m++){
+        failures += (modes[m].panel.stats.frames == BENCH_FRAMES) ? 0 : 1;
+    }
+    failures += (modes[1].panel.stats.pixels <= modes[0].panel.stats.pixels) ? 0 : 1;
+    printf("\nmismatched_frames,%u\nfailed_checks,%u\n", (unsigned int)mismatchedFrames, (unsigned int)failures);
+
+    if ((argc > 1) && (panelFbWritePPM(&modes[1].fb, argv[1]) == false)){
+        perror(argv[1]);
+        return 1;
+    }
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,275 @@
+// PIO I2C command stream check and bus time benchmark (host build)
+//
+// Encodes the TPS55289 transactions the driver issues, then decodes each command stream the way the
+// state machine would execute it (line levels from the SET instructions, bytes from the data words) and
+// compares the resulting bus events with the intended transaction. Any mismatch fails the run. Each line
+// is one JSON object:
+//   encode      words, RX bytes, PIO cycles and bus time of one stream; pass/fail of the decode
+//   ref_update  bus time per REF update: driver path over the hardware controller vs PIO burst and batch
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_pio_i2c_encode.h"
+#include "TPS55289_sim.h"
+
+#define BENCH_BATCH                     8           // REF updates per DMA run in the sequencer case
+#define BENCH_ENCODE_RUNS               100000
+
+static uint64_t benchClockNs(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static double streamUs(const PIO_I2C_STREAM *stream, uint32_t baudrate){
+    return pioI2CStreamCycles(stream) * 1e6 / ((double)PIO_I2C_CYCLES_PER_BIT * baudrate);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Decoder
+//
+// Tokens: S (START), Sr (repeated START), P (STOP), wXX (byte written, target ACK expected),
+// r+ (byte read, ACK from us), r- (last byte read, NAK from us).
+
+typedef struct {
+    char   text[1024];
+    size_t length;
+    const char *error;
+} BENCH_DECODED;
+
+static void emit(BENCH_DECODED *decoded, const char *token){
+    int written = snprintf(decoded->text + decoded->length, sizeof(decoded->text) - decoded->length,
+                           "%s%s", (decoded->length > 0) ? " " : "", token);
+    if (written > 0){
+        decoded->length += (size_t)written;
+    }
+}
+
+static void decodeStream(const PIO_I2C_STREAM *stream, BENCH_DECODED *decoded){
+    const uint16_t setMask = (uint16_t)~((1u << 11) | 1u);
+    uint8_t scl = 1;
+    uint8_t sda = 1;
+    _Bool started = false;
+    _Bool addressNext = false;
+    _Bool reading = false;
+    uint16_t bytes = 0;
+
+    memset(decoded, 0, sizeof(*decoded));
+    for (uint16_t i = 0; (i < stream->count) && (decoded->error == NULL); i++){
+        uint16_t word = stream->words[i];
+        uint16_t instructions = word >> PIO_I2C_WORD_COUNT_SHIFT;
+
+        if (instructions == 0){
+            uint8_t data  = (uint8_t)(word >> PIO_I2C_WORD_DATA_SHIFT);
+            _Bool final   = (word & PIO_I2C_WORD_FINAL) != 0;
+            _Bool release = (word & PIO_I2C_WORD_ACK_RELEASE) != 0;
+            char token[8];
+            bytes++;
+            if (!started){
+                decoded->error = "data outside a transaction";
+            } else if (addressNext || !reading){
+                if (!release || final){
+                    decoded->error = "written byte must release ACK and expect it";
+                }
+                if (addressNext){
+                    reading = (data & 1) != 0;
+                    addressNext = false;
+                }
+                snprintf(token, sizeof(token), "w%02X", data);
+                emit(decoded, token);
+            } else {
+                if (data != 0xFF){
+                    decoded->error = "read byte must release SDA";
+                } else if (release != final){
+                    decoded->error = "NAK without final halts the state machine";
+                }
+                emit(decoded, release ? "r-" : "r+");
+            }
+            scl = 0;                        // jmp pin nak side 0
+            sda = release ? 1 : 0;
+            continue;
+        }
+
+        if (i + 1u + instructions >= stream->count){
+            decoded->error = "instruction group runs past the stream";
+            break;
+        }
+        for (uint16_t k = 0; k <= instructions; k++){
+            uint16_t instruction = stream->words[i + 1 + k];
+            if ((instruction & setMask) != PIO_I2C_INSTR_SET(0, 0)){
+                decoded->error = "not a SET pindirs with side-set and 7 delay cycles";
+                break;
+            }
+            uint8_t nextScl = (instruction >> 11) & 1;
+            uint8_t nextSda = instruction & 1;
+            if ((nextScl != scl) && (nextSda != sda)){
+                decoded->error = "SCL and SDA change together";
+                break;
+            }
+            if (scl && nextScl && (sda != nextSda)){
+                if (nextSda == 0){
+                    emit(decoded, started ? "Sr" : "S");
+                    started = true;
+                    addressNext = true;
+                } else {
+                    emit(decoded, "P");
+                    started = false;
+                }
+            }
+            scl = nextScl;
+            sda = nextSda;
+        }
+        i += instructions + 1;
+    }
+
+    if (decoded->error == NULL){
+        if (bytes != stream->bytes){
+            decoded->error = "RX byte count does not match the data words";
+        } else if (!stream->claimed && (started || !scl || !sda)){
+            decoded->error = "bus not released at the end of the stream";
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t failures;
+
+static void checkStream(const char *name, const PIO_I2C_STREAM *stream, _Bool encoded, const char *expected){
+    BENCH_DECODED decoded;
+    decodeStream(stream, &decoded);
+    _Bool pass = encoded && !stream->overflow && (decoded.error == NULL) && (strcmp(decoded.text, expected) == 0);
+    failures += pass ? 0 : 1;
+
+    printf("{\"bench\":\"pio_i2c\",\"test\":\"encode\",\"case\":\"%s\",\"words\":%u,\"bytes\":%u,\"cycles\":%u,"
+           "\"bus_us_400k\":%.1f,\"bus_us_1M\":%.1f,\"pass\":%s", name, stream->count, stream->bytes,
+           (unsigned int)pioI2CStreamCycles(stream), streamUs(stream, TPS55289_SIM_BUS_FAST),
+           streamUs(stream, TPS55289_SIM_BUS_FAST_PLUS), pass ? "true" : "false");
+    if (!pass){
+        printf(",\"error\":\"%s\",\"decoded\":\"%s\",\"expected\":\"%s\"",
+               decoded.error ? decoded.error : "token mismatch", decoded.text, expected);
+    }
+    printf("}\n");
+}
+
+static void appendTokens(char *text, size_t size, const char *tokens){
+    size_t length = strlen(text);
+    snprintf(text + length, size - length, "%s%s", (length > 0) ? " " : "", tokens);
+}
+
+static void encodeReferenceBurst(PIO_I2C_STREAM *stream, uint16_t code){
+    uint8_t burst[3] = { TPS55289_REF_VOLTAGE_LSB_ADDR, (uint8_t)(code & 0xFF), (uint8_t)(code >> 8) };
+    pioI2CEncodeWrite(stream, TPS55289_I2C_ADDR, burst, sizeof(burst), false);
+}
+
+static void benchEncode(void){
+    PIO_I2C_STREAM stream;
+    char expected[1024];
+    _Bool encoded;
+
+    // Single register write (IOUT_LIMIT)
+    uint8_t limit[2] = { TPS55289_IOUT_LIMIT_ADDR, 0xE4 };
+    pioI2CStreamReset(&stream);
+    encoded = pioI2CEncodeWrite(&stream, TPS55289_I2C_ADDR, limit, sizeof(limit), false);
+    checkStream("register_write", &stream, encoded, "S wE8 w02 wE4 P");
+
+    // REF LSB + MSB in one auto-increment burst
+    pioI2CStreamReset(&stream);
+    encodeReferenceBurst(&stream, 0x0563);
+    checkStream("reference_burst", &stream, !stream.overflow, "S wE8 w00 w63 w05 P");
+
+    // getRegister: pointer write, repeated START, one byte read
+    uint8_t pointer = TPS55289_STATUS_ADDR;
+    pioI2CStreamReset(&stream);
+    encoded = pioI2CEncodeWrite(&stream, TPS55289_I2C_ADDR, &pointer, 1, true) &&
+              pioI2CEncodeRead(&stream, TPS55289_I2C_ADDR, 1, false);
+    checkStream("register_read", &stream, encoded && (stream.readOffset == 3), "S wE8 w07 Sr wE9 r- P");
+
+    // Whole register map 0x00-0x07
+    pointer = TPS55289_REF_VOLTAGE_LSB_ADDR;
+    pioI2CStreamReset(&stream);
+    encoded = pioI2CEncodeWrite(&stream, TPS55289_I2C_ADDR, &pointer, 1, true) &&
+              pioI2CEncodeRead(&stream, TPS55289_I2C_ADDR, 8, false);
+    checkStream("map_read", &stream, encoded && (stream.readLength == 8),
+                "S wE8 w00 Sr wE9 r+ r+ r+ r+ r+ r+ r+ r- P");
+
+    // Sequencer: back-to-back REF updates in one DMA run
+    pioI2CStreamReset(&stream);
+    expected[0] = '\0';
+    for (uint16_t n = 0; n < BENCH_BATCH; n++){
+        uint16_t code = (uint16_t)(0x100 + n * 0x40);
+        char tokens[64];
+        encodeReferenceBurst(&stream, code);
+        snprintf(tokens, sizeof(tokens), "S wE8 w00 w%02X w%02X P", code & 0xFF, code >> 8);
+        appendTokens(expected, sizeof(expected), tokens);
+    }
+    checkStream("sequencer_batch", &stream, !stream.overflow, expected);
+
+    // A transaction that does not fit must be rejected, not truncated
+    static uint8_t large[PIO_I2C_MAX_WORDS];
+    pioI2CStreamReset(&stream);
+    encoded = pioI2CEncodeWrite(&stream, TPS55289_I2C_ADDR, large, sizeof(large), false);
+    _Bool rejected = !encoded && stream.overflow;
+    failures += rejected ? 0 : 1;
+    printf("{\"bench\":\"pio_i2c\",\"test\":\"encode\",\"case\":\"overflow\",\"pass\":%s}\n", rejected ? "true" : "false");
+}
+
+/*
+    REF update bus time. The driver path is setReferenceCode over the hardware controller: two 3-byte
+    transactions, each a separate blocking call. Only wire time is counted for it; the gaps between and
+    inside blocking calls come on top on target.
+*/
+static void benchReferenceUpdate(uint32_t baudrate){
+    TPS55289_SIM sim;
+    TPS55289SimInit(&sim, baudrate);
+    double driverUs = 2.0 * TPS55289SimTransferTime(&sim, 3);
+
+    PIO_I2C_STREAM stream;
+    pioI2CStreamReset(&stream);
+    encodeReferenceBurst(&stream, 0x0563);
+    double burstUs = streamUs(&stream, baudrate);
+
+    pioI2CStreamReset(&stream);
+    for (uint16_t n = 0; n < BENCH_BATCH; n++){
+        encodeReferenceBurst(&stream, (uint16_t)(0x100 + n));
+    }
+    double batchUs = streamUs(&stream, baudrate) / BENCH_BATCH;
+
+    static const char *const paths[] = { "driver_i2c", "pio_burst", "pio_batch" };
+    const double us[] = { driverUs, burstUs, batchUs };
+    const double handoffs[] = { 2, 1, 1.0 / BENCH_BATCH };
+    for (uint32_t i = 0; i < 3; i++){
+        printf("{\"bench\":\"pio_i2c\",\"test\":\"ref_update\",\"path\":\"%s\",\"baud\":%u,\"bus_us\":%.2f,"
+               "\"cpu_handoffs\":%.3f,\"updates_per_s\":%.0f}\n", paths[i], (unsigned int)baudrate, us[i],
+               handoffs[i], 1e6 / us[i]);
+    }
+}
+
+// CPU cost of pre-assembling one REF burst
+static void benchEncodeCost(void){
+    PIO_I2C_STREAM stream;
+    uint32_t words = 0;
+    uint64_t start = benchClockNs();
+    for (uint32_t n = 0; n < BENCH_ENCODE_RUNS; n++){
+        pioI2CStreamReset(&stream);
+        encodeReferenceBurst(&stream, (uint16_t)n & 0x7FF);
+        words += stream.count;
+    }
+    uint64_t elapsed = benchClockNs() - start;
+    printf("{\"bench\":\"pio_i2c\",\"test\":\"encode_cost\",\"runs\":%u,\"words\":%u,\"cpu_ns_per_burst\":%.1f}\n",
+           BENCH_ENCODE_RUNS, (unsigned int)(words / BENCH_ENCODE_RUNS), (double)elapsed / BENCH_ENCODE_RUNS);
+}
+
+int main(void)
+{
+    benchEncode();
+    benchReferenceUpdate(TPS55289_SIM_BUS_FAST);
+    benchReferenceUpdate(TPS55289_SIM_BUS_FAST_PLUS);
+    benchEncodeCost();
+    printf("{\"bench\":\"pio_i2c\",\"test\":\"summary\",\"failures\":%u}\n", (unsigned int)failures);
+    return (failures == 0) ? 0 : 1;
+}
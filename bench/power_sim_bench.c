@@ -0,0 +1,242 @@
+// Idle power benchmark: periodic tick vs tickless idle vs tickless idle with the power manager (host build)
+//
+// Replays a 60 s scripted session in 1 ms steps of virtual time against the TPS55289 simulator. The
+// firmware's tasks are modelled by their vTaskDelay periods (main.c, usb_device.c) plus a 10 ms control
+// loop that samples IOUT; host commands arrive as USB interrupts. Prints two CSV tables:
+//   configuration   wakeups/s, MCU clock residency, converter mode residency and switch counts
+//   hysteresis      mode switches over the noisy-load segment vs a single-threshold comparator
+// and checks that the clock stays full while only one of the two cores is asleep.
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_log.h"
+#include "TPS55289_sim.h"
+#include "power_manager.h"
+
+#define BENCH_DURATION_MS               60000
+#define BENCH_VOUT                      5.0
+#define BENCH_COMMAND_PERIOD_MS         50      // Host polling rate during an active session
+#define BENCH_NAIVE_THRESHOLD           400     // Single PFM/FPWM threshold in mA for comparison
+
+// Task periods in ms: active, idle (stretched by the power manager)
+typedef struct {
+    const char *name;
+    uint32_t active;
+    uint32_t idle;
+} BENCH_TASK;
+
+static const BENCH_TASK benchTasks[] = {
+    { "Green LED",  1000,   1000 },
+    { "Red LED",    100,    100 },
+    { "Log",        10,     250 },
+    { "USB",        1,      100 },
+    { "Control",    10,     100 },
+};
+#define BENCH_TASKS                     (sizeof(benchTasks) / sizeof(benchTasks[0]))
+
+typedef enum {
+    BENCH_PERIODIC_TICK = 0,            // 1 kHz tick, fixed clock, converter held in FPWM
+    BENCH_TICKLESS,                     // Tickless idle only
+    BENCH_TICKLESS_MANAGED,             // Tickless idle + clock-down + PFM/FPWM auto-switching
+    BENCH_CONFIGS
+} BENCH_CONFIG;
+
+static const char *const configNames[BENCH_CONFIGS] = { "periodic_tick", "tickless", "tickless_power_manager" };
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Scripted Session
+
+static uint32_t noiseState;
+
+static uint32_t noise(void){
+    noiseState = noiseState * 1664525u + 1013904223u;
+    return noiseState >> 16;
+}
+
+/*
+    Load profile (mA) and host activity by time:
+      0-5 s     active session, 2 A load
+      5-20 s    host quiet, 2 A load
+      20-40 s   100 mA load, one command at 30 s
+      40-50 s   noisy load, 400 mA +/- 150 mA
+      50-60 s   output open
+*/
+static uint32_t loadCurrent(uint32_t ms){
+    if (ms < 20000){
+        return 2000;
+    } else if (ms < 40000){
+        return 100;
+    } else if (ms < 50000){
+        return 250 + (noise() % 301);
+    }
+    return 0;
+}
+
+static _Bool commandAt(uint32_t ms){
+    if (ms < 5000){
+        return (ms % BENCH_COMMAND_PERIOD_MS) == 0;
+    }
+    return ms == 30000;
+}
+
+static _Bool noisySegment(uint32_t ms){
+    return (ms >= 40000) && (ms < 50000);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    uint32_t wakeups;
+    uint32_t noisySwitches;
+    uint32_t naiveSwitches;
+    POWER_CONVERTER converter;
+    POWER_MANAGER_STATS manager;
+} BENCH_RESULT;
+
+// Both cores go through the tickless hooks; core 1 follows core 0 into and out of sleep
+static void sleepCores(_Bool enter){
+    for (unsigned int core = 0; core < POWER_CORES; core++){
+        uint32_t idleTicks = 1;
+        hostSetCore(core);
+        if (enter){
+            powerManagerPreSleep(&idleTicks);
+        } else {
+            powerManagerPostSleep(&idleTicks);
+        }
+    }
+    hostSetCore(0);
+}
+
+/*
+    Single core idle: core 0 sleeps well past the holdoff while core 1 stays busy. clk_sys is shared, so
+    the clock must stay full until core 1 sleeps too. Returns the number of failed checks.
+*/
+static uint32_t coreIdleCheck(void){
+    uint32_t failures = 0;
+    uint32_t idleTicks = 1;
+    powerManagerInit(NULL);
+    hostAdvanceTime(2 * POWER_IDLE_HOLDOFF_US);
+
+    hostSetCore(0);
+    powerManagerPreSleep(&idleTicks);
+    failures += powerManagerIsIdle() ? 1 : 0;
+    hostSetCore(1);
+    powerManagerPreSleep(&idleTicks);
+    failures += powerManagerIsIdle() ? 0 : 1;
+
+    powerManagerPostSleep(&idleTicks);
+    hostSetCore(0);
+    powerManagerPostSleep(&idleTicks);
+    powerManagerActivity();
+    return failures;
+}
+
+static void runConfig(BENCH_CONFIG config, TPS55289 *device, TPS55289_SIM *sim, BENCH_RESULT *result){
+    _Bool managed = (config == BENCH_TICKLESS_MANAGED);
+    uint32_t nextRun[BENCH_TASKS] = {0};
+    uint8_t naiveMode = POWER_MODE_FPWM;
+
+    *result = (BENCH_RESULT){0};
+    noiseState = 1;
+    powerManagerInit(NULL);
+    powerConverterInit(&result->converter, device);
+
+    uint64_t start = time_us_64();
+    for (uint32_t ms = 0; ms < BENCH_DURATION_MS; ms++){
+        uint64_t target = start + (uint64_t)ms * 1000;
+        if (time_us_64() < target){
+            hostAdvanceTime(target - time_us_64());
+        }
+
+        uint32_t mA = loadCurrent(ms);
+        sim->loadOhms = (mA > 0) ? (BENCH_VOUT * 1000.0f) / mA : 0;
+
+        _Bool wake = (config == BENCH_PERIODIC_TICK);       // Every tick is a wakeup
+        _Bool command = commandAt(ms);
+        if (command){
+            powerManagerActivity();
+            result->wakeups += 2;                           // OUT completion + IN completion interrupts
+        }
+
+        _Bool idle = managed && powerManagerIsIdle();
+        for (uint32_t t = 0; t < BENCH_TASKS; t++){
+            if (ms < nextRun[t]){
+                continue;
+            }
+            wake = true;
+            nextRun[t] = ms + (idle ? benchTasks[t].idle : benchTasks[t].active);
+            if (managed && (t == BENCH_TASKS - 1)){
+                TPS55289SimUpdate(sim);
+                uint32_t before = result->converter.switches;
+                powerConverterUpdate(&result->converter, device, (uint16_t)TPS55289SimIOUT(sim));
+                if (noisySegment(ms)){
+                    result->noisySwitches += result->converter.switches - before;
+                    uint8_t naive = (TPS55289SimIOUT(sim) < BENCH_NAIVE_THRESHOLD) ? POWER_MODE_PFM : POWER_MODE_FPWM;
+                    result->naiveSwitches += (naive != naiveMode) ? 1 : 0;
+                    naiveMode = naive;
+                }
+            }
+        }
+
+        if (config == BENCH_PERIODIC_TICK){
+            result->wakeups++;
+        } else if (wake){
+            sleepCores(false);
+            result->wakeups++;
+        }
+        if (managed){
+            sleepCores(true);
+        }
+        TPS55289LogDiscard();
+    }
+
+    hostAdvanceTime(start + (uint64_t)BENCH_DURATION_MS * 1000 - time_us_64());
+    powerConverterUpdate(&result->converter, device, 0);
+    result->manager = *powerManagerStats();
+}
+
+static double percent(uint64_t part, uint64_t whole){
+    return (whole > 0) ? 100.0 * part / whole : 0;
+}
+
+int main(void)
+{
+    TPS55289LogInit();
+
+    TPS55289_SIM sim;
+    TPS55289SimInit(&sim, TPS55289_SIM_BUS_FAST);
+    sim.VIN = 12000;
+    TPS55289 device = {0};
+    device.transport = &sim.transport;
+    TPS55289Init(&device);
+    setOutputVoltage(&device, BENCH_VOUT);
+    enableDevice(&device);
+    TPS55289LogDiscard();
+
+    BENCH_RESULT results[BENCH_CONFIGS];
+    printf("config,duration_s,wakeups_per_s,clock_full_pct,clock_low_pct,fpwm_pct,pfm_pct,mode_switches,clock_switches\n");
+    for (uint32_t c = 0; c < BENCH_CONFIGS; c++){
+        BENCH_RESULT *result = &results[c];
+        runConfig((BENCH_CONFIG)c, &device, &sim, result);
+
+        uint64_t clockTotal = result->manager.residency[POWER_CLOCK_FULL] + result->manager.residency[POWER_CLOCK_LOW];
+        uint64_t modeTotal  = result->converter.residency[POWER_MODE_FPWM] + result->converter.residency[POWER_MODE_PFM];
+        printf("%s,%u,%.1f,%.1f,%.1f,%.1f,%.1f,%u,%u\n", configNames[c], BENCH_DURATION_MS / 1000,
+               result->wakeups / (BENCH_DURATION_MS / 1000.0),
+               percent(result->manager.residency[POWER_CLOCK_FULL], clockTotal),
+               percent(result->manager.residency[POWER_CLOCK_LOW], clockTotal),
+               percent(result->converter.residency[POWER_MODE_FPWM], modeTotal),
+               percent(result->converter.residency[POWER_MODE_PFM], modeTotal),
+               (unsigned int)result->converter.switches, (unsigned int)result->manager.clockSwitches);
+    }
+
+    const BENCH_RESULT *managed = &results[BENCH_TICKLESS_MANAGED];
+    printf("\nsegment,hysteresis_switches,single_threshold_switches\n");
+    printf("noisy_load,%u,%u\n", (unsigned int)managed->noisySwitches, (unsigned int)managed->naiveSwitches);
+
+    uint32_t failures = coreIdleCheck();
+    printf("\nfailed_checks,%u\n", (unsigned int)failures);
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,296 @@
+// SOA and over-temperature protection benchmark (host build)
+//
+// Sweeps the protection engine and checks it against the model the SOA table was generated from. Prints:
+//   grid        per STATUS mode: grid points, largest difference from the model, smallest and largest limit
+//   sweep       per STATUS mode: points on a 32 mV VIN x VOUT sweep, monotonicity and bound violations, and
+//               the largest difference from bilinear interpolation of the model grid between grid points
+//   thresholds  one line per DERATE/RESTORE/trip/over-temperature case with the action returned
+//   cost        CPU time per TPS55289ProtectionEvaluate over the sweep, with and without a thermistor
+// Returns non-zero if any check failed.
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_protection.h"
+
+#define BENCH_SWEEP_STEP_MV             32
+#define BENCH_GRID_TOLERANCE_MA         1
+#define BENCH_INTERPOLATION_TOLERANCE   3           // Table rounding plus the two shifts of the lookup
+#define BENCH_COST_ROUNDS               20
+
+static const char *modeNames[TPS55289_SOA_MODES] = { "boost", "buck", "buck_boost" };
+static const char *actionNames[] = { "none", "derate", "restore", "soa_trip", "overtemp" };
+
+static uint32_t failures;
+
+static uint64_t benchClockNs(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static const uint32_t vinMax  = ((TPS55289_SOA_VIN_POINTS - 1) << TPS55289_SOA_BIN_SHIFT) - 1;
+static const uint32_t voutMax = ((TPS55289_SOA_VOUT_POINTS - 1) << TPS55289_SOA_BIN_SHIFT) - 1;
+
+/*
+    SOA Model
+
+    The limits the table in TPS55289_protection.c was generated from, in mA: switch current 14A and 3W
+    dissipation, clamped to the IOUT_LIMIT full scale, with VIN clamped to 3V and VOUT to 0.8V.
+*/
+static double benchModel(uint32_t mode, double vin, double vout){
+    vin  = (vin < 3.0) ? 3.0 : vin;
+    vout = (vout < 0.8) ? 0.8 : vout;
+    double k = (mode == 0) ? vout / vin : (mode == 1) ? 1.0 : (vin + vout) / vin;
+    double a = 0.040 * k * k;
+    double b = 0.03 * vout;
+    double dissipation = (-b + sqrt(b * b + 4.0 * a * 3.0)) / (2.0 * a);
+    double limit = 14.0 / k;
+    limit = (dissipation < limit) ? dissipation : limit;
+    limit = (limit > 6.35) ? 6.35 : limit;
+    return limit * 1000.0;
+}
+
+static double modelGrid[TPS55289_SOA_MODES][TPS55289_SOA_VIN_POINTS][TPS55289_SOA_VOUT_POINTS];
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Table
+
+// Grid points straight from the lookup; the last row and column are only reachable 1 mV short
+static void benchGrid(void){
+    printf("mode,grid_points,max_model_diff_ma,min_ma,max_ma\n");
+    for (uint32_t mode = 0; mode < TPS55289_SOA_MODES; mode++){
+        uint32_t worst = 0;
+        uint32_t lowest = 0xFFFF, highest = 0;
+        for (uint32_t i = 0; i < TPS55289_SOA_VIN_POINTS; i++){
+            for (uint32_t j = 0; j < TPS55289_SOA_VOUT_POINTS; j++){
+                modelGrid[mode][i][j] = benchModel(mode, (i << TPS55289_SOA_BIN_SHIFT) / 1000.0,
+                                                   (j << TPS55289_SOA_BIN_SHIFT) / 1000.0);
+                uint32_t vin  = i << TPS55289_SOA_BIN_SHIFT;
+                uint32_t vout = j << TPS55289_SOA_BIN_SHIFT;
+                vin  = (vin > vinMax) ? vinMax : vin;
+                vout = (vout > voutMax) ? voutMax : vout;
+                uint16_t limit = TPS55289SOALimit((uint8_t)mode, (uint16_t)vin, (uint16_t)vout);
+                uint32_t diff = (uint32_t)fabs(limit - modelGrid[mode][i][j]);
+                uint32_t tolerance = BENCH_GRID_TOLERANCE_MA +
+                                     (((i == TPS55289_SOA_VIN_POINTS - 1) || (j == TPS55289_SOA_VOUT_POINTS - 1)) ?
+                                      BENCH_INTERPOLATION_TOLERANCE : 0);
+                if (diff > tolerance){
+                    printf("# %s VIN %u VOUT %u: %u mA, model %.1f mA\n", modeNames[mode], (unsigned int)vin,
+                           (unsigned int)vout, limit, modelGrid[mode][i][j]);
+                    failures++;
+                }
+                worst   = (diff > worst) ? diff : worst;
+                lowest  = (limit < lowest) ? limit : lowest;
+                highest = (limit > highest) ? limit : highest;
+            }
+        }
+        printf("%s,%u,%u,%u,%u\n", modeNames[mode], TPS55289_SOA_VIN_POINTS * TPS55289_SOA_VOUT_POINTS,
+               (unsigned int)worst, (unsigned int)lowest, (unsigned int)highest);
+    }
+}
+
+/*
+    Sweep
+
+    The limit may not rise with VOUT nor fall with VIN in any mode, stays inside (0, 6350] mA, and between
+    grid points follows bilinear interpolation of the model grid. A reserved STATUS mode reads as
+    Buck-Boost.
+*/
+static void benchSweep(void){
+    printf("\nmode,points,not_monotonic,out_of_bounds,max_interpolation_diff_ma\n");
+    for (uint32_t mode = 0; mode < TPS55289_SOA_MODES; mode++){
+        uint32_t points = 0, notMonotonic = 0, outOfBounds = 0;
+        double worst = 0.0;
+        for (uint32_t vin = 0; vin <= vinMax; vin += BENCH_SWEEP_STEP_MV){
+            for (uint32_t vout = 0; vout <= voutMax; vout += BENCH_SWEEP_STEP_MV){
+                uint16_t limit = TPS55289SOALimit((uint8_t)mode, (uint16_t)vin, (uint16_t)vout);
+                points++;
+                if ((limit == 0) || (limit > TPS55289_CURRENT_LIMIT_MAX)){
+                    outOfBounds++;
+                }
+                if ((vout >= BENCH_SWEEP_STEP_MV) &&
+                    (limit > TPS55289SOALimit((uint8_t)mode, (uint16_t)vin, (uint16_t)(vout - BENCH_SWEEP_STEP_MV)))){
+                    notMonotonic++;
+                }
+                if ((vin >= BENCH_SWEEP_STEP_MV) &&
+                    (limit < TPS55289SOALimit((uint8_t)mode, (uint16_t)(vin - BENCH_SWEEP_STEP_MV), (uint16_t)vout))){
+                    notMonotonic++;
+                }
+                if ((mode == 2) && (limit != TPS55289SOALimit(3, (uint16_t)vin, (uint16_t)vout))){
+                    outOfBounds++;
+                }
+
+                uint32_t i = vin >> TPS55289_SOA_BIN_SHIFT;
+                uint32_t j = vout >> TPS55289_SOA_BIN_SHIFT;
+                double fi = (double)(vin & ((1u << TPS55289_SOA_BIN_SHIFT) - 1)) / (1u << TPS55289_SOA_BIN_SHIFT);
+                double fj = (double)(vout & ((1u << TPS55289_SOA_BIN_SHIFT) - 1)) / (1u << TPS55289_SOA_BIN_SHIFT);
+                double lo = modelGrid[mode][i][j] + (modelGrid[mode][i][j + 1] - modelGrid[mode][i][j]) * fj;
+                double hi = modelGrid[mode][i + 1][j] + (modelGrid[mode][i + 1][j + 1] - modelGrid[mode][i + 1][j]) * fj;
+                double diff = fabs(limit - (lo + (hi - lo) * fi));
+                worst = (diff > worst) ? diff : worst;
+            }
+        }
+        if (worst > BENCH_INTERPOLATION_TOLERANCE){
+            failures++;
+        }
+        failures += notMonotonic + outOfBounds;
+        printf("%s,%u,%u,%u,%.2f\n", modeNames[mode], (unsigned int)points, (unsigned int)notMonotonic,
+               (unsigned int)outOfBounds, worst);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Thresholds
+
+static void benchExpect(const char *name, TPS55289_PROTECTION_ACTION action, TPS55289_PROTECTION_ACTION expected,
+                        _Bool ok){
+    printf("%s,%s,%s\n", name, actionNames[action], (ok && (action == expected)) ? "ok" : "FAILED");
+    if (!ok || (action != expected)){
+        failures++;
+    }
+}
+
+// Engine with the given user and applied limits, as after a few ticks at that operating point
+static void benchProtection(TPS55289_PROTECTION *protection, uint16_t user, uint16_t applied){
+    TPS55289ProtectionInit(protection, user);
+    protection->appliedCurrentLimit = applied;
+    protection->targetCurrentLimit  = applied;
+}
+
+static void benchThresholds(void){
+    TPS55289_PROTECTION protection;
+    TPS55289_PROTECTION_SAMPLE sample = { 5000, 12000, 0, 0, false };
+    const uint8_t mode = 0;
+    uint16_t limit  = TPS55289SOALimit(mode, sample.VIN, sample.VOUT);
+    uint16_t target = (limit / TPS55289_CURRENT_LIMIT_STEP) * TPS55289_CURRENT_LIMIT_STEP;
+    TPS55289_PROTECTION_ACTION action;
+    printf("\ncase,action,result\n");
+
+    // Applied limit one code above the SOA: lowered to the SOA rounded down to a whole code
+    benchProtection(&protection, TPS55289_CURRENT_LIMIT_MAX, target + TPS55289_CURRENT_LIMIT_STEP);
+    action = TPS55289ProtectionEvaluate(&protection, mode, &sample);
+    benchExpect("derate_one_code", action, TPS55289_PROTECTION_DERATE,
+                (protection.targetCurrentLimit == target) && (protection.derateEvents == 1) &&
+                (protection.soaCurrentLimit == limit));
+
+    benchProtection(&protection, TPS55289_CURRENT_LIMIT_MAX, target);
+    action = TPS55289ProtectionEvaluate(&protection, mode, &sample);
+    benchExpect("at_soa_code", action, TPS55289_PROTECTION_NONE, protection.derateEvents == 0);
+
+    // User setting below the SOA wins
+    benchProtection(&protection, 1000, 1500);
+    action = TPS55289ProtectionEvaluate(&protection, mode, &sample);
+    benchExpect("derate_to_user", action, TPS55289_PROTECTION_DERATE, protection.targetCurrentLimit == 1000);
+
+    // Raised again only with TPS55289_RESTORE_HYSTERESIS of headroom
+    benchProtection(&protection, TPS55289_CURRENT_LIMIT_MAX, limit - TPS55289_RESTORE_HYSTERESIS);
+    action = TPS55289ProtectionEvaluate(&protection, mode, &sample);
+    benchExpect("restore_at_hysteresis", action, TPS55289_PROTECTION_RESTORE, protection.targetCurrentLimit == target);
+
+    benchProtection(&protection, TPS55289_CURRENT_LIMIT_MAX, limit - TPS55289_RESTORE_HYSTERESIS + 1);
+    action = TPS55289ProtectionEvaluate(&protection, mode, &sample);
+    benchExpect("inside_hysteresis", action, TPS55289_PROTECTION_NONE, true);
+
+    // Trip only after TPS55289_SOA_TRIP_SAMPLES consecutive samples above the limit
+    benchProtection(&protection, TPS55289_CURRENT_LIMIT_MAX, target);
+    sample.IOUT = limit + 1;
+    _Bool early = false;
+    for (uint32_t i = 1; i < TPS55289_SOA_TRIP_SAMPLES; i++){
+        early |= (TPS55289ProtectionEvaluate(&protection, mode, &sample) == TPS55289_PROTECTION_SOA_TRIP);
+    }
+    action = TPS55289ProtectionEvaluate(&protection, mode, &sample);
+    benchExpect("trip_after_samples", action, TPS55289_PROTECTION_SOA_TRIP,
+                !early && (protection.soaTrips == 1) && (protection.overSOASamples == 0));
+
+    // A sample at the limit restarts the count
+    for (uint32_t i = 1; i < TPS55289_SOA_TRIP_SAMPLES; i++){
+        TPS55289ProtectionEvaluate(&protection, mode, &sample);
+    }
+    sample.IOUT = limit;
+    TPS55289ProtectionEvaluate(&protection, mode, &sample);
+    sample.IOUT = limit + 1;
+    early = false;
+    for (uint32_t i = 1; i < TPS55289_SOA_TRIP_SAMPLES; i++){
+        early |= (TPS55289ProtectionEvaluate(&protection, mode, &sample) == TPS55289_PROTECTION_SOA_TRIP);
+    }
+    benchExpect("count_reset_at_limit", early ? TPS55289_PROTECTION_SOA_TRIP : TPS55289_PROTECTION_NONE,
+                TPS55289_PROTECTION_NONE, protection.soaTrips == 1);
+    sample.IOUT = 0;
+
+    // Thermal derating: full limit up to 85 degC, half way at 105 degC, nothing at 125 degC
+    benchExpect("derate_start", TPS55289_PROTECTION_NONE, TPS55289_PROTECTION_NONE,
+                (TPS55289ThermalDerate(limit, TPS55289_DERATE_START_TEMP) == limit) &&
+                (TPS55289ThermalDerate(limit, TPS55289_DERATE_START_TEMP + 1) < limit));
+    benchExpect("derate_midpoint", TPS55289_PROTECTION_NONE, TPS55289_PROTECTION_NONE,
+                TPS55289ThermalDerate(limit, (TPS55289_DERATE_START_TEMP + TPS55289_SHUTDOWN_TEMP) / 2) == limit / 2);
+    benchExpect("derate_shutdown", TPS55289_PROTECTION_NONE, TPS55289_PROTECTION_NONE,
+                (TPS55289ThermalDerate(limit, TPS55289_SHUTDOWN_TEMP) == 0) &&
+                (TPS55289ThermalDerate(limit, TPS55289_SHUTDOWN_TEMP - 1) > 0));
+
+    // The thermistor curve falls with the ADC code; find the last code at or above the shutdown temperature
+    _Bool falling = true;
+    uint16_t hot = 0;
+    for (uint16_t code = 1; code < 4096; code++){
+        int16_t temperature = TPS55289ThermistorTemperature(code);
+        falling &= (temperature <= TPS55289ThermistorTemperature(code - 1));
+        hot = (temperature >= TPS55289_SHUTDOWN_TEMP) ? code : hot;
+    }
+    benchExpect("thermistor_monotonic", TPS55289_PROTECTION_NONE, TPS55289_PROTECTION_NONE, falling);
+
+    sample.thermistorValid = true;
+    sample.thermistor = hot;
+    benchProtection(&protection, TPS55289_CURRENT_LIMIT_MAX, target);
+    action = TPS55289ProtectionEvaluate(&protection, mode, &sample);
+    benchExpect("overtemp_trip", action, TPS55289_PROTECTION_OVERTEMP,
+                (protection.soaCurrentLimit == 0) && (protection.overTempTrips == 1));
+
+    sample.thermistor = hot + 1;
+    benchProtection(&protection, TPS55289_CURRENT_LIMIT_MAX, target);
+    action = TPS55289ProtectionEvaluate(&protection, mode, &sample);
+    uint16_t derated = TPS55289ThermalDerate(limit, TPS55289ThermistorTemperature(hot + 1));
+    benchExpect("overtemp_margin_derates", action, TPS55289_PROTECTION_DERATE,
+                (protection.overTempTrips == 0) && (protection.soaCurrentLimit == derated) &&
+                (protection.targetCurrentLimit == (derated / TPS55289_CURRENT_LIMIT_STEP) * TPS55289_CURRENT_LIMIT_STEP));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cost
+
+static void benchCost(void){
+    static TPS55289_PROTECTION protection;
+    printf("\nthermistor,evaluations,ns_per_evaluation\n");
+    for (uint32_t thermistor = 0; thermistor < 2; thermistor++){
+        TPS55289_PROTECTION_SAMPLE sample = { 0, 0, 2500, 1400, thermistor == 1 };
+        uint32_t evaluations = 0;
+        volatile uint32_t sink = 0;
+        TPS55289ProtectionInit(&protection, 3000);
+        uint64_t start = benchClockNs();
+        for (uint32_t round = 0; round < BENCH_COST_ROUNDS; round++){
+            for (uint32_t vin = 0; vin <= vinMax; vin += BENCH_SWEEP_STEP_MV * 4){
+                for (uint32_t vout = 0; vout <= voutMax; vout += BENCH_SWEEP_STEP_MV * 4){
+                    sample.VIN  = (uint16_t)vin;
+                    sample.VOUT = (uint16_t)vout;
+                    sink += TPS55289ProtectionEvaluate(&protection, (uint8_t)(round % TPS55289_SOA_MODES), &sample);
+                    evaluations++;
+                }
+            }
+        }
+        uint64_t elapsed = benchClockNs() - start;
+        printf("%s,%u,%.1f\n", thermistor ? "yes" : "no", (unsigned int)evaluations, (double)elapsed / evaluations);
+    }
+}
+
+int main(void)
+{
+    benchGrid();
+    benchSweep();
+    benchThresholds();
+    benchCost();
+
+    printf("\nfailed_checks,%u\n", (unsigned int)failures);
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,241 @@
+// Script interpreter benchmark (host build)
+//
+// Assembles four scripts with the host assembler and runs them against the TPS55289 simulator, advancing
+// the virtual clock to each WAIT deadline the way the script task's hardware alarm would. Prints one JSON
+// object per script:
+//   production    5 V -> 12 V ramp in 100 mV / 1 ms steps with a +/-150 mV check per step, then an
+//                 overload into 10 Ohm that must trip OCP
+//   compute       register loop only: interpreter cost per instruction on the host CPU
+//   wrap          ADD and SUB across the int32 limits: registers wrap rather than overflow
+//   tight_wait    VOUT writes paced faster than the bus allows, next to the same loop with a wait it can meet
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_log.h"
+#include "TPS55289_sim.h"
+#include "script_asm.h"
+#include "script_vm.h"
+
+#define BENCH_LOAD_OHMS                 10.0f
+
+static const char productionScript[] =
+    "; Ramp 5 V -> 12 V, check every step, then provoke OCP\n"
+    "        ilim 6000\n"
+    "        vout 5000\n"
+    "        output on\n"
+    "        wait 20ms\n"
+    "        sync                    ; schedule from here\n"
+    "        load r1, 5000           ; expected mV\n"
+    "        load r2, 70             ; steps\n"
+    "ramp:   add r1, 100\n"
+    "        vout r1\n"
+    "        wait 1ms\n"
+    "        measure r0, vout\n"
+    "        sub r0, r1\n"
+    "        jlt r0, -150, low\n"
+    "        jgt r0, 150, high\n"
+    "        djnz r2, ramp\n"
+    "        report 0, r1\n"
+    "        measure r3, iout\n"
+    "        report 1, r3\n"
+    "        ilim 1000               ; 12 V into 10 Ohm wants 1.2 A\n"
+    "        wait 5ms\n"
+    "        jset ocp, tripped\n"
+    "        fail 3\n"
+    "tripped: measure r4, vout\n"
+    "        report 2, r4\n"
+    "        output off\n"
+    "        end\n"
+    "low:    report 3, r0\n"
+    "        fail 1\n"
+    "high:   report 3, r0\n"
+    "        fail 2\n";
+
+static const char computeScript[] =
+    "        load r0, 1000000\n"
+    "loop:   add r1, 3\n"
+    "        djnz r0, loop\n"
+    "        report 0, r1\n"
+    "        end\n";
+
+// Register arithmetic wraps at 32 bits rather than overflowing
+static const char wrapScript[] =
+    "        load r0, 2147483647\n"
+    "        add r0, 1\n"
+    "        report 0, r0\n"
+    "        load r1, 1\n"
+    "        sub r0, r1\n"
+    "        report 1, r0\n"
+    "        end\n";
+
+// %s: wait per iteration
+static const char tightWaitScript[] =
+    "        load r0, 200\n"
+    "        sync\n"
+    "loop:   vout 5000\n"
+    "        wait %s\n"
+    "        djnz r0, loop\n"
+    "        end\n";
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    TPS55289_SIM *sim;
+} BENCH_CONTEXT;
+
+static uint64_t benchClockNs(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+/*
+    Measurement hook: analog channels come straight from the simulator, STATUS is a real register read over
+    the transport so reading it clears the latched flags as on the part.
+*/
+static _Bool benchMeasure(void *context, uint8_t channel, int32_t *value){
+    BENCH_CONTEXT *bench = (BENCH_CONTEXT *)context;
+    TPS55289SimUpdate(bench->sim);
+    switch (channel){
+        case SCRIPT_CHANNEL_VIN:
+            *value = (int32_t)bench->sim->VIN;
+            return true;
+        case SCRIPT_CHANNEL_VOUT:
+            *value = (int32_t)bench->sim->VOUT;
+            return true;
+        case SCRIPT_CHANNEL_IOUT:
+            *value = (int32_t)TPS55289SimIOUT(bench->sim);
+            return true;
+        case SCRIPT_CHANNEL_STATUS: {
+            const TPS55289_TRANSPORT *transport = &bench->sim->transport;
+            uint8_t pointer = TPS55289_STATUS_ADDR;
+            uint8_t status;
+            if ((transport->write(transport->context, bench->sim->address, &pointer, 1, true) != 1) ||
+                (transport->read(transport->context, bench->sim->address, &status, 1, false) != 1)){
+                return false;
+            }
+            *value = status;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+typedef struct {
+    uint32_t steps;                     // scriptVmStep calls
+    uint32_t sleeps;                    // WAITING returns, i.e. timer wakeups on target
+    uint64_t cpuNs;
+} BENCH_RUN;
+
+static _Bool benchLoad(SCRIPT_VM *vm, const char *source){
+    uint8_t program[SCRIPT_VM_MAX_PROGRAM];
+    SCRIPT_ASM_ERROR error;
+    int length = scriptAsmAssemble(source, program, sizeof(program), &error);
+    if (length < 0){
+        fprintf(stderr, "line %d: %s\n", error.line, error.message);
+        return false;
+    }
+    return scriptVmLoad(vm, 0, program, (uint16_t)length);
+}
+
+static SCRIPT_STATE benchRun(SCRIPT_VM *vm, BENCH_RUN *run){
+    SCRIPT_STATE state;
+    *run = (BENCH_RUN){0};
+    if (scriptVmStart(vm) == false){
+        return (SCRIPT_STATE)vm->state;
+    }
+    uint64_t start = benchClockNs();
+    for (;;){
+        state = scriptVmStep(vm);
+        run->steps++;
+        if (state == SCRIPT_STATE_WAITING){
+            run->sleeps++;
+            if (vm->wakeAt > time_us_64()){
+                hostAdvanceTime(vm->wakeAt - time_us_64());
+            }
+        } else if (state != SCRIPT_STATE_RUNNING){
+            break;
+        }
+    }
+    run->cpuNs = benchClockNs() - start;
+    TPS55289LogDiscard();
+    return state;
+}
+
+static void benchReport(const char *name, const SCRIPT_VM *vm, const BENCH_RUN *run, const char *extra){
+    printf("{\"bench\":\"script_vm\",\"script\":\"%s\",\"length\":%u,\"state\":%u,\"error\":%u,\"fail\":%u,",
+           name, (unsigned int)vm->length, (unsigned int)vm->state, (unsigned int)vm->error,
+           (unsigned int)vm->failCode);
+    printf("\"instructions\":%u,\"steps\":%u,\"sleeps\":%u,\"virtual_ms\":%.3f,\"overruns\":%u,",
+           (unsigned int)vm->instructions, (unsigned int)run->steps, (unsigned int)run->sleeps,
+           (vm->finished - vm->started) / 1000.0, (unsigned int)vm->overruns);
+    printf("\"cpu_ns_per_instr\":%.1f,\"results\":[", (vm->instructions > 0) ? (double)run->cpuNs / vm->instructions : 0);
+    for (uint32_t i = 0; i < SCRIPT_VM_RESULTS; i++){
+        printf("%s%d", (i > 0) ? "," : "", (int)vm->results[i]);
+    }
+    printf("]%s}\n", extra);
+}
+
+int main(void)
+{
+    TPS55289LogInit();
+
+    TPS55289_SIM sim;
+    TPS55289SimInit(&sim, TPS55289_SIM_BUS_FAST);
+    sim.VIN = 12000;
+    sim.loadOhms = BENCH_LOAD_OHMS;
+    TPS55289 device = {0};
+    device.transport = &sim.transport;
+    TPS55289Init(&device);
+    enableOutputCurrentLimit(&device);
+    TPS55289LogDiscard();
+
+    BENCH_CONTEXT context = { .sim = &sim };
+    static SCRIPT_VM vm;
+    scriptVmInit(&vm, &device, benchMeasure, &context);
+
+    BENCH_RUN run;
+    int failures = 0;
+
+    if (benchLoad(&vm, productionScript) == false){
+        return 1;
+    }
+    failures += (benchRun(&vm, &run) != SCRIPT_STATE_DONE);
+    benchReport("production", &vm, &run, "");
+
+    if (benchLoad(&vm, computeScript) == false){
+        return 1;
+    }
+    failures += (benchRun(&vm, &run) != SCRIPT_STATE_DONE);
+    char extra[64];
+    snprintf(extra, sizeof(extra), ",\"cpu_Minstr_per_s\":%.1f", vm.instructions * 1000.0 / run.cpuNs);
+    benchReport("compute", &vm, &run, extra);
+
+    if (benchLoad(&vm, wrapScript) == false){
+        return 1;
+    }
+    failures += (benchRun(&vm, &run) != SCRIPT_STATE_DONE);
+    failures += (vm.results[0] != INT32_MIN) || (vm.results[1] != INT32_MAX);
+    benchReport("wrap", &vm, &run, "");
+
+    // setOutputVoltage costs ~290 us of bus time at 400 kHz: a 100 us period cannot be met, 400 us can
+    static const char *const waits[] = { "100us", "400us" };
+    for (uint32_t i = 0; i < sizeof(waits) / sizeof(waits[0]); i++){
+        char source[256];
+        snprintf(source, sizeof(source), tightWaitScript, waits[i]);
+        if (benchLoad(&vm, source) == false){
+            return 1;
+        }
+        failures += (benchRun(&vm, &run) != SCRIPT_STATE_DONE);
+        snprintf(extra, sizeof(extra), ",\"wait\":\"%s\"", waits[i]);
+        benchReport("tight_wait", &vm, &run, extra);
+    }
+
+    printf("{\"bench\":\"script_vm\",\"failures\":%d}\n", failures);
+    return (failures == 0) ? 0 : 1;
+}
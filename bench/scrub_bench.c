@@ -0,0 +1,198 @@
+// Register scrubber benchmark (host build)
+//
+// Checks the scrubber against injected faults on the TPS55289 simulator, then measures what it costs. Prints:
+//   cases       one line per injected fault: scrub result, repair writes, and whether device and cache agree after
+//   read_cost   bus time of one scrub read, as one burst vs eight single-register reads, per bus speed
+//   interval    60 s at 400 kHz with a brown-out every 7.31 s: bus time spent scrubbing (percentage of the
+//               bus), and the time the output stays down after each brown-out until the scrub restores it
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_log.h"
+#include "TPS55289_scrub.h"
+#include "TPS55289_sim.h"
+
+#define BENCH_VOUT                      12.0f
+#define BENCH_DURATION_US               60000000ull
+#define BENCH_BROWNOUT_PERIOD_US        7312345ull      // Not a multiple of any interval, so the phase walks
+
+typedef struct {
+    TPS55289_SIM sim;
+    TPS55289 device;
+    TPS55289_SCRUB scrub;
+} BENCH_RIG;
+
+static void benchSetup(BENCH_RIG *rig, uint32_t busHz){
+    memset(rig, 0, sizeof(*rig));
+    TPS55289SimInit(&rig->sim, busHz);
+    rig->device.transport = &rig->sim.transport;
+    TPS55289Init(&rig->device);
+    setStepSize(&rig->device, 0x02);
+    setOutputCurrentLimit(&rig->device, 3.0f);
+    setOutputVoltage(&rig->device, BENCH_VOUT);
+    TPS55289ScrubInit(&rig->scrub);
+    TPS55289LogDiscard();
+    TPS55289SimResetStats(&rig->sim);
+}
+
+static _Bool benchMatches(const BENCH_RIG *rig){
+    uint8_t shadow[TPS55289_SCRUB_WRITABLE];
+    TPS55289ScrubShadow(&rig->device, shadow);
+    for (uint32_t i = 0; i < TPS55289_SCRUB_WRITABLE; i++){
+        if ((rig->sim.registers[i] ^ shadow[i]) & rig->scrub.mask[i]){
+            return false;
+        }
+    }
+    return true;
+}
+
+static const char *resultNames[] = { "clean", "repaired", "reset", "failed" };
+
+typedef void (*BENCH_INJECT)(BENCH_RIG *rig);
+
+static void injectNothing(BENCH_RIG *rig)       { (void)rig; }
+static void injectLimitBit(BENCH_RIG *rig)      { rig->sim.registers[TPS55289_IOUT_LIMIT_ADDR] ^= 0x10; }
+static void injectRefByte(BENCH_RIG *rig)       { rig->sim.registers[TPS55289_REF_VOLTAGE_LSB_ADDR] ^= 0x5A; }
+static void injectOutputOff(BENCH_RIG *rig)     { rig->sim.registers[TPS55289_MODE_ADDR] &= (uint8_t)~TPS55289_SIM_MODE_OE; }
+static void injectBrownout(BENCH_RIG *rig)      { TPS55289SimReset(&rig->sim); }
+
+// Reserved bits of MODE (bits 2-3 in TPS55289_MODE_REG) are not compared
+static void injectReservedBits(BENCH_RIG *rig)  { rig->sim.registers[TPS55289_MODE_ADDR] ^= 0x0C; }
+
+// A short that latches SCP: the scrub read clears it, so the scrubber must act on it
+static void injectShort(BENCH_RIG *rig){
+    rig->sim.shortCircuit = true;
+    TPS55289SimUpdate(&rig->sim);
+    rig->sim.shortCircuit = false;
+}
+
+static const struct {
+    const char *name;
+    BENCH_INJECT inject;
+    TPS55289_SCRUB_RESULT expected;
+    uint32_t writes;                    // Register writes expected from the scrub
+    _Bool outputOn;                     // OE expected in the device afterwards
+} cases[] = {
+    { "no_fault",          injectNothing,      TPS55289_SCRUB_CLEAN,    0, true  },
+    { "ilim_bit_flip",     injectLimitBit,     TPS55289_SCRUB_REPAIRED, 1, true  },
+    { "ref_lsb_corrupt",   injectRefByte,      TPS55289_SCRUB_REPAIRED, 1, true  },
+    { "oe_dropped",        injectOutputOff,    TPS55289_SCRUB_REPAIRED, 1, true  },
+    { "mode_reserved",     injectReservedBits, TPS55289_SCRUB_CLEAN,    0, true  },
+    { "brownout",          injectBrownout,     TPS55289_SCRUB_RESET,    5, true  },
+    { "latched_scp",       injectShort,        TPS55289_SCRUB_CLEAN,    1, false },
+};
+
+static uint32_t benchCases(void){
+    static BENCH_RIG rig;
+    uint32_t failures = 0;
+
+    printf("case,result,writes,drift_mask,device_matches_cache,output_on,ok\n");
+    for (uint32_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++){
+        benchSetup(&rig, TPS55289_SIM_BUS_FAST);
+        cases[c].inject(&rig);
+        TPS55289_SCRUB_RESULT result = TPS55289Scrub(&rig.device, &rig.scrub);
+        TPS55289LogDiscard();
+
+        uint32_t mask = 0;
+        for (uint32_t i = 0; i < TPS55289_SCRUB_WRITABLE; i++){
+            mask |= (rig.scrub.drift[i] != 0) ? (1u << i) : 0;
+        }
+        TPS55289_MODE_REG mode = { .regValue = rig.sim.registers[TPS55289_MODE_ADDR] };
+        _Bool matches = benchMatches(&rig);
+        _Bool ok = (result == cases[c].expected) && (rig.sim.writes == cases[c].writes) && matches &&
+                   (mode.OE == cases[c].outputOn);
+        failures += ok ? 0 : 1;
+        printf("%s,%s,%u,0x%02x,%s,%u,%s\n", cases[c].name, resultNames[result], (unsigned int)rig.sim.writes,
+               (unsigned int)mask, matches ? "yes" : "no", mode.OE, ok ? "ok" : "FAIL");
+    }
+    return failures;
+}
+
+static void benchReadCost(void){
+    static const uint32_t speeds[] = { TPS55289_SIM_BUS_STANDARD, TPS55289_SIM_BUS_FAST, TPS55289_SIM_BUS_FAST_PLUS };
+    static BENCH_RIG rig;
+
+    printf("\nbus_hz,burst_read_us,single_reads_us\n");
+    for (uint32_t s = 0; s < sizeof(speeds) / sizeof(speeds[0]); s++){
+        benchSetup(&rig, speeds[s]);
+        uint8_t map[TPS55289_SCRUB_REGISTERS];
+        TPS55289ReadRegisters(&rig.device, 0, map, sizeof(map));
+        uint64_t burst = rig.sim.busTimeUs;
+
+        TPS55289SimResetStats(&rig.sim);
+        for (uint8_t i = 0; i < TPS55289_SCRUB_REGISTERS; i++){
+            TPS55289ReadRegisters(&rig.device, i, &map[i], 1);
+        }
+        printf("%u,%llu,%llu\n", (unsigned int)speeds[s], (unsigned long long)burst,
+               (unsigned long long)rig.sim.busTimeUs);
+    }
+}
+
+// Moves the virtual clock forward to an absolute time
+static void advanceTo(uint64_t when){
+    uint64_t now = time_us_64();
+    if (when > now){
+        hostAdvanceTime(when - now);
+    }
+}
+
+static uint32_t benchInterval(uint32_t intervalMs){
+    static BENCH_RIG rig;
+    benchSetup(&rig, TPS55289_SIM_BUS_FAST);
+
+    uint64_t start       = time_us_64();
+    uint64_t interval    = (uint64_t)intervalMs * 1000;
+    uint64_t nextScrub   = start + interval;
+    uint64_t nextFault   = start + BENCH_BROWNOUT_PERIOD_US;
+    uint64_t faultAt     = 0;
+    uint64_t downTotal   = 0;
+    uint64_t downMax     = 0;
+    uint32_t brownouts   = 0;
+    uint32_t recovered   = 0;
+
+    while (time_us_64() - start < BENCH_DURATION_US){
+        if (nextFault < nextScrub){
+            advanceTo(nextFault);
+            TPS55289SimReset(&rig.sim);
+            faultAt = time_us_64();
+            brownouts++;
+            nextFault += BENCH_BROWNOUT_PERIOD_US;
+            continue;
+        }
+        advanceTo(nextScrub);
+        if ((TPS55289Scrub(&rig.device, &rig.scrub) == TPS55289_SCRUB_RESET) && (faultAt != 0)){
+            uint64_t down = time_us_64() - faultAt;
+            downTotal += down;
+            downMax = (down > downMax) ? down : downMax;
+            recovered++;
+            faultAt = 0;
+        }
+        TPS55289LogDiscard();
+        nextScrub += interval;
+    }
+
+    uint64_t elapsed = time_us_64() - start;
+    printf("%u,%u,%llu,%.1f,%.4f,%u,%u,%.1f,%.1f\n", (unsigned int)intervalMs, (unsigned int)rig.scrub.scrubs,
+           (unsigned long long)rig.sim.busTimeUs, (double)rig.sim.busTimeUs / rig.scrub.scrubs,
+           100.0 * rig.sim.busTimeUs / elapsed, (unsigned int)brownouts, (unsigned int)recovered,
+           recovered ? downTotal / 1000.0 / recovered : 0.0, downMax / 1000.0);
+    return (recovered == brownouts) ? 0 : 1;
+}
+
+int main(void)
+{
+    static const uint32_t intervals[] = { 10, 50, 100, 250, 1000, 5000 };
+    uint32_t failures = benchCases();
+    benchReadCost();
+
+    printf("\ninterval_ms,scrubs,bus_us,bus_us_per_scrub,bus_pct,brownouts,recovered,mean_down_ms,max_down_ms\n");
+    for (uint32_t i = 0; i < sizeof(intervals) / sizeof(intervals[0]); i++){
+        failures += benchInterval(intervals[i]);
+    }
+
+    printf("\nfailed_checks,%u\n", (unsigned int)failures);
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,539 @@
+// Stackless driver sequence benchmark (host build)
+//
+// Brings up N simulated converters, each on its own bus, and ramps every one of them to a different
+// setpoint, two ways:
+//   sequences   one TPS55289_SEQ_OP per device, all multiplexed by TPS55289SeqRun on one stack
+//   tasks       one task per device with its own stack, running TPS55289Init and setReferenceCode
+//               straight-line. ucontext stands in for the RTOS: a write starts a split write and
+//               switches out until the transfer is done, a sleep switches out until the deadline
+// Both schedulers only resume what can make progress, and move the virtual clock to the next
+// completion or deadline when nothing can, so the bus timeline is the same and only the CPU side differs.
+// Prints the cost of one bare resume (protothread re-entry against a swapcontext round trip), then per
+// mode and device count: writes, resumes, host CPU per resume, virtual makespan, and RAM on target.
+// Target RAM counts sequence state plus the one 256-word sequence task stack, against a 1024-word stack
+// per task as the driver tasks were first created with; TCBs are left out of both. The deepest stack a
+// host task actually used is printed alongside, from a pattern fill. glibc swapcontext also saves the
+// signal mask with a system call, which a FreeRTOS switch does not, so the task costs are an upper bound.
+// Last, a thread standing in for another task holds a controller lock: no sequence write may reach that
+// bus until it lets go, and the scheduler must report the wait so its task polls rather than sleeping
+// for good. Then one starts an operation while the pass is finishing the operation at the head of the
+// list: the new one must not be unlinked with it. Last of all, an initialisation finds a latched short
+// with its queued STATUS read and turns the output off, and a voltage change on a device with the output
+// state machine attached is refused without a write.
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_log.h"
+#include "TPS55289_output.h"
+#include "TPS55289_seq.h"
+#include "TPS55289_sim.h"
+
+#define BENCH_MAX_DEVICES               16
+#define BENCH_STEPS                     50
+#define BENCH_INTERVAL_US               200
+#define BENCH_SWITCH_RUNS               1000000
+#define BENCH_HOST_STACK_BYTES          65536
+#define BENCH_TARGET_TASK_WORDS         1024
+#define BENCH_TARGET_SEQ_WORDS          256
+#define BENCH_STACK_FILL                0xA5
+
+static const uint32_t deviceCounts[] = { 1, 4, 8, 16 };
+
+typedef enum {
+    BENCH_TASK_READY = 0,
+    BENCH_TASK_WAIT_WRITE,
+    BENCH_TASK_WAIT_TIME,
+    BENCH_TASK_DONE
+} BENCH_TASK_STATE;
+
+typedef struct {
+    ucontext_t context;
+    BENCH_TASK_STATE state;
+    uint64_t wakeAt;
+    TPS55289_TRANSPORT transport;       // Blocking transport that switches out while a write is on the wire
+    uint8_t stack[BENCH_HOST_STACK_BYTES];
+} BENCH_TASK;
+
+typedef struct {
+    TPS55289_SIM sim[BENCH_MAX_DEVICES];
+    TPS55289 device[BENCH_MAX_DEVICES];
+    TPS55289_SEQ_OP op[BENCH_MAX_DEVICES];
+    BENCH_TASK task[BENCH_MAX_DEVICES];
+    TPS55289_SEQ seq;
+    ucontext_t scheduler;
+    uint32_t devices;
+    uint64_t switches;
+    uint64_t writes;
+} BENCH_RIG;
+
+typedef struct {
+    uint64_t writes;
+    uint64_t resumes;
+    uint64_t cpuNs;
+    uint64_t makespanUs;
+    uint8_t  registers[BENCH_MAX_DEVICES][TPS55289_SIM_REGISTERS];
+    uint32_t failed;
+} BENCH_RESULT;
+
+static BENCH_RIG rig;
+
+static uint64_t benchClockNs(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static float benchTarget(uint32_t i){
+    return 5.0f + 0.5f * (float)i;
+}
+
+static void benchSetup(uint32_t devices){
+    for (uint32_t i = 0; i < devices; i++){
+        memset(&rig.device[i], 0, sizeof(rig.device[i]));
+        memset(&rig.op[i], 0, sizeof(rig.op[i]));
+        TPS55289SimInit(&rig.sim[i], TPS55289_SIM_BUS_FAST);
+        rig.sim[i].transactionOverheadUs = i % 3;
+        rig.device[i].transport = &rig.sim[i].transport;
+    }
+    rig.devices  = devices;
+    rig.switches = 0;
+    rig.writes   = 0;
+}
+
+// Earliest split-write completion or sleep deadline; false if nothing is waiting on time
+static _Bool benchNextEvent(uint64_t *at, _Bool found){
+    for (uint32_t i = 0; i < rig.devices; i++){
+        if ((rig.sim[i].pendingLength > 0) && (!found || (rig.sim[i].pendingDone < *at))){
+            *at   = rig.sim[i].pendingDone;
+            found = true;
+        }
+        if ((rig.task[i].state == BENCH_TASK_WAIT_TIME) && (!found || (rig.task[i].wakeAt < *at))){
+            *at   = rig.task[i].wakeAt;
+            found = true;
+        }
+    }
+    return found;
+}
+
+static void benchSkipTo(uint64_t at){
+    uint64_t now = time_us_64();
+    if (at > now){
+        hostAdvanceTime(at - now);
+    }
+}
+
+static void benchCollect(BENCH_RESULT *result, uint64_t start){
+    result->makespanUs = time_us_64() - start;
+    for (uint32_t i = 0; i < rig.devices; i++){
+        memcpy(result->registers[i], rig.sim[i].registers, TPS55289_SIM_REGISTERS);
+        uint16_t expected = TPS55289VoltageCode(&rig.device[i], benchTarget(i));
+        uint16_t written  = (uint16_t)(rig.sim[i].registers[TPS55289_REF_VOLTAGE_MSB_ADDR] << 8) |
+                            rig.sim[i].registers[TPS55289_REF_VOLTAGE_LSB_ADDR];
+        result->failed += (written != expected) ? 1 : 0;
+        result->failed += (rig.device[i].TPS55289_REF_VOLTAGE.regValue_16 != expected) ? 1 : 0;
+        result->failed += (rig.device[i].TPS55289_MODE.regValue != rig.sim[i].registers[TPS55289_MODE_ADDR]) ? 1 : 0;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sequences
+
+static void benchSequences(uint32_t devices, BENCH_RESULT *result){
+    benchSetup(devices);
+    TPS55289SeqInit(&rig.seq);
+    uint64_t start = time_us_64();
+    uint64_t cpuNs = 0;
+
+    for (uint32_t phase = 0; phase < 2; phase++){
+        for (uint32_t i = 0; i < devices; i++){
+            if (phase == 0){
+                TPS55289SeqStartInit(&rig.seq, &rig.op[i], &rig.device[i]);
+            } else {
+                TPS55289SeqStartRamp(&rig.seq, &rig.op[i], &rig.device[i], benchTarget(i), BENCH_STEPS,
+                                     BENCH_INTERVAL_US);
+            }
+        }
+        for (;;){
+            uint64_t before = benchClockNs();
+            uint32_t active = TPS55289SeqRun(&rig.seq);
+            cpuNs += benchClockNs() - before;
+            if (active == 0){
+                break;
+            }
+            uint64_t at = 0;
+            _Bool found = TPS55289SeqNextWake(&rig.seq, &at);
+            if (benchNextEvent(&at, found)){
+                benchSkipTo(at);
+            }
+        }
+    }
+
+    result->writes  = rig.seq.writes;
+    result->resumes = rig.seq.resumes;
+    result->cpuNs   = cpuNs;
+    result->failed  = rig.seq.failures;
+    benchCollect(result, start);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// One Task Per Device
+
+static void benchYield(BENCH_TASK *task){
+    swapcontext(&task->context, &rig.scheduler);
+}
+
+static int benchTaskWrite(void *context, uint8_t address, const uint8_t *src, size_t len, _Bool nostop){
+    BENCH_TASK *task = (BENCH_TASK *)context;
+    TPS55289_SIM *sim = &rig.sim[task - rig.task];
+    (void)nostop;
+
+    rig.writes++;
+    int result = sim->transport.writeStart(sim, address, src, len);
+    if (result != (int)len){
+        return result;
+    }
+    while ((result = sim->transport.writePoll(sim)) == 0){
+        task->state = BENCH_TASK_WAIT_WRITE;
+        benchYield(task);
+    }
+    return result;
+}
+
+static int benchTaskRead(void *context, uint8_t address, uint8_t *dst, size_t len, _Bool nostop){
+    BENCH_TASK *task = (BENCH_TASK *)context;
+    TPS55289_SIM *sim = &rig.sim[task - rig.task];
+    return sim->transport.read(sim, address, dst, len, nostop);
+}
+
+static void benchTaskSleep(BENCH_TASK *task, uint32_t us){
+    task->wakeAt = time_us_64() + us;
+    task->state  = BENCH_TASK_WAIT_TIME;
+    benchYield(task);
+}
+
+// What a driver task would run: bring-up, then the ramp with a sleep between steps
+static void benchTaskBody(int index){
+    BENCH_TASK *task = &rig.task[index];
+    TPS55289 *device = &rig.device[index];
+
+    if (TPS55289Init(device)){
+        float from = device->settings.VOUT;
+        float to   = benchTarget((uint32_t)index);
+        for (uint32_t step = 1; step <= BENCH_STEPS; step++){
+            float voltage = from + (to - from) * step / BENCH_STEPS;
+            if (!setReferenceCode(device, TPS55289VoltageCode(device, voltage))){
+                break;
+            }
+            device->settings.VOUT = voltage;
+            if (step < BENCH_STEPS){
+                benchTaskSleep(task, BENCH_INTERVAL_US);
+            }
+        }
+    }
+    task->state = BENCH_TASK_DONE;
+}
+
+static _Bool benchTaskReady(const BENCH_TASK *task){
+    switch (task->state){
+        case BENCH_TASK_READY:
+            return true;
+        case BENCH_TASK_WAIT_WRITE:
+            return time_us_64() >= rig.sim[task - rig.task].pendingDone;
+        case BENCH_TASK_WAIT_TIME:
+            return time_us_64() >= task->wakeAt;
+        default:
+            return false;
+    }
+}
+
+static size_t benchStackUsed(const BENCH_TASK *task){
+    size_t untouched = 0;
+    while ((untouched < sizeof(task->stack)) && (task->stack[untouched] == BENCH_STACK_FILL)){
+        untouched++;
+    }
+    return sizeof(task->stack) - untouched;
+}
+
+static size_t benchTasks(uint32_t devices, BENCH_RESULT *result){
+    benchSetup(devices);
+    for (uint32_t i = 0; i < devices; i++){
+        BENCH_TASK *task = &rig.task[i];
+        memset(task->stack, BENCH_STACK_FILL, sizeof(task->stack));
+        task->transport.write      = benchTaskWrite;
+        task->transport.read       = benchTaskRead;
+        task->transport.writeStart = NULL;
+        task->transport.writePoll  = NULL;
+        task->transport.context    = task;
+        task->state                = BENCH_TASK_READY;
+        rig.device[i].transport    = &task->transport;
+
+        getcontext(&task->context);
+        task->context.uc_stack.ss_sp   = task->stack;
+        task->context.uc_stack.ss_size = sizeof(task->stack);
+        task->context.uc_link          = &rig.scheduler;
+        makecontext(&task->context, (void (*)(void))benchTaskBody, 1, (int)i);
+    }
+
+    uint64_t start = time_us_64();
+    uint64_t cpuNs = 0;
+    for (;;){
+        uint32_t active = 0;
+        uint64_t before = benchClockNs();
+        for (uint32_t i = 0; i < devices; i++){
+            BENCH_TASK *task = &rig.task[i];
+            if (task->state == BENCH_TASK_DONE){
+                continue;
+            }
+            if (benchTaskReady(task)){
+                rig.switches++;
+                swapcontext(&rig.scheduler, &task->context);
+            }
+            active += (task->state != BENCH_TASK_DONE) ? 1 : 0;
+        }
+        cpuNs += benchClockNs() - before;
+        if (active == 0){
+            break;
+        }
+        uint64_t at = 0;
+        if (benchNextEvent(&at, false)){
+            benchSkipTo(at);
+        }
+    }
+
+    size_t deepest = 0;
+    for (uint32_t i = 0; i < devices; i++){
+        size_t used = benchStackUsed(&rig.task[i]);
+        deepest = (used > deepest) ? used : deepest;
+        rig.task[i].state = BENCH_TASK_DONE;
+    }
+    result->writes  = rig.writes;
+    result->resumes = rig.switches;
+    result->cpuNs   = cpuNs;
+    benchCollect(result, start);
+    return deepest;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Bare Resume Cost
+
+static TPS55289_SEQ_RESULT benchYieldBody(TPS55289_SEQ_OP *op){
+    TPS55289_SEQ_BEGIN(op);
+    for (;;){
+        TPS55289_SEQ_YIELD(op);
+    }
+    TPS55289_SEQ_END(op);
+}
+
+static ucontext_t pingContext;
+static ucontext_t pongContext;
+static uint8_t pongStack[BENCH_HOST_STACK_BYTES];
+
+static void benchPong(void){
+    for (;;){
+        swapcontext(&pongContext, &pingContext);
+    }
+}
+
+static void benchSwitchCost(void){
+    TPS55289_SEQ_OP op;
+    memset(&op, 0, sizeof(op));
+    TPS55289_SEQ_BODY volatile body = benchYieldBody;
+    uint64_t start = benchClockNs();
+    for (uint32_t i = 0; i < BENCH_SWITCH_RUNS; i++){
+        body(&op);
+    }
+    uint64_t seqNs = benchClockNs() - start;
+
+    getcontext(&pongContext);
+    pongContext.uc_stack.ss_sp   = pongStack;
+    pongContext.uc_stack.ss_size = sizeof(pongStack);
+    pongContext.uc_link          = NULL;
+    makecontext(&pongContext, benchPong, 0);
+    start = benchClockNs();
+    for (uint32_t i = 0; i < BENCH_SWITCH_RUNS; i++){
+        swapcontext(&pingContext, &pongContext);
+    }
+    uint64_t taskNs = benchClockNs() - start;
+
+    printf("seq_resume_ns,task_switch_ns,seq_op_bytes,seq_scheduler_bytes\n");
+    printf("%.1f,%.1f,%u,%u\n", (double)seqNs / BENCH_SWITCH_RUNS, (double)taskNs / BENCH_SWITCH_RUNS,
+           (unsigned int)sizeof(TPS55289_SEQ_OP), (unsigned int)sizeof(TPS55289_SEQ));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Controller Lock
+
+static atomic_int holderState;          // 0 starting, 1 holding, 2 release requested
+
+static void *benchHolder(void *param){
+    TPS55289_SIM *sim = param;
+    recursive_mutex_enter_blocking(&sim->lock);
+    atomic_store(&holderState, 1);
+    while (atomic_load(&holderState) != 2){
+    }
+    recursive_mutex_exit(&sim->lock);
+    return NULL;
+}
+
+static uint32_t benchLockedBus(void){
+    uint32_t failures = 0;
+    pthread_t holder;
+    benchSetup(1);
+    TPS55289SeqInit(&rig.seq);
+    atomic_store(&holderState, 0);
+    pthread_create(&holder, NULL, benchHolder, &rig.sim[0]);
+    while (atomic_load(&holderState) != 1){
+    }
+
+    TPS55289SeqStartInit(&rig.seq, &rig.op[0], &rig.device[0]);
+    for (uint32_t i = 0; i < 100; i++){
+        TPS55289SeqRun(&rig.seq);
+        hostAdvanceTime(BENCH_INTERVAL_US);
+    }
+    uint32_t whileHeld = rig.sim[0].writes;
+    _Bool busyReported = rig.seq.lockBusy;
+    atomic_store(&holderState, 2);
+    pthread_join(holder, NULL);
+
+    while (TPS55289SeqRun(&rig.seq) > 0){
+        hostAdvanceTime(BENCH_INTERVAL_US);
+    }
+    printf("\nlock,writes_while_held,busy_reported,writes_after_release,state\n");
+    printf("controller_held,%u,%u,%u,%s\n", (unsigned int)whileHeld, (unsigned int)busyReported,
+           (unsigned int)rig.sim[0].writes, (rig.op[0].state == TPS55289_SEQ_DONE) ? "done" : "not_done");
+    failures += ((whileHeld != 0) || !busyReported || rig.seq.lockBusy) ? 1 : 0;
+    failures += ((rig.sim[0].writes == 0) || (rig.op[0].state != TPS55289_SEQ_DONE)) ? 1 : 0;
+    return failures;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Start During Run
+
+static atomic_int starterState;         // 0 waiting, 1 body ending, 2 operation started
+
+static TPS55289_SEQ_RESULT benchLateBody(TPS55289_SEQ_OP *op){
+    TPS55289_SEQ_BEGIN(op);
+    TPS55289_SEQ_END(op);
+}
+
+// Holds the pass inside the head operation's last resume until the starter thread has pushed a new head
+static TPS55289_SEQ_RESULT benchEndingBody(TPS55289_SEQ_OP *op){
+    TPS55289_SEQ_BEGIN(op);
+    atomic_store(&starterState, 1);
+    while (atomic_load(&starterState) != 2){
+    }
+    TPS55289_SEQ_END(op);
+}
+
+static void *benchStarter(void *param){
+    (void)param;
+    while (atomic_load(&starterState) != 1){
+    }
+    TPS55289SeqStart(&rig.seq, &rig.op[1], &rig.device[1], benchLateBody);
+    atomic_store(&starterState, 2);
+    return NULL;
+}
+
+static uint32_t benchStartDuringRun(void){
+    pthread_t starter;
+    benchSetup(2);
+    TPS55289SeqInit(&rig.seq);
+    atomic_store(&starterState, 0);
+    pthread_create(&starter, NULL, benchStarter, NULL);
+
+    TPS55289SeqStart(&rig.seq, &rig.op[0], &rig.device[0], benchEndingBody);
+    uint32_t passes = 0;
+    while ((TPS55289SeqRun(&rig.seq) > 0) || (rig.seq.head != NULL)){
+        passes++;
+    }
+    pthread_join(starter, NULL);
+
+    _Bool ran = (rig.op[1].state == TPS55289_SEQ_DONE);
+    printf("\nstart_during_run,passes,late_operation\n");
+    printf("head_removed,%u,%s\n", (unsigned int)passes, ran ? "done" : "lost");
+    return ran ? 0 : 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Status and Refusal
+
+static uint32_t benchStatusAndRefusal(void){
+    static TPS55289_OUTPUT output;
+    uint32_t failures = 0;
+    benchSetup(1);
+    TPS55289SeqInit(&rig.seq);
+    rig.sim[0].registers[TPS55289_STATUS_ADDR] |= TPS55289_SIM_STATUS_SCP;
+
+    TPS55289SeqStartInit(&rig.seq, &rig.op[0], &rig.device[0]);
+    while (TPS55289SeqRun(&rig.seq) > 0){
+        hostAdvanceTime(BENCH_INTERVAL_US);
+    }
+    _Bool seen   = rig.device[0].TPS55289_STATUS.SCP;
+    _Bool offed  = (rig.sim[0].registers[TPS55289_MODE_ADDR] & TPS55289_SIM_MODE_OE) == 0;
+    _Bool inited = (rig.op[0].state == TPS55289_SEQ_DONE);
+    TPS55289LogDiscard();
+
+    memset(&output, 0, sizeof(output));
+    rig.device[0].output = &output;
+    uint32_t writes = rig.sim[0].writes;
+    TPS55289SeqStartVoltage(&rig.seq, &rig.op[0], &rig.device[0], 9.0f);
+    while (TPS55289SeqRun(&rig.seq) > 0){
+        hostAdvanceTime(BENCH_INTERVAL_US);
+    }
+    _Bool refused = (rig.op[0].state == TPS55289_SEQ_FAILED) && (rig.sim[0].writes == writes);
+    rig.device[0].output = NULL;
+
+    printf("\ncase,status_seen,output_off,init,voltage_with_fsm\n");
+    printf("latched_short,%u,%u,%s,%s\n", (unsigned int)seen, (unsigned int)offed, inited ? "done" : "failed",
+           refused ? "refused" : "written");
+    failures += (seen && offed && inited) ? 0 : 1;
+    failures += refused ? 0 : 1;
+    return failures;
+}
+
+int main(void)
+{
+    uint32_t failures = 0;
+    benchSwitchCost();
+
+    printf("\nmode,devices,writes,resumes,cpu_ns_per_resume,makespan_us,target_ram_bytes,host_stack_used_bytes\n");
+    for (uint32_t c = 0; c < sizeof(deviceCounts) / sizeof(deviceCounts[0]); c++){
+        uint32_t devices = deviceCounts[c];
+        static BENCH_RESULT sequences;
+        static BENCH_RESULT tasks;
+        memset(&sequences, 0, sizeof(sequences));
+        memset(&tasks, 0, sizeof(tasks));
+
+        benchSequences(devices, &sequences);
+        uint32_t seqRam = devices * sizeof(TPS55289_SEQ_OP) + sizeof(TPS55289_SEQ) + BENCH_TARGET_SEQ_WORDS * 4;
+        printf("sequences,%u,%llu,%llu,%.1f,%llu,%u,-\n", (unsigned int)devices,
+               (unsigned long long)sequences.writes, (unsigned long long)sequences.resumes,
+               (double)sequences.cpuNs / sequences.resumes, (unsigned long long)sequences.makespanUs,
+               (unsigned int)seqRam);
+
+        size_t used = benchTasks(devices, &tasks);
+        uint32_t taskRam = devices * BENCH_TARGET_TASK_WORDS * 4;
+        printf("tasks,%u,%llu,%llu,%.1f,%llu,%u,%u\n", (unsigned int)devices,
+               (unsigned long long)tasks.writes, (unsigned long long)tasks.resumes,
+               (double)tasks.cpuNs / tasks.resumes, (unsigned long long)tasks.makespanUs,
+               (unsigned int)taskRam, (unsigned int)used);
+
+        // Same register image on every simulator either way
+        failures += sequences.failed + tasks.failed;
+        failures += (memcmp(sequences.registers, tasks.registers, sizeof(sequences.registers)) != 0) ? 1 : 0;
+        TPS55289LogDiscard();
+    }
+    failures += benchLockedBus();
+    failures += benchStartDuringRun();
+    failures += benchStatusAndRefusal();
+
+    printf("\nfailed_checks,%u\n", (unsigned int)failures);
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,268 @@
+// Device state snapshot benchmark (host build)
+//
+// One writer thread rewrites the driver cache of a TPS55289 as fast as it can while reader threads copy
+// it out, the way the control task and the telemetry/UI/command/fault tasks share a device. Every value
+// the writer stores is derived from one counter, so a copy mixing two updates is caught as a torn read.
+// Four ways of sharing are run for the same time:
+//   unprotected   readers copy the cache fields directly, as the tasks did before
+//   mutex         writer and readers take a pthread mutex around the cache
+//   seqlock       writer publishes with TPS55289StatePublish, readers use TPS55289StateRead
+//   two_publishers as seqlock, with the writer updating under the device lock and stalling halfway
+//                 through, while a second thread publishes the same device nonstop the way a register
+//                 access from another task does; a publish that does not wait for the lock goes out torn
+// Prints the uncontended cost of one publish and one read, then per mode: reads, torn reads, read retries,
+// writer updates, updates that had to wait for a reader, and the writer's mean/worst time per update.
+// On a host with fewer CPUs than threads the worst case is a scheduler time slice in every mode, and a
+// writer preempted mid-publish leaves readers retrying until it runs again; on target a publish runs
+// with interrupts off, so only a publish on the other core can make a reader retry.
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_state.h"
+
+#define BENCH_READERS                   3
+#define BENCH_DURATION_NS               1000000000ull
+#define BENCH_UNCONTENDED_RUNS          1000000
+#define BENCH_PREEMPT_NS                20000ull
+
+typedef enum {
+    BENCH_UNPROTECTED = 0,
+    BENCH_MUTEX,
+    BENCH_SEQLOCK,
+    BENCH_TWO_PUBLISHERS,
+    BENCH_MODES
+} BENCH_MODE;
+
+static const char *modeNames[BENCH_MODES] = { "unprotected", "mutex", "seqlock", "two_publishers" };
+
+typedef struct {
+    uint64_t reads;
+    uint64_t torn;
+    uint64_t retries;
+    uint64_t regressions;               // Snapshot versions going backwards
+} BENCH_READER;
+
+static recursive_mutex_t deviceLock;
+static const TPS55289_TRANSPORT lockOnlyTransport = {
+    .lock       = &deviceLock,             // Never reaches a bus; the device only needs a lock
+};
+static TPS55289 device;
+static TPS55289_STATE state;
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static volatile _Bool running;
+static volatile uint64_t publisherRuns;
+static BENCH_MODE mode;
+
+static uint64_t benchClockNs(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+// Stores update m in every cached field a snapshot carries, one field at a time as the setters do.
+// preempt stops halfway until the second publisher has published or BENCH_PREEMPT_NS has passed, as a
+// task preempted in the middle of an update would
+static void benchUpdate(uint32_t m, _Bool preempt){
+    volatile TPS55289 *target = &device;
+    target->settings.VOUT                        = (float)(m & 0xFFFF);
+    target->settings.slewRate                    = (float)(m & 0xFFFF);
+    target->settings.currentLimitAmp             = m;
+    if (preempt){
+        uint64_t seen     = publisherRuns;
+        uint64_t deadline = benchClockNs() + BENCH_PREEMPT_NS;
+        while ((publisherRuns == seen) && (benchClockNs() < deadline)){
+            sched_yield();
+        }
+    }
+    target->TPS55289_REF_VOLTAGE.regValue_16     = (uint16_t)(m & 0x07FF);
+    target->TPS55289_IOUT_LIMIT.regValue         = (uint8_t)m;
+    target->TPS55289_VOUT_SR.regValue            = (uint8_t)(m >> 1);
+    target->TPS55289_VOUT_FS.regValue            = (uint8_t)(m >> 2);
+    target->TPS55289_CDC.regValue                = (uint8_t)(m >> 3);
+    target->TPS55289_MODE.regValue               = (uint8_t)(m >> 4);
+    target->TPS55289_STATUS.regValue             = (uint8_t)(m >> 5);
+}
+
+static void benchCopy(TPS55289_SNAPSHOT *snapshot){
+    const volatile TPS55289 *source = &device;
+    snapshot->VOUT            = source->settings.VOUT;
+    snapshot->slewRate        = source->settings.slewRate;
+    snapshot->currentLimitAmp = source->settings.currentLimitAmp;
+    snapshot->refCode         = source->TPS55289_REF_VOLTAGE.regValue_16;
+    snapshot->currentLimit    = source->TPS55289_IOUT_LIMIT.regValue;
+    snapshot->voutSR          = source->TPS55289_VOUT_SR.regValue;
+    snapshot->voutFS          = source->TPS55289_VOUT_FS.regValue;
+    snapshot->cdc             = source->TPS55289_CDC.regValue;
+    snapshot->mode            = source->TPS55289_MODE.regValue;
+    snapshot->status          = source->TPS55289_STATUS.regValue;
+    snapshot->version         = 0;
+}
+
+static _Bool benchConsistent(const TPS55289_SNAPSHOT *snapshot){
+    uint32_t m = snapshot->currentLimitAmp;
+    return (snapshot->VOUT == (float)(m & 0xFFFF)) && (snapshot->slewRate == (float)(m & 0xFFFF)) &&
+           (snapshot->refCode == (m & 0x07FF)) && (snapshot->currentLimit == (uint8_t)m) &&
+           (snapshot->voutSR == (uint8_t)(m >> 1)) && (snapshot->voutFS == (uint8_t)(m >> 2)) &&
+           (snapshot->cdc == (uint8_t)(m >> 3)) && (snapshot->mode == (uint8_t)(m >> 4)) &&
+           (snapshot->status == (uint8_t)(m >> 5));
+}
+
+static void *benchReader(void *param){
+    BENCH_READER *reader = (BENCH_READER *)param;
+    TPS55289_SNAPSHOT snapshot;
+    uint32_t version = 0;
+
+    while (running){
+        if ((mode == BENCH_SEQLOCK) || (mode == BENCH_TWO_PUBLISHERS)){
+            reader->retries += TPS55289StateRead(&state, &snapshot);
+            reader->regressions += (snapshot.version < version) ? 1 : 0;
+            version = snapshot.version;
+        } else if (mode == BENCH_MUTEX){
+            pthread_mutex_lock(&mutex);
+            benchCopy(&snapshot);
+            pthread_mutex_unlock(&mutex);
+        } else {
+            benchCopy(&snapshot);
+        }
+        reader->torn += benchConsistent(&snapshot) ? 0 : 1;
+        reader->reads++;
+    }
+    return NULL;
+}
+
+// Publishes whatever the cache holds, as often as it can
+static void *benchPublisher(void *param){
+    (void)param;
+    while (running){
+        TPS55289StatePublish(&device);
+        publisherRuns++;
+    }
+    return NULL;
+}
+
+static uint32_t benchMode(BENCH_MODE which){
+    BENCH_READER readers[BENCH_READERS];
+    pthread_t threads[BENCH_READERS];
+    pthread_t publisher;
+    memset(readers, 0, sizeof(readers));
+    memset(&device, 0, sizeof(device));
+    device.transport = &lockOnlyTransport;
+    benchUpdate(0, false);
+    TPS55289StateInit(&state, &device);
+    if ((which != BENCH_SEQLOCK) && (which != BENCH_TWO_PUBLISHERS)){
+        device.state = NULL;
+    }
+
+    mode    = which;
+    running = true;
+    for (uint32_t i = 0; i < BENCH_READERS; i++){
+        pthread_create(&threads[i], NULL, benchReader, &readers[i]);
+    }
+    if (which == BENCH_TWO_PUBLISHERS){
+        pthread_create(&publisher, NULL, benchPublisher, NULL);
+    }
+
+    uint64_t start   = benchClockNs();
+    uint64_t updates = 0;
+    uint64_t busyNs  = 0;
+    uint64_t worstNs = 0;
+    uint64_t blocked = 0;
+    uint64_t now     = start;
+    while (now - start < BENCH_DURATION_NS){
+        updates++;
+        if (which == BENCH_MUTEX){
+            if (pthread_mutex_trylock(&mutex) != 0){
+                blocked++;
+                pthread_mutex_lock(&mutex);
+            }
+            benchUpdate((uint32_t)updates, false);
+            pthread_mutex_unlock(&mutex);
+        } else if (which == BENCH_TWO_PUBLISHERS){
+            TPS55289Lock(&device);
+            benchUpdate((uint32_t)updates, true);
+            TPS55289StatePublish(&device);
+            TPS55289Unlock(&device);
+        } else {
+            benchUpdate((uint32_t)updates, false);
+            TPS55289StatePublish(&device);
+        }
+        uint64_t after = benchClockNs();
+        busyNs += after - now;
+        worstNs = (after - now > worstNs) ? after - now : worstNs;
+        now = after;
+    }
+    running = false;
+    if (which == BENCH_TWO_PUBLISHERS){
+        pthread_join(publisher, NULL);
+    }
+
+    BENCH_READER total = { 0 };
+    for (uint32_t i = 0; i < BENCH_READERS; i++){
+        pthread_join(threads[i], NULL);
+        total.reads       += readers[i].reads;
+        total.torn        += readers[i].torn;
+        total.retries     += readers[i].retries;
+        total.regressions += readers[i].regressions;
+    }
+
+    printf("%s,%llu,%llu,%llu,%llu,%llu,%llu,%.1f,%.1f\n", modeNames[which], (unsigned long long)total.reads,
+           (unsigned long long)total.torn, (unsigned long long)total.retries,
+           (unsigned long long)total.regressions, (unsigned long long)updates, (unsigned long long)blocked,
+           (double)busyNs / updates, worstNs / 1000.0);
+
+    // Only the seqlock modes are required to be clean; the others show what it prevents
+    _Bool checked = (which == BENCH_SEQLOCK) || (which == BENCH_TWO_PUBLISHERS);
+    return checked ? (uint32_t)(total.torn + total.regressions) : 0;
+}
+
+static void benchUncontended(void){
+    TPS55289_SNAPSHOT snapshot;
+    memset(&device, 0, sizeof(device));
+    device.transport = &lockOnlyTransport;
+    TPS55289StateInit(&state, &device);
+
+    uint64_t start = benchClockNs();
+    for (uint32_t i = 0; i < BENCH_UNCONTENDED_RUNS; i++){
+        TPS55289StatePublish(&device);
+    }
+    uint64_t publishNs = benchClockNs() - start;
+
+    start = benchClockNs();
+    for (uint32_t i = 0; i < BENCH_UNCONTENDED_RUNS; i++){
+        TPS55289StateRead(&state, &snapshot);
+    }
+    uint64_t readNs = benchClockNs() - start;
+
+    start = benchClockNs();
+    for (uint32_t i = 0; i < BENCH_UNCONTENDED_RUNS; i++){
+        pthread_mutex_lock(&mutex);
+        benchCopy(&snapshot);
+        pthread_mutex_unlock(&mutex);
+    }
+    uint64_t mutexNs = benchClockNs() - start;
+
+    printf("publish_ns,read_ns,mutex_copy_ns,snapshot_bytes\n");
+    printf("%.1f,%.1f,%.1f,%u\n", (double)publishNs / BENCH_UNCONTENDED_RUNS, (double)readNs / BENCH_UNCONTENDED_RUNS,
+           (double)mutexNs / BENCH_UNCONTENDED_RUNS, (unsigned int)sizeof(TPS55289_SNAPSHOT));
+}
+
+int main(void)
+{
+    uint32_t failures = 0;
+    recursive_mutex_init(&deviceLock);
+    benchUncontended();
+
+    printf("\nmode,reads,torn,retries,version_regressions,updates,writer_blocked,writer_mean_ns,writer_max_us\n");
+    for (uint32_t m = 0; m < BENCH_MODES; m++){
+        failures += benchMode((BENCH_MODE)m);
+    }
+
+    printf("\nfailed_checks,%u\n", (unsigned int)failures);
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,299 @@
+// Register trace benchmark (host build)
+//
+// Captures the register traffic of two simulated converters through the driver's trace ring: bring-up,
+// setpoint and limit changes, burst read-backs, a tracking ramp over both, a sequence ramp, a latched short
+// circuit, and a run of writes with nothing draining the ring so records are dropped. The drained records
+// go to a trace file the way the host writes TRACE_READ payloads, which is then read back with the
+// streaming reader and replayed against fresh simulators. A copy with one read-back value altered checks
+// that the replay notices. The capture is then repeated, 10 s apart on the trace clock, into a large file
+// spanning many wraps of the 32-bit timestamps, to time the streaming statistics and replay passes.
+// Prints the capture cost per record, then the summary, timing and replay of the scenario trace, then the
+// throughput of both passes over the large file and the process's peak resident set.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_log.h"
+#include "TPS55289_seq.h"
+#include "TPS55289_sim.h"
+#include "TPS55289_trace.h"
+#include "TPS55289_tracking.h"
+#include "trace_analysis.h"
+
+#define BENCH_CHANNELS                  2
+#define BENCH_CAPTURE_RECORDS           16384
+#define BENCH_OVERFLOW_WRITES           (TPS55289_TRACE_BUFFER_SIZE + 44)
+#define BENCH_RECORD_RUNS               1000000
+#define BENCH_LARGE_BYTES               (256ull << 20)
+#define BENCH_REPEAT_PERIOD_US          10000000u
+
+static TPS55289_SIM sim[BENCH_CHANNELS];
+static TPS55289 device[BENCH_CHANNELS];
+static TPS55289_TRACE_RECORD captured[BENCH_CAPTURE_RECORDS];
+static uint32_t capturedCount;
+
+static uint64_t benchClockNs(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+// What the host does on TRACE_READ until the device has nothing more
+static void benchDrain(void){
+    uint32_t count;
+    do {
+        count = TPS55289TraceDrain(&captured[capturedCount], BENCH_CAPTURE_RECORDS - capturedCount);
+        capturedCount += count;
+    } while ((count > 0) && (capturedCount < BENCH_CAPTURE_RECORDS));
+}
+
+static void benchCaptureCost(void){
+    TPS55289 traced;
+    TPS55289 untraced;
+    TPS55289_TRACE_RECORD sink[TPS55289_TRACE_BUFFER_SIZE];
+    uint8_t value = 0x20;
+    memset(&traced, 0, sizeof(traced));
+    memset(&untraced, 0, sizeof(untraced));
+    TPS55289TraceInit();
+    TPS55289TraceAttach(&traced, 0);
+
+    uint64_t busyNs = 0;
+    for (uint32_t done = 0; done < BENCH_RECORD_RUNS; done += TPS55289_TRACE_BUFFER_SIZE){
+        uint64_t start = benchClockNs();
+        for (uint32_t i = 0; i < TPS55289_TRACE_BUFFER_SIZE; i++){
+            TPS55289TraceRecord(&traced, 0, TPS55289_MODE_ADDR, &value, 1, time_us_32());
+        }
+        busyNs += benchClockNs() - start;
+        TPS55289TraceDrain(sink, TPS55289_TRACE_BUFFER_SIZE);
+    }
+    uint32_t runs = (BENCH_RECORD_RUNS / TPS55289_TRACE_BUFFER_SIZE + 1) * TPS55289_TRACE_BUFFER_SIZE;
+
+    uint64_t start = benchClockNs();
+    for (uint32_t i = 0; i < BENCH_RECORD_RUNS; i++){
+        TPS55289TraceRecord(&untraced, 0, TPS55289_MODE_ADDR, &value, 1, time_us_32());
+    }
+    uint64_t untracedNs = benchClockNs() - start;
+
+    printf("record_ns,untraced_ns,record_bytes,ring_bytes\n");
+    printf("%.1f,%.1f,%u,%u\n", (double)busyNs / runs, (double)untracedNs / BENCH_RECORD_RUNS,
+           (unsigned int)sizeof(TPS55289_TRACE_RECORD),
+           (unsigned int)(TPS55289_TRACE_BUFFER_SIZE * sizeof(TPS55289_TRACE_RECORD)));
+}
+
+// Returns the number of records dropped by the overflow at the end
+static uint32_t benchScenario(void){
+    capturedCount = 0;
+    TPS55289TraceInit();
+    for (uint32_t i = 0; i < BENCH_CHANNELS; i++){
+        memset(&device[i], 0, sizeof(device[i]));
+        TPS55289SimInit(&sim[i], TPS55289_SIM_BUS_FAST);
+        device[i].transport = &sim[i].transport;
+        TPS55289TraceAttach(&device[i], (uint8_t)i);
+        TPS55289Init(&device[i]);
+        benchDrain();
+    }
+
+    uint8_t registers[TPS55289_REGISTER_COUNT];
+    for (uint32_t i = 0; i < BENCH_CHANNELS; i++){
+        setStepSize(&device[i], 0x02);
+        enableDevice(&device[i]);
+        setOutputVoltage(&device[i], 5.0f);
+        setOutputCurrentLimit(&device[i], 3.0f);
+        setSlewRate(&device[i], 0x02);
+        readStatusRegister(&device[i]);
+        TPS55289ReadRegisters(&device[i], 0, registers, sizeof(registers));
+        benchDrain();
+    }
+
+    static TPS55289_TRACKING tracking;
+    static const float targets[BENCH_CHANNELS] = { 9.0f, 12.0f };
+    TPS55289TrackingInit(&tracking, TPS55289_TRACKING_RATIOMETRIC, 10);
+    for (uint32_t i = 0; i < BENCH_CHANNELS; i++){
+        TPS55289TrackingAdd(&tracking, &device[i]);
+    }
+    TPS55289TrackingStart(&tracking, targets, 20);
+    while (TPS55289TrackingStep(&tracking)){
+        hostAdvanceTime(250);
+        benchDrain();
+    }
+
+    static TPS55289_SEQ seq;
+    static TPS55289_SEQ_OP op;
+    TPS55289SeqInit(&seq);
+    TPS55289SeqStartRamp(&seq, &op, &device[0], 3.3f, 20, 500);
+    while (TPS55289SeqRun(&seq) > 0){
+        uint64_t wakeAt;
+        hostAdvanceTime((TPS55289SeqNextWake(&seq, &wakeAt) && (wakeAt > time_us_64())) ? wakeAt - time_us_64() : 1);
+        benchDrain();
+    }
+
+    // Latched short circuit on channel 1: the first STATUS read sees it, the second does not
+    sim[1].shortCircuit = true;
+    hostAdvanceTime(100);
+    readStatusRegister(&device[1]);
+    sim[1].shortCircuit = false;
+    hostAdvanceTime(100);
+    readStatusRegister(&device[1]);
+    benchDrain();
+
+    // Nothing drains the ring for a while
+    uint32_t dropped = TPS55289TraceDropped();
+    for (uint32_t i = 0; i < BENCH_OVERFLOW_WRITES; i++){
+        TPS55289WriteRegister(&device[0], TPS55289_CDC_ADDR, (uint8_t)(0xE0 | (i & 0x07)));
+    }
+    dropped = TPS55289TraceDropped() - dropped;
+    benchDrain();
+    TPS55289ReadRegisters(&device[0], 0, registers, sizeof(registers));
+    benchDrain();
+    TPS55289LogDiscard();
+    return dropped;
+}
+
+static _Bool benchWriteTrace(const char *path, const TPS55289_TRACE_RECORD *records, uint32_t count, uint32_t copies){
+    TPS55289_TRACE_FILE_HEADER header = { TPS55289_TRACE_MAGIC, TPS55289_TRACE_VERSION,
+                                          sizeof(TPS55289_TRACE_RECORD), TPS55289_SIM_BUS_FAST, 0 };
+    FILE *file = fopen(path, "wb");
+    if (file == NULL){
+        return false;
+    }
+    _Bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    static TPS55289_TRACE_RECORD shifted[BENCH_CAPTURE_RECORDS];
+    for (uint32_t copy = 0; ok && (copy < copies); copy++){
+        for (uint32_t i = 0; i < count; i++){
+            shifted[i] = records[i];
+            shifted[i].timestamp += copy * BENCH_REPEAT_PERIOD_US;
+        }
+        ok = fwrite(shifted, sizeof(shifted[0]), count, file) == count;
+    }
+    return (fclose(file) == 0) && ok;
+}
+
+typedef struct {
+    uint64_t records;
+    uint64_t backwards;
+    uint64_t statsNs;
+    uint64_t replayNs;
+    TRACE_STATS stats;
+    TRACE_REPLAY replay;
+} BENCH_ANALYSIS;
+
+// Statistics and replay as two separate streaming passes, the way TraceTool runs them
+static _Bool benchAnalyse(const char *path, BENCH_ANALYSIS *analysis){
+    static TRACE_READER reader;
+    TRACE_EVENT event;
+
+    if (traceReaderOpen(&reader, path) != 0){
+        return false;
+    }
+    traceStatsInit(&analysis->stats);
+    uint64_t start = benchClockNs();
+    while (traceReaderNext(&reader, &event)){
+        traceStatsAdd(&analysis->stats, &event);
+    }
+    analysis->statsNs   = benchClockNs() - start;
+    analysis->records   = reader.records;
+    analysis->backwards = reader.backwards;
+    traceReaderClose(&reader);
+
+    if (traceReaderOpen(&reader, path) != 0){
+        return false;
+    }
+    traceReplayInit(&analysis->replay, reader.busHz);
+    start = benchClockNs();
+    while (traceReaderNext(&reader, &event)){
+        traceReplayEvent(&analysis->replay, &event);
+    }
+    traceReplayFinish(&analysis->replay);
+    analysis->replayNs = benchClockNs() - start;
+    traceReaderClose(&reader);
+    return true;
+}
+
+static uint32_t benchCheck(const char *name, _Bool ok){
+    if (!ok){
+        printf("check failed: %s\n", name);
+    }
+    return ok ? 0 : 1;
+}
+
+int main(void)
+{
+    uint32_t failures = 0;
+    static BENCH_ANALYSIS analysis;
+    char path[] = "/tmp/trace_benchXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0){
+        perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+
+    benchCaptureCost();
+    uint32_t dropped = benchScenario();
+
+    // Scenario trace
+    failures += benchCheck("write scenario trace", benchWriteTrace(path, captured, capturedCount, 1));
+    failures += benchCheck("analyse scenario trace", benchAnalyse(path, &analysis));
+    printf("\ncaptured_records,dropped_records\n%u,%u\n\n", (unsigned int)capturedCount, (unsigned int)dropped);
+    traceStatsPrint(&analysis.stats, stdout);
+    printf("\n");
+    traceReplayPrint(&analysis.replay, stdout);
+
+    failures += benchCheck("every record read back", analysis.records == capturedCount);
+    failures += benchCheck("drops reported in one marker", (analysis.stats.markers == 1) && (analysis.stats.dropped == dropped));
+    failures += benchCheck("replay matches the device", (analysis.replay.mismatches == 0) && (analysis.replay.compared > 0));
+    failures += benchCheck("replay saw the gap", analysis.replay.gaps == 1);
+    failures += benchCheck("latched short circuit differs", analysis.replay.statusDiffers > 0);
+    failures += benchCheck("blocking reads match the bus model",
+                           (analysis.replay.residualMinUs[1] == 0) && (analysis.replay.residualMaxUs[1] == 0));
+
+    TRACE_EVENT mode = { .address = TPS55289_MODE_ADDR, .value = 0xA0 };
+    char line[160];
+    traceDecode(&mode, line, sizeof(line));
+    failures += benchCheck("MODE bitfields decoded", strstr(line, "OE=1 FSWDBL=0 HICCUP=1 DISCHG=0 FPWM=0") != NULL);
+
+    // The first MODE read-back of channel 0 reports a different value
+    static TPS55289_TRACE_RECORD altered[BENCH_CAPTURE_RECORDS];
+    memcpy(altered, captured, capturedCount * sizeof(captured[0]));
+    for (uint32_t i = 0; i < capturedCount; i++){
+        if (altered[i].flags == (TPS55289_TRACE_READ | TPS55289_MODE_ADDR)){
+            altered[i].value ^= 0x80;
+            break;
+        }
+    }
+    static BENCH_ANALYSIS alteredAnalysis;
+    failures += benchCheck("write altered trace", benchWriteTrace(path, altered, capturedCount, 1));
+    failures += benchCheck("analyse altered trace", benchAnalyse(path, &alteredAnalysis));
+    failures += benchCheck("altered read-back caught", alteredAnalysis.replay.mismatches == 1);
+
+    // Large trace
+    uint32_t copies = (uint32_t)(BENCH_LARGE_BYTES / (capturedCount * sizeof(captured[0])));
+    failures += benchCheck("write large trace", benchWriteTrace(path, captured, capturedCount, copies));
+    static BENCH_ANALYSIS large;
+    failures += benchCheck("analyse large trace", benchAnalyse(path, &large));
+    double megabytes = (double)(large.records * sizeof(TPS55289_TRACE_RECORD)) / (1 << 20);
+    uint64_t expectedSpan = (uint64_t)(copies - 1) * BENCH_REPEAT_PERIOD_US;
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    printf("\nfile_mb,records,span_h,out_of_order,stats_mb_s,stats_ns_per_record,replay_mb_s,replay_ns_per_record,max_rss_mb\n");
+    printf("%.0f,%llu,%.1f,%llu,%.0f,%.1f,%.0f,%.1f,%.0f\n", megabytes, (unsigned long long)large.records,
+           (large.stats.lastTime - large.stats.firstTime) / 3.6e9, (unsigned long long)large.backwards,
+           megabytes / (large.statsNs / 1e9), (double)large.statsNs / large.records,
+           megabytes / (large.replayNs / 1e9), (double)large.replayNs / large.records, usage.ru_maxrss / 1024.0);
+
+    failures += benchCheck("large trace read in full", large.records == (uint64_t)capturedCount * copies);
+    failures += benchCheck("timestamps unwrapped across 32-bit wraps",
+                           large.stats.lastTime - large.stats.firstTime >= expectedSpan);
+    failures += benchCheck("large replay matches the device", large.replay.mismatches == 0);
+    unlink(path);
+
+    printf("\nfailed_checks,%u\n", (unsigned int)failures);
+    return (failures == 0) ? 0 : 1;
+}
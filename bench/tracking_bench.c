@@ -0,0 +1,138 @@
+// Multi-channel tracking benchmark (host build)
+//
+// Ramps four simulated converters, each on its own bus, through the tracking coordinator. The skew of a
+// step is taken from the simulators themselves (the virtual time each REF MSB landed) and checked against
+// the bound at every step, alongside the skew the coordinator measured. Each simulator gets a slightly
+// different per-transaction overhead, standing in for controllers that do not start in the same cycle.
+// Prints, per mode and bus speed, parallel split writes against the blocking sequential fallback:
+//   max/mean skew   ground truth from the simulators, and as measured by the coordinator
+//   over_bound      steps whose ground-truth skew exceeded the bound
+//   step_us         virtual time one step holds the CPU
+//   ratio_err_pct   worst spread of ramp fraction between rails over the second half of a ratiometric
+//                   ramp; below that the 45 mV REF floor holds the low rails up
+//   final_err_pct   worst difference between a rail's final VOUT and its target
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_log.h"
+#include "TPS55289_sim.h"
+#include "TPS55289_tracking.h"
+
+#define BENCH_CHANNELS                  4
+#define BENCH_STEPS                     200
+#define BENCH_SKEW_BOUND_US             10
+
+static const float targets[BENCH_CHANNELS]             = { 1.8f, 3.3f, 5.0f, 12.0f };
+static const uint32_t overheadUs[BENCH_CHANNELS]       = { 0, 3, 1, 2 };
+
+typedef struct {
+    TPS55289_SIM sim[BENCH_CHANNELS];
+    TPS55289 device[BENCH_CHANNELS];
+    TPS55289_TRACKING tracking;
+} BENCH_RIG;
+
+static void benchSetup(BENCH_RIG *rig, TPS55289_TRACKING_MODE mode, uint32_t busHz, _Bool parallel){
+    memset(rig, 0, sizeof(*rig));
+    TPS55289TrackingInit(&rig->tracking, mode, BENCH_SKEW_BOUND_US);
+    for (uint32_t i = 0; i < BENCH_CHANNELS; i++){
+        TPS55289SimInit(&rig->sim[i], busHz);
+        rig->sim[i].transactionOverheadUs = overheadUs[i];
+        if (!parallel){
+            rig->sim[i].transport.writeStart = NULL;
+            rig->sim[i].transport.writePoll  = NULL;
+        }
+        rig->device[i].transport = &rig->sim[i].transport;
+        TPS55289Init(&rig->device[i]);
+        setStepSize(&rig->device[i], 0x02);
+        enableDevice(&rig->device[i]);
+        TPS55289TrackingAdd(&rig->tracking, &rig->device[i]);
+    }
+    TPS55289LogDiscard();
+}
+
+static uint32_t benchRun(TPS55289_TRACKING_MODE mode, uint32_t busHz, _Bool parallel){
+    static BENCH_RIG rig;
+    benchSetup(&rig, mode, busHz, parallel);
+    TPS55289TrackingStart(&rig.tracking, targets, BENCH_STEPS);
+
+    uint64_t truthMax   = 0;
+    uint64_t truthTotal = 0;
+    uint32_t overBound  = 0;
+    uint32_t mismatched = 0;
+    uint64_t busyUs     = 0;
+    float    ratioErr   = 0;
+
+    while (!TPS55289TrackingDone(&rig.tracking)){
+        uint64_t before = time_us_64();
+        TPS55289TrackingStep(&rig.tracking);
+        busyUs += time_us_64() - before;
+
+        uint64_t first = UINT64_MAX;
+        uint64_t last  = 0;
+        float lowest   = 1e9f;
+        float highest  = 0;
+        for (uint32_t i = 0; i < BENCH_CHANNELS; i++){
+            first = (rig.sim[i].refLatchedAt < first) ? rig.sim[i].refLatchedAt : first;
+            last  = (rig.sim[i].refLatchedAt > last) ? rig.sim[i].refLatchedAt : last;
+            float fraction = TPS55289SimTargetVOUT(&rig.sim[i]) / (targets[i] * 1000);
+            lowest  = (fraction < lowest) ? fraction : lowest;
+            highest = (fraction > highest) ? fraction : highest;
+        }
+        uint64_t skew = last - first;
+        truthMax    = (skew > truthMax) ? skew : truthMax;
+        truthTotal += skew;
+        overBound  += (skew > BENCH_SKEW_BOUND_US) ? 1 : 0;
+
+        // The coordinator sees a completion on the first poll after it, 1 us apart
+        int64_t error = (int64_t)rig.tracking.stats.lastSkewUs - (int64_t)skew;
+        mismatched += ((error < -1) || (error > 1)) ? 1 : 0;
+
+        if ((rig.tracking.step * 2 >= BENCH_STEPS) && (highest - lowest > ratioErr)){
+            ratioErr = highest - lowest;
+        }
+    }
+
+    float finalErr = 0;
+    for (uint32_t i = 0; i < BENCH_CHANNELS; i++){
+        float error = TPS55289SimTargetVOUT(&rig.sim[i]) / (targets[i] * 1000) - 1;
+        error = (error < 0) ? -error : error;
+        finalErr = (error > finalErr) ? error : finalErr;
+    }
+    TPS55289LogDiscard();
+
+    const TPS55289_TRACKING_STATS *stats = &rig.tracking.stats;
+    printf("%s,%s,%u,%llu,%.1f,%u,%.1f,%u,%u,%.1f,%.3f,%.3f\n",
+           (mode == TPS55289_TRACKING_RATIOMETRIC) ? "ratiometric" : "coincident", parallel ? "parallel" : "sequential",
+           (unsigned int)busHz, (unsigned long long)truthMax, (double)truthTotal / stats->steps,
+           (unsigned int)stats->maxSkewUs, (double)stats->totalSkewUs / stats->steps, (unsigned int)overBound,
+           (unsigned int)stats->failures, (double)busyUs / stats->steps,
+           (mode == TPS55289_TRACKING_RATIOMETRIC) ? ratioErr * 100.0 : 0.0, finalErr * 100.0);
+
+    // Parallel writes must hold the bound at every step; both paths must agree with the simulators
+    uint32_t failures = mismatched + stats->failures + (finalErr > 0.01f ? 1 : 0);
+    failures += (parallel && (overBound > 0)) ? 1 : 0;
+    failures += (stats->overBound != overBound) ? 1 : 0;
+    return failures;
+}
+
+int main(void)
+{
+    static const uint32_t speeds[] = { TPS55289_SIM_BUS_STANDARD, TPS55289_SIM_BUS_FAST, TPS55289_SIM_BUS_FAST_PLUS };
+    static const TPS55289_TRACKING_MODE modes[] = { TPS55289_TRACKING_COINCIDENT, TPS55289_TRACKING_RATIOMETRIC };
+    uint32_t failures = 0;
+
+    printf("mode,writes,bus_hz,max_skew_us,mean_skew_us,measured_max_us,measured_mean_us,over_bound,failures,"
+           "step_us,ratio_err_pct,final_err_pct\n");
+    for (uint32_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++){
+        for (uint32_t s = 0; s < sizeof(speeds) / sizeof(speeds[0]); s++){
+            failures += benchRun(modes[m], speeds[s], true);
+            failures += benchRun(modes[m], speeds[s], false);
+        }
+    }
+
+    printf("\nfailed_checks,%u\n", (unsigned int)failures);
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,227 @@
+// Loopback benchmark of the vendor bulk protocol layer (host build)
+//
+// Drives usb_protocol.c exactly as the vendor class driver does (acquire a frame, fill it as an OUT transfer
+// would, receive, take the reply for the IN endpoint, release) with no USB stack or libusb involved. Commands
+// that touch the converter run against the TPS55289 simulator. Each line is one JSON object:
+//   cpu_ns      CPU time of the protocol layer per frame (CLOCK_MONOTONIC)
+//   bus_us      virtual I2C time the command spent talking to the converter
+//   wire_us     modelled full-speed bulk time for request + reply (19 packets per 1 ms frame at best)
+// Returns non-zero if a round trip failed, a telemetry sample was lost or a frame was rejected.
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_log.h"
+#include "TPS55289_sim.h"
+#include "usb_protocol.h"
+
+#define BENCH_RUNS                      2000
+#define BENCH_FS_PACKET_SIZE            64
+#define BENCH_FS_PACKETS_PER_MS         19      // Bulk bandwidth ceiling of a full-speed frame
+
+static uint64_t benchClockNs(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+// Full-speed wire time of one transfer, including the ZLP the class driver adds
+static double wireUs(uint32_t length){
+    uint32_t packets = (length + BENCH_FS_PACKET_SIZE - 1) / BENCH_FS_PACKET_SIZE;
+    if ((length % BENCH_FS_PACKET_SIZE) == 0 && (length < USB_PROTOCOL_FRAME_SIZE)){
+        packets++;
+    }
+    return packets * 1000.0 / BENCH_FS_PACKETS_PER_MS;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Statistics
+
+static uint32_t samples[BENCH_RUNS];
+
+static void sortSamples(uint32_t *values, uint32_t count){
+    for (uint32_t i = 1; i < count; i++){
+        uint32_t value = values[i];
+        uint32_t j = i;
+        while ((j > 0) && (values[j - 1] > value)){
+            values[j] = values[j - 1];
+            j--;
+        }
+        values[j] = value;
+    }
+}
+
+static void printStats(const char *label, uint32_t *values, uint32_t count){
+    sortSamples(values, count);
+    printf("\"%s\":{\"min\":%u,\"median\":%u,\"p99\":%u}", label,
+           (unsigned int)values[0], (unsigned int)values[count / 2], (unsigned int)values[(count * 99) / 100]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Loopback
+
+static uint8_t request[USB_PROTOCOL_FRAME_SIZE];
+static uint16_t sequence;
+
+static uint32_t buildRequest(uint8_t command, const void *payload, uint16_t length){
+    USB_PROTOCOL_HEADER header = { USB_PROTOCOL_SYNC, command, sequence++, length, 0, 0 };
+    memcpy(request, &header, sizeof(header));
+    if (length > 0){
+        memcpy(request + USB_PROTOCOL_HEADER_SIZE, payload, length);
+    }
+    return USB_PROTOCOL_HEADER_SIZE + length;
+}
+
+/*
+    One round trip. The memcpy into the frame stands in for the controller filling the OUT buffer and is
+    timed; the reply must come back in the same buffer (zero copy) with a matching header.
+*/
+static _Bool roundTrip(uint32_t length, uint32_t *replyLength, uint8_t *replyStatus){
+    uint8_t *frame = usbProtocolAcquire();
+    if (frame == NULL){
+        return false;
+    }
+    memcpy(frame, request, length);
+    usbProtocolReceive(frame, length);
+
+    uint8_t *reply = usbProtocolNextTx(replyLength);
+    _Bool ok = (reply == frame);
+    if (reply != NULL){
+        const USB_PROTOCOL_HEADER *header = (const USB_PROTOCOL_HEADER *)reply;
+        ok = ok && (header->sync == USB_PROTOCOL_SYNC) &&
+             (header->command == (request[1] | USB_PROTOCOL_RESPONSE)) &&
+             ((uint32_t)header->length + USB_PROTOCOL_HEADER_SIZE == *replyLength);
+        *replyStatus = header->status;
+        usbProtocolRelease(reply);
+    }
+    return ok;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t benchEcho(uint16_t payloadLength){
+    static uint8_t payload[USB_PROTOCOL_MAX_PAYLOAD];
+    for (uint32_t i = 0; i < payloadLength; i++){
+        payload[i] = (uint8_t)i;
+    }
+    uint32_t length = buildRequest(USB_CMD_ECHO, payload, payloadLength);
+    uint32_t failures = 0;
+    uint64_t total = 0;
+
+    for (uint32_t n = 0; n < BENCH_RUNS; n++){
+        uint32_t replyLength = 0;
+        uint8_t status = 0;
+        uint64_t start = benchClockNs();
+        _Bool ok = roundTrip(length, &replyLength, &status);
+        uint64_t elapsed = benchClockNs() - start;
+        samples[n] = (uint32_t)elapsed;
+        total += elapsed;
+        failures += (ok && (replyLength == length) && (status == USB_STATUS_OK)) ? 0 : 1;
+    }
+
+    double wire = wireUs(length) * 2;
+    printf("{\"bench\":\"usb_protocol\",\"test\":\"echo\",\"payload\":%u,\"runs\":%u,\"failures\":%u,",
+           payloadLength, BENCH_RUNS, (unsigned int)failures);
+    printStats("cpu_ns", samples, BENCH_RUNS);
+    printf(",\"cpu_MBps\":%.1f,\"wire_us\":%.1f,\"wire_kBps\":%.1f}\n",
+           (2.0 * length * BENCH_RUNS) / (total / 1e9) / 1e6, wire, (2.0 * length) / wire * 1e3);
+    return failures;
+}
+
+static uint32_t benchCommand(const char *name, uint8_t command, const void *payload, uint16_t payloadLength,
+                         TPS55289_SIM *sim){
+    uint32_t failures = 0;
+    uint32_t replyLength = 0;
+    uint32_t busUs = 0;
+
+    for (uint32_t n = 0; n < BENCH_RUNS; n++){
+        uint8_t status = 0;
+        uint32_t length = buildRequest(command, payload, payloadLength);
+        TPS55289SimResetStats(sim);
+        uint64_t start = benchClockNs();
+        _Bool ok = roundTrip(length, &replyLength, &status);
+        samples[n] = (uint32_t)(benchClockNs() - start);
+        busUs = (uint32_t)sim->busTimeUs;
+        failures += (ok && (status == USB_STATUS_OK)) ? 0 : 1;
+        TPS55289LogDiscard();
+    }
+
+    double wire = wireUs(USB_PROTOCOL_HEADER_SIZE + payloadLength) + wireUs(replyLength);
+    printf("{\"bench\":\"usb_protocol\",\"test\":\"command\",\"command\":\"%s\",\"runs\":%u,\"failures\":%u,",
+           name, BENCH_RUNS, (unsigned int)failures);
+    printStats("cpu_ns", samples, BENCH_RUNS);
+    printf(",\"bus_us\":%u,\"wire_us\":%.1f}\n", (unsigned int)busUs, wire);
+    return failures;
+}
+
+static uint32_t benchTelemetry(void){
+    const uint32_t frames = 1000;
+    const uint32_t count = frames * USB_TELEMETRY_SAMPLES_PER_FRAME;
+    uint32_t sent = 0;
+    uint32_t bytes = 0;
+
+    uint64_t start = benchClockNs();
+    for (uint32_t n = 0; n < count; n++){
+        USB_TELEMETRY_SAMPLE sample = { n, 12000, 5000, 1000, 0x40, 0 };
+        usbProtocolTelemetry(&sample);
+
+        uint32_t length;
+        uint8_t *frame = usbProtocolNextTx(&length);
+        if (frame != NULL){
+            sent++;
+            bytes += length;
+            usbProtocolRelease(frame);
+        }
+    }
+    uint64_t elapsed = benchClockNs() - start;
+
+    const USB_PROTOCOL_STATS *stats = usbProtocolStats();
+    double frameWire = wireUs(USB_PROTOCOL_FRAME_SIZE);
+    printf("{\"bench\":\"usb_protocol\",\"test\":\"telemetry\",\"samples\":%u,\"frames\":%u,\"bytes\":%u,"
+           "\"dropped\":%u,\"samples_per_frame\":%u,\"cpu_ns_per_sample\":%.1f,\"wire_samples_per_s\":%.0f}\n",
+           (unsigned int)count, (unsigned int)sent, (unsigned int)bytes, (unsigned int)stats->telemetryDropped,
+           (unsigned int)USB_TELEMETRY_SAMPLES_PER_FRAME, (double)elapsed / count,
+           USB_TELEMETRY_SAMPLES_PER_FRAME / frameWire * 1e6);
+    return (sent * USB_TELEMETRY_SAMPLES_PER_FRAME == count) ? 0 : 1;
+}
+
+int main(void)
+{
+    TPS55289LogInit();
+
+    TPS55289_SIM sim;
+    TPS55289SimInit(&sim, TPS55289_SIM_BUS_FAST);
+    TPS55289 device = {0};
+    device.transport = &sim.transport;
+    TPS55289Init(&device);
+    TPS55289LogDiscard();
+
+    usbProtocolInit(&device);
+    uint32_t failures = 0;
+
+    static const uint16_t echoSizes[] = { 0, 56, 120, 248, USB_PROTOCOL_MAX_PAYLOAD };
+    for (uint32_t i = 0; i < sizeof(echoSizes) / sizeof(echoSizes[0]); i++){
+        failures += benchEcho(echoSizes[i]);
+    }
+
+    uint32_t mV = 5000;
+    uint32_t mA = 3000;
+    uint8_t enable = 1;
+    failures += benchCommand("PING",        USB_CMD_PING,       NULL,    0,               &sim);
+    failures += benchCommand("GET_STATUS",  USB_CMD_GET_STATUS, NULL,    0,               &sim);
+    failures += benchCommand("SET_VOUT",    USB_CMD_SET_VOUT,   &mV,     sizeof(mV),      &sim);
+    failures += benchCommand("SET_ILIM",    USB_CMD_SET_ILIM,   &mA,     sizeof(mA),      &sim);
+    failures += benchCommand("OUTPUT",      USB_CMD_OUTPUT,     &enable, sizeof(enable),  &sim);
+
+    failures += benchTelemetry();
+
+    const USB_PROTOCOL_STATS *stats = usbProtocolStats();
+    failures += stats->badFrames + stats->noBuffer;
+    printf("{\"bench\":\"usb_protocol\",\"test\":\"stats\",\"rx_frames\":%u,\"tx_frames\":%u,\"bad_frames\":%u,"
+           "\"no_buffer\":%u,\"failures\":%u}\n", (unsigned int)stats->rxFrames, (unsigned int)stats->txFrames,
+           (unsigned int)stats->badFrames, (unsigned int)stats->noBuffer, (unsigned int)failures);
+    return (failures == 0) ? 0 : 1;
+}
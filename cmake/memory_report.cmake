@@ -0,0 +1,96 @@
+# Generates a RAM-per-subsystem report from a GNU ld map file and fails if the total exceeds the budget
+#
+# Usage:
+#   cmake -DMAP_FILE=<target>.elf.map -DREPORT_FILE=<target>.memory.txt -DRAM_BUDGET=<bytes> -P memory_report.cmake
+#
+# Every input section placed in RP2040 SRAM (0x20000000 - 0x20042000) is attributed to the object file
+# that contributed it, and object files are grouped into subsystems by path.
+
+if(NOT MAP_FILE OR NOT REPORT_FILE OR NOT RAM_BUDGET)
+        message(FATAL_ERROR "memory_report.cmake needs MAP_FILE, REPORT_FILE and RAM_BUDGET")
+endif()
+
+set(RAM_START 536870912)        # 0x20000000
+set(RAM_END   537141248)        # 0x20042000 (SRAM0-5 including the scratch banks)
+
+set(SUBSYSTEMS "TPS55289 driver" "Application" "FreeRTOS" "TinyUSB" "pico-sdk" "C library" "Other")
+foreach(SUBSYSTEM IN LISTS SUBSYSTEMS)
+        set("RAM_${SUBSYSTEM}" 0)
+endforeach()
+
+function(classify OBJECT RESULT)
+        if(OBJECT MATCHES "/src/TPS55289[^/]*\\.c\\.obj")
+                set(${RESULT} "TPS55289 driver" PARENT_SCOPE)
+        elseif(OBJECT MATCHES "/src/[^/]+\\.c\\.obj")
+                set(${RESULT} "Application" PARENT_SCOPE)
+        elseif(OBJECT MATCHES "FreeRTOS")
+                set(${RESULT} "FreeRTOS" PARENT_SCOPE)
+        elseif(OBJECT MATCHES "tinyusb")
+                set(${RESULT} "TinyUSB" PARENT_SCOPE)
+        elseif(OBJECT MATCHES "pico[-_]sdk|/rp2_common/|/common/|/rp2040/")
+                set(${RESULT} "pico-sdk" PARENT_SCOPE)
+        elseif(OBJECT MATCHES "lib(c|g|m|gcc|nosys|stdc\\+\\+)[^/]*\\.a")
+                set(${RESULT} "C library" PARENT_SCOPE)
+        else()
+                set(${RESULT} "Other" PARENT_SCOPE)
+        endif()
+endfunction()
+
+file(STRINGS "${MAP_FILE}" MAP_LINES)
+set(TOTAL 0)
+set(HEAP_FUNCTIONS "")
+set(LIBC_HEAP_FUNCTIONS "")
+foreach(LINE IN LISTS MAP_LINES)
+        # Input section lines: [ .section] 0xADDRESS 0xSIZE object
+        if(LINE MATCHES "^ [^ ]* *0x([0-9a-fA-F]+) +0x([0-9a-fA-F]+) (.+)$")
+                set(OBJECT "${CMAKE_MATCH_3}")
+                math(EXPR ADDRESS "0x${CMAKE_MATCH_1}")
+                math(EXPR SIZE "0x${CMAKE_MATCH_2}")
+                if(SIZE GREATER 0 AND ADDRESS GREATER_EQUAL RAM_START AND ADDRESS LESS RAM_END)
+                        classify("${OBJECT}" SUBSYSTEM)
+                        math(EXPR "RAM_${SUBSYSTEM}" "${RAM_${SUBSYSTEM}} + ${SIZE}")
+                        math(EXPR TOTAL "${TOTAL} + ${SIZE}")
+                endif()
+        endif()
+        # Runtime heap use shows up as an allocator being linked in: the FreeRTOS heap, or the C library's
+        # (newlib's printf pulls _malloc_r in for floating point, and the allocator pulls in _sbrk)
+        if(LINE MATCHES "^ +0x[0-9a-fA-F]+ +(pvPortMalloc|pvPortCalloc)$")
+                list(APPEND HEAP_FUNCTIONS "${CMAKE_MATCH_1}")
+        endif()
+        if(LINE MATCHES "^ +0x[0-9a-fA-F]+ +((__wrap_)?(malloc|calloc|realloc)|_(malloc|calloc|realloc)_r|_sbrk(_r)?)$")
+                list(APPEND LIBC_HEAP_FUNCTIONS "${CMAKE_MATCH_1}")
+        endif()
+endforeach()
+
+set(REPORT "RAM usage by subsystem (${MAP_FILE})\n\n")
+foreach(SUBSYSTEM IN LISTS SUBSYSTEMS)
+        string(LENGTH "${SUBSYSTEM}" NAME_LENGTH)
+        math(EXPR PAD "20 - ${NAME_LENGTH}")
+        string(REPEAT " " ${PAD} SPACES)
+        string(APPEND REPORT "  ${SUBSYSTEM}${SPACES}${RAM_${SUBSYSTEM}} bytes\n")
+endforeach()
+string(APPEND REPORT "\n  Total               ${TOTAL} bytes\n  Budget              ${RAM_BUDGET} bytes\n")
+if(HEAP_FUNCTIONS)
+        string(APPEND REPORT "  FreeRTOS heap       linked (${HEAP_FUNCTIONS})\n")
+else()
+        string(APPEND REPORT "  FreeRTOS heap       not linked\n")
+endif()
+if(LIBC_HEAP_FUNCTIONS)
+        list(REMOVE_DUPLICATES LIBC_HEAP_FUNCTIONS)
+        string(APPEND REPORT "  C library heap      linked (${LIBC_HEAP_FUNCTIONS})\n")
+else()
+        string(APPEND REPORT "  C library heap      not linked\n")
+endif()
+
+file(WRITE "${REPORT_FILE}" "${REPORT}")
+message(STATUS "${REPORT}")
+
+if(TOTAL GREATER RAM_BUDGET)
+        message(FATAL_ERROR "RAM usage ${TOTAL} bytes exceeds the budget of ${RAM_BUDGET} bytes (see ${REPORT_FILE})")
+endif()
+if(HEAP_FUNCTIONS AND REQUIRE_NO_HEAP)
+        message(FATAL_ERROR "Static allocation build links the FreeRTOS heap: ${HEAP_FUNCTIONS}")
+endif()
+if(LIBC_HEAP_FUNCTIONS AND REQUIRE_NO_HEAP)
+        message(FATAL_ERROR "Static allocation build links the C library heap: ${LIBC_HEAP_FUNCTIONS}")
+endif()
@@ -0,0 +1,264 @@
+// Host-side behavioural simulator of the TPS55289 Buck-Boost Converter
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_sim.h"
+
+// Reset values are the ones TPS55289Init writes, STATUS included
+static_assert(TPS55289_SIM_REGISTERS == TPS55289_REGISTER_COUNT, "Simulator resets from TPS55289DefaultValues");
+
+static const float TPS55289_SIM_INTFB[4]     = { INTFB_00, INTFB_01, INTFB_10, INTFB_11 };
+static const float TPS55289_SIM_SLEW_RATE[4] = { 1.25, 2.5, 5.0, 10.0 };     // in mV/us
+
+#define TPS55289_SIM_VREF_OFFSET        45.0        // mV at code 0x000
+#define TPS55289_SIM_VREF_STEP          0.5645      // mV per code
+#define TPS55289_SIM_DISCHARGE_RATE     1.0         // mV/us with DISCHG set
+#define TPS55289_SIM_LEAKAGE_RATE       0.05        // mV/us with DISCHG clear
+#define TPS55289_SIM_NO_LIMIT           1.0e9
+
+static int simWrite(void *context, uint8_t address, const uint8_t *src, size_t len, _Bool nostop);
+static int simRead(void *context, uint8_t address, uint8_t *dst, size_t len, _Bool nostop);
+static int simWriteStart(void *context, uint8_t address, const uint8_t *src, size_t len);
+static int simWritePoll(void *context);
+
+void TPS55289SimInit(TPS55289_SIM *sim, uint32_t busHz){
+    sim->address               = TPS55289_I2C_ADDR;
+    sim->busHz                 = busHz;
+    sim->transactionOverheadUs = 0;
+    sim->VIN                   = 12000;
+    sim->loadOhms              = 0;
+    sim->shortCircuit          = false;
+    sim->overVoltage           = false;
+    sim->voutGain              = 1;
+    sim->voutOffset            = 0;
+    sim->ilimGain              = 1;
+    sim->ilimOffset            = 0;
+    sim->transport.write       = simWrite;
+    sim->transport.read        = simRead;
+    sim->transport.writeStart  = simWriteStart;
+    sim->transport.writePoll   = simWritePoll;
+    sim->transport.context     = sim;
+    sim->transport.lock        = &sim->lock;
+    recursive_mutex_init(&sim->lock);
+    TPS55289SimReset(sim);
+    TPS55289SimResetStats(sim);
+}
+
+/*
+    Power-on / brown-out reset of the register map; the output collapses immediately
+*/
+void TPS55289SimReset(TPS55289_SIM *sim){
+    memcpy(sim->registers, TPS55289DefaultValues, sizeof(sim->registers));
+    sim->pointer       = 0;
+    sim->pendingLength = 0;
+    sim->VOUT          = 0;
+    sim->lastUpdate    = time_us_64();
+}
+
+void TPS55289SimResetStats(TPS55289_SIM *sim){
+    sim->busTimeUs    = 0;
+    sim->transactions = 0;
+    sim->bytes        = 0;
+    sim->writes       = 0;
+    sim->naks         = 0;
+}
+
+/*
+    Wire time of one transaction: 9 clocks per byte (8 data + ACK) plus START and STOP
+*/
+uint32_t TPS55289SimTransferTime(const TPS55289_SIM *sim, size_t bytes){
+    uint64_t bits = (uint64_t)bytes * 9 + 2;
+    return (uint32_t)((bits * 1000000 + sim->busHz - 1) / sim->busHz) + sim->transactionOverheadUs;
+}
+
+float TPS55289SimTargetVOUT(const TPS55289_SIM *sim){
+    if ((sim->registers[TPS55289_MODE_ADDR] & TPS55289_SIM_MODE_OE) == 0){
+        return 0;
+    }
+    uint16_t code = ((sim->registers[TPS55289_REF_VOLTAGE_MSB_ADDR] << 8) |
+                      sim->registers[TPS55289_REF_VOLTAGE_LSB_ADDR]) & 0x07FF;
+    float vref = TPS55289_SIM_VREF_OFFSET + code * TPS55289_SIM_VREF_STEP;
+    uint8_t intfb = sim->registers[TPS55289_VOUT_FS_ADDR] & TPS55289_SIM_FS_INTFB;
+    float target = (vref / TPS55289_SIM_INTFB[intfb]) * sim->voutGain + sim->voutOffset;
+    return (target > 0) ? target : 0;
+}
+
+float TPS55289SimCurrentLimit(const TPS55289_SIM *sim){
+    uint8_t limit = sim->registers[TPS55289_IOUT_LIMIT_ADDR];
+    if ((limit & TPS55289_SIM_ILIM_EN) == 0){
+        return TPS55289_SIM_NO_LIMIT;
+    }
+    float nominal = (limit & TPS55289_SIM_ILIM_SETTING) * 0.5 / TPPS55289_SENSE_RESISTOR * 1000;   // 0.5mV per code across the sense resistor
+    float actual  = nominal * sim->ilimGain + sim->ilimOffset;
+    return (actual > 0) ? actual : 0;
+}
+
+float TPS55289SimIOUT(const TPS55289_SIM *sim){
+    return (sim->loadOhms > 0) ? (sim->VOUT / sim->loadOhms) : 0;
+}
+
+/*
+    Evolve the analog state up to the present virtual time
+
+    VOUT slews towards the programmed target at the VOUT_SR rate, discharges when the output is disabled,
+    folds back to the current limit into a resistive load, and latches SCP/OCP/OVP in STATUS. The operating
+    mode bits follow the VIN/VOUT ratio.
+*/
+void TPS55289SimUpdate(TPS55289_SIM *sim){
+    uint64_t now = time_us_64();
+    float dt = (float)(now - sim->lastUpdate);
+    sim->lastUpdate = now;
+
+    uint8_t mode   = sim->registers[TPS55289_MODE_ADDR];
+    uint8_t status = sim->registers[TPS55289_STATUS_ADDR];
+
+    float target = TPS55289SimTargetVOUT(sim);
+    float rate;
+    if (mode & TPS55289_SIM_MODE_OE){
+        rate = TPS55289_SIM_SLEW_RATE[sim->registers[TPS55289_VOUT_SR_ADDR] & TPS55289_SIM_SR];
+    } else {
+        rate = (mode & TPS55289_SIM_MODE_DISCHG) ? TPS55289_SIM_DISCHARGE_RATE : TPS55289_SIM_LEAKAGE_RATE;
+    }
+    float step = rate * dt;
+    if (sim->VOUT < target){
+        sim->VOUT = (target - sim->VOUT > step) ? sim->VOUT + step : target;
+    } else {
+        sim->VOUT = (sim->VOUT - target > step) ? sim->VOUT - step : target;
+    }
+
+    if (sim->shortCircuit && (mode & TPS55289_SIM_MODE_OE)){
+        sim->VOUT  = 0;
+        status |= TPS55289_SIM_STATUS_SCP;
+    }
+    float limit = TPS55289SimCurrentLimit(sim);
+    if ((sim->loadOhms > 0) && (TPS55289SimIOUT(sim) > limit)){
+        sim->VOUT  = limit * sim->loadOhms;          // mA * Ohm = mV
+        status |= TPS55289_SIM_STATUS_OCP;
+    }
+    if (sim->overVoltage){
+        status |= TPS55289_SIM_STATUS_OVP;
+    }
+
+    status &= (uint8_t)~TPS55289_SIM_STATUS_MODE;
+    if (target < sim->VIN * 0.9f){
+        status |= 0b01;             // Buck
+    } else if (target > sim->VIN * 1.1f){
+        status |= 0b00;             // Boost
+    } else {
+        status |= 0b10;             // Buck-Boost
+    }
+    sim->registers[TPS55289_STATUS_ADDR] = status;
+}
+
+static void simBusTime(TPS55289_SIM *sim, size_t bytes){
+    uint32_t us = TPS55289SimTransferTime(sim, bytes);
+    sim->busTimeUs += us;
+    sim->transactions++;
+    sim->bytes += bytes;
+    hostAdvanceTime(us);
+}
+
+/*
+    First byte sets the register pointer, remaining bytes are written with auto-increment. STATUS is
+    read-only. at is the virtual time the last byte finished on the wire.
+*/
+static void simApplyWrite(TPS55289_SIM *sim, const uint8_t *src, size_t len, uint64_t at){
+    sim->pointer = src[0];
+    for (size_t i = 1; i < len; i++){
+        if (sim->pointer < TPS55289_STATUS_ADDR){
+            sim->registers[sim->pointer] = src[i];
+            sim->writes++;
+        }
+        if (sim->pointer == TPS55289_REF_VOLTAGE_MSB_ADDR){
+            sim->refLatchedAt = at;
+        }
+        sim->pointer = (sim->pointer + 1) & (TPS55289_SIM_REGISTERS - 1);
+    }
+}
+
+/*
+    Transport: blocking register write, over when the last byte is on the wire
+*/
+static int simWrite(void *context, uint8_t address, const uint8_t *src, size_t len, _Bool nostop){
+    TPS55289_SIM *sim = (TPS55289_SIM *)context;
+    (void)nostop;
+
+    TPS55289SimUpdate(sim);
+    if ((address != sim->address) || (len == 0)){
+        sim->naks++;
+        simBusTime(sim, 1);
+        return PICO_ERROR_GENERIC;
+    }
+    simBusTime(sim, 1 + len);
+    simApplyWrite(sim, src, len, time_us_64());
+    return (int)len;
+}
+
+/*
+    Split write: the transfer is timed from writeStart but takes effect, like the blocking write, when its
+    last byte is on the wire. The virtual clock is not advanced, so writes started on several simulators
+    in a row overlap the way transfers on separate controllers do.
+*/
+static int simWriteStart(void *context, uint8_t address, const uint8_t *src, size_t len){
+    TPS55289_SIM *sim = (TPS55289_SIM *)context;
+    if ((sim->pendingLength > 0) || (len > sizeof(sim->pending))){
+        return PICO_ERROR_GENERIC;
+    }
+
+    TPS55289SimUpdate(sim);
+    _Bool acked = (address == sim->address) && (len > 0);
+    size_t bytes = acked ? 1 + len : 1;
+    uint32_t us = TPS55289SimTransferTime(sim, bytes);
+    if (!acked){
+        sim->naks++;
+    }
+    sim->busTimeUs += us;
+    sim->transactions++;
+    sim->bytes += bytes;
+
+    memcpy(sim->pending, src, len);
+    sim->pendingLength = acked ? len : 1;
+    sim->pendingResult = acked ? (int)len : PICO_ERROR_GENERIC;
+    sim->pendingDone   = time_us_64() + us;
+    return (int)len;
+}
+
+static int simWritePoll(void *context){
+    TPS55289_SIM *sim = (TPS55289_SIM *)context;
+    if ((sim->pendingLength == 0) || (time_us_64() < sim->pendingDone)){
+        return 0;
+    }
+    TPS55289SimUpdate(sim);
+    if (sim->pendingResult > 0){
+        simApplyWrite(sim, sim->pending, sim->pendingLength, sim->pendingDone);
+    }
+    sim->pendingLength = 0;
+    return sim->pendingResult;
+}
+
+/*
+    Transport: reads from the register pointer with auto-increment. Reading STATUS clears the latched
+    fault flags; the operating mode bits are live.
+*/
+static int simRead(void *context, uint8_t address, uint8_t *dst, size_t len, _Bool nostop){
+    TPS55289_SIM *sim = (TPS55289_SIM *)context;
+    (void)nostop;
+
+    TPS55289SimUpdate(sim);
+    if (address != sim->address){
+        sim->naks++;
+        simBusTime(sim, 1);
+        return PICO_ERROR_GENERIC;
+    }
+    for (size_t i = 0; i < len; i++){
+        dst[i] = sim->registers[sim->pointer];
+        if (sim->pointer == TPS55289_STATUS_ADDR){
+            sim->registers[TPS55289_STATUS_ADDR] &= (uint8_t)~TPS55289_SIM_STATUS_FAULTS;
+        }
+        sim->pointer = (sim->pointer + 1) & (TPS55289_SIM_REGISTERS - 1);
+    }
+    simBusTime(sim, 1 + len);
+    return (int)len;
+}
@@ -0,0 +1,91 @@
+// Host-side behavioural simulator of the TPS55289 Buck-Boost Converter
+#ifndef TPS55289_SIM_H
+#define TPS55289_SIM_H
+
+#include "pico/stdlib.h"
+#include "TPS55289.h"
+
+#define TPS55289_SIM_REGISTERS          8
+
+// Bus speeds in Hz
+#define TPS55289_SIM_BUS_STANDARD       100000
+#define TPS55289_SIM_BUS_FAST           400000
+#define TPS55289_SIM_BUS_FAST_PLUS      1000000
+
+// Register bits as the datasheet places them
+#define TPS55289_SIM_ILIM_EN            0x80        // IOUT_LIMIT
+#define TPS55289_SIM_ILIM_SETTING       0x7F
+#define TPS55289_SIM_SR                 0x03        // VOUT_SR
+#define TPS55289_SIM_FS_INTFB           0x03        // VOUT_FS
+#define TPS55289_SIM_MODE_OE            0x80        // MODE
+#define TPS55289_SIM_MODE_DISCHG        0x10
+#define TPS55289_SIM_STATUS_SCP         0x80        // STATUS
+#define TPS55289_SIM_STATUS_OCP         0x40
+#define TPS55289_SIM_STATUS_OVP         0x20
+#define TPS55289_SIM_STATUS_FAULTS      (TPS55289_SIM_STATUS_SCP | TPS55289_SIM_STATUS_OCP | TPS55289_SIM_STATUS_OVP)
+#define TPS55289_SIM_STATUS_MODE        0x03        // 00 = Boost; 01 = Buck; 10 = Buck-Boost
+
+/*
+    Simulator State
+
+    Registers are decoded with the datasheet bit positions above rather than the driver's register
+    structures, so a bitfield in TPS55289.h that sits in the wrong place shows up in the benches. Analog quantities are in mV/mA and evolve on the virtual clock
+    (time_us_64) which the simulator advances by the time each bus transaction occupies the wire.
+*/
+typedef struct {
+    // Register map
+    uint8_t  registers[TPS55289_SIM_REGISTERS];
+    uint8_t  pointer;                    // Register pointer for the next read/write
+    uint8_t  address;                    // 7-bit I2C address
+
+    // Bus timing
+    uint32_t busHz;                      // SCL frequency
+    uint32_t transactionOverheadUs;      // Fixed per-transaction cost (controller setup, host gaps)
+
+    // Board model
+    float    VIN;                        // Input voltage in mV
+    float    loadOhms;                   // Resistive load on VOUT; 0 = open
+    float    VOUT;                       // Present output voltage in mV
+    uint64_t lastUpdate;                 // Virtual time VOUT was last evolved to
+
+    // Fault injection
+    _Bool    shortCircuit;               // Forces SCP and collapses VOUT
+    _Bool    overVoltage;                // Forces OVP
+
+    // Unit-to-unit error, applied on top of the datasheet transfer functions
+    float    voutGain;                   // VOUT = nominal * voutGain + voutOffset
+    float    voutOffset;                 // in mV
+    float    ilimGain;                   // Current limit = nominal * ilimGain + ilimOffset
+    float    ilimOffset;                 // in mA
+
+    // Split write in flight (writeStart/writePoll); the bus is free again at pendingDone
+    uint8_t  pending[TPS55289_SIM_REGISTERS + 1];
+    size_t   pendingLength;
+    int      pendingResult;
+    uint64_t pendingDone;
+    uint64_t refLatchedAt;               // Virtual time the last write to REF MSB finished
+
+    // Statistics
+    uint64_t busTimeUs;                  // Total virtual time spent on the bus
+    uint32_t transactions;
+    uint32_t bytes;
+    uint32_t writes;                     // Register bytes written (excludes pointer bytes)
+    uint32_t naks;
+
+    TPS55289_TRANSPORT transport;        // Transport to hand to the driver (device.transport = &sim.transport)
+    recursive_mutex_t  lock;             // The simulated controller's lock, as transport.lock
+} TPS55289_SIM;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+void TPS55289SimInit(TPS55289_SIM *sim, uint32_t busHz);
+void TPS55289SimReset(TPS55289_SIM *sim);
+void TPS55289SimUpdate(TPS55289_SIM *sim);
+void TPS55289SimResetStats(TPS55289_SIM *sim);
+uint32_t TPS55289SimTransferTime(const TPS55289_SIM *sim, size_t bytes);
+float TPS55289SimTargetVOUT(const TPS55289_SIM *sim);
+float TPS55289SimCurrentLimit(const TPS55289_SIM *sim);
+float TPS55289SimIOUT(const TPS55289_SIM *sim);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // TPS55289_SIM_H
@@ -0,0 +1,37 @@
+// Host stand-in for hardware/sync.h; spin locks map onto C11 atomics so host threads behave like cores
+#ifndef HARDWARE_SYNC_HOST_H
+#define HARDWARE_SYNC_HOST_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef atomic_flag spin_lock_t;
+
+spin_lock_t *spin_lock_instance(unsigned int lock_num);
+int spin_lock_claim_unused(bool required);
+
+static inline uint32_t spin_lock_blocking(spin_lock_t *lock){
+    while (atomic_flag_test_and_set_explicit(lock, memory_order_acquire)){
+    }
+    return 0;
+}
+
+static inline void spin_unlock(spin_lock_t *lock, uint32_t saved_irq){
+    (void)saved_irq;
+    atomic_flag_clear_explicit(lock, memory_order_release);
+}
+
+static inline uint32_t save_and_disable_interrupts(void){
+    return 0;
+}
+
+static inline void restore_interrupts(uint32_t status){
+    (void)status;
+}
+
+static inline void __dmb(void){
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+#endif // HARDWARE_SYNC_HOST_H
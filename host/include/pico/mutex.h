@@ -0,0 +1,28 @@
+// Host stand-in for pico/mutex.h; recursive mutexes map onto pthread mutexes so host threads behave like tasks
+#ifndef PICO_MUTEX_HOST_H
+#define PICO_MUTEX_HOST_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    pthread_mutex_t mutex;
+} recursive_mutex_t;
+
+void recursive_mutex_init(recursive_mutex_t *mtx);
+
+static inline void recursive_mutex_enter_blocking(recursive_mutex_t *mtx){
+    pthread_mutex_lock(&mtx->mutex);
+}
+
+static inline bool recursive_mutex_try_enter(recursive_mutex_t *mtx, uint32_t *owner_out){
+    (void)owner_out;
+    return pthread_mutex_trylock(&mtx->mutex) == 0;
+}
+
+static inline void recursive_mutex_exit(recursive_mutex_t *mtx){
+    pthread_mutex_unlock(&mtx->mutex);
+}
+
+#endif // PICO_MUTEX_HOST_H
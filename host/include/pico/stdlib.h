@@ -0,0 +1,30 @@
+// Host stand-in for the subset of pico/stdlib.h used by the TPS55289 sources
+#ifndef PICO_STDLIB_HOST_H
+#define PICO_STDLIB_HOST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define PICO_ON_DEVICE          0
+
+#define PICO_OK                 0
+#define PICO_ERROR_GENERIC      -1
+#define PICO_ERROR_TIMEOUT      -2
+
+// Virtual microsecond clock; advanced by sleeps and by simulated bus traffic, never by wall time
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void busy_wait_us_32(uint32_t us);
+void hostAdvanceTime(uint64_t us);
+
+// Core the calling thread stands in for; 0 unless the thread selects another one
+unsigned int get_core_num(void);
+void hostSetCore(unsigned int core);
+
+static inline void tight_loop_contents(void) {}
+
+#endif // PICO_STDLIB_HOST_H
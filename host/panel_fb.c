@@ -0,0 +1,45 @@
+// In-memory framebuffer display backend for the front panel (host only)
+#include <stdio.h>
+#include <string.h>
+
+#include "panel_fb.h"
+
+static _Bool fbBlit(void *context, const PANEL_RECT *rect, const uint16_t *pixels){
+    PANEL_FB *fb = (PANEL_FB *)context;
+    if ((rect->width == 0) || (rect->x + rect->width > PANEL_WIDTH) || (rect->y + rect->height > PANEL_HEIGHT)){
+        fb->rejected++;
+        return false;
+    }
+    for (uint16_t row = 0; row < rect->height; row++){
+        memcpy(&fb->pixels[(rect->y + row) * PANEL_WIDTH + rect->x], &pixels[row * rect->width],
+               rect->width * sizeof(uint16_t));
+    }
+    fb->blits++;
+    fb->pixelsWritten += (uint32_t)rect->width * rect->height;
+    return true;
+}
+
+void panelFbInit(PANEL_FB *fb){
+    memset(fb, 0, sizeof(*fb));
+    fb->display.blit    = fbBlit;
+    fb->display.wait    = NULL;         // Copies complete inside blit
+    fb->display.context = fb;
+}
+
+// Binary PPM, for looking at a frame
+_Bool panelFbWritePPM(const PANEL_FB *fb, const char *path){
+    _Bool STATUS = true;
+    FILE *file = fopen(path, "wb");
+    if (file == NULL){
+        STATUS = false;
+        return STATUS;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", PANEL_WIDTH, PANEL_HEIGHT);
+    for (uint32_t i = 0; i < PANEL_WIDTH * PANEL_HEIGHT; i++){
+        uint16_t p = fb->pixels[i];
+        uint8_t rgb[3] = { (uint8_t)((p >> 8) & 0xF8), (uint8_t)((p >> 3) & 0xFC), (uint8_t)(p << 3) };
+        fwrite(rgb, 1, sizeof(rgb), file);
+    }
+    fclose(file);
+    return STATUS;
+}
@@ -0,0 +1,22 @@
+// In-memory framebuffer display backend for the front panel (host only)
+#ifndef PANEL_FB_H
+#define PANEL_FB_H
+
+#include "pico/stdlib.h"
+#include "panel.h"
+
+typedef struct {
+    uint16_t pixels[PANEL_WIDTH * PANEL_HEIGHT];
+    uint32_t blits;
+    uint32_t pixelsWritten;
+    uint32_t rejected;                  // Rectangles outside the screen
+    PANEL_DISPLAY display;              // Backend to hand to panelRender
+} PANEL_FB;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+void panelFbInit(PANEL_FB *fb);
+_Bool panelFbWritePPM(const PANEL_FB *fb, const char *path);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // PANEL_FB_H
@@ -0,0 +1,94 @@
+// Host implementations of the pico SDK stand-ins and the unconnected hardware I2C transports
+#include "pico/stdlib.h"
+#include "pico/mutex.h"
+#include "hardware/sync.h"
+
+#include "TPS55289_transport.h"
+
+#define HOST_SPIN_LOCKS     32
+
+static _Atomic uint64_t hostTime;
+static spin_lock_t hostSpinLocks[HOST_SPIN_LOCKS];
+static atomic_uint hostSpinLocksClaimed;
+static _Thread_local unsigned int hostCore;
+
+uint64_t time_us_64(void){
+    return hostTime;
+}
+
+uint32_t time_us_32(void){
+    return (uint32_t)hostTime;
+}
+
+void hostAdvanceTime(uint64_t us){
+    hostTime += us;
+}
+
+void sleep_us(uint64_t us){
+    hostAdvanceTime(us);
+}
+
+void busy_wait_us_32(uint32_t us){
+    hostAdvanceTime(us);
+}
+
+void sleep_ms(uint32_t ms){
+    hostAdvanceTime((uint64_t)ms * 1000);
+}
+
+unsigned int get_core_num(void){
+    return hostCore;
+}
+
+void hostSetCore(unsigned int core){
+    hostCore = core;
+}
+
+spin_lock_t *spin_lock_instance(unsigned int lock_num){
+    return &hostSpinLocks[lock_num % HOST_SPIN_LOCKS];
+}
+
+int spin_lock_claim_unused(bool required){
+    unsigned int lock = atomic_fetch_add(&hostSpinLocksClaimed, 1);
+    if (lock >= HOST_SPIN_LOCKS){
+        return required ? 0 : -1;
+    }
+    atomic_flag_clear(&hostSpinLocks[lock]);
+    return (int)lock;
+}
+
+void recursive_mutex_init(recursive_mutex_t *mtx){
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mtx->mutex, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+}
+
+// Nothing is attached to the host's "hardware" controllers; every address NAKs
+static int unconnectedWrite(void *context, uint8_t address, const uint8_t *src, size_t len, _Bool nostop){
+    (void)context; (void)address; (void)src; (void)len; (void)nostop;
+    return PICO_ERROR_GENERIC;
+}
+
+static int unconnectedRead(void *context, uint8_t address, uint8_t *dst, size_t len, _Bool nostop){
+    (void)context; (void)address; (void)dst; (void)len; (void)nostop;
+    return PICO_ERROR_GENERIC;
+}
+
+const TPS55289_TRANSPORT TPS55289_I2C0_TRANSPORT = {
+    .write      = unconnectedWrite,
+    .read       = unconnectedRead,
+    .context    = NULL,
+};
+
+const TPS55289_TRANSPORT TPS55289_I2C1_TRANSPORT = {
+    .write      = unconnectedWrite,
+    .read       = unconnectedRead,
+    .context    = NULL,
+};
+
+// No interrupts on the host; split writes are only ever polled
+void TPS55289I2CSetCompletionCallback(TPS55289_I2C_COMPLETION callback){
+    (void)callback;
+}
@@ -0,0 +1,358 @@
+// Assembler for script_vm bytecode (host only)
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "TPS55289.h"
+#include "script_asm.h"
+#include "script_vm.h"
+
+#define SCRIPT_ASM_MAX_LINE             256
+#define SCRIPT_ASM_MAX_TOKENS           8
+
+/*
+    Mnemonic Table
+
+    Operand kinds: R register, I int32, H uint16, B uint8, C channel, M STATUS mask, L label (rel16),
+    T time in us (uint32), O on/off. A mnemonic listed twice is chosen by whether its first operand is a
+    register.
+*/
+static const struct {
+    const char *name;
+    uint8_t     opcode;
+    const char *operands;
+} mnemonics[] = {
+    { "end",     SCRIPT_OP_END,     "" },
+    { "fail",    SCRIPT_OP_FAIL,    "B" },
+    { "wait",    SCRIPT_OP_WAIT,    "T" },
+    { "sync",    SCRIPT_OP_SYNC,    "" },
+    { "vout",    SCRIPT_OP_VOUT_R,  "R" },
+    { "vout",    SCRIPT_OP_VOUT,    "H" },
+    { "ilim",    SCRIPT_OP_ILIM_R,  "R" },
+    { "ilim",    SCRIPT_OP_ILIM,    "H" },
+    { "output",  SCRIPT_OP_OUTPUT,  "O" },
+    { "measure", SCRIPT_OP_MEASURE, "RC" },
+    { "load",    SCRIPT_OP_LOAD,    "RI" },
+    { "add",     SCRIPT_OP_ADD,     "RI" },
+    { "mov",     SCRIPT_OP_MOV,     "RR" },
+    { "sub",     SCRIPT_OP_SUB,     "RR" },
+    { "jmp",     SCRIPT_OP_JMP,     "L" },
+    { "djnz",    SCRIPT_OP_DJNZ,    "RL" },
+    { "jlt",     SCRIPT_OP_JLT,     "RIL" },
+    { "jgt",     SCRIPT_OP_JGT,     "RIL" },
+    { "jset",    SCRIPT_OP_JSET,    "ML" },
+    { "jclr",    SCRIPT_OP_JCLR,    "ML" },
+    { "report",  SCRIPT_OP_REPORT,  "BR" },
+};
+
+static const char *const channelNames[SCRIPT_CHANNELS] = { "vin", "vout", "iout", "status" };
+
+typedef struct {
+    char     name[SCRIPT_ASM_MAX_NAME];
+    uint16_t address;
+} SCRIPT_ASM_LABEL;
+
+typedef struct {
+    SCRIPT_ASM_LABEL labels[SCRIPT_ASM_MAX_LABELS];
+    uint32_t labelCount;
+    SCRIPT_ASM_ERROR *error;
+    int      line;
+    uint8_t  *output;
+    size_t   capacity;
+    size_t   pc;
+} SCRIPT_ASM;
+
+static _Bool fail(SCRIPT_ASM *assembler, const char *format, ...){
+    if (assembler->error != NULL){
+        va_list args;
+        va_start(args, format);
+        assembler->error->line = assembler->line;
+        vsnprintf(assembler->error->message, sizeof(assembler->error->message), format, args);
+        va_end(args);
+    }
+    return false;
+}
+
+static uint8_t operandSize(char kind){
+    switch (kind){
+        case 'I':
+        case 'T':   return 4;
+        case 'H':
+        case 'L':   return 2;
+        default:    return 1;
+    }
+}
+
+static _Bool isRegister(const char *token){
+    return (token[0] == 'r') && isdigit((unsigned char)token[1]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Operands
+
+static _Bool parseNumber(SCRIPT_ASM *assembler, const char *token, long min, long max, long *value){
+    char *end;
+    long number = strtol(token, &end, 0);
+    if ((end == token) || (*end != '\0')){
+        return fail(assembler, "'%s' is not a number", token);
+    }
+    if ((number < min) || (number > max)){
+        return fail(assembler, "%s out of range %ld..%ld", token, min, max);
+    }
+    *value = number;
+    return true;
+}
+
+static _Bool parseTime(SCRIPT_ASM *assembler, const char *token, long *value){
+    char *end;
+    long long number = strtoll(token, &end, 0);
+    long long scale = 1;
+    if (end == token){
+        return fail(assembler, "'%s' is not a time", token);
+    }
+    if (strcmp(end, "ms") == 0){
+        scale = 1000;
+    } else if (strcmp(end, "s") == 0){
+        scale = 1000000;
+    } else if ((*end != '\0') && (strcmp(end, "us") != 0)){
+        return fail(assembler, "unknown time unit '%s'", end);
+    }
+    if ((number < 0) || (number * scale > 0xFFFFFFFFll)){
+        return fail(assembler, "time %s out of range", token);
+    }
+    *value = (long)(number * scale);
+    return true;
+}
+
+static _Bool parseRegister(SCRIPT_ASM *assembler, const char *token, long *value){
+    if (!isRegister(token)){
+        return fail(assembler, "expected a register, got '%s'", token);
+    }
+    char *end;
+    *value = strtol(token + 1, &end, 10);
+    if ((*end != '\0') || (*value >= SCRIPT_VM_REGISTERS)){
+        return fail(assembler, "no register '%s' (r0..r%d)", token, SCRIPT_VM_REGISTERS - 1);
+    }
+    return true;
+}
+
+// STATUS flag names use the driver's bit layout so scripts and firmware agree
+static _Bool parseMask(SCRIPT_ASM *assembler, const char *token, long *value){
+    char copy[SCRIPT_ASM_MAX_LINE];
+    long mask = 0;
+    snprintf(copy, sizeof(copy), "%s", token);
+    for (char *name = strtok(copy, "|"); name != NULL; name = strtok(NULL, "|")){
+        TPS55289_STATUS_REG flag = { .regValue = 0 };
+        long number;
+        if (strcmp(name, "scp") == 0){
+            flag.SCP = 1;
+        } else if (strcmp(name, "ocp") == 0){
+            flag.OCP = 1;
+        } else if (strcmp(name, "ovp") == 0){
+            flag.OVP = 1;
+        } else if (parseNumber(assembler, name, 0, 0xFF, &number)){
+            flag.regValue = (uint8_t)number;
+        } else {
+            return fail(assembler, "unknown STATUS flag '%s'", name);
+        }
+        mask |= flag.regValue;
+    }
+    *value = mask;
+    return true;
+}
+
+static _Bool findLabel(SCRIPT_ASM *assembler, const char *name, uint16_t *address){
+    for (uint32_t i = 0; i < assembler->labelCount; i++){
+        if (strcmp(assembler->labels[i].name, name) == 0){
+            *address = assembler->labels[i].address;
+            return true;
+        }
+    }
+    return fail(assembler, "undefined label '%s'", name);
+}
+
+static void emit(SCRIPT_ASM *assembler, uint32_t value, uint8_t size){
+    for (uint8_t i = 0; i < size; i++){
+        assembler->output[assembler->pc++] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Lines
+
+static int tokenize(char *line, char **tokens){
+    int count = 0;
+    char *comment = strpbrk(line, ";#");
+    if (comment != NULL){
+        *comment = '\0';
+    }
+    for (char *token = strtok(line, " \t\r\n,"); (token != NULL) && (count < SCRIPT_ASM_MAX_TOKENS);
+         token = strtok(NULL, " \t\r\n,")){
+        for (char *c = token; *c != '\0'; c++){
+            *c = (char)tolower((unsigned char)*c);
+        }
+        tokens[count++] = token;
+    }
+    return count;
+}
+
+static int findMnemonic(const char *name, const char *firstOperand){
+    for (uint32_t i = 0; i < sizeof(mnemonics) / sizeof(mnemonics[0]); i++){
+        if (strcmp(mnemonics[i].name, name) != 0){
+            continue;
+        }
+        // vout/ilim: the register form is listed first and only taken for a register operand
+        _Bool hasAlternative = (i + 1 < sizeof(mnemonics) / sizeof(mnemonics[0])) &&
+                               (strcmp(mnemonics[i + 1].name, name) == 0);
+        if (hasAlternative && ((firstOperand == NULL) || !isRegister(firstOperand))){
+            continue;
+        }
+        return (int)i;
+    }
+    return -1;
+}
+
+/*
+    One source line. Pass 1 only records labels and advances pc; pass 2 also parses operands and emits.
+*/
+static _Bool assembleLine(SCRIPT_ASM *assembler, char *line, int pass){
+    char *tokens[SCRIPT_ASM_MAX_TOKENS];
+    int count = tokenize(line, tokens);
+    int first = 0;
+
+    if ((count > 0) && (tokens[0][strlen(tokens[0]) - 1] == ':')){
+        tokens[0][strlen(tokens[0]) - 1] = '\0';
+        if (pass == 1){
+            if ((strlen(tokens[0]) == 0) || (strlen(tokens[0]) >= SCRIPT_ASM_MAX_NAME)){
+                return fail(assembler, "bad label name");
+            }
+            for (uint32_t i = 0; i < assembler->labelCount; i++){
+                if (strcmp(assembler->labels[i].name, tokens[0]) == 0){
+                    return fail(assembler, "label '%s' defined twice", tokens[0]);
+                }
+            }
+            if (assembler->labelCount >= SCRIPT_ASM_MAX_LABELS){
+                return fail(assembler, "too many labels");
+            }
+            snprintf(assembler->labels[assembler->labelCount].name, SCRIPT_ASM_MAX_NAME, "%s", tokens[0]);
+            assembler->labels[assembler->labelCount].address = (uint16_t)assembler->pc;
+            assembler->labelCount++;
+        }
+        first = 1;
+    }
+    if (first >= count){
+        return true;
+    }
+
+    int index = findMnemonic(tokens[first], (first + 1 < count) ? tokens[first + 1] : NULL);
+    if (index < 0){
+        return fail(assembler, "unknown instruction '%s'", tokens[first]);
+    }
+    const char *operands = mnemonics[index].operands;
+    int expected = (int)strlen(operands);
+    if (count - first - 1 != expected){
+        return fail(assembler, "%s takes %d operand(s)", mnemonics[index].name, expected);
+    }
+
+    size_t size = 1;
+    for (int i = 0; i < expected; i++){
+        size += operandSize(operands[i]);
+    }
+    if (assembler->pc + size > assembler->capacity){
+        return fail(assembler, "program larger than %zu bytes", assembler->capacity);
+    }
+    if (pass == 1){
+        assembler->pc += size;
+        return true;
+    }
+
+    size_t end = assembler->pc + size;
+    emit(assembler, mnemonics[index].opcode, 1);
+    for (int i = 0; i < expected; i++){
+        const char *token = tokens[first + 1 + i];
+        long value = 0;
+        uint16_t address;
+        _Bool ok = true;
+        switch (operands[i]){
+            case 'R': ok = parseRegister(assembler, token, &value); break;
+            case 'I': ok = parseNumber(assembler, token, INT32_MIN, INT32_MAX, &value); break;
+            case 'H': ok = parseNumber(assembler, token, 0, 0xFFFF, &value); break;
+            case 'B': ok = parseNumber(assembler, token, 0, 0xFF, &value); break;
+            case 'T': ok = parseTime(assembler, token, &value); break;
+            case 'M': ok = parseMask(assembler, token, &value); break;
+            case 'O':
+                if ((strcmp(token, "on") == 0) || (strcmp(token, "1") == 0)){
+                    value = 1;
+                } else if ((strcmp(token, "off") != 0) && (strcmp(token, "0") != 0)){
+                    ok = fail(assembler, "expected on/off, got '%s'", token);
+                }
+                break;
+            case 'C':
+                value = -1;
+                for (long c = 0; c < SCRIPT_CHANNELS; c++){
+                    if (strcmp(token, channelNames[c]) == 0){
+                        value = c;
+                    }
+                }
+                ok = (value >= 0) ? true : fail(assembler, "unknown channel '%s'", token);
+                break;
+            case 'L':
+                ok = findLabel(assembler, token, &address);
+                value = (long)address - (long)end;
+                if (ok && ((value < INT16_MIN) || (value > INT16_MAX))){
+                    ok = fail(assembler, "label '%s' out of branch range", token);
+                }
+                break;
+        }
+        if (!ok){
+            return false;
+        }
+        emit(assembler, (uint32_t)value, operandSize(operands[i]));
+    }
+    return true;
+}
+
+/*
+    Assemble
+
+    Returns the bytecode length, or -1 with error filled in. The result is also run through
+    scriptVmValidate, so anything this returns will be accepted by the device.
+*/
+int scriptAsmAssemble(const char *source, uint8_t *output, size_t capacity, SCRIPT_ASM_ERROR *error){
+    SCRIPT_ASM assembler = { .error = error, .output = output, .capacity = capacity };
+
+    if (error != NULL){
+        error->line = 0;
+        error->message[0] = '\0';
+    }
+    for (int pass = 1; pass <= 2; pass++){
+        const char *cursor = source;
+        assembler.pc = 0;
+        assembler.line = 0;
+        while (*cursor != '\0'){
+            char line[SCRIPT_ASM_MAX_LINE];
+            size_t length = strcspn(cursor, "\n");
+            assembler.line++;
+            if (length >= sizeof(line)){
+                fail(&assembler, "line too long");
+                return -1;
+            }
+            memcpy(line, cursor, length);
+            line[length] = '\0';
+            cursor += length + ((cursor[length] == '\n') ? 1 : 0);
+            if (assembleLine(&assembler, line, pass) == false){
+                return -1;
+            }
+        }
+    }
+
+    SCRIPT_ERROR check = scriptVmValidate(output, (uint16_t)assembler.pc);
+    if (check != SCRIPT_ERROR_NONE){
+        assembler.line = 0;
+        fail(&assembler, "bytecode rejected by scriptVmValidate (error %d)", (int)check);
+        return -1;
+    }
+    return (int)assembler.pc;
+}
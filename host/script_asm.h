@@ -0,0 +1,38 @@
+// Assembler for script_vm bytecode (host only)
+#ifndef SCRIPT_ASM_H
+#define SCRIPT_ASM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    Source Syntax
+
+    One instruction per line; ';' or '#' starts a comment; "name:" defines a label. Operands are separated
+    by commas or spaces. Numbers are decimal or 0x hex; WAIT takes an optional us/ms/s suffix.
+
+        end                     fail code
+        wait 1ms                sync
+        vout 5000 | vout r1     ilim 3000 | ilim r2     output on|off
+        measure r0, vin|vout|iout|status
+        load r1, -5             add r1, 100             mov r1, r2          sub r1, r2
+        jmp label               djnz r2, label
+        jlt r0, 4900, label     jgt r0, 5100, label
+        jset ocp|scp|ovp|0xNN, label                    jclr ..., label
+        report slot, r3
+*/
+
+#define SCRIPT_ASM_MAX_LABELS           64
+#define SCRIPT_ASM_MAX_NAME             32
+
+typedef struct {
+    int  line;                          // 1-based source line of the first error
+    char message[96];
+} SCRIPT_ASM_ERROR;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+int scriptAsmAssemble(const char *source, uint8_t *output, size_t capacity, SCRIPT_ASM_ERROR *error);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SCRIPT_ASM_H
@@ -0,0 +1,51 @@
+// Command line front end for the script assembler: ScriptAsm input.s output.bin
+//
+// The output is raw bytecode for SCRIPT_LOAD; the host uploads it in chunks and starts it with SCRIPT_RUN.
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "script_asm.h"
+#include "script_vm.h"
+
+int main(int argc, char **argv)
+{
+    if (argc != 3){
+        fprintf(stderr, "usage: %s input.s output.bin\n", argv[0]);
+        return 2;
+    }
+
+    FILE *input = fopen(argv[1], "rb");
+    if (input == NULL){
+        perror(argv[1]);
+        return 1;
+    }
+    fseek(input, 0, SEEK_END);
+    long size = ftell(input);
+    fseek(input, 0, SEEK_SET);
+    char *source = malloc((size_t)size + 1);
+    if ((source == NULL) || (fread(source, 1, (size_t)size, input) != (size_t)size)){
+        fprintf(stderr, "%s: read failed\n", argv[1]);
+        fclose(input);
+        return 1;
+    }
+    source[size] = '\0';
+    fclose(input);
+
+    uint8_t program[SCRIPT_VM_MAX_PROGRAM];
+    SCRIPT_ASM_ERROR error;
+    int length = scriptAsmAssemble(source, program, sizeof(program), &error);
+    free(source);
+    if (length < 0){
+        fprintf(stderr, "%s:%d: %s\n", argv[1], error.line, error.message);
+        return 1;
+    }
+
+    FILE *output = fopen(argv[2], "wb");
+    if ((output == NULL) || (fwrite(program, 1, (size_t)length, output) != (size_t)length)){
+        perror(argv[2]);
+        return 1;
+    }
+    fclose(output);
+    printf("%s: %d bytes\n", argv[2], length);
+    return 0;
+}
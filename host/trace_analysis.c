@@ -0,0 +1,503 @@
+// Offline analysis of TPS55289 register traces (host only): streaming reader, decoder, statistics and replay
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_sim.h"
+#include "TPS55289_trace.h"
+#include "trace_analysis.h"
+
+static const char *const traceRegisterNames[TPS55289_REGISTER_COUNT] = {
+    "REF_LSB", "REF_MSB", "IOUT_LIMIT", "VOUT_SR", "VOUT_FS", "CDC", "MODE", "STATUS"
+};
+
+static const char *const traceConverterModes[] = { "Boost", "Buck", "Buck-Boost", "Reserved" };
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Reader
+
+/*
+    Open
+
+    Checks the file header. Returns 0, or a negative errno (-EINVAL for a file that is not a trace of
+    this version).
+*/
+int traceReaderOpen(TRACE_READER *reader, const char *path){
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = open(path, O_RDONLY);
+    if (reader->fd < 0){
+        return -errno;
+    }
+    struct stat info;
+    TPS55289_TRACE_FILE_HEADER header;
+    if ((fstat(reader->fd, &info) != 0) ||
+        (pread(reader->fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header))){
+        int error = (errno != 0) ? errno : EINVAL;
+        close(reader->fd);
+        return -error;
+    }
+    if ((header.magic != TPS55289_TRACE_MAGIC) || (header.version != TPS55289_TRACE_VERSION) ||
+        (header.recordSize != sizeof(TPS55289_TRACE_RECORD))){
+        close(reader->fd);
+        return -EINVAL;
+    }
+    reader->size   = (uint64_t)info.st_size;
+    reader->offset = sizeof(header);
+    reader->busHz  = header.busHz;
+    return 0;
+}
+
+// Moves the window on to the next record; the one before it is unmapped
+static _Bool traceReaderMap(TRACE_READER *reader){
+    if (reader->window != NULL){
+        munmap((void *)reader->window, reader->windowLength);
+        reader->window = NULL;
+    }
+    uint64_t page  = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t start = reader->offset & ~(page - 1);
+    uint64_t left  = reader->size - start;
+    size_t length  = (left < TRACE_WINDOW_BYTES) ? (size_t)left : TRACE_WINDOW_BYTES;
+
+    void *window = mmap(NULL, length, PROT_READ, MAP_PRIVATE, reader->fd, (off_t)start);
+    if (window == MAP_FAILED){
+        return false;
+    }
+    madvise(window, length, MADV_SEQUENTIAL);
+    reader->window       = (const uint8_t *)window;
+    reader->windowStart  = start;
+    reader->windowLength = length;
+    return true;
+}
+
+static _Bool traceSameTransaction(const TPS55289_TRACE_RECORD *previous, const TPS55289_TRACE_RECORD *record){
+    return ((previous->flags & ~TPS55289_TRACE_REGISTER_MASK) == (record->flags & ~TPS55289_TRACE_REGISTER_MASK)) &&
+           ((previous->flags & TPS55289_TRACE_MARKER) != TPS55289_TRACE_MARKER) &&
+           (previous->timestamp == record->timestamp) && (previous->durationUs == record->durationUs) &&
+           (((previous->flags + 1) & TPS55289_TRACE_REGISTER_MASK) == (record->flags & TPS55289_TRACE_REGISTER_MASK));
+}
+
+/*
+    Next
+
+    Decodes the next record into event. Returns false at the end of the file or if the file could not be
+    mapped.
+*/
+_Bool traceReaderNext(TRACE_READER *reader, TRACE_EVENT *event){
+    const size_t recordSize = sizeof(TPS55289_TRACE_RECORD);
+    if (reader->offset + recordSize > reader->size){
+        reader->truncated = (reader->offset < reader->size);
+        return false;
+    }
+    if (reader->offset + recordSize > reader->windowStart + reader->windowLength){
+        if (!traceReaderMap(reader)){
+            return false;
+        }
+    }
+    TPS55289_TRACE_RECORD record;
+    memcpy(&record, reader->window + (reader->offset - reader->windowStart), recordSize);
+    reader->offset += recordSize;
+
+    if (reader->started){
+        int32_t delta = (int32_t)(record.timestamp - reader->lastStamp);
+        reader->backwards += (delta < 0) ? 1 : 0;
+        reader->lastTime  += delta;
+    }
+    event->time       = (reader->lastTime > 0) ? (uint64_t)reader->lastTime : 0;
+    event->marker     = (record.flags & TPS55289_TRACE_MARKER) == TPS55289_TRACE_MARKER;
+    event->durationUs = event->marker ? 0 : record.durationUs;
+    event->dropped    = event->marker ? record.durationUs : 0;
+    event->channel    = record.flags >> TPS55289_TRACE_CHANNEL_SHIFT;
+    event->address    = record.flags & TPS55289_TRACE_REGISTER_MASK;
+    event->value      = record.value;
+    event->read       = (record.flags & TPS55289_TRACE_READ) != 0;
+    event->failed     = (record.flags & TPS55289_TRACE_FAILED) != 0;
+    event->burst      = reader->started && !event->marker && traceSameTransaction(&reader->previous, &record);
+
+    reader->started   = true;
+    reader->lastStamp = record.timestamp;
+    reader->previous  = record;
+    reader->records++;
+    return true;
+}
+
+void traceReaderClose(TRACE_READER *reader){
+    if (reader->window != NULL){
+        munmap((void *)reader->window, reader->windowLength);
+        reader->window = NULL;
+    }
+    if (reader->fd >= 0){
+        close(reader->fd);
+        reader->fd = -1;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Decoder
+
+static void traceAppend(char *text, size_t size, int *used, const char *format, ...){
+    if ((size_t)*used >= size){
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    int added = vsnprintf(text + *used, size - (size_t)*used, format, args);
+    va_end(args);
+    *used += (added > 0) ? added : 0;
+}
+
+/*
+    Decode
+
+    One line of text for an event, the register's bitfields spelled out through the structures in
+    TPS55289.h. Returns the length snprintf would have produced.
+*/
+int traceDecode(const TRACE_EVENT *event, char *text, size_t size){
+    int used = 0;
+    traceAppend(text, size, &used, "%14.6f ", event->time / 1e6);
+    if (event->marker){
+        if (event->dropped > 0){
+            traceAppend(text, size, &used, "-- gap: %u records dropped", (unsigned int)event->dropped);
+        } else {
+            traceAppend(text, size, &used, "-- anchor");
+        }
+        return used;
+    }
+
+    traceAppend(text, size, &used, "ch%u %c %-10s 0x%02X %5uus%s%s ", (unsigned int)event->channel,
+                event->read ? 'R' : 'W', traceRegisterNames[event->address], (unsigned int)event->value,
+                (unsigned int)event->durationUs, event->burst ? " +" : "  ", event->failed ? " FAILED" : "");
+    switch (event->address){
+        case TPS55289_REF_VOLTAGE_LSB_ADDR:
+            traceAppend(text, size, &used, "VREF[7:0]=%u", (unsigned int)event->value);
+            break;
+        case TPS55289_REF_VOLTAGE_MSB_ADDR:
+            traceAppend(text, size, &used, "VREF[10:8]=%u", (unsigned int)(event->value & 0x07));
+            break;
+        case TPS55289_IOUT_LIMIT_ADDR: {
+            TPS55289_IOUT_LIMIT_REG reg;
+            reg.regValue = event->value;
+            traceAppend(text, size, &used, "EN=%u SETTING=%u (%.2f A)", (unsigned int)reg.Current_Limit_EN,
+                        (unsigned int)reg.Current_Limit_Setting,
+                        reg.Current_Limit_Setting * 0.5 / TPPS55289_SENSE_RESISTOR);
+            break;
+        }
+        case TPS55289_VOUT_SR_ADDR: {
+            TPS55289_VOUT_SR_REG reg;
+            reg.regValue = event->value;
+            traceAppend(text, size, &used, "OCP_DELAY=%u SR=%u", (unsigned int)reg.OCP_DELAY, (unsigned int)reg.SR);
+            break;
+        }
+        case TPS55289_VOUT_FS_ADDR: {
+            TPS55289_VOUT_FS_REG reg;
+            reg.regValue = event->value;
+            traceAppend(text, size, &used, "FB=%s INTFB=%u", reg.FB ? "EXT" : "INT", (unsigned int)reg.INTFB);
+            break;
+        }
+        case TPS55289_CDC_ADDR: {
+            TPS55289_CDC_REG reg;
+            reg.regValue = event->value;
+            traceAppend(text, size, &used, "SC_MASK=%u OCP_MASK=%u OVP_MASK=%u CDC_OPTION=%s CDC=%u",
+                        (unsigned int)reg.SC_MASK, (unsigned int)reg.OCP_MASK, (unsigned int)reg.OVP_MASK,
+                        reg.CDC_OPTION ? "EXT" : "INT", (unsigned int)reg.CDC);
+            break;
+        }
+        case TPS55289_MODE_ADDR: {
+            TPS55289_MODE_REG reg;
+            reg.regValue = event->value;
+            traceAppend(text, size, &used, "OE=%u FSWDBL=%u HICCUP=%u DISCHG=%u FPWM=%u", (unsigned int)reg.OE,
+                        (unsigned int)reg.FSWDBL, (unsigned int)reg.HICCUP, (unsigned int)reg.DISCHG,
+                        (unsigned int)reg.FPWM);
+            break;
+        }
+        default: {
+            TPS55289_STATUS_REG reg;
+            reg.regValue = event->value;
+            traceAppend(text, size, &used, "SCP=%u OCP=%u OVP=%u STATUS=%s", (unsigned int)reg.SCP,
+                        (unsigned int)reg.OCP, (unsigned int)reg.OVP, traceConverterModes[reg.STATUS]);
+            break;
+        }
+    }
+    return used;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Statistics
+
+void traceStatsInit(TRACE_STATS *stats){
+    memset(stats, 0, sizeof(*stats));
+    for (uint32_t d = 0; d < 2; d++){
+        stats->timing[d].minUs = UINT32_MAX;
+    }
+    for (uint32_t c = 0; c < TPS55289_TRACE_CHANNELS; c++){
+        stats->refIntervalMin[c] = UINT64_MAX;
+    }
+}
+
+/*
+    Add
+
+    Timing is per transaction: a burst counts once, with the duration its records share.
+*/
+void traceStatsAdd(TRACE_STATS *stats, const TRACE_EVENT *event){
+    stats->records++;
+    if (stats->records == 1){
+        stats->firstTime = event->time;
+    }
+    stats->lastTime = (event->time > stats->lastTime) ? event->time : stats->lastTime;
+    if (event->marker){
+        stats->markers++;
+        stats->dropped += event->dropped;
+        return;
+    }
+
+    uint32_t direction = event->read ? 1 : 0;
+    uint32_t channel   = event->channel;
+    stats->registerCount[direction][event->address]++;
+    if (!event->burst){
+        TRACE_TIMING *timing = &stats->timing[direction];
+        timing->transactions++;
+        timing->failed  += event->failed ? 1 : 0;
+        timing->totalUs += event->durationUs;
+        timing->minUs    = (event->durationUs < timing->minUs) ? event->durationUs : timing->minUs;
+        timing->maxUs    = (event->durationUs > timing->maxUs) ? event->durationUs : timing->maxUs;
+        timing->histogram[(event->durationUs < TRACE_HISTOGRAM_US) ? event->durationUs : TRACE_HISTOGRAM_US - 1]++;
+
+        if ((stats->channelTransactions[channel] > 0) && (event->time > stats->channelLast[channel])){
+            uint64_t idle = event->time - stats->channelLast[channel];
+            stats->channelMaxIdleUs[channel] = (idle > stats->channelMaxIdleUs[channel]) ? idle
+                                                                                          : stats->channelMaxIdleUs[channel];
+        }
+        stats->channelTransactions[channel]++;
+        stats->channelLast[channel] = event->time;
+    }
+
+    if (!event->read && !event->failed && (event->address == TPS55289_REF_VOLTAGE_MSB_ADDR)){
+        if ((stats->refUpdates[channel] > 0) && (event->time >= stats->refLast[channel])){
+            uint64_t interval = event->time - stats->refLast[channel];
+            stats->refIntervalTotal[channel] += interval;
+            stats->refIntervalMin[channel] = (interval < stats->refIntervalMin[channel]) ? interval
+                                                                                          : stats->refIntervalMin[channel];
+        }
+        stats->refUpdates[channel]++;
+        stats->refLast[channel] = event->time;
+    }
+}
+
+// Smallest duration at or below which fraction of the transactions fall; 1 us resolution
+uint32_t traceStatsPercentile(const TRACE_TIMING *timing, double fraction){
+    uint64_t wanted = (uint64_t)(fraction * timing->transactions + 0.999999);
+    uint64_t seen = 0;
+    for (uint32_t us = 0; us < TRACE_HISTOGRAM_US; us++){
+        seen += timing->histogram[us];
+        if ((seen >= wanted) && (seen > 0)){
+            return us;
+        }
+    }
+    return TRACE_HISTOGRAM_US - 1;
+}
+
+void traceStatsPrint(const TRACE_STATS *stats, FILE *output){
+    static const char *const directions[2] = { "write", "read" };
+
+    fprintf(output, "records,markers,dropped,span_s\n");
+    fprintf(output, "%llu,%llu,%llu,%.6f\n", (unsigned long long)stats->records, (unsigned long long)stats->markers,
+            (unsigned long long)stats->dropped, (stats->lastTime - stats->firstTime) / 1e6);
+
+    fprintf(output, "\ndirection,transactions,failed,min_us,mean_us,p50_us,p99_us,p999_us,max_us\n");
+    for (uint32_t d = 0; d < 2; d++){
+        const TRACE_TIMING *timing = &stats->timing[d];
+        if (timing->transactions == 0){
+            fprintf(output, "%s,0,0,-,-,-,-,-,-\n", directions[d]);
+            continue;
+        }
+        fprintf(output, "%s,%llu,%llu,%u,%.1f,%u,%u,%u,%u\n", directions[d], (unsigned long long)timing->transactions,
+                (unsigned long long)timing->failed, (unsigned int)timing->minUs,
+                (double)timing->totalUs / timing->transactions, (unsigned int)traceStatsPercentile(timing, 0.5),
+                (unsigned int)traceStatsPercentile(timing, 0.99), (unsigned int)traceStatsPercentile(timing, 0.999),
+                (unsigned int)timing->maxUs);
+    }
+
+    fprintf(output, "\nregister,writes,reads\n");
+    for (uint32_t r = 0; r < TPS55289_REGISTER_COUNT; r++){
+        fprintf(output, "%s,%llu,%llu\n", traceRegisterNames[r], (unsigned long long)stats->registerCount[0][r],
+                (unsigned long long)stats->registerCount[1][r]);
+    }
+
+    fprintf(output, "\nchannel,transactions,max_idle_ms,ref_updates,min_ref_interval_us,mean_ref_interval_us\n");
+    for (uint32_t c = 0; c < TPS55289_TRACE_CHANNELS; c++){
+        if (stats->channelTransactions[c] == 0){
+            continue;
+        }
+        fprintf(output, "%u,%llu,%.3f,%llu,", (unsigned int)c, (unsigned long long)stats->channelTransactions[c],
+                stats->channelMaxIdleUs[c] / 1000.0, (unsigned long long)stats->refUpdates[c]);
+        if (stats->refUpdates[c] > 1){
+            fprintf(output, "%llu,%.1f\n", (unsigned long long)stats->refIntervalMin[c],
+                    (double)stats->refIntervalTotal[c] / (stats->refUpdates[c] - 1));
+        } else {
+            fprintf(output, "-,-\n");
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Replay
+
+void traceReplayInit(TRACE_REPLAY *replay, uint32_t busHz){
+    memset(replay, 0, sizeof(*replay));
+    for (uint32_t c = 0; c < TPS55289_TRACE_CHANNELS; c++){
+        TPS55289SimInit(&replay->sim[c], (busHz != 0) ? busHz : TPS55289_SIM_BUS_FAST);
+    }
+}
+
+// Timing residual of the transaction just completed: traced duration less the simulator's bus time
+static void replayClose(TRACE_REPLAY *replay){
+    if (!replay->open){
+        return;
+    }
+    replay->open = false;
+    const TPS55289_SIM *sim = &replay->sim[replay->openChannel];
+    uint32_t modelled = replay->openRead ? TPS55289SimTransferTime(sim, 2) + TPS55289SimTransferTime(sim, 1 + replay->openCount)
+                                         : TPS55289SimTransferTime(sim, 2 + replay->openCount);
+    int32_t residual = (int32_t)replay->openDurationUs - (int32_t)modelled;
+    uint32_t d = replay->openRead ? 1 : 0;
+    if (replay->residualTransactions[d] == 0){
+        replay->residualMinUs[d] = residual;
+        replay->residualMaxUs[d] = residual;
+    }
+    replay->residualTransactions[d]++;
+    replay->residualTotalUs[d] += residual;
+    replay->residualMinUs[d] = (residual < replay->residualMinUs[d]) ? residual : replay->residualMinUs[d];
+    replay->residualMaxUs[d] = (residual > replay->residualMaxUs[d]) ? residual : replay->residualMaxUs[d];
+}
+
+void traceReplayEvent(TRACE_REPLAY *replay, const TRACE_EVENT *event){
+    if (!replay->started){
+        replay->origin  = time_us_64();
+        replay->started = true;
+    }
+    uint64_t at  = replay->origin + event->time;
+    uint64_t now = time_us_64();
+    if (at > now){
+        hostAdvanceTime(at - now);
+    }
+    if (event->marker){
+        if (event->dropped > 0){
+            replay->gaps++;
+            memset(replay->known, 0, sizeof(replay->known));
+        }
+        return;
+    }
+
+    uint8_t bit = (uint8_t)(1u << event->address);
+    TPS55289_SIM *sim = &replay->sim[event->channel];
+    if (!event->burst || event->failed){
+        replayClose(replay);
+    }
+    if (event->failed){
+        replay->failedSkipped++;
+        replay->known[event->channel] &= (uint8_t)~bit;     // A timed-out write may or may not have landed
+        return;
+    }
+    if (event->burst && replay->open){
+        replay->openCount++;
+    } else {
+        replay->open           = true;
+        replay->openRead       = event->read;
+        replay->openCount      = 1;
+        replay->openDurationUs = event->durationUs;
+        replay->openChannel    = event->channel;
+    }
+
+    if (!event->read){
+        uint8_t buffer[2] = { event->address, event->value };
+        replay->writes++;
+        sim->transport.write(sim, sim->address, buffer, sizeof(buffer), false);
+        if (event->address != TPS55289_STATUS_ADDR){
+            replay->known[event->channel] |= bit;
+        }
+        return;
+    }
+
+    uint8_t pointer = event->address;
+    uint8_t value   = 0;
+    replay->reads++;
+    sim->transport.write(sim, sim->address, &pointer, 1, true);
+    sim->transport.read(sim, sim->address, &value, 1, false);
+    if (event->address == TPS55289_STATUS_ADDR){
+        replay->statusDiffers += (value != event->value) ? 1 : 0;
+        return;
+    }
+    if ((replay->known[event->channel] & bit) == 0){
+        replay->unverified++;
+        sim->registers[event->address] = event->value;
+        replay->known[event->channel] |= bit;
+        return;
+    }
+    replay->compared++;
+    if (value != event->value){
+        if (replay->mismatches == 0){
+            replay->firstMismatch         = *event;
+            replay->firstMismatchExpected = value;
+        }
+        replay->mismatches++;
+        replay->mismatchByRegister[event->address]++;
+        sim->registers[event->address] = event->value;      // Follow the device from here on
+    }
+}
+
+void traceReplayFinish(TRACE_REPLAY *replay){
+    replayClose(replay);
+}
+
+void traceReplayPrint(const TRACE_REPLAY *replay, FILE *output){
+    static const char *const directions[2] = { "write", "read" };
+
+    fprintf(output, "writes,reads,compared,mismatches,status_differs,unverified,failed_skipped,gaps\n");
+    fprintf(output, "%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu\n", (unsigned long long)replay->writes,
+            (unsigned long long)replay->reads, (unsigned long long)replay->compared,
+            (unsigned long long)replay->mismatches, (unsigned long long)replay->statusDiffers,
+            (unsigned long long)replay->unverified, (unsigned long long)replay->failedSkipped,
+            (unsigned long long)replay->gaps);
+
+    fprintf(output, "\ndirection,transactions,mean_residual_us,min_residual_us,max_residual_us\n");
+    for (uint32_t d = 0; d < 2; d++){
+        if (replay->residualTransactions[d] == 0){
+            fprintf(output, "%s,0,-,-,-\n", directions[d]);
+            continue;
+        }
+        fprintf(output, "%s,%llu,%.1f,%d,%d\n", directions[d], (unsigned long long)replay->residualTransactions[d],
+                (double)replay->residualTotalUs[d] / replay->residualTransactions[d], (int)replay->residualMinUs[d],
+                (int)replay->residualMaxUs[d]);
+    }
+
+    if (replay->mismatches > 0){
+        char line[160];
+        fprintf(output, "\nregister,mismatches\n");
+        for (uint32_t r = 0; r < TPS55289_REGISTER_COUNT; r++){
+            if (replay->mismatchByRegister[r] > 0){
+                fprintf(output, "%s,%llu\n", traceRegisterNames[r], (unsigned long long)replay->mismatchByRegister[r]);
+            }
+        }
+        traceDecode(&replay->firstMismatch, line, sizeof(line));
+        fprintf(output, "first mismatch: %s (simulator 0x%02X)\n", line, (unsigned int)replay->firstMismatchExpected);
+    }
+
+    fprintf(output, "\nchannel,ref_code,vout_target_mv,mode,iout_limit\n");
+    for (uint32_t c = 0; c < TPS55289_TRACE_CHANNELS; c++){
+        const TPS55289_SIM *sim = &replay->sim[c];
+        if (replay->known[c] == 0){
+            continue;
+        }
+        uint16_t code = (uint16_t)(((sim->registers[TPS55289_REF_VOLTAGE_MSB_ADDR] << 8) |
+                                     sim->registers[TPS55289_REF_VOLTAGE_LSB_ADDR]) & 0x07FF);
+        fprintf(output, "%u,%u,%.0f,0x%02X,0x%02X\n", (unsigned int)c, (unsigned int)code, TPS55289SimTargetVOUT(sim),
+                (unsigned int)sim->registers[TPS55289_MODE_ADDR], (unsigned int)sim->registers[TPS55289_IOUT_LIMIT_ADDR]);
+    }
+}
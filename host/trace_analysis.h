@@ -0,0 +1,144 @@
+// Offline analysis of TPS55289 register traces (host only): streaming reader, decoder, statistics and replay
+#ifndef TRACE_ANALYSIS_H
+#define TRACE_ANALYSIS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "TPS55289_sim.h"
+#include "TPS55289_trace.h"
+
+// Part of the file mapped at a time; a multiple of the page size, so records never straddle two windows
+#define TRACE_WINDOW_BYTES              (32u << 20)
+
+// Transaction durations are binned per microsecond up to here; longer ones share the last bin
+#define TRACE_HISTOGRAM_US              4096
+
+/*
+    Trace Event
+
+    One record with its timestamp unwrapped to 64 bits, counted from the first record in the file.
+*/
+typedef struct {
+    uint64_t time;                      // in us
+    uint32_t durationUs;
+    uint32_t dropped;                   // Marker only: records lost at this point
+    uint8_t  channel;
+    uint8_t  address;
+    uint8_t  value;
+    _Bool    read;
+    _Bool    failed;
+    _Bool    marker;
+    _Bool    burst;                     // Next register of the previous record's transaction
+} TRACE_EVENT;
+
+/*
+    Streaming Reader
+
+    Maps TRACE_WINDOW_BYTES of the file at a time and moves on sequentially, so a trace of any size is
+    read with a bounded footprint. Timestamps are unwrapped against the previous record, which holds as
+    long as consecutive records are less than 2^31 us apart; the firmware's anchor markers see to that.
+*/
+typedef struct {
+    int      fd;
+    uint64_t size;
+    uint64_t offset;                    // File offset of the next record
+    const uint8_t *window;
+    uint64_t windowStart;
+    size_t   windowLength;
+    uint32_t busHz;                     // From the file header; 0 if not recorded
+    uint64_t records;
+    uint64_t backwards;                 // Records stamped earlier than the record before them
+    _Bool    truncated;                 // File ends part way through a record
+    _Bool    started;
+    uint32_t lastStamp;
+    int64_t  lastTime;
+    TPS55289_TRACE_RECORD previous;
+} TRACE_READER;
+
+typedef struct {
+    uint64_t transactions;
+    uint64_t failed;
+    uint64_t totalUs;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint32_t histogram[TRACE_HISTOGRAM_US];
+} TRACE_TIMING;
+
+typedef struct {
+    uint64_t records;
+    uint64_t markers;
+    uint64_t dropped;
+    uint64_t firstTime;
+    uint64_t lastTime;
+    TRACE_TIMING timing[2];             // Writes, reads
+    uint64_t registerCount[2][TPS55289_REGISTER_COUNT];
+    uint64_t channelTransactions[TPS55289_TRACE_CHANNELS];
+    uint64_t channelLast[TPS55289_TRACE_CHANNELS];
+    uint64_t channelMaxIdleUs[TPS55289_TRACE_CHANNELS];
+    uint64_t refUpdates[TPS55289_TRACE_CHANNELS];       // Writes reaching REF MSB
+    uint64_t refLast[TPS55289_TRACE_CHANNELS];
+    uint64_t refIntervalTotal[TPS55289_TRACE_CHANNELS];
+    uint64_t refIntervalMin[TPS55289_TRACE_CHANNELS];
+} TRACE_STATS;
+
+/*
+    Replay
+
+    Re-issues the traced transactions against one simulator per channel on the virtual clock, holding
+    the clock to the trace's timeline. Writes are applied; reads are compared with what the device
+    returned. The simulator only vouches for a register once the trace has written or read it, and
+    forgets everything at a gap, so a trace starting mid-run or with drops does not show false
+    mismatches. STATUS also reflects the analog side the simulator does not know, so its differences
+    are counted apart. Transaction durations are compared with the simulator's bus timing: the residual
+    is controller overhead, clock stretching, retries and preemption of the traced task.
+*/
+typedef struct {
+    TPS55289_SIM sim[TPS55289_TRACE_CHANNELS];
+    uint8_t  known[TPS55289_TRACE_CHANNELS];            // Bit per register
+    uint64_t origin;                                    // Virtual time of trace time 0
+    _Bool    started;
+    uint64_t writes;
+    uint64_t reads;
+    uint64_t compared;
+    uint64_t mismatches;
+    uint64_t statusDiffers;
+    uint64_t unverified;                                // Reads of registers not known yet; adopted
+    uint64_t failedSkipped;
+    uint64_t gaps;
+    uint64_t mismatchByRegister[TPS55289_REGISTER_COUNT];
+    TRACE_EVENT firstMismatch;
+    uint8_t  firstMismatchExpected;
+
+    // Transaction being assembled, for the timing residual
+    _Bool    open;
+    _Bool    openRead;
+    uint32_t openCount;
+    uint32_t openDurationUs;
+    uint8_t  openChannel;
+
+    uint64_t residualTransactions[2];
+    int64_t  residualTotalUs[2];
+    int32_t  residualMinUs[2];
+    int32_t  residualMaxUs[2];
+} TRACE_REPLAY;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+int traceReaderOpen(TRACE_READER *reader, const char *path);
+_Bool traceReaderNext(TRACE_READER *reader, TRACE_EVENT *event);
+void traceReaderClose(TRACE_READER *reader);
+int traceDecode(const TRACE_EVENT *event, char *text, size_t size);
+
+void traceStatsInit(TRACE_STATS *stats);
+void traceStatsAdd(TRACE_STATS *stats, const TRACE_EVENT *event);
+uint32_t traceStatsPercentile(const TRACE_TIMING *timing, double fraction);
+void traceStatsPrint(const TRACE_STATS *stats, FILE *output);
+
+void traceReplayInit(TRACE_REPLAY *replay, uint32_t busHz);
+void traceReplayEvent(TRACE_REPLAY *replay, const TRACE_EVENT *event);
+void traceReplayFinish(TRACE_REPLAY *replay);
+void traceReplayPrint(const TRACE_REPLAY *replay, FILE *output);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // TRACE_ANALYSIS_H
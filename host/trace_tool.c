@@ -0,0 +1,65 @@
+// Command line front end for register trace analysis: TraceTool decode|stats|replay trace.bin [busHz]
+//
+// trace.bin is a TPS55289_TRACE_FILE_HEADER followed by the TRACE_READ payloads in the order they were
+// received. decode prints one line per record, stats prints transaction timing and register traffic,
+// replay runs the trace against the simulator. busHz overrides the bus speed in the file header; replay
+// needs one of them to model transfer times and assumes 400 kHz otherwise.
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace_analysis.h"
+
+int main(int argc, char **argv)
+{
+    if ((argc < 3) || (argc > 4)){
+        fprintf(stderr, "usage: %s decode|stats|replay trace.bin [busHz]\n", argv[0]);
+        return 2;
+    }
+    const char *command = argv[1];
+    _Bool decode = (strcmp(command, "decode") == 0);
+    _Bool stats  = (strcmp(command, "stats") == 0);
+    _Bool replay = (strcmp(command, "replay") == 0);
+    if (!decode && !stats && !replay){
+        fprintf(stderr, "%s: unknown command %s\n", argv[0], command);
+        return 2;
+    }
+
+    static TRACE_READER reader;
+    int error = traceReaderOpen(&reader, argv[2]);
+    if (error != 0){
+        fprintf(stderr, "%s: %s\n", argv[2], (error == -EINVAL) ? "not a TPS55289 trace" : strerror(-error));
+        return 1;
+    }
+    uint32_t busHz = (argc == 4) ? (uint32_t)strtoul(argv[3], NULL, 0) : reader.busHz;
+
+    static TRACE_STATS statistics;
+    static TRACE_REPLAY simulation;
+    traceStatsInit(&statistics);
+    traceReplayInit(&simulation, busHz);
+
+    TRACE_EVENT event;
+    char line[160];
+    while (traceReaderNext(&reader, &event)){
+        if (decode){
+            traceDecode(&event, line, sizeof(line));
+            puts(line);
+        } else if (stats){
+            traceStatsAdd(&statistics, &event);
+        } else {
+            traceReplayEvent(&simulation, &event);
+        }
+    }
+    traceReplayFinish(&simulation);
+
+    if (stats){
+        traceStatsPrint(&statistics, stdout);
+    } else if (replay){
+        traceReplayPrint(&simulation, stdout);
+    }
+    fprintf(stderr, "%s: %llu records, %llu out of order%s\n", argv[2], (unsigned long long)reader.records,
+            (unsigned long long)reader.backwards, reader.truncated ? ", last record truncated" : "");
+    traceReaderClose(&reader);
+    return 0;
+}
@@ -40,9 +40,15 @@
  * See http://www.freertos.org/a00110.html
  *----------------------------------------------------------*/
 
+/* USBPD_LOW_POWER (set from CMake) suppresses the tick while every task is blocked and lets
+   power_manager.c clock the MCU down. */
+#ifndef USBPD_LOW_POWER
+#define USBPD_LOW_POWER                         0
+#endif
+
 /* Scheduler Related */
 #define configUSE_PREEMPTION                    1
-#define configUSE_TICKLESS_IDLE                 0
+#define configUSE_TICKLESS_IDLE                 USBPD_LOW_POWER
 #define configUSE_IDLE_HOOK                     0
 #define configUSE_TICK_HOOK                     0
 #define configTICK_RATE_HZ                      ( ( TickType_t ) 1000 )
@@ -69,8 +75,19 @@
 #define configMESSAGE_BUFFER_LENGTH_TYPE        size_t
 
 /* Memory allocation related definitions. */
+/* USBPD_STATIC_ALLOCATION (set from CMake) removes the FreeRTOS heap entirely; every kernel object
+   is allocated at link time. */
+#ifndef USBPD_STATIC_ALLOCATION
+#define USBPD_STATIC_ALLOCATION                 0
+#endif
+
+#if USBPD_STATIC_ALLOCATION
+#define configSUPPORT_STATIC_ALLOCATION         1
+#define configSUPPORT_DYNAMIC_ALLOCATION        0
+#else
 #define configSUPPORT_STATIC_ALLOCATION         0
 #define configSUPPORT_DYNAMIC_ALLOCATION        1
+#endif
 #define configTOTAL_HEAP_SIZE                   (128*1024)
 #define configAPPLICATION_ALLOCATED_HEAP        0
 
@@ -92,7 +109,7 @@
 #define configUSE_TIMERS                        1
 #define configTIMER_TASK_PRIORITY               ( configMAX_PRIORITIES - 1 )
 #define configTIMER_QUEUE_LENGTH                10
-#define configTIMER_TASK_STACK_DEPTH            1024
+#define configTIMER_TASK_STACK_DEPTH            256
 
 /* Interrupt nesting behaviour configuration. */
 /*
@@ -101,6 +118,22 @@
 #define configMAX_API_CALL_INTERRUPT_PRIORITY   [dependent on processor and application]
 */
 
+/* Low power */
+#if USBPD_LOW_POWER
+/* SysTick counts the 1 MHz reference tick instead of the core clock, so tick timing and tickless
+   sleep lengths do not change when clk_sys is switched. */
+#define configSYSTICK_CLOCK_HZ                  1000000
+/* Called on each core as it enters and leaves tickless sleep; the clock only goes down once all
+   configNUM_CORES (POWER_CORES in power_manager.h) are asleep. */
+#define configPRE_SLEEP_PROCESSING( x )         powerManagerPreSleep( &( x ) )
+#define configPOST_SLEEP_PROCESSING( x )        powerManagerPostSleep( &( x ) )
+#ifndef __ASSEMBLER__
+#include <stdint.h>
+void powerManagerPreSleep( uint32_t * expectedIdleTicks );
+void powerManagerPostSleep( uint32_t * expectedIdleTicks );
+#endif
+#endif
+
 /* SMP port only */
 #define configNUM_CORES                         2
 #define configTICK_CORE                         0
@@ -26,7 +26,11 @@ SOFTWARE.
 #define TPS55289_H
 
 
+#include <assert.h>
+#include <stddef.h>
+
 #include "pico/stdlib.h"
+#include "TPS55289_transport.h"
 
 // Register Addresses
 #define TPS55289_REF_VOLTAGE_LSB_ADDR   0x00
@@ -37,6 +41,7 @@ SOFTWARE.
 #define TPS55289_CDC_ADDR               0x05
 #define TPS55289_MODE_ADDR              0x06
 #define TPS55289_STATUS_ADDR            0x07
+#define TPS55289_REGISTER_COUNT         8
 
 // Constants
 #define INTFB_00                        0.2256
@@ -50,19 +55,17 @@ SOFTWARE.
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Structure Definitions
+// Bitfields are declared from bit 0 up, the order GCC allocates them in, so each matches the datasheet
 
 // Structure for REF Register (0x01)
 typedef struct {
     union {
         struct {
-            uint8_t     reserved    : 5;
-            uint16_t    VREF        : 10;
+            uint16_t    VREF        : 11;       // LSB register holds bits 7:0, MSB register bits 10:8
+            uint16_t    reserved    : 5;
         };
         uint16_t regValue_16;  
     };
-    float VOUT;                          // Stores set output voltage in mV
-    float CURRENT_INTFB;                 // Stores currently chosen internal feedback ratio
-
     uint8_t VREF_LSB    : 8;
     uint8_t VREF_MSB    : 8;
 } TPS55289_REF_VOLTAGE_REG;
@@ -71,36 +74,33 @@ typedef struct {
 typedef struct {
     union {
         struct {
-            uint8_t Current_Limit_EN        : 1;
             uint8_t Current_Limit_Setting   : 7;
+            uint8_t Current_Limit_EN        : 1;
         };
         uint8_t regValue;
     };
-    uint32_t currentLimitAmp;
 } TPS55289_IOUT_LIMIT_REG;
 
 // Structure for VOUT_SR Register (0x03) [reset = 0b00000001]
 typedef struct {
     union {
         struct {
-            uint8_t reserved    : 2;
-            uint8_t OCP_DELAY   : 2;
-            uint8_t reserved1   : 2;
             uint8_t SR          : 2;
+            uint8_t reserved1   : 2;
+            uint8_t OCP_DELAY   : 2;
+            uint8_t reserved    : 2;
         };
         uint8_t regValue;
     };
-    float OCResponseTime;
-    float slewRate;
 } TPS55289_VOUT_SR_REG;
 
 // Structure for VOUT_FS Register (0x04) [reset = 0b00000011]
 typedef struct {
     union {
         struct {
-            uint8_t FB          : 1;        // 0 if internal; 1 if external
-            uint8_t reserved    : 5;
             uint8_t INTFB       : 2;        // 00 = 0.2256; 01 = 0.1128; 10 = 0.0752; 11 = 0.0564
+            uint8_t reserved    : 5;
+            uint8_t FB          : 1;        // 0 if internal; 1 if external
         };
         uint8_t regValue;
     };
@@ -112,12 +112,12 @@ typedef struct {
 typedef struct {
     union {
         struct {
-            uint8_t SC_MASK     : 1;        // 0 = disabled; 1 = Enabled; Short Circuit Indication
-            uint8_t OCP_MASK    : 1;        // 0 = disabled; 1 = Enabled; Over-Current Indication
-            uint8_t OVP_MASK    : 1;        // 0 = disabled; 1 = Enabled; Over-Voltage Indication
-            uint8_t reserved    : 1;
-            uint8_t CDC_OPTION  : 1;        // 0 = Internal; 1 = External; CDC Compensation
             uint8_t CDC         : 3;        // Refer to Table 7-9 of datasheet
+            uint8_t CDC_OPTION  : 1;        // 0 = Internal; 1 = External; CDC Compensation
+            uint8_t reserved    : 1;
+            uint8_t OVP_MASK    : 1;        // 0 = disabled; 1 = Enabled; Over-Voltage Indication
+            uint8_t OCP_MASK    : 1;        // 0 = disabled; 1 = Enabled; Over-Current Indication
+            uint8_t SC_MASK     : 1;        // 0 = disabled; 1 = Enabled; Short Circuit Indication
         };
         uint8_t regValue;
     };
@@ -127,13 +127,13 @@ typedef struct {
 typedef struct {
     union {
         struct {
-            uint8_t OE          : 1;        // 0 = Output Disabled; 1 = Output Enabled
-            uint8_t FSWDBL      : 1;        // 0 = Unchanged Freq; 1 = Double Frequency during Buck-Boost Operation
-            uint8_t HICCUP      : 1;        // 0 = Disabled; 1 = Enabled; Hiccup Mode
-            uint8_t DISCHG      : 1;        // 0 = Disabled; 1 = Enabled; VOUT Discharge in Shutdown Mode
-            uint8_t reserved    : 2;
-            uint8_t FPWM        : 1;        // 0 = PFM; 1 = FPWM
             uint8_t reserved1   : 1;
+            uint8_t FPWM        : 1;        // 0 = PFM; 1 = FPWM
+            uint8_t reserved    : 2;
+            uint8_t DISCHG      : 1;        // 0 = Disabled; 1 = Enabled; VOUT Discharge in Shutdown Mode
+            uint8_t HICCUP      : 1;        // 0 = Disabled; 1 = Enabled; Hiccup Mode
+            uint8_t FSWDBL      : 1;        // 0 = Unchanged Freq; 1 = Double Frequency during Buck-Boost Operation
+            uint8_t OE          : 1;        // 0 = Output Disabled; 1 = Output Enabled
         };
         uint8_t regValue;
     };
@@ -143,10 +143,6 @@ typedef struct {
 typedef struct {
     union {
         struct {
-            uint8_t SCP         : 1;        // 0 = No Short Circuit; 1 = Short Circuit Indicator
-            uint8_t OCP         : 1;        // 0 = No Overcurrent; 1 = Overcurrent Indicator
-            uint8_t OVP         : 1;        // 0 = No OVP; 1 = Over Voltage Indicator
-            uint8_t reserved    : 3;
             uint8_t STATUS      : 2;
             /*
                 00 = Boost
@@ -154,34 +150,73 @@ typedef struct {
                 10 = Buck-Boost
                 11 = Reserved
             */
+            uint8_t reserved    : 3;
+            uint8_t OVP         : 1;        // 0 = No OVP; 1 = Over Voltage Indicator
+            uint8_t OCP         : 1;        // 0 = No Overcurrent; 1 = Overcurrent Indicator
+            uint8_t SCP         : 1;        // 0 = No Short Circuit; 1 = Short Circuit Indicator
         };
         uint8_t regValue;
     };
 } TPS55289_STATUS_REG;
 
+// Settings derived from the registers, kept apart from them so the register structures stay byte-sized
+typedef struct {
+    float VOUT;                          // Stores set output voltage in V
+    float CURRENT_INTFB;                 // Stores currently chosen internal feedback ratio
+    float OCResponseTime;                // in milliseconds
+    float slewRate;                      // in mV/us
+    uint32_t currentLimitAmp;
+} TPS55289_SETTINGS;
+
 // TPS55289 Device Info Structure
+// Pointers and derived settings first, then the registers from widest to narrowest, so nothing is padded
 typedef struct {
+    const TPS55289_TRANSPORT   *transport;          // Bus used for this device; i2c0 if left NULL
+    const struct TPS55289_CALIBRATION *calibration; // Per-unit correction tables; nominal conversion if NULL
+    struct TPS55289_OUTPUT     *output;             // Output state machine; enable/disable/VOUT go through it if set
+    struct TPS55289_STATE      *state;              // Snapshot publisher for other tasks; nothing published if NULL
+    TPS55289_SETTINGS           settings;
+
     // Registers
     TPS55289_REF_VOLTAGE_REG    TPS55289_REF_VOLTAGE;
+    TPS55289_VOUT_FS_REG        TPS55289_VOUT_FS;
     TPS55289_IOUT_LIMIT_REG     TPS55289_IOUT_LIMIT;
     TPS55289_VOUT_SR_REG        TPS55289_VOUT_SR;
-    TPS55289_VOUT_FS_REG        TPS55289_VOUT_FS;
     TPS55289_CDC_REG            TPS55289_CDC;
     TPS55289_MODE_REG           TPS55289_MODE;
     TPS55289_STATUS_REG         TPS55289_STATUS;
 
-    uint8_t I2C_ADDRESS;
+    uint8_t I2C_ADDRESS;                            // 7-bit address; TPS55289_I2C_ADDR if left 0
+    uint8_t traceChannel;                           // Trace channel + 1 (TPS55289TraceAttach); not traced if 0
 } TPS55289;
 
+#define TPS55289_DEVICE_BYTES           (4 * sizeof(void *) + sizeof(TPS55289_SETTINGS) + \
+                                         sizeof(TPS55289_REF_VOLTAGE_REG) + sizeof(TPS55289_VOUT_FS_REG) + \
+                                         sizeof(TPS55289_IOUT_LIMIT_REG) + sizeof(TPS55289_VOUT_SR_REG) + \
+                                         sizeof(TPS55289_CDC_REG) + sizeof(TPS55289_MODE_REG) + \
+                                         sizeof(TPS55289_STATUS_REG) + 2)
+static_assert(offsetof(TPS55289, traceChannel) + 1 == TPS55289_DEVICE_BYTES, "TPS55289 carries internal padding");
+static_assert(sizeof(TPS55289) == ((TPS55289_DEVICE_BYTES + sizeof(void *) - 1) & ~(sizeof(void *) - 1)),
+              "TPS55289 is padded beyond its alignment");
+
+extern const uint8_t TPS55289DefaultValues[TPS55289_REGISTER_COUNT];
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Function Declarations
 _Bool TPS55289Init(TPS55289 *device);
-static int setRegister(uint8_t registerAddress, const uint8_t data);
-static int getRegister(uint8_t registerAddress, uint8_t data);
+void TPS55289LoadDefaults(TPS55289 *device);
+const TPS55289_TRANSPORT *TPS55289Transport(TPS55289 *device);
+void TPS55289Lock(TPS55289 *device);
+void TPS55289Unlock(TPS55289 *device);
+_Bool TPS55289WriteRegister(TPS55289 *device, uint8_t registerAddress, uint8_t value);
+_Bool TPS55289ReadRegisters(TPS55289 *device, uint8_t firstAddress, uint8_t *data, size_t count);
 _Bool setOutputVoltage(TPS55289 *device, float voltage);
+uint16_t TPS55289VoltageCode(TPS55289 *device, float voltage);
+_Bool setReferenceCode(TPS55289 *device, uint16_t code);
 _Bool enableOutputCurrentLimit(TPS55289 *device);
 _Bool disableOutputCurrentLimit(TPS55289 *device);
 _Bool setOutputCurrentLimit(TPS55289 *device, float currentLimit);
+_Bool setCurrentLimitSetting(TPS55289 *device, uint8_t setting);
 _Bool setOCPResponseTime(TPS55289 *device, uint8_t OCPResponseTime);
 _Bool setSlewRate(TPS55289 *device, uint8_t slewRate);
 _Bool setFBMechanism(TPS55289 *device, uint8_t FB);
@@ -203,6 +238,8 @@ _Bool enableVOUTDSCHG(TPS55289 *device);
 _Bool disableVOUTDSCHG(TPS55289 *device);
 _Bool FSWOpMode(TPS55289 *device, uint8_t mode);
 _Bool readStatusRegister(TPS55289 *device);
+_Bool operateOnStatusRegister(TPS55289 *device);
+_Bool TPS55289HandleStatus(TPS55289 *device);
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #endif // TPS55289_H
\ No newline at end of file
@@ -0,0 +1,54 @@
+// Per-unit calibration of the TPS55289 output voltage and current limit
+#ifndef TPS55289_CALIBRATION_H
+#define TPS55289_CALIBRATION_H
+
+#include "pico/stdlib.h"
+#include "TPS55289.h"
+
+// Correction Table Geometry
+// Corrections are sampled on a uniform grid of the nominal register code, so lookup is a shift and one
+// interpolation. Values are stored in 1/16 of a register code.
+#define TPS55289_CAL_POINTS             17
+#define TPS55289_CAL_VREF_SHIFT         7           // 2048 REF codes / 16 segments
+#define TPS55289_CAL_ILIM_SHIFT         3           // 128 IOUT_LIMIT settings / 16 segments
+#define TPS55289_CAL_FRAC_BITS          4
+#define TPS55289_CAL_VREF_MAX           0x07FF
+#define TPS55289_CAL_ILIM_MAX           0x7F
+
+#define TPS55289_CAL_MAGIC              0x4C414354  // "TCAL"
+#define TPS55289_CAL_VERSION            1
+
+// Calibration Flags
+#define TPS55289_CAL_VOUT_VALID         0x01
+#define TPS55289_CAL_ILIM_VALID         0x02
+
+// Calibration Record; stored as-is in flash
+typedef struct TPS55289_CALIBRATION {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t  INTFB;                                  // VOUT_FS.INTFB the voltage table was measured with
+    uint8_t  flags;
+    int16_t  voutCorrection[TPS55289_CAL_POINTS];    // REF code correction in 1/16 code
+    int16_t  ilimCorrection[TPS55289_CAL_POINTS];    // IOUT_LIMIT setting correction in 1/16 code
+    uint32_t crc;
+} TPS55289_CALIBRATION;
+
+// Measurement callback for the calibration routines; returns VOUT in mV or IOUT in mA
+typedef uint32_t (*TPS55289_MEASURE)(void *context);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+void TPS55289CalibrationReset(TPS55289_CALIBRATION *calibration);
+uint32_t TPS55289CalibrationCRC(const TPS55289_CALIBRATION *calibration);
+_Bool TPS55289CalibrationValid(const TPS55289_CALIBRATION *calibration);
+uint16_t TPS55289CalibrateVREF(const TPS55289_CALIBRATION *calibration, uint8_t INTFB, uint16_t code);
+uint8_t TPS55289CalibrateILIM(const TPS55289_CALIBRATION *calibration, uint8_t setting);
+_Bool TPS55289CalibrationRunVOUT(TPS55289 *device, TPS55289_CALIBRATION *calibration, TPS55289_MEASURE measureVOUT,
+                                 void *context, uint32_t settleMs);
+_Bool TPS55289CalibrationRunILIM(TPS55289 *device, TPS55289_CALIBRATION *calibration, TPS55289_MEASURE measureIOUT,
+                                 void *context, uint32_t settleMs);
+_Bool TPS55289CalibrationLoad(TPS55289_CALIBRATION *calibration);
+_Bool TPS55289CalibrationSave(TPS55289_CALIBRATION *calibration);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // TPS55289_CALIBRATION_H
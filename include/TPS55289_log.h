@@ -0,0 +1,201 @@
+// Compile-time filtered, deferred logging for the TPS55289 driver
+#ifndef TPS55289_LOG_H
+#define TPS55289_LOG_H
+
+#include "pico/stdlib.h"
+
+// Log Levels
+#define TPS55289_LOG_LEVEL_NONE         0
+#define TPS55289_LOG_LEVEL_ERROR        1
+#define TPS55289_LOG_LEVEL_WARN         2
+#define TPS55289_LOG_LEVEL_INFO         3
+#define TPS55289_LOG_LEVEL_DEBUG        4
+
+// Messages above this level are removed at compile time
+#ifndef TPS55289_LOG_LEVEL
+#define TPS55289_LOG_LEVEL              TPS55289_LOG_LEVEL_INFO
+#endif
+
+// Log Modes
+#define TPS55289_LOG_MODE_PRINTF        0       // Format and print inline at the call site
+#define TPS55289_LOG_MODE_DEFERRED      1       // Record message ID and raw argument; format later in TPS55289LogFlush
+
+#ifndef TPS55289_LOG_MODE
+#define TPS55289_LOG_MODE               TPS55289_LOG_MODE_DEFERRED
+#endif
+
+// Number of records held by the deferred log ring; must be a power of two
+#ifndef TPS55289_LOG_BUFFER_SIZE
+#define TPS55289_LOG_BUFFER_SIZE        64
+#endif
+
+/*
+    Message Table
+
+    X(ID, LEVEL, ARGUMENT, FORMAT)
+        ID          Message identifier; referenced as TPS55289_LOG(ID)
+        LEVEL       ERROR, WARN, INFO or DEBUG
+        ARGUMENT    NONE, U32 (formatted with %u) or F32 (formatted with %f)
+        FORMAT      printf format string, only ever used by the formatter
+*/
+#define TPS55289_LOG_MESSAGES(X) \
+    X(INIT_FAILED,                         ERROR, NONE, "Failed to initialise TPS55289\n") \
+    X(VOUT_INVALID,                        WARN,  NONE, "Requested Output Voltage is invalid\n") \
+    X(DISABLING_OUTPUT,                    DEBUG, NONE, "Disabling Output\n") \
+    X(FAILED_DISABLE_OUTPUT,               ERROR, NONE, "Failed to Disable Output\n") \
+    X(DISABLED_OUTPUT,                     DEBUG, NONE, "Disabled Output\n") \
+    X(VOLTAGE_SET,                         INFO,  F32,  "Voltage Set: %f mV\n") \
+    X(FAILED_SET_REFERENCE,                ERROR, NONE, "Couldn't Set Reference Voltage\n") \
+    X(ENABLING_OUTPUT,                     DEBUG, NONE, "Enabling Output\n") \
+    X(FAILED_ENABLE_OUTPUT,                ERROR, NONE, "Failed to enable Output\n") \
+    X(ENABLED_OUTPUT,                      DEBUG, NONE, "Enabled Output\n") \
+    X(FAILED_ENABLE_CURRENT_LIMIT,         ERROR, NONE, "Couldn't Enable Current Limit\n") \
+    X(ENABLED_OUTPUT_CURRENT_LIMIT,        INFO,  NONE, "Enabled Output Current Limit\n") \
+    X(OUTPUT_CURRENT_LIMIT,                INFO,  F32,  "Output Current Limit: %f A\n") \
+    X(FAILED_DISABLE_CURRENT_LIMIT,        ERROR, NONE, "Couldn't Disable Current Limit\n") \
+    X(DISABLED_OUTPUT_CURRENT_LIMIT,       INFO,  NONE, "Disabled Output Current Limit\n") \
+    X(INVALID_CURRENT_LIMIT_SELECTED,      WARN,  NONE, "Invalid Current Limit Selected\n") \
+    X(CURRENT_LIMIT_RANGE,                 WARN,  NONE, "Current Limit needs to be between 0.0 and 6.35A and is rounded to the nearest 0.05A\n") \
+    X(FAILED_SET_OUTPUT_CURRENT_LIMIT,     ERROR, NONE, "Couldn't Set Ouput Current Limit\n") \
+    X(OUTPUT_CURRENT_LIMIT_SET,            INFO,  NONE, "Output Current Limit Set Succesfully!\n") \
+    X(INVALID_RESPONSE_TIME_SELECTED,      WARN,  NONE, "Invalid Response Time Selected\n") \
+    X(RESPONSE_TIME_RANGE,                 WARN,  NONE, "Valid Response Time inputs are 0x00-0x03\n") \
+    X(FAILED_SET_OCP_RESPONSE_TIME,        ERROR, NONE, "Couldn't Set Overcurrent Protection Response Time\n") \
+    X(INVALID_SLEW_RATES_SELECTED,         WARN,  NONE, "Invalid Slew Rates Selected\n") \
+    X(SLEW_RATE_RANGE,                     WARN,  NONE, "Valid Slew Rate inputs are 0x00-0x03\n") \
+    X(FAILED_SET_OUTPUT_VOLTAGE_SLEW_RATE, ERROR, NONE, "Couldn't Set Output Voltage Slew Rate\n") \
+    X(FB_INTERNAL_SET,                     INFO,  NONE, "Feedback Mechanism set to Internal Feedback\n") \
+    X(FB_EXTERNAL_SET,                     INFO,  NONE, "Feedback Mechanism set to External Feedback\n") \
+    X(FAILED_SET_FB_MECHANISM,             ERROR, NONE, "Couldn't Set Updated Feedback Mechanism\n") \
+    X(INVALID_STEP_SIZE_REQUESTED,         WARN,  NONE, "Invalid Step Size Requested\n") \
+    X(STEP_SIZE_RANGE,                     WARN,  NONE, "Valid Step Sizes are 0x00-0x03\n") \
+    X(STEP_SIZE_SET,                       INFO,  F32,  "Output Voltage Step Size: %.1fmV\n") \
+    X(FAILED_SET_STEP_SIZE,                ERROR, NONE, "Couldn't Update Output Voltage Step Size\n") \
+    X(FAILED_ENABLE_SC_INDICATION,         ERROR, NONE, "Couldn't Enable Short Circuit Indication\n") \
+    X(ENABLED_SC_INDICATION,               INFO,  NONE, "Enabled Short Circuit Indication\n") \
+    X(FAILED_DISABLE_SC_INDICATION,        ERROR, NONE, "Couldn't Disable Short Circuit Indication\n") \
+    X(DISABLED_SC_INDICATION,              INFO,  NONE, "Disabled Short Circuit Indication\n") \
+    X(FAILED_ENABLE_OCP_INDICATION,        ERROR, NONE, "Couldn't Enable OCP Indication\n") \
+    X(ENABLED_OCP_INDICATION,              INFO,  NONE, "Enabled OCP Indication\n") \
+    X(FAILED_DISABLE_OCP_INDICATION,       ERROR, NONE, "Couldn't Disable OCP Indication\n") \
+    X(DISABLED_OCP_INDICATION,             INFO,  NONE, "Disabled OCP Indication\n") \
+    X(FAILED_ENABLE_OVP_INDICATION,        ERROR, NONE, "Couldn't Enable OVP Indication\n") \
+    X(ENABLED_OVP_INDICATION,              INFO,  NONE, "Enabled OVP Indication\n") \
+    X(FAILED_DISABLE_OVP_INDICATION,       ERROR, NONE, "Couldn't Disable OVP Indication\n") \
+    X(DISABLED_OVP_INDICATION,             INFO,  NONE, "Disabled OVP Indication\n") \
+    X(FAILED_SET_CDC_OPTION,               ERROR, NONE, "Couldn't set CDC Option\n") \
+    X(INTERNAL_CDC_COMPENSATION_SET,       INFO,  NONE, "Internal CDC Compensation Set\n") \
+    X(EXTERNAL_CDC_COMPENSATION_SET,       INFO,  NONE, "External CDC Compensation Set\n") \
+    X(INVALID_COMPENSATION_REQUESTED,      WARN,  NONE, "Invalid Compensation Requested\n") \
+    X(CDC_COMP_RANGE,                      WARN,  NONE, "Valid Compensation Presets are 0x00-0x07\n") \
+    X(CDC_COMP_SET,                        INFO,  U32,  "Compensation set at 0.%uV\n") \
+    X(FAILED_SET_CDC_COMPENSATION,         ERROR, NONE, "Couldn't set CDC Compensation\n") \
+    X(FAILED_ENABLE_DEVICE,                ERROR, NONE, "Couldn't Enable Device\n") \
+    X(ENABLED_DEVICE,                      DEBUG, NONE, "Enabled Device\n") \
+    X(FAILED_DISABLE_DEVICE,               ERROR, NONE, "Couldn't Disable Device\n") \
+    X(DISABLED_DEVICE,                     DEBUG, NONE, "Disabled Device\n") \
+    X(FAILED_SET_FSWDBL_MODE,              ERROR, NONE, "Couldn't set FSWDBL Mode\n") \
+    X(FSWDBL_MODE_SET,                     INFO,  NONE, "Set FSWDBL Mode Successfully\n") \
+    X(FAILED_ENABLE_HICCUP_MODE,           ERROR, NONE, "Couldn't Enable Hiccup Mode\n") \
+    X(ENABLED_HICCUP_MODE,                 INFO,  NONE, "Enabled Hiccup Mode\n") \
+    X(FAILED_DISABLE_HICCUP_MODE,          ERROR, NONE, "Couldn't Disable Hiccup Mode\n") \
+    X(DISABLED_HICCUP_MODE,                INFO,  NONE, "Disabled Hiccup Mode\n") \
+    X(FAILED_ENABLE_DISCHARGE_MODE,        ERROR, NONE, "Couldn't Enable Discharge Mode\n") \
+    X(ENABLED_DISCHARGE_MODE,              INFO,  NONE, "Enabled Discharge Mode\n") \
+    X(FAILED_DISABLE_DISCHARGE_MODE,       ERROR, NONE, "Couldn't Disable Discharge Mode\n") \
+    X(DISABLED_DISCHARGE_MODE,             INFO,  NONE, "Disabled Discharge Mode\n") \
+    X(FAILED_SET_LIGHT_LOAD_MODE,          ERROR, NONE, "Couldn't set Light Load Operating Mode\n") \
+    X(LIGHT_LOAD_MODE_SET,                 INFO,  NONE, "Set Light Load Operating Mode Successfully\n") \
+    X(FAILED_READ_STATUS,                  ERROR, NONE, "Failed to read Status Register\n") \
+    X(SHORT_CIRCUIT_DETECTED,              WARN,  NONE, "Short Circuit Condition Detected\n") \
+    X(DISABLED_OUTPUT_VOLTAGE,             WARN,  NONE, "Disabled Output Voltage\n") \
+    X(OVERCURRENT_DETECTED,                WARN,  NONE, "Overcurrent Condition Detected\n") \
+    X(OVERVOLTAGE_DETECTED,                WARN,  NONE, "Overvoltage Condition Detected\n") \
+    X(SOA_VIOLATION_DETECTED,              WARN,  NONE, "SOA Violation Detected\n") \
+    X(CALIBRATION_POINT,                   DEBUG, U32,  "Calibration point measured: %u\n") \
+    X(CALIBRATION_NOT_MONOTONIC,           ERROR, NONE, "Calibration aborted: readback is not monotonic\n") \
+    X(CALIBRATION_LOADED,                  INFO,  NONE, "Calibration loaded from flash\n") \
+    X(CALIBRATION_INVALID,                 WARN,  NONE, "No valid calibration in flash; using nominal conversion\n") \
+    X(CALIBRATION_SAVED,                   INFO,  NONE, "Calibration saved to flash\n") \
+    X(FAILED_SAVE_CALIBRATION,             ERROR, NONE, "Couldn't Save Calibration\n") \
+    X(OVER_TEMPERATURE_DETECTED,           WARN,  NONE, "Over Temperature Condition Detected\n") \
+    X(OUTPUT_STATE,                        DEBUG, U32,  "Output state: %u\n") \
+    X(OUTPUT_EVENT_DROPPED,                WARN,  NONE, "Output event queue full; event dropped\n") \
+    X(FAILED_OUTPUT_TRANSITION,            ERROR, NONE, "Couldn't apply output state registers\n") \
+    X(FAILED_SCRUB_READ,                   ERROR, NONE, "Couldn't read back the register map\n") \
+    X(REGISTER_DRIFT_REPAIRED,             WARN,  U32,  "Register drift repaired, mask 0x%02x\n") \
+    X(DEVICE_RESET_DETECTED,               WARN,  NONE, "Device found at power-on values; registers restored\n") \
+    X(FAILED_REGISTER_REPAIR,              ERROR, NONE, "Couldn't repair drifted register\n") \
+    X(FAILED_TRACKING_WRITE,               ERROR, NONE, "Couldn't write tracking step to a channel\n") \
+    X(TRACKING_SKEW_EXCEEDED,              WARN,  U32,  "Tracking step skew over bound: %u us\n")
+
+typedef enum {
+#define TPS55289_LOG_ID(id, level, argument, format)   TPS55289_MSG_##id,
+    TPS55289_LOG_MESSAGES(TPS55289_LOG_ID)
+#undef TPS55289_LOG_ID
+    TPS55289_MSG_COUNT
+} TPS55289_LOG_MSG;
+
+// Per-message level constants so that filtering folds away at compile time
+enum {
+#define TPS55289_LOG_LVL(id, level, argument, format)  TPS55289_MSG_LEVEL_##id = TPS55289_LOG_LEVEL_##level,
+    TPS55289_LOG_MESSAGES(TPS55289_LOG_LVL)
+#undef TPS55289_LOG_LVL
+};
+
+typedef enum {
+    TPS55289_LOG_ARG_NONE = 0,
+    TPS55289_LOG_ARG_U32,
+    TPS55289_LOG_ARG_F32
+} TPS55289_LOG_ARG;
+
+// Deferred Log Record
+typedef struct {
+    uint32_t timestamp;                  // time_us_32() at the call site
+    uint16_t id;                         // TPS55289_LOG_MSG
+    uint16_t sequence;                   // Wraps; gaps show dropped records
+    uint32_t argument;                   // Raw argument bits (float stored bit-for-bit)
+} TPS55289_LOG_RECORD;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+void TPS55289LogInit(void);
+void TPS55289LogWrite(TPS55289_LOG_MSG id, uint32_t argument);
+void TPS55289LogFormat(TPS55289_LOG_MSG id, uint32_t argument);
+uint32_t TPS55289LogFlush(uint32_t maxRecords);
+uint32_t TPS55289LogDiscard(void);
+uint32_t TPS55289LogDropped(void);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline uint32_t TPS55289LogFloatBits(float value){
+    union { float f; uint32_t u; } bits;
+    bits.f = value;
+    return bits.u;
+}
+
+#if TPS55289_LOG_MODE == TPS55289_LOG_MODE_DEFERRED
+#define TPS55289_LOG_EMIT(id, argument)     TPS55289LogWrite((id), (argument))
+#else
+#define TPS55289_LOG_EMIT(id, argument)     TPS55289LogFormat((id), (argument))
+#endif
+
+// Logging Macros
+#define TPS55289_LOG(id) do { \
+        if (TPS55289_MSG_LEVEL_##id <= TPS55289_LOG_LEVEL) { \
+            TPS55289_LOG_EMIT(TPS55289_MSG_##id, 0); \
+        } \
+    } while (0)
+
+#define TPS55289_LOG_U32(id, value) do { \
+        if (TPS55289_MSG_LEVEL_##id <= TPS55289_LOG_LEVEL) { \
+            TPS55289_LOG_EMIT(TPS55289_MSG_##id, (uint32_t)(value)); \
+        } \
+    } while (0)
+
+#define TPS55289_LOG_F32(id, value) do { \
+        if (TPS55289_MSG_LEVEL_##id <= TPS55289_LOG_LEVEL) { \
+            TPS55289_LOG_EMIT(TPS55289_MSG_##id, TPS55289LogFloatBits((float)(value))); \
+        } \
+    } while (0)
+
+#endif // TPS55289_LOG_H
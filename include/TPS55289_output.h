@@ -0,0 +1,92 @@
+// Output lifecycle state machine for the TPS55289 Buck-Boost Converter
+#ifndef TPS55289_OUTPUT_H
+#define TPS55289_OUTPUT_H
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "TPS55289.h"
+
+#define TPS55289_OUTPUT_QUEUE               16          // Pending events; must be a power of two
+
+// Timing (in us)
+#define TPS55289_OUTPUT_SOFT_START_SR       0x00        // VOUT_SR code used while ramping: 1.25 mV/us
+#define TPS55289_OUTPUT_SOFT_START_MARGIN   1000        // Settling allowance after the computed ramp time
+#define TPS55289_OUTPUT_LIMIT_TIMEOUT       50000       // Current limiting this long is handled like a short
+#define TPS55289_OUTPUT_RETRY_DELAY         100000      // Off time before a hiccup retry
+#define TPS55289_OUTPUT_MAX_RETRIES         3           // Hiccup retries before latching FAULTED
+#define TPS55289_OUTPUT_DISCHARGE_TIME      20000       // DISCHG held on before returning to OFF
+
+typedef enum {
+    TPS55289_OUTPUT_OFF = 0,
+    TPS55289_OUTPUT_SOFT_START,         // Enabled at the soft-start slew rate until VOUT has ramped
+    TPS55289_OUTPUT_REGULATING,
+    TPS55289_OUTPUT_LIMITING,           // OCP flagged: running at the current limit
+    TPS55289_OUTPUT_FAULTED,            // Latched off until CLEAR
+    TPS55289_OUTPUT_HICCUP,             // Off, waiting to retry after a short
+    TPS55289_OUTPUT_DISCHARGE,          // Off with VOUT discharge on
+    TPS55289_OUTPUT_STATES
+} TPS55289_OUTPUT_STATE;
+
+typedef enum {
+    TPS55289_OUTPUT_EVENT_ENABLE = 0,
+    TPS55289_OUTPUT_EVENT_DISABLE,
+    TPS55289_OUTPUT_EVENT_SETPOINT,     // New REF code in pendingCode
+    TPS55289_OUTPUT_EVENT_SOFT_START_DONE,
+    TPS55289_OUTPUT_EVENT_OCP,
+    TPS55289_OUTPUT_EVENT_OCP_CLEAR,
+    TPS55289_OUTPUT_EVENT_LIMIT_TIMEOUT,
+    TPS55289_OUTPUT_EVENT_SCP,
+    TPS55289_OUTPUT_EVENT_FAULT,        // Latching fault: OVP, SOA trip or over temperature
+    TPS55289_OUTPUT_EVENT_RETRY,
+    TPS55289_OUTPUT_EVENT_RETRIES_EXHAUSTED,
+    TPS55289_OUTPUT_EVENT_DISCHARGED,
+    TPS55289_OUTPUT_EVENT_CLEAR,        // Acknowledge a latched fault
+    TPS55289_OUTPUT_EVENTS
+} TPS55289_OUTPUT_EVENT;
+
+typedef struct {
+    uint32_t transitions;               // Events that matched a table entry, including self transitions
+    uint32_t ignored;                   // Events with no entry for the current state
+    uint32_t dropped;                   // Events lost to a full queue
+    uint32_t writes;                    // Register writes issued
+    uint32_t failures;                  // Register writes that failed
+    uint8_t  lastWrites;                // Writes issued by the last transition
+} TPS55289_OUTPUT_STATS;
+
+/*
+    Output State Machine
+
+    Events are queued from any context and applied in order by TPS55289OutputProcess. Every state has a
+    register image (MODE.OE, MODE.DISCHG, VOUT_SR.SR); a transition writes only the registers whose image
+    differs from the driver's cached value, so one MODE write covers both bits and a repeated request
+    writes nothing.
+*/
+typedef struct TPS55289_OUTPUT {
+    uint8_t  state;                     // TPS55289_OUTPUT_STATE
+    uint8_t  userSlewRate;              // VOUT_SR code restored after soft start
+    uint8_t  retries;
+    _Bool    softActive;                // VOUT_SR holds the soft-start rate written by the machine
+    volatile _Bool processing;          // The device lock holder is applying events
+    uint16_t pendingCode;               // REF code carried by the latest SETPOINT
+
+    uint8_t  queue[TPS55289_OUTPUT_QUEUE];
+    uint32_t head;
+    uint32_t tail;
+    spin_lock_t *lock;
+
+    uint64_t deadline;                  // Timer of the current state (soft start, limit, retry, discharge)
+    TPS55289_OUTPUT_STATS stats;
+} TPS55289_OUTPUT;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+void TPS55289OutputInit(TPS55289_OUTPUT *output, TPS55289 *device);
+_Bool TPS55289OutputPost(TPS55289_OUTPUT *output, uint8_t event);
+_Bool TPS55289OutputProcess(TPS55289 *device);
+_Bool TPS55289OutputRequest(TPS55289 *device, uint8_t event);
+_Bool TPS55289OutputSetpoint(TPS55289 *device, uint16_t code);
+_Bool TPS55289OutputStatus(TPS55289 *device, uint8_t status);
+_Bool TPS55289OutputTick(TPS55289 *device);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // TPS55289_OUTPUT_H
@@ -0,0 +1,42 @@
+// PIO I2C master transport for the TPS55289 driver (up to 1 MHz Fm+, DMA-fed)
+#ifndef TPS55289_PIO_I2C_H
+#define TPS55289_PIO_I2C_H
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+
+#include "TPS55289_pio_i2c_encode.h"
+#include "TPS55289_transport.h"
+
+#define PIO_I2C_BAUD_FAST_PLUS          1000000
+#define PIO_I2C_TIMEOUT_MARGIN_US       1000        // Clock stretching allowance on top of twice the stream time
+
+/*
+    PIO I2C Bus
+
+    One state machine and two DMA channels (TX command words, RX bytes). Writes issued with nostop are
+    held in the pending stream and sent together with the following transaction, so a register read
+    (write pointer, repeated START, read) is a single DMA run.
+*/
+typedef struct {
+    PIO      pio;
+    uint     sm;
+    uint     offset;                    // Program offset in instruction memory
+    uint32_t baudrate;
+    int      txChannel;
+    int      rxChannel;
+    PIO_I2C_STREAM stream;              // Pending transactions
+    uint8_t  rx[PIO_I2C_MAX_WORDS];     // One byte per data word
+    uint32_t naks;
+    uint32_t timeouts;
+    recursive_mutex_t lock;             // Shared by every transport on this bus
+} PIO_I2C;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+_Bool pioI2CInit(PIO_I2C *bus, PIO pio, uint sda, uint scl, uint32_t baudrate);
+int pioI2CRun(PIO_I2C *bus, PIO_I2C_STREAM *stream);
+void pioI2CTransportInit(TPS55289_TRANSPORT *transport, PIO_I2C *bus);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // TPS55289_PIO_I2C_H
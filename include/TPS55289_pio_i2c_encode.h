@@ -0,0 +1,63 @@
+// Command stream encoder for the PIO I2C master (TPS55289_pio_i2c.pio)
+#ifndef TPS55289_PIO_I2C_ENCODE_H
+#define TPS55289_PIO_I2C_ENCODE_H
+
+#include "pico/stdlib.h"
+
+/*
+    Command Words
+
+    The state machine pulls one 16-bit word per FIFO entry:
+      | 15:10 count | 9 final | 8:1 data | 0 ack |
+    count == 0  data word: shift data out MSB first, then drive ack. Every data word returns one byte on
+                the RX FIFO (the bits sampled on SDA), so reads and writes are encoded the same way.
+    count == n  the next n + 1 words are PIO instructions executed as-is (START/STOP/repeated START).
+    final       a NAK on this byte is expected and does not halt the state machine (last byte of a read).
+*/
+#define PIO_I2C_WORD_COUNT_SHIFT        10
+#define PIO_I2C_WORD_FINAL              (1u << 9)
+#define PIO_I2C_WORD_DATA_SHIFT         1
+#define PIO_I2C_WORD_ACK_RELEASE        1u          // Release SDA for the ACK slot (writes, read NAK)
+
+// SET instruction with the program's optional side-set on SCL and 7 delay cycles: one quarter SCL period.
+// Levels are line levels; the OE inversion in the pad turns pindirs 1 into a released (high) line.
+#define PIO_I2C_INSTR_SET(scl, sda)     (uint16_t)(0xE000u | (1u << 12) | ((uint16_t)(scl) << 11) | (7u << 8) | \
+                                                   (4u << 5) | (uint16_t)(sda))
+
+// PIO cycles (no clock stretching)
+#define PIO_I2C_CYCLES_PER_BIT          32          // SCL period; the clock divider is set from this
+#define PIO_I2C_CYCLES_PER_BYTE         287         // Word decode + 8 data bits + ACK slot
+#define PIO_I2C_CYCLES_PER_SEQUENCE     4           // Word decode and OSR flush ahead of the instructions
+#define PIO_I2C_CYCLES_PER_INSTRUCTION  10          // out exec + instruction with delay + loop
+
+#define PIO_I2C_MAX_WORDS               128         // Eleven REF bursts per DMA run
+
+/*
+    Command Stream
+
+    One DMA transfer's worth of pre-assembled transactions. claimed tracks whether the last transaction
+    ended without a STOP, so the next one opens with a repeated START.
+*/
+typedef struct {
+    uint16_t words[PIO_I2C_MAX_WORDS];
+    uint16_t count;                     // Words used
+    uint16_t bytes;                     // Data words, i.e. bytes the RX FIFO will return
+    uint16_t readOffset;                // RX byte index of the first byte of the last read
+    uint16_t readLength;
+    _Bool    claimed;                   // Bus held (no STOP yet)
+    _Bool    overflow;                  // A word did not fit; the stream must not be run
+} PIO_I2C_STREAM;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+void pioI2CStreamReset(PIO_I2C_STREAM *stream);
+_Bool pioI2CEncodeStart(PIO_I2C_STREAM *stream);
+_Bool pioI2CEncodeStop(PIO_I2C_STREAM *stream);
+_Bool pioI2CEncodeByte(PIO_I2C_STREAM *stream, uint8_t data);
+_Bool pioI2CEncodeReadByte(PIO_I2C_STREAM *stream, _Bool last);
+_Bool pioI2CEncodeWrite(PIO_I2C_STREAM *stream, uint8_t address, const uint8_t *src, size_t len, _Bool nostop);
+_Bool pioI2CEncodeRead(PIO_I2C_STREAM *stream, uint8_t address, size_t len, _Bool nostop);
+uint32_t pioI2CStreamCycles(const PIO_I2C_STREAM *stream);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // TPS55289_PIO_I2C_ENCODE_H
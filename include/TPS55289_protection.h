@@ -0,0 +1,66 @@
+// Safe Operating Area (SOA) and Over-Temperature Protection for the TPS55289 Buck-Boost Converter
+#ifndef TPS55289_PROTECTION_H
+#define TPS55289_PROTECTION_H
+
+#include "TPS55289.h"
+
+// SOA Table Geometry
+// VIN and VOUT are binned in 2.048V steps so that the bin index is a plain shift of the millivolt value
+#define TPS55289_SOA_BIN_SHIFT              11
+#define TPS55289_SOA_VIN_POINTS             16          // 0V - 30.72V
+#define TPS55289_SOA_VOUT_POINTS            12          // 0V - 22.528V
+#define TPS55289_SOA_MODES                  3           // Indexed by STATUS[7:6]: 00 = Boost; 01 = Buck; 10 = Buck-Boost
+
+// Thermal Derating (temperatures in 0.1 degC)
+#define TPS55289_DERATE_START_TEMP          850         // Full SOA current available below 85.0 degC
+#define TPS55289_SHUTDOWN_TEMP              1250        // Output disabled at 125.0 degC
+#define TPS55289_THERMISTOR_SHIFT           8           // 12-bit ADC code binned in steps of 256 codes
+
+// Current Limit Control (in mA)
+#define TPS55289_CURRENT_LIMIT_STEP         50          // 0.5mV / 10mOhm per IOUT_LIMIT code
+#define TPS55289_CURRENT_LIMIT_MAX          6350
+#define TPS55289_RESTORE_HYSTERESIS         200         // Headroom required before a derated limit is raised again
+#define TPS55289_SOA_TRIP_SAMPLES           3           // Consecutive samples above the SOA limit before tripping
+
+typedef enum {
+    TPS55289_PROTECTION_NONE = 0,       // Operating point inside SOA; nothing to do
+    TPS55289_PROTECTION_DERATE,         // Current limit must be lowered to targetCurrentLimit
+    TPS55289_PROTECTION_RESTORE,        // Current limit can be raised back to targetCurrentLimit
+    TPS55289_PROTECTION_SOA_TRIP,       // IOUT stayed above the SOA limit; output must be disabled
+    TPS55289_PROTECTION_OVERTEMP        // Thermistor above TPS55289_SHUTDOWN_TEMP; output must be disabled
+} TPS55289_PROTECTION_ACTION;
+
+// One control tick worth of measurements
+typedef struct {
+    uint16_t VIN;                        // in mV
+    uint16_t VOUT;                       // in mV
+    uint16_t IOUT;                       // in mA
+    uint16_t thermistor;                 // Raw 12-bit ADC code of the NTC divider
+    _Bool    thermistorValid;            // false if no thermistor is fitted
+} TPS55289_PROTECTION_SAMPLE;
+
+// Protection Engine State
+typedef struct {
+    uint16_t userCurrentLimit;           // Limit requested by the user in mA
+    uint16_t appliedCurrentLimit;        // Limit currently programmed into IOUT_LIMIT in mA
+    uint16_t targetCurrentLimit;         // Limit requested by the last DERATE/RESTORE action in mA
+    uint16_t soaCurrentLimit;            // SOA limit after thermal derating from the last evaluation in mA
+    int16_t  temperature;                // Last thermistor temperature in 0.1 degC
+    uint8_t  overSOASamples;             // Consecutive samples with IOUT above soaCurrentLimit
+
+    uint32_t derateEvents;
+    uint32_t soaTrips;
+    uint32_t overTempTrips;
+} TPS55289_PROTECTION;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+void TPS55289ProtectionInit(TPS55289_PROTECTION *protection, uint16_t userCurrentLimit);
+uint16_t TPS55289SOALimit(uint8_t mode, uint16_t VIN, uint16_t VOUT);
+int16_t TPS55289ThermistorTemperature(uint16_t thermistor);
+uint16_t TPS55289ThermalDerate(uint16_t currentLimit, int16_t temperature);
+TPS55289_PROTECTION_ACTION TPS55289ProtectionEvaluate(TPS55289_PROTECTION *protection, uint8_t mode, const TPS55289_PROTECTION_SAMPLE *sample);
+_Bool TPS55289ProtectionTick(TPS55289 *device, TPS55289_PROTECTION *protection, const TPS55289_PROTECTION_SAMPLE *sample);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // TPS55289_PROTECTION_H
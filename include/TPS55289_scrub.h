@@ -0,0 +1,43 @@
+// Register scrubber for the TPS55289 Buck-Boost Converter: read-back of the register map against the driver cache
+#ifndef TPS55289_SCRUB_H
+#define TPS55289_SCRUB_H
+
+#include "TPS55289.h"
+
+#define TPS55289_SCRUB_REGISTERS            8           // 0x00 - 0x07 in one burst
+#define TPS55289_SCRUB_WRITABLE             7           // STATUS (0x07) is read-only and not repaired
+
+// Scrub period in ticks; stretched while the power manager has clocked down
+#define TPS55289_SCRUB_PERIOD               1000
+#define TPS55289_SCRUB_IDLE_PERIOD          5000
+
+typedef enum {
+    TPS55289_SCRUB_CLEAN = 0,           // Device matched the cache
+    TPS55289_SCRUB_REPAIRED,            // Drifted registers rewritten
+    TPS55289_SCRUB_RESET,               // Device found at its power-on values and restored
+    TPS55289_SCRUB_FAILED               // Read or repair write failed; retried next scrub
+} TPS55289_SCRUB_RESULT;
+
+// Scrubber State
+typedef struct {
+    uint32_t scrubs;
+    uint32_t readFailures;
+    uint32_t repairFailures;
+    uint32_t repairs;                    // Register writes issued to correct drift
+    uint32_t driftEvents;                // Scrubs that found at least one register off
+    uint32_t resets;                     // Scrubs that found the device back at its power-on values
+    uint32_t drift[TPS55289_SCRUB_WRITABLE];     // Mismatches per register address
+    uint8_t  lastRead[TPS55289_SCRUB_REGISTERS];  // Register map as read by the last scrub
+    uint8_t  mask[TPS55289_SCRUB_WRITABLE];       // Defined bits per register; reserved bits are not compared
+} TPS55289_SCRUB;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+void TPS55289ScrubInit(TPS55289_SCRUB *scrub);
+void TPS55289ScrubShadow(const TPS55289 *device, uint8_t *shadow);
+TPS55289_SCRUB_RESULT TPS55289Scrub(TPS55289 *device, TPS55289_SCRUB *scrub);
+void TPS55289ScrubTaskInit(TPS55289 *device);
+void TPS55289ScrubTask(void *param);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // TPS55289_SCRUB_H
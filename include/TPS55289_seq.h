@@ -0,0 +1,120 @@
+// Stackless driver sequences for the TPS55289 Buck-Boost Converter: many operations in flight on one task
+#ifndef TPS55289_SEQ_H
+#define TPS55289_SEQ_H
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "TPS55289.h"
+
+typedef enum {
+    TPS55289_SEQ_IDLE = 0,
+    TPS55289_SEQ_READY,                 // Body runs on the next TPS55289SeqRun
+    TPS55289_SEQ_WAIT_BUS,              // Write or read queued behind another operation on the same bus
+    TPS55289_SEQ_WAIT_LOCK,             // Waiting to own the device's controller
+    TPS55289_SEQ_WAIT_WRITE,            // Split write on the wire
+    TPS55289_SEQ_WAIT_TIME,             // Sleeping until wakeAt
+    TPS55289_SEQ_DONE,
+    TPS55289_SEQ_FAILED
+} TPS55289_SEQ_STATE;
+
+typedef enum {
+    TPS55289_SEQ_WAITING = 0,           // Body returned at a wait point
+    TPS55289_SEQ_ENDED                  // Body ran to its end
+} TPS55289_SEQ_RESULT;
+
+struct TPS55289_SEQ_OP;
+typedef TPS55289_SEQ_RESULT (*TPS55289_SEQ_BODY)(struct TPS55289_SEQ_OP *op);
+
+/*
+    Sequence Operation
+
+    One in-flight driver operation. The body is a protothread: it returns at every wait and is re-entered
+    at the line it left, so anything it needs across a wait lives here rather than on a stack. A few
+    bytes per operation instead of a task stack each.
+*/
+typedef struct TPS55289_SEQ_OP {
+    uint16_t line;                      // Resume point in the body; 0 = start
+    uint8_t  state;                     // TPS55289_SEQ_STATE
+    uint8_t  buffer[2];                 // Register address and value of the write in flight, or of the read
+    uint8_t  read;                      // The queued transfer is a read
+    uint16_t index;                     // Loop counter for the body
+    uint16_t count;
+    uint16_t code;                      // REF code being written
+    int      result;                    // Result of the last write
+    uint64_t wakeAt;
+    float    from;                      // Ramp start and end, in V
+    float    to;
+    uint32_t intervalUs;                // Ramp step period
+    uint32_t startedAt;                 // time_us_32() the write in flight was started, for the trace
+    TPS55289 *device;
+    TPS55289_SEQ_BODY body;
+    struct TPS55289_SEQ_OP *next;
+} TPS55289_SEQ_OP;
+
+typedef struct {
+    TPS55289_SEQ_OP *head;
+    spin_lock_t *lock;                  // Guards the list; operations may be started from any task
+    uint32_t resumes;                   // Body entries
+    uint32_t writes;
+    uint32_t failures;
+    _Bool    lockBusy;                  // Last pass left a step waiting for a controller another task holds
+} TPS55289_SEQ;
+
+/*
+    Protothread Macros
+
+    Only usable in a body, and a body may not use switch across a wait. A wait is the only place a body
+    gives up the CPU; locals do not survive it. A body ends with TPS55289_SEQ_END, or earlier with
+    TPS55289_SEQ_EXIT.
+*/
+#define TPS55289_SEQ_BEGIN(op)          switch ((op)->line) { case 0:
+#define TPS55289_SEQ_YIELD(op)          do { (op)->line = __LINE__; return TPS55289_SEQ_WAITING; case __LINE__:; } while (0)
+#define TPS55289_SEQ_END(op)            } TPS55289_SEQ_EXIT(op, true)
+
+// Leaves the body for good, from anywhere in it
+#define TPS55289_SEQ_EXIT(op, ok) \
+    do { (op)->line = 0; (op)->state = (ok) ? TPS55289_SEQ_DONE : TPS55289_SEQ_FAILED; return TPS55289_SEQ_ENDED; } while (0)
+
+// Register write; resumes once it is on the wire, with the outcome in TPS55289SeqWriteOK
+#define TPS55289_SEQ_WRITE(op, address, value) \
+    do { TPS55289SeqQueueWrite((op), (address), (value)); TPS55289_SEQ_YIELD(op); } while (0)
+
+// Register read; resumes with the value in buffer[1] and the outcome in TPS55289SeqReadOK
+#define TPS55289_SEQ_READ(op, address) \
+    do { TPS55289SeqQueueRead((op), (address)); TPS55289_SEQ_YIELD(op); } while (0)
+
+#define TPS55289_SEQ_SLEEP(op, us) \
+    do { TPS55289SeqQueueSleep((op), (us)); TPS55289_SEQ_YIELD(op); } while (0)
+
+// Takes the device lock once no other operation's write is on the controller; the body releases it
+// with TPS55289Unlock before it ends. Until its next wait the body owns the controller.
+#define TPS55289_SEQ_LOCK(op) \
+    do { TPS55289SeqQueueLock(op); TPS55289_SEQ_YIELD(op); } while (0)
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+void TPS55289SeqInit(TPS55289_SEQ *seq);
+void TPS55289SeqStart(TPS55289_SEQ *seq, TPS55289_SEQ_OP *op, TPS55289 *device, TPS55289_SEQ_BODY body);
+uint32_t TPS55289SeqRun(TPS55289_SEQ *seq);
+_Bool TPS55289SeqNextWake(const TPS55289_SEQ *seq, uint64_t *wakeAt);
+void TPS55289SeqQueueWrite(TPS55289_SEQ_OP *op, uint8_t address, uint8_t value);
+void TPS55289SeqQueueRead(TPS55289_SEQ_OP *op, uint8_t address);
+void TPS55289SeqQueueSleep(TPS55289_SEQ_OP *op, uint32_t us);
+void TPS55289SeqQueueLock(TPS55289_SEQ_OP *op);
+_Bool TPS55289SeqWriteOK(const TPS55289_SEQ_OP *op);
+_Bool TPS55289SeqReadOK(const TPS55289_SEQ_OP *op);
+
+// Sequences
+void TPS55289SeqStartInit(TPS55289_SEQ *seq, TPS55289_SEQ_OP *op, TPS55289 *device);
+void TPS55289SeqStartVoltage(TPS55289_SEQ *seq, TPS55289_SEQ_OP *op, TPS55289 *device, float voltage);
+void TPS55289SeqStartRamp(TPS55289_SEQ *seq, TPS55289_SEQ_OP *op, TPS55289 *device, float voltage,
+                          uint16_t steps, uint32_t intervalUs);
+
+// Task (TPS55289_seq_task.c)
+void TPS55289SeqTaskInit(void);
+void TPS55289SeqTask(void *param);
+TPS55289_SEQ *TPS55289SeqTaskScheduler(void);
+void TPS55289SeqTaskWake(void);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // TPS55289_SEQ_H
@@ -0,0 +1,57 @@
+// Published snapshot of the TPS55289 driver state, readable from any task or core without locking
+#ifndef TPS55289_STATE_H
+#define TPS55289_STATE_H
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "TPS55289.h"
+
+/*
+    Device Snapshot
+
+    Plain copies of the cached setpoints and registers, so readers never touch the driver's bitfield
+    unions. version counts publishes: two snapshots with the same version are identical.
+*/
+typedef struct {
+    float    VOUT;                      // Setpoint in V
+    float    slewRate;                  // in mV/us
+    uint32_t currentLimitAmp;
+    uint16_t refCode;                   // 11-bit REF code
+    uint8_t  currentLimit;              // IOUT_LIMIT
+    uint8_t  voutSR;                    // VOUT_SR
+    uint8_t  voutFS;                    // VOUT_FS
+    uint8_t  cdc;                       // CDC
+    uint8_t  mode;                      // MODE
+    uint8_t  status;                    // STATUS as last read
+    uint32_t version;
+} TPS55289_SNAPSHOT;
+
+#define TPS55289_STATE_WORDS            (sizeof(TPS55289_SNAPSHOT) / sizeof(uint32_t))
+
+/*
+    State Publisher
+
+    A sequence lock: the driver publishes after every register access, under the device lock and a
+    spin lock that only publishers take, and sequence is odd while the words are being rewritten. Readers copy the words and
+    retry if sequence was odd or moved meanwhile; they never block the control task, and with interrupts
+    off during a publish a reader can only spin while the other core is mid-copy.
+*/
+typedef struct TPS55289_STATE {
+    volatile uint32_t sequence;
+    union {
+        TPS55289_SNAPSHOT snapshot;
+        uint32_t words[TPS55289_STATE_WORDS];
+    } data;
+    spin_lock_t *lock;
+    uint32_t publishes;
+} TPS55289_STATE;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+void TPS55289StateInit(TPS55289_STATE *state, TPS55289 *device);
+void TPS55289StatePublish(TPS55289 *device);
+uint32_t TPS55289StateRead(const TPS55289_STATE *state, TPS55289_SNAPSHOT *snapshot);
+void TPS55289Snapshot(TPS55289 *device, TPS55289_SNAPSHOT *snapshot);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // TPS55289_STATE_H
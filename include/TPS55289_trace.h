@@ -0,0 +1,94 @@
+// Register transaction trace for the TPS55289 driver: a compact ring drained to the host for offline replay
+#ifndef TPS55289_TRACE_H
+#define TPS55289_TRACE_H
+
+#include <assert.h>
+
+#include "pico/stdlib.h"
+#include "TPS55289.h"
+
+// Set to 0 to compile the capture out of the driver
+#ifndef TPS55289_TRACE_ENABLED
+#define TPS55289_TRACE_ENABLED          1
+#endif
+
+// Number of records held by the trace ring; must be a power of two
+#ifndef TPS55289_TRACE_BUFFER_SIZE
+#define TPS55289_TRACE_BUFFER_SIZE      256
+#endif
+
+// Record flags
+#define TPS55289_TRACE_REGISTER_MASK    0x07        // Register address
+#define TPS55289_TRACE_READ             0x08        // Clear for a write
+#define TPS55289_TRACE_FAILED           0x10        // Not acknowledged; the value is what was sent, or not valid
+#define TPS55289_TRACE_CHANNEL_SHIFT    5
+#define TPS55289_TRACE_CHANNELS         7           // Channels 0-6; channel 7 marks a marker record
+
+/*
+    Marker Record
+
+    Emitted by TPS55289TraceDrain, never by a transaction: durationUs holds the number of records dropped
+    since the previous drain (0 if none). One is also emitted when nothing has been traced for
+    TPS55289_TRACE_ANCHOR_US, so a reader can unwrap the 32-bit timestamps across idle periods as long as
+    the host drains at least that often.
+*/
+#define TPS55289_TRACE_MARKER           (7 << TPS55289_TRACE_CHANNEL_SHIFT)
+#define TPS55289_TRACE_ANCHOR_US        (1u << 30)
+
+/*
+    Trace Record
+
+    One register of one transaction. A burst (a multi-register write or read) gives one record per
+    register with the same timestamp and duration, in address order.
+*/
+typedef struct {
+    uint32_t timestamp;                 // time_us_32() when the transaction started
+    uint16_t durationUs;                // Start to completion; saturates at 0xFFFF
+    uint8_t  value;                     // Byte written or read
+    uint8_t  flags;                     // Register, direction, failure and channel
+} TPS55289_TRACE_RECORD;
+
+static_assert(sizeof(TPS55289_TRACE_RECORD) == 8, "Trace records are part of the file format");
+
+/*
+    Trace File
+
+    What the host writes: this header, then the TRACE_READ payloads back to back. Little-endian like the
+    RP2040.
+*/
+#define TPS55289_TRACE_MAGIC            0x54353554  // "T55T"
+#define TPS55289_TRACE_VERSION          1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;                // sizeof(TPS55289_TRACE_RECORD)
+    uint32_t busHz;                     // SCL frequency of the traced buses; 0 if unknown
+    uint32_t reserved;
+} TPS55289_TRACE_FILE_HEADER;
+
+static_assert(sizeof(TPS55289_TRACE_FILE_HEADER) == 16, "Trace file header is part of the file format");
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+void TPS55289TraceInit(void);
+void TPS55289TraceAttach(TPS55289 *device, uint8_t channel);
+void TPS55289TraceRecord(const TPS55289 *device, uint8_t flags, uint8_t address, const uint8_t *data,
+                         size_t count, uint32_t startUs);
+uint32_t TPS55289TraceDrain(TPS55289_TRACE_RECORD *records, uint32_t maxRecords);
+uint32_t TPS55289TraceDropped(void);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Capture Macros
+#if TPS55289_TRACE_ENABLED
+#define TPS55289_TRACE_ON_WRITE(device, address, data, count, startUs, ok) \
+    TPS55289TraceRecord((device), (ok) ? 0 : TPS55289_TRACE_FAILED, (address), (data), (count), (startUs))
+#define TPS55289_TRACE_ON_READ(device, address, data, count, startUs, ok) \
+    TPS55289TraceRecord((device), TPS55289_TRACE_READ | ((ok) ? 0 : TPS55289_TRACE_FAILED), (address), (data), \
+                        (count), (startUs))
+#else
+#define TPS55289_TRACE_ON_WRITE(device, address, data, count, startUs, ok)  ((void)(startUs))
+#define TPS55289_TRACE_ON_READ(device, address, data, count, startUs, ok)   ((void)(startUs))
+#endif
+
+#endif // TPS55289_TRACE_H
@@ -0,0 +1,64 @@
+// Multi-channel tracking for TPS55289 Buck-Boost Converters: rails ramped together, REF writes issued in parallel
+#ifndef TPS55289_TRACKING_H
+#define TPS55289_TRACKING_H
+
+#include "pico/stdlib.h"
+#include "TPS55289.h"
+
+#define TPS55289_TRACKING_CHANNELS          4
+#define TPS55289_TRACKING_TIMEOUT           2000        // Per step, in us; a 3-byte write at 100kHz takes ~400us
+#define TPS55289_TRACKING_LOCK_RETRY        50          // in us; wait before retrying a busy controller
+
+typedef enum {
+    TPS55289_TRACKING_COINCIDENT = 0,   // Every rail moves by the same voltage per step until it reaches its target
+    TPS55289_TRACKING_RATIOMETRIC       // Every rail covers the same fraction of its ramp per step
+} TPS55289_TRACKING_MODE;
+
+typedef struct {
+    TPS55289 *device;
+    float    start;                     // VOUT at TPS55289TrackingStart, in V
+    float    target;                    // in V
+    uint16_t code;                      // REF code of the current step
+    uint8_t  buffer[3];                 // REF LSB address, LSB, MSB: one burst per step
+    uint8_t  state;                     // TPS55289_TRACKING_IDLE/QUEUED/PENDING/DONE/FAILED
+    uint64_t doneAt;                    // Time the step's write was seen complete
+    uint32_t startedAt;                 // time_us_32() the step's write was started, for the trace
+} TPS55289_TRACKING_CHANNEL;
+
+typedef struct {
+    uint32_t steps;
+    uint32_t lastSkewUs;                // Spread of write completions over the channels in the last step
+    uint32_t maxSkewUs;
+    uint64_t totalSkewUs;
+    uint32_t overBound;                 // Steps whose skew exceeded skewBoundUs
+    uint32_t failures;                  // Channel writes that failed or timed out
+} TPS55289_TRACKING_STATS;
+
+/*
+    Tracking Coordinator
+
+    One step computes the REF code of every channel first, then starts all the writes before waiting on
+    any of them, so channels on separate I2C controllers change within a few bus clocks of each other.
+    Channels sharing a controller, or on a transport that can only block, are written one after another
+    and show up in the measured skew.
+*/
+typedef struct {
+    TPS55289_TRACKING_CHANNEL channel[TPS55289_TRACKING_CHANNELS];
+    uint32_t channels;
+    uint8_t  mode;                      // TPS55289_TRACKING_MODE
+    uint32_t skewBoundUs;
+    uint32_t step;
+    uint32_t totalSteps;
+    TPS55289_TRACKING_STATS stats;
+} TPS55289_TRACKING;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+void TPS55289TrackingInit(TPS55289_TRACKING *tracking, TPS55289_TRACKING_MODE mode, uint32_t skewBoundUs);
+_Bool TPS55289TrackingAdd(TPS55289_TRACKING *tracking, TPS55289 *device);
+_Bool TPS55289TrackingStart(TPS55289_TRACKING *tracking, const float *targets, uint32_t steps);
+_Bool TPS55289TrackingStep(TPS55289_TRACKING *tracking);
+_Bool TPS55289TrackingDone(const TPS55289_TRACKING *tracking);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // TPS55289_TRACKING_H
@@ -0,0 +1,60 @@
+// Bus transport used by the TPS55289 driver
+#ifndef TPS55289_TRANSPORT_H
+#define TPS55289_TRANSPORT_H
+
+#include "pico/stdlib.h"
+#include "pico/mutex.h"
+
+/*
+    Transport Structure
+
+    Mirrors the blocking i2c_write_blocking/i2c_read_blocking contract so the hardware controller can be
+    used directly: returns the number of bytes transferred, or a negative PICO_ERROR_* code if the address
+    was not acknowledged. nostop keeps the bus claimed for a repeated start.
+
+    writeStart/writePoll are optional (NULL if the bus can only block): writeStart queues a complete write
+    and returns at once, writePoll returns 0 while it is on the wire and then the write's result. Lets the
+    tracking coordinator keep several controllers busy at the same time.
+
+    lock serialises the tasks sharing the controller (NULL if only one task ever uses it). It is held for
+    one register access, for a split write from its start until the poll that completes it, and for a
+    whole tracking step; it is recursive, so a holder may still make ordinary register accesses.
+*/
+typedef struct {
+    int  (*write)(void *context, uint8_t address, const uint8_t *src, size_t len, _Bool nostop);
+    int  (*read)(void *context, uint8_t address, uint8_t *dst, size_t len, _Bool nostop);
+    void *context;
+    int  (*writeStart)(void *context, uint8_t address, const uint8_t *src, size_t len);
+    int  (*writePoll)(void *context);
+    recursive_mutex_t *lock;
+} TPS55289_TRANSPORT;
+
+static inline void TPS55289TransportLock(const TPS55289_TRANSPORT *transport){
+    if (transport->lock != NULL){
+        recursive_mutex_enter_blocking(transport->lock);
+    }
+}
+
+// For callers that must not block, such as the sequence scheduler
+static inline _Bool TPS55289TransportTryLock(const TPS55289_TRANSPORT *transport){
+    return (transport->lock == NULL) || recursive_mutex_try_enter(transport->lock, NULL);
+}
+
+static inline void TPS55289TransportUnlock(const TPS55289_TRANSPORT *transport){
+    if (transport->lock != NULL){
+        recursive_mutex_exit(transport->lock);
+    }
+}
+
+// Hardware I2C controllers (TPS55289_i2c.c on target; unconnected buses on the host)
+extern const TPS55289_TRANSPORT TPS55289_I2C0_TRANSPORT;
+extern const TPS55289_TRANSPORT TPS55289_I2C1_TRANSPORT;
+
+// Creates the controller locks; call before any task that uses the hardware transports is started
+void TPS55289I2CInit(void);
+
+// Run from interrupt context when a split write on a hardware controller finishes
+typedef void (*TPS55289_I2C_COMPLETION)(void);
+void TPS55289I2CSetCompletionCallback(TPS55289_I2C_COMPLETION callback);
+
+#endif // TPS55289_TRANSPORT_H
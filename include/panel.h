@@ -0,0 +1,150 @@
+// Front panel: live readout on an SPI display and setpoint editing from a rotary encoder
+#ifndef PANEL_H
+#define PANEL_H
+
+#include "pico/stdlib.h"
+#include "TPS55289.h"
+
+// Display geometry (ST7789 240x135 in landscape)
+#define PANEL_WIDTH                     240
+#define PANEL_HEIGHT                    135
+
+#define PANEL_FONT_WIDTH                6           // 5x8 glyph + 1 column spacing, before scaling
+#define PANEL_FONT_HEIGHT               8
+#define PANEL_MAX_TEXT                  12
+
+// Render buffers: two strips so one can be filled while DMA sends the other
+#define PANEL_STRIP_PIXELS              2048        // 4 KiB each
+
+// Encoder: quadrature transitions per detent
+#define PANEL_ENCODER_STEPS             4
+
+// RGB565
+#define PANEL_RGB(r, g, b)              (uint16_t)((((r) & 0xF8) << 8) | (((g) & 0xFC) << 3) | ((b) >> 3))
+#define PANEL_BLACK                     PANEL_RGB(0, 0, 0)
+#define PANEL_WHITE                     PANEL_RGB(255, 255, 255)
+#define PANEL_GREY                      PANEL_RGB(96, 96, 96)
+#define PANEL_GREEN                     PANEL_RGB(0, 220, 0)
+#define PANEL_RED                       PANEL_RGB(255, 32, 32)
+#define PANEL_AMBER                     PANEL_RGB(255, 176, 0)
+#define PANEL_CYAN                      PANEL_RGB(0, 200, 255)
+
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+} PANEL_RECT;
+
+/*
+    Display Backend
+
+    blit sends a rectangle of row-major RGB565 pixels and may return before the transfer has finished;
+    the renderer calls wait before it reuses that buffer. ST7789 over DMA SPI on the target
+    (panel_st7789.c), a framebuffer in memory on the host.
+*/
+typedef struct {
+    _Bool (*blit)(void *context, const PANEL_RECT *rect, const uint16_t *pixels);
+    void  (*wait)(void *context);
+    void  *context;
+} PANEL_DISPLAY;
+
+// Setpoint being edited with the encoder
+typedef enum {
+    PANEL_SELECT_NONE = 0,
+    PANEL_SELECT_VOUT,
+    PANEL_SELECT_ILIM,
+    PANEL_SELECT_OUTPUT,
+    PANEL_SELECTS
+} PANEL_SELECT;
+
+// PANEL_READING.valid
+#define PANEL_VALID_VIN                 0x01
+#define PANEL_VALID_VOUT                0x02
+#define PANEL_VALID_IOUT                0x04
+#define PANEL_VALID_STATUS              0x08
+
+// What the panel shows; measurements without their valid bit are drawn as dashes
+typedef struct {
+    uint16_t VIN;                       // in mV
+    uint16_t VOUT;                      // in mV
+    uint16_t IOUT;                      // in mA
+    uint16_t setVOUT;                   // in mV
+    uint16_t setILIM;                   // in mA
+    uint8_t  status;                    // STATUS register
+    uint8_t  output;                    // Output enabled
+    uint8_t  selected;                  // PANEL_SELECT
+    uint8_t  valid;                     // PANEL_VALID_*
+} PANEL_READING;
+
+// Platform measurement hook: fills VIN/VOUT/IOUT and sets their valid bits
+typedef void (*PANEL_SAMPLE)(void *context, PANEL_READING *reading);
+
+typedef enum {
+    PANEL_FIELD_VOUT = 0,
+    PANEL_FIELD_MODE,
+    PANEL_FIELD_OUTPUT,
+    PANEL_FIELD_IOUT,
+    PANEL_FIELD_POWER,
+    PANEL_FIELD_VIN,
+    PANEL_FIELD_ILIM,
+    PANEL_FIELD_SET,
+    PANEL_FIELD_FAULT,
+    PANEL_FIELDS
+} PANEL_FIELD;
+
+// Text and colours of one field as last drawn
+typedef struct {
+    char     text[PANEL_MAX_TEXT + 1];
+    uint16_t fg;
+    uint16_t bg;
+} PANEL_CELL;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t blits;
+    uint32_t pixels;                    // Pixels sent to the display
+} PANEL_STATS;
+
+/*
+    Panel State
+
+    shown is what the display holds; damage[] is one rectangle per field plus the background, recorded
+    by panelUpdate and drained by panelRender. A field whose colours are unchanged is only damaged over
+    the character cells whose text changed, so a ticking last digit costs one glyph.
+*/
+typedef struct {
+    PANEL_CELL shown[PANEL_FIELDS];
+    PANEL_RECT damage[PANEL_FIELDS + 1];
+    uint32_t   damaged;                 // Bit per damage[] entry; bit PANEL_FIELDS is the background
+    uint16_t   strip[2][PANEL_STRIP_PIXELS];
+    PANEL_STATS stats;
+} PANEL;
+
+// Quadrature decoder state; panelEncoderEdge runs in the GPIO interrupt
+typedef struct {
+    uint8_t  state;                     // Last A/B sample
+    int8_t   steps;                     // Transitions towards the next detent
+    volatile int32_t detents;           // Running count, written by the interrupt only
+    int32_t  taken;                     // detents already returned by panelEncoderTake
+} PANEL_ENCODER;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+void panelInit(PANEL *panel);
+void panelInvalidate(PANEL *panel);
+void panelUpdate(PANEL *panel, const PANEL_READING *reading);
+_Bool panelRender(PANEL *panel, const PANEL_DISPLAY *display);
+void panelEncoderInit(PANEL_ENCODER *encoder, _Bool a, _Bool b);
+void panelEncoderEdge(PANEL_ENCODER *encoder, _Bool a, _Bool b);
+int32_t panelEncoderTake(PANEL_ENCODER *encoder);
+
+// ST7789 backend (panel_st7789.c)
+_Bool panelST7789Init(PANEL_DISPLAY *display);
+
+// Task (panel_task.c)
+void panelTaskInit(TPS55289 *device, PANEL_SAMPLE sample, void *context);
+void panelTask(void *param);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // PANEL_H
@@ -1,4 +1,20 @@
+#ifndef PINDEFINITIONS_H
+#define PINDEFINITIONS_H
+
 #define LED_PIN 25
 
 #define GPIO_ON     1
-#define GPIO_OFF    0
\ No newline at end of file
+#define GPIO_OFF    0
+
+// Front panel: ST7789 on SPI0, rotary encoder with push button
+#define PANEL_SPI               spi0
+#define PANEL_PIN_DC            16
+#define PANEL_PIN_CS            17
+#define PANEL_PIN_SCK           18
+#define PANEL_PIN_MOSI          19
+#define PANEL_PIN_BACKLIGHT     20
+#define PANEL_PIN_ENC_A         10
+#define PANEL_PIN_ENC_B         11
+#define PANEL_PIN_ENC_BUTTON    12
+
+#endif // PINDEFINITIONS_H
@@ -0,0 +1,73 @@
+// Idle power management: MCU clock-down and TPS55289 PFM/FPWM selection
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include "pico/stdlib.h"
+#include "TPS55289.h"
+
+// MCU Idle Policy
+#define POWER_IDLE_HOLDOFF_US           200000      // Quiet time after the last command before clocking down
+#define POWER_CORES                     2           // configNUM_CORES; all of them must be asleep to clock down
+
+// Converter Light-Load Policy (IOUT in mA)
+// Needs an IOUT measurement per powerConverterUpdate. No ADC is wired up on target yet, so the firmware
+// never calls it and the converter stays in FPWM; only the host power simulation exercises the policy.
+#define POWER_PFM_ENTER_CURRENT         300         // Below this for POWER_PFM_ENTER_SAMPLES: switch to PFM
+#define POWER_PFM_EXIT_CURRENT          500         // Above this on any sample: back to FPWM
+#define POWER_PFM_ENTER_SAMPLES         5
+
+// Pending work that keeps the MCU at full clock
+#define POWER_PENDING_COMMAND           0x01
+#define POWER_PENDING_FAULT             0x02
+
+typedef enum {
+    POWER_CLOCK_FULL = 0,
+    POWER_CLOCK_LOW,
+    POWER_CLOCKS
+} POWER_CLOCK;
+
+typedef enum {
+    POWER_MODE_PFM = 0,                 // Matches the FSWOpMode argument
+    POWER_MODE_FPWM,
+    POWER_MODES
+} POWER_MODE;
+
+// Platform hook that switches the system clock; NULL on the host
+typedef void (*POWER_SET_CLOCK)(POWER_CLOCK clock);
+
+typedef struct {
+    uint64_t residency[POWER_CLOCKS];   // in us
+    uint32_t clockSwitches;
+    uint32_t wakeups;                   // Returns from tickless sleep
+    uint64_t since;                     // Start of the statistics window
+} POWER_MANAGER_STATS;
+
+// Light-load state of one converter
+typedef struct {
+    uint8_t  mode;                      // POWER_MODE
+    uint8_t  lightLoadSamples;          // Consecutive samples below POWER_PFM_ENTER_CURRENT
+    uint32_t switches;
+    uint64_t residency[POWER_MODES];    // in us
+    uint64_t lastUpdate;
+} POWER_CONVERTER;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+void powerManagerInit(POWER_SET_CLOCK setClock);
+void powerManagerActivity(void);
+void powerManagerSetPending(uint32_t pending);
+void powerManagerClearPending(uint32_t pending);
+_Bool powerManagerEvaluate(void);
+_Bool powerManagerIsIdle(void);
+void powerManagerPreSleep(uint32_t *expectedIdleTicks);
+void powerManagerPostSleep(uint32_t *expectedIdleTicks);
+const POWER_MANAGER_STATS *powerManagerStats(void);
+_Bool powerConverterInit(POWER_CONVERTER *converter, TPS55289 *device);
+_Bool powerConverterUpdate(POWER_CONVERTER *converter, TPS55289 *device, uint16_t IOUT);
+
+// Platform (power_rp2040.c)
+void powerPlatformInit(void);
+void powerPlatformSetClock(POWER_CLOCK clock);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,43 @@
+// Static allocation helpers for FreeRTOS objects
+#ifndef RTOS_STATIC_H
+#define RTOS_STATIC_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/*
+    With USBPD_STATIC_ALLOCATION every task and queue gets its storage from .bss at link time, so the
+    memory report sees it and nothing is allocated at runtime. Without it the same calls fall back to
+    the FreeRTOS heap.
+*/
+#if USBPD_STATIC_ALLOCATION
+#define RTOS_TASK_MEMORY(name, depth) \
+    static StackType_t name##Stack[depth]; \
+    static StaticTask_t name##TCB
+#define RTOS_TASK_STACK(name)               (name##Stack)
+#define RTOS_TASK_TCB(name)                 (&name##TCB)
+
+#define RTOS_QUEUE_MEMORY(name, length, itemSize) \
+    static uint8_t name##Storage[(length) * (itemSize)]; \
+    static StaticQueue_t name##Queue
+#define RTOS_QUEUE_STORAGE(name)            (name##Storage)
+#define RTOS_QUEUE_BUFFER(name)             (&name##Queue)
+#else
+#define RTOS_TASK_MEMORY(name, depth)
+#define RTOS_TASK_STACK(name)               NULL
+#define RTOS_TASK_TCB(name)                 NULL
+
+#define RTOS_QUEUE_MEMORY(name, length, itemSize)
+#define RTOS_QUEUE_STORAGE(name)            NULL
+#define RTOS_QUEUE_BUFFER(name)             NULL
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+TaskHandle_t rtosCreateTask(TaskFunction_t function, const char *name, uint32_t stackDepth, void *param,
+                            UBaseType_t priority, StackType_t *stack, StaticTask_t *tcb);
+QueueHandle_t rtosCreateQueue(UBaseType_t length, UBaseType_t itemSize, uint8_t *storage, StaticQueue_t *buffer);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // RTOS_STATIC_H
@@ -0,0 +1,118 @@
+// Bytecode interpreter for uploaded DUT power sequence scripts
+#ifndef SCRIPT_VM_H
+#define SCRIPT_VM_H
+
+#include "pico/stdlib.h"
+#include "TPS55289.h"
+
+#define SCRIPT_VM_MAX_PROGRAM           1024        // Bytes of bytecode
+#define SCRIPT_VM_REGISTERS             8
+#define SCRIPT_VM_RESULTS               8
+#define SCRIPT_VM_SLICE                 256         // Instructions per scriptVmStep before yielding
+
+/*
+    Instruction Set
+
+    One opcode byte followed by fixed operands, little-endian. r = register index, rel = signed byte
+    offset from the end of the instruction. Every program is validated once by scriptVmStart, so the
+    interpreter never re-checks operands or jump targets.
+
+    WAIT advances a deadline on the hardware timer rather than sleeping from "now": step timing follows
+    the script, not the latency of whatever woke the interpreter.
+*/
+typedef enum {
+    SCRIPT_OP_END       = 0x00,         //                          stop, passed
+    SCRIPT_OP_FAIL      = 0x01,         // code8                    stop, failed with code
+    SCRIPT_OP_WAIT      = 0x02,         // us32                     deadline += us, sleep until deadline
+    SCRIPT_OP_SYNC      = 0x03,         //                          deadline = now
+    SCRIPT_OP_VOUT      = 0x10,         // mV16                     setOutputVoltage
+    SCRIPT_OP_VOUT_R    = 0x11,         // r                        setOutputVoltage, mV in r
+    SCRIPT_OP_ILIM      = 0x12,         // mA16                     setOutputCurrentLimit
+    SCRIPT_OP_ILIM_R    = 0x13,         // r                        setOutputCurrentLimit, mA in r
+    SCRIPT_OP_OUTPUT    = 0x14,         // on8                      enableDevice / disableDevice
+    SCRIPT_OP_MEASURE   = 0x20,         // r ch8                    r = SCRIPT_CHANNEL reading
+    SCRIPT_OP_LOAD      = 0x30,         // r i32                    r = i32
+    SCRIPT_OP_ADD       = 0x31,         // r i32                    r += i32
+    SCRIPT_OP_MOV       = 0x32,         // r r2                     r = r2
+    SCRIPT_OP_SUB       = 0x33,         // r r2                     r -= r2
+    SCRIPT_OP_JMP       = 0x40,         // rel16
+    SCRIPT_OP_DJNZ      = 0x41,         // r rel16                  if (--r != 0) jump
+    SCRIPT_OP_JLT       = 0x42,         // r i32 rel16              if (r < i32) jump
+    SCRIPT_OP_JGT       = 0x43,         // r i32 rel16              if (r > i32) jump
+    SCRIPT_OP_JSET      = 0x44,         // mask8 rel16              read STATUS; if (STATUS & mask) jump
+    SCRIPT_OP_JCLR      = 0x45,         // mask8 rel16              read STATUS; if !(STATUS & mask) jump
+    SCRIPT_OP_REPORT    = 0x50          // slot8 r                  results[slot] = r
+} SCRIPT_OPCODE;
+
+typedef enum {
+    SCRIPT_CHANNEL_VIN = 0,             // mV
+    SCRIPT_CHANNEL_VOUT,                // mV
+    SCRIPT_CHANNEL_IOUT,                // mA
+    SCRIPT_CHANNEL_STATUS,              // STATUS register
+    SCRIPT_CHANNELS
+} SCRIPT_CHANNEL;
+
+typedef enum {
+    SCRIPT_STATE_IDLE = 0,              // Nothing loaded or not started
+    SCRIPT_STATE_RUNNING,               // Instructions left in this slice; call scriptVmStep again
+    SCRIPT_STATE_WAITING,               // Sleeping until wakeAt
+    SCRIPT_STATE_DONE,                  // END reached
+    SCRIPT_STATE_ERROR                  // See error
+} SCRIPT_STATE;
+
+typedef enum {
+    SCRIPT_ERROR_NONE = 0,
+    SCRIPT_ERROR_BAD_OPCODE,
+    SCRIPT_ERROR_BAD_OPERAND,           // Register, slot or channel out of range
+    SCRIPT_ERROR_BAD_JUMP,              // Target outside the program or inside an instruction
+    SCRIPT_ERROR_TOO_LARGE,
+    SCRIPT_ERROR_DEVICE,                // Driver call failed
+    SCRIPT_ERROR_MEASURE,               // No measurement for the channel
+    SCRIPT_ERROR_FAILED,                // FAIL executed; see failCode
+    SCRIPT_ERROR_STOPPED                // Stopped by the host
+} SCRIPT_ERROR;
+
+// Platform measurement; returns false if the channel cannot be measured
+typedef _Bool (*SCRIPT_MEASURE)(void *context, uint8_t channel, int32_t *value);
+
+typedef struct {
+    uint8_t  program[SCRIPT_VM_MAX_PROGRAM];
+    uint16_t length;
+    uint16_t pc;
+    int32_t  registers[SCRIPT_VM_REGISTERS];
+    int32_t  results[SCRIPT_VM_RESULTS];
+
+    volatile uint8_t state;             // SCRIPT_STATE
+    uint8_t  error;                     // SCRIPT_ERROR
+    uint8_t  failCode;
+    volatile _Bool stopRequest;
+
+    uint64_t deadline;                  // Schedule time base advanced by WAIT
+    uint64_t wakeAt;                    // Valid in SCRIPT_STATE_WAITING
+    uint64_t started;
+    uint64_t finished;
+    uint32_t instructions;
+    uint32_t overruns;                  // WAITs whose deadline had already passed
+
+    TPS55289 *device;
+    SCRIPT_MEASURE measure;             // NULL: STATUS from the driver, other channels unavailable
+    void     *context;
+} SCRIPT_VM;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+void scriptVmInit(SCRIPT_VM *vm, TPS55289 *device, SCRIPT_MEASURE measure, void *context);
+_Bool scriptVmLoad(SCRIPT_VM *vm, uint16_t offset, const uint8_t *data, uint16_t length);
+SCRIPT_ERROR scriptVmValidate(const uint8_t *program, uint16_t length);
+_Bool scriptVmStart(SCRIPT_VM *vm);
+void scriptVmStop(SCRIPT_VM *vm);
+SCRIPT_STATE scriptVmStep(SCRIPT_VM *vm);
+_Bool scriptVmBusy(const SCRIPT_VM *vm);
+
+// Task (script_task.c)
+void scriptTaskInit(TPS55289 *device);
+void scriptTask(void *param);
+void scriptTaskWake(void);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SCRIPT_VM_H
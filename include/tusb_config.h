@@ -0,0 +1,24 @@
+// TinyUSB configuration: composite device with a CDC console and a vendor bulk control interface
+#ifndef TUSB_CONFIG_H
+#define TUSB_CONFIG_H
+
+// CFG_TUSB_MCU and CFG_TUSB_OS are set by the pico SDK
+#define CFG_TUSB_RHPORT0_MODE           OPT_MODE_DEVICE
+
+#define CFG_TUD_ENDPOINT0_SIZE          64
+
+// Console (stdio)
+#define CFG_TUD_CDC                     1
+#define CFG_TUD_CDC_RX_BUFSIZE          64
+#define CFG_TUD_CDC_TX_BUFSIZE          256
+#define CFG_TUD_CDC_EP_BUFSIZE          64
+
+// The vendor interface is served by the application class driver in usb_device.c, which hands the
+// protocol's frame buffers to the endpoints directly instead of going through TinyUSB's vendor FIFOs
+#define CFG_TUD_VENDOR                  0
+
+#define CFG_TUD_MSC                     0
+#define CFG_TUD_HID                     0
+#define CFG_TUD_MIDI                    0
+
+#endif // TUSB_CONFIG_H
@@ -0,0 +1,33 @@
+// Composite USB device: CDC console and vendor bulk control interface
+#ifndef USB_DEVICE_H
+#define USB_DEVICE_H
+
+#include "pico/stdlib.h"
+#include "TPS55289.h"
+
+// Placeholder IDs from the TinyUSB example range; replace with an allocated VID/PID for production
+#define USB_DEVICE_VID                  0xCAFE
+#define USB_DEVICE_PID                  0x4055
+#define USB_DEVICE_BCD                  0x0100
+
+// Interface and endpoint numbers
+#define USB_ITF_CDC                     0       // CDC uses two interfaces
+#define USB_ITF_VENDOR                  2
+#define USB_ITF_COUNT                   3
+
+#define USB_EP_CDC_NOTIFY               0x81
+#define USB_EP_CDC_OUT                  0x02
+#define USB_EP_CDC_IN                   0x82
+#define USB_EP_VENDOR_OUT               0x03
+#define USB_EP_VENDOR_IN                0x83
+
+#define USB_FS_PACKET_SIZE              64
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+void usbDeviceInit(TPS55289 *device);
+void usbDeviceTask(void *param);
+void usbDeviceWake(void);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // USB_DEVICE_H
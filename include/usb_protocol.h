@@ -0,0 +1,124 @@
+// Framed command and telemetry protocol carried on the vendor bulk interface
+#ifndef USB_PROTOCOL_H
+#define USB_PROTOCOL_H
+
+#include "pico/stdlib.h"
+#include "TPS55289.h"
+#include "TPS55289_trace.h"
+#include "script_vm.h"
+
+#define USB_PROTOCOL_VERSION            1
+#define USB_PROTOCOL_SYNC               0xA5
+
+// Frame Geometry
+// A frame is one bulk transfer of at most 8 full-speed packets; a frame whose length is a multiple of
+// 64 bytes and shorter than USB_PROTOCOL_FRAME_SIZE is terminated with a zero-length packet.
+#define USB_PROTOCOL_FRAME_SIZE         512
+#define USB_PROTOCOL_HEADER_SIZE        8
+#define USB_PROTOCOL_MAX_PAYLOAD        (USB_PROTOCOL_FRAME_SIZE - USB_PROTOCOL_HEADER_SIZE)
+
+// Frame buffers shared by OUT transfers, responses and telemetry; at most 32
+#ifndef USB_PROTOCOL_BUFFERS
+#define USB_PROTOCOL_BUFFERS            6
+#endif
+
+#define USB_PROTOCOL_RESPONSE           0x80        // Set in the command byte of every device to host frame
+
+typedef enum {
+    USB_CMD_PING        = 0x01,         // -> USB_PING_PAYLOAD
+    USB_CMD_ECHO        = 0x02,         // Any payload; returned unchanged
+    USB_CMD_GET_STATUS  = 0x10,         // -> USB_STATUS_PAYLOAD
+    USB_CMD_SET_VOUT    = 0x11,         // uint32_t mV
+    USB_CMD_SET_ILIM    = 0x12,         // uint32_t mA
+    USB_CMD_OUTPUT      = 0x13,         // uint8_t 0 = disable; 1 = enable
+    USB_CMD_TELEMETRY   = 0x20,         // Device to host only; payload is USB_TELEMETRY_SAMPLE[]
+    USB_CMD_TRACE_READ  = 0x21,         // -> TPS55289_TRACE_RECORD[], oldest first; empty when nothing is pending
+    USB_CMD_SCRIPT_LOAD = 0x30,         // uint16_t offset + bytecode chunk; offset 0 starts a new program
+    USB_CMD_SCRIPT_RUN  = 0x31,         // Validates and starts the loaded program
+    USB_CMD_SCRIPT_STOP = 0x32,
+    USB_CMD_SCRIPT_STATUS = 0x33        // -> USB_SCRIPT_STATUS_PAYLOAD
+} USB_PROTOCOL_COMMAND;
+
+typedef enum {
+    USB_STATUS_OK = 0,
+    USB_STATUS_BAD_FRAME,               // Sync byte or length field does not match the transfer
+    USB_STATUS_UNKNOWN_COMMAND,
+    USB_STATUS_BAD_LENGTH,              // Payload length wrong for the command
+    USB_STATUS_NO_DEVICE,               // No TPS55289 attached to the protocol
+    USB_STATUS_DEVICE_ERROR,            // Driver call failed
+    USB_STATUS_NO_SCRIPT,               // No script interpreter attached
+    USB_STATUS_BUSY,                    // A script is running
+    USB_STATUS_SCRIPT_ERROR             // Program rejected; SCRIPT_STATUS has the SCRIPT_ERROR
+} USB_PROTOCOL_STATUS;
+
+// Frame Header; little-endian like the RP2040
+typedef struct __attribute__((packed)) {
+    uint8_t  sync;                      // USB_PROTOCOL_SYNC
+    uint8_t  command;                   // USB_PROTOCOL_COMMAND, | USB_PROTOCOL_RESPONSE in replies
+    uint16_t sequence;                  // Copied into the reply; counts up on telemetry frames
+    uint16_t length;                    // Payload bytes after the header
+    uint8_t  status;                    // USB_PROTOCOL_STATUS in replies; 0 in requests
+    uint8_t  reserved;
+} USB_PROTOCOL_HEADER;
+
+typedef struct __attribute__((packed)) {
+    uint16_t version;                   // USB_PROTOCOL_VERSION
+    uint16_t frameSize;                 // USB_PROTOCOL_FRAME_SIZE
+} USB_PING_PAYLOAD;
+
+typedef struct __attribute__((packed)) {
+    uint16_t refCode;                   // Programmed REF code
+    uint8_t  status;                    // STATUS register
+    uint8_t  mode;                      // MODE register
+    uint8_t  currentLimit;              // IOUT_LIMIT register
+    uint8_t  reserved;
+} USB_STATUS_PAYLOAD;
+
+typedef struct __attribute__((packed)) {
+    uint8_t  state;                     // SCRIPT_STATE
+    uint8_t  error;                     // SCRIPT_ERROR
+    uint8_t  failCode;                  // Operand of the FAIL that ended the script
+    uint8_t  reserved;
+    uint16_t pc;
+    uint16_t length;                    // Loaded program size
+    uint32_t instructions;
+    uint32_t overruns;
+    uint32_t elapsedUs;                 // Start to finish, or to now while running
+    int32_t  results[SCRIPT_VM_RESULTS];
+} USB_SCRIPT_STATUS_PAYLOAD;
+
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp;                 // time_us_32
+    uint16_t VIN;                       // in mV
+    uint16_t VOUT;                      // in mV
+    uint16_t IOUT;                      // in mA
+    uint8_t  status;                    // STATUS register
+    uint8_t  flags;
+} USB_TELEMETRY_SAMPLE;
+
+#define USB_TELEMETRY_SAMPLES_PER_FRAME (USB_PROTOCOL_MAX_PAYLOAD / sizeof(USB_TELEMETRY_SAMPLE))
+#define USB_TRACE_RECORDS_PER_FRAME     (USB_PROTOCOL_MAX_PAYLOAD / sizeof(TPS55289_TRACE_RECORD))
+
+typedef struct {
+    uint32_t rxFrames;
+    uint32_t txFrames;
+    uint32_t badFrames;
+    uint32_t noBuffer;                  // Acquire failed; an OUT transfer or telemetry frame was not started
+    uint32_t telemetrySamples;
+    uint32_t telemetryDropped;
+} USB_PROTOCOL_STATS;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function Declarations
+void usbProtocolInit(TPS55289 *device);
+void usbProtocolSetScript(SCRIPT_VM *vm, void (*wake)(void));
+uint8_t *usbProtocolAcquire(void);
+void usbProtocolRelease(uint8_t *frame);
+void usbProtocolReceive(uint8_t *frame, uint32_t length);
+uint8_t *usbProtocolNextTx(uint32_t *length);
+_Bool usbProtocolTelemetry(const USB_TELEMETRY_SAMPLE *sample);
+void usbProtocolTelemetryFlush(void);
+const USB_PROTOCOL_STATS *usbProtocolStats(void);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // USB_PROTOCOL_H
@@ -1,13 +1,36 @@
 // Adding this to test Git
 #include "pico/stdlib.h"
 // #include "pico/binary_info.h"
-// #include "/home/swaroop/pico/pico-sdk/src/rp2_common/hardware_i2c/include/hardware/i2c.h"
-#include "../../pico-sdk/src/rp2_common/hardware_i2c/include/hardware/i2c.h"
 
 #include "TPS55289.h"
+#include "TPS55289_log.h"
+#include "TPS55289_calibration.h"
+#include "TPS55289_output.h"
+#include "TPS55289_state.h"
+#include "TPS55289_trace.h"
 #include "math.h"
 #include <stdio.h>
 
+// Register access; other modules go through TPS55289WriteRegister / TPS55289ReadRegisters
+static int setRegister(TPS55289 *device, uint8_t registerAddress, const uint8_t data);
+static int getRegister(TPS55289 *device, uint8_t registerAddress, uint8_t *data);
+static int getRegisters(TPS55289 *device, uint8_t firstAddress, uint8_t *data, size_t count);
+
+// Register values written by TPS55289Init, indexed by address; STATUS holds its power-on value
+const uint8_t TPS55289DefaultValues[TPS55289_REGISTER_COUNT] = {
+    0b00000000,         // REF_VOLTAGE LSB
+    0b00000000,         // REF_VOLTAGE MSB
+    0b11100100,         // IOUT_LIMIT
+    0b00000001,         // VOUT_SR
+    0b10000011,         // VOUT_FS
+    0b11100000,         // CDC
+    0b00100000,         // MODE
+    0b00000011,         // STATUS
+};
+
+// Internal feedback ratio, indexed by VOUT_FS.INTFB
+static const float feedbackRatios[4] = { INTFB_00, INTFB_01, INTFB_10, INTFB_11 };
+
 /*
     Initialisation Function
 */ 
@@ -16,74 +39,73 @@
 _Bool TPS55289Init(TPS55289 *device){
     _Bool STATUS = true;
     
-    uint8_t TPS55289_REF_VOLTAGE_LSB_DEFVAL = 0b00000000;
-    uint8_t TPS55289_REF_VOLTAGE_MSB_DEFVAL = 0b00000000;
-    uint8_t TPS55289_IOUT_LIMIT_DEFVAL      = 0b11100100;
-    uint8_t TPS55289_VOUT_SR_DEFVAL         = 0b00000001;
-    uint8_t TPS55289_VOUT_FS_DEFVAL         = 0b10000011;
-    uint8_t TPS55289_CDC_DEFVAL             = 0b11100000;
-    uint8_t TPS55289_MODE_DEFVAL            = 0b00100000;    
-    uint8_t TPS55289_STATUS_DEFVAL          = 0b00000011;
+    uint8_t TPS55289_REF_VOLTAGE_LSB_DEFVAL = TPS55289DefaultValues[TPS55289_REF_VOLTAGE_LSB_ADDR];
+    uint8_t TPS55289_REF_VOLTAGE_MSB_DEFVAL = TPS55289DefaultValues[TPS55289_REF_VOLTAGE_MSB_ADDR];
+    uint8_t TPS55289_IOUT_LIMIT_DEFVAL      = TPS55289DefaultValues[TPS55289_IOUT_LIMIT_ADDR];
+    uint8_t TPS55289_VOUT_SR_DEFVAL         = TPS55289DefaultValues[TPS55289_VOUT_SR_ADDR];
+    uint8_t TPS55289_VOUT_FS_DEFVAL         = TPS55289DefaultValues[TPS55289_VOUT_FS_ADDR];
+    uint8_t TPS55289_CDC_DEFVAL             = TPS55289DefaultValues[TPS55289_CDC_ADDR];
+    uint8_t TPS55289_MODE_DEFVAL            = TPS55289DefaultValues[TPS55289_MODE_ADDR];
+
+    if(device->I2C_ADDRESS == 0){
+        device->I2C_ADDRESS = TPS55289_I2C_ADDR;
+    }
     
     if(!disableDevice(device)){
-        printf("Failed to initialise TPS55289\n");
+        TPS55289_LOG(INIT_FAILED);
         STATUS = false;
         return STATUS;
     }
 
     // Set Register Structures to default values
-    device->TPS55289_REF_VOLTAGE.regValue_16    = (TPS55289_REF_VOLTAGE_MSB_DEFVAL << 8)|(TPS55289_REF_VOLTAGE_LSB_DEFVAL);
-    device->TPS55289_IOUT_LIMIT.regValue        = TPS55289_IOUT_LIMIT_DEFVAL;
-    device->TPS55289_VOUT_SR.regValue           = TPS55289_VOUT_SR_DEFVAL;
-    device->TPS55289_VOUT_FS.regValue           = TPS55289_VOUT_FS_DEFVAL;
-    device->TPS55289_CDC.regValue               = TPS55289_CDC_DEFVAL;
-    device->TPS55289_MODE.regValue              = TPS55289_MODE_DEFVAL;
-    device->TPS55289_STATUS.regValue            = TPS55289_STATUS_DEFVAL;
+    TPS55289Lock(device);
+    TPS55289LoadDefaults(device);
+    TPS55289Unlock(device);
 
     // Update Registers in the device
-    if(setRegister(TPS55289_REF_VOLTAGE_LSB_ADDR,TPS55289_REF_VOLTAGE_LSB_DEFVAL) != 1){
-        printf("Failed to initialise TPS55289\n");
+    if(setRegister(device, TPS55289_REF_VOLTAGE_LSB_ADDR,TPS55289_REF_VOLTAGE_LSB_DEFVAL) != 1){
+        TPS55289_LOG(INIT_FAILED);
         STATUS = false;
         return STATUS;
     }
-    if(setRegister(TPS55289_REF_VOLTAGE_MSB_ADDR,TPS55289_REF_VOLTAGE_MSB_DEFVAL) != 1){
-        printf("Failed to initialise TPS55289\n");
+    if(setRegister(device, TPS55289_REF_VOLTAGE_MSB_ADDR,TPS55289_REF_VOLTAGE_MSB_DEFVAL) != 1){
+        TPS55289_LOG(INIT_FAILED);
         STATUS = false;
         return STATUS;
     }
-    if(setRegister(TPS55289_IOUT_LIMIT_ADDR,TPS55289_IOUT_LIMIT_DEFVAL) != 1){
-        printf("Failed to initialise TPS55289\n");
+    if(setRegister(device, TPS55289_IOUT_LIMIT_ADDR,TPS55289_IOUT_LIMIT_DEFVAL) != 1){
+        TPS55289_LOG(INIT_FAILED);
         STATUS = false;
         return STATUS;
     }
-    if(setRegister(TPS55289_VOUT_SR_ADDR,TPS55289_VOUT_SR_DEFVAL) != 1){
-        printf("Failed to initialise TPS55289\n");
+    if(setRegister(device, TPS55289_VOUT_SR_ADDR,TPS55289_VOUT_SR_DEFVAL) != 1){
+        TPS55289_LOG(INIT_FAILED);
         STATUS = false;
         return STATUS;
     }
-    if(setRegister(TPS55289_VOUT_FS_ADDR,TPS55289_VOUT_FS_DEFVAL) != 1){
-        printf("Failed to initialise TPS55289\n");
+    if(setRegister(device, TPS55289_VOUT_FS_ADDR,TPS55289_VOUT_FS_DEFVAL) != 1){
+        TPS55289_LOG(INIT_FAILED);
         STATUS = false;
         return STATUS;
     }
-    if(setRegister(TPS55289_CDC_ADDR,TPS55289_CDC_DEFVAL) != 1){
-        printf("Failed to initialise TPS55289\n");
+    if(setRegister(device, TPS55289_CDC_ADDR,TPS55289_CDC_DEFVAL) != 1){
+        TPS55289_LOG(INIT_FAILED);
         STATUS = false;
         return STATUS;
     }
-    if(setRegister(TPS55289_MODE_ADDR,TPS55289_MODE_DEFVAL) != 1){
-        printf("Failed to initialise TPS55289\n");
+    if(setRegister(device, TPS55289_MODE_ADDR,TPS55289_MODE_DEFVAL) != 1){
+        TPS55289_LOG(INIT_FAILED);
         STATUS = false;
         return STATUS;
     }
-    if(setRegister(TPS55289_CDC_ADDR,TPS55289_CDC_DEFVAL) != 1){
-        printf("Failed to initialise TPS55289\n");
+    if(setRegister(device, TPS55289_CDC_ADDR,TPS55289_CDC_DEFVAL) != 1){
+        TPS55289_LOG(INIT_FAILED);
         STATUS = false;
         return STATUS;
     }
     // Enable Device after setting all registers with default values
     if(!enableDevice(device)){
-        printf("Failed to initialise TPS55289\n");
+        TPS55289_LOG(INIT_FAILED);
         STATUS = false;
         return STATUS;
     }
@@ -92,24 +114,118 @@ _Bool TPS55289Init(TPS55289 *device){
     return STATUS;
 }
 
+/*
+    Default Register Structures
+    Sets the cached registers to the values TPS55289Init writes, and the feedback ratio to match, without
+    touching the device
+*/
+void TPS55289LoadDefaults(TPS55289 *device){
+    device->TPS55289_REF_VOLTAGE.regValue_16    = (TPS55289DefaultValues[TPS55289_REF_VOLTAGE_MSB_ADDR] << 8)|
+                                                  (TPS55289DefaultValues[TPS55289_REF_VOLTAGE_LSB_ADDR]);
+    device->TPS55289_IOUT_LIMIT.regValue        = TPS55289DefaultValues[TPS55289_IOUT_LIMIT_ADDR];
+    device->TPS55289_VOUT_SR.regValue           = TPS55289DefaultValues[TPS55289_VOUT_SR_ADDR];
+    device->TPS55289_VOUT_FS.regValue           = TPS55289DefaultValues[TPS55289_VOUT_FS_ADDR];
+    device->TPS55289_CDC.regValue               = TPS55289DefaultValues[TPS55289_CDC_ADDR];
+    device->TPS55289_MODE.regValue              = TPS55289DefaultValues[TPS55289_MODE_ADDR];
+    device->TPS55289_STATUS.regValue            = TPS55289DefaultValues[TPS55289_STATUS_ADDR];
+    device->settings.CURRENT_INTFB              = feedbackRatios[device->TPS55289_VOUT_FS.INTFB];
+}
+
+/*
+    Transport Selection
+    Devices without an explicit transport talk to the TPS55289 on i2c0
+*/
+static const TPS55289_TRANSPORT *getTransport(TPS55289 *device) {
+    return (device->transport != NULL) ? device->transport : &TPS55289_I2C0_TRANSPORT;
+}
+
+const TPS55289_TRANSPORT *TPS55289Transport(TPS55289 *device){
+    return getTransport(device);
+}
+
+/*
+    Device Lock
+
+    The lock of the device's controller. Every register access takes it on its own; hold it across
+    several accesses that other tasks must not come between, such as a scrub pass.
+*/
+void TPS55289Lock(TPS55289 *device){
+    TPS55289TransportLock(getTransport(device));
+}
+
+void TPS55289Unlock(TPS55289 *device){
+    TPS55289TransportUnlock(getTransport(device));
+}
+
 /*
     Set Register Function
+    Writes under the controller lock; returns 1 if the register was written. The cache has been updated
+    by then, so it is published here
 */
-static int setRegister(uint8_t registerAddress, const uint8_t data) {
+static int setRegister(TPS55289 *device, uint8_t registerAddress, const uint8_t data) {
+    const TPS55289_TRANSPORT *transport = getTransport(device);
     uint8_t buffer[2];
     buffer[0] = registerAddress;
     buffer[1] = data;
 
-    return i2c_write_blocking(i2c0, TPS55289_I2C_ADDR, &buffer[0], 2, false);
+    TPS55289TransportLock(transport);
+    uint32_t started = time_us_32();
+    int written = (transport->write(transport->context, device->I2C_ADDRESS, &buffer[0], 2, false) == 2) ? 1 : 0;
+    TPS55289_TRACE_ON_WRITE(device, registerAddress, &buffer[1], 1, started, written == 1);
+    TPS55289StatePublish(device);
+    TPS55289TransportUnlock(transport);
+    return written;
 }
 /*
     Get Register Function
+    Returns 1 if the register was read into data; the read and its publish share one hold of the lock
 */
-static int getRegister(uint8_t registerAddress, uint8_t data) {
-    if (i2c_write_blocking(i2c0, TPS55289_I2C_ADDR, &registerAddress, 1, false) != 1) {
-        return false; // Error writing register address
-    }
-    return i2c_read_blocking(i2c0, TPS55289_I2C_ADDR, &data, 1, false);
+static int getRegister(TPS55289 *device, uint8_t registerAddress, uint8_t *data) {
+    TPS55289Lock(device);
+    int read = (getRegisters(device, registerAddress, data, 1) == 1) ? 1 : 0;
+    TPS55289StatePublish(device);
+    TPS55289Unlock(device);
+    return read;
+}
+
+/*
+    Burst Read
+    Reads count consecutive registers in one transaction (the register pointer auto-increments). The
+    pointer write and the read share one hold of the controller lock. Returns the number of bytes read
+*/
+static int getRegisters(TPS55289 *device, uint8_t firstAddress, uint8_t *data, size_t count) {
+    const TPS55289_TRANSPORT *transport = getTransport(device);
+    TPS55289TransportLock(transport);
+    uint32_t started = time_us_32();
+    if (transport->write(transport->context, device->I2C_ADDRESS, &firstAddress, 1, true) != 1) {
+        TPS55289_TRACE_ON_READ(device, firstAddress, data, count, started, false);
+        TPS55289TransportUnlock(transport);
+        return 0; // Error writing register address
+    }
+    int read = transport->read(transport->context, device->I2C_ADDRESS, data, count, false);
+    TPS55289_TRACE_ON_READ(device, firstAddress, data, count, started, read == (int)count);
+    TPS55289TransportUnlock(transport);
+    return (read > 0) ? read : 0;
+}
+
+/*
+    Raw Register Write
+
+    Writes one register without touching the cached register structures; the caller keeps them in step.
+    Used by the output state machine, which compares against the cache before writing.
+*/
+_Bool TPS55289WriteRegister(TPS55289 *device, uint8_t registerAddress, uint8_t value){
+    return setRegister(device, registerAddress, value) == 1;
+}
+
+/*
+    Raw Register Read
+
+    Reads count registers from firstAddress in one burst into data, leaving the cached register
+    structures alone. Used by the register scrubber to compare the device against the cache.
+*/
+_Bool TPS55289ReadRegisters(TPS55289 *device, uint8_t firstAddress, uint8_t *data, size_t count){
+    return getRegisters(device, firstAddress, data, count) == (int)count;
 }
 
 _Bool setOutputVoltage(TPS55289 *device, float voltage){
@@ -117,163 +233,248 @@ _Bool setOutputVoltage(TPS55289 *device, float voltage){
     // Check if the voltage requested is valid
     if (((voltage >= 0.8) && (voltage <= 22)) == 0)
     {
-        printf("Requested Output Voltage is invalid");
+        TPS55289_LOG(VOUT_INVALID);
         STATUS = false;
         return STATUS;
     }
+    TPS55289Lock(device);
+    device->settings.VOUT = voltage;
+    uint16_t code = TPS55289VoltageCode(device, voltage);
+
+    // With the state machine attached the output stays up and only the changed REF bytes are written
+    if(device->output != NULL){
+        STATUS = TPS55289OutputSetpoint(device, code);
+        if(STATUS){
+            TPS55289_LOG_F32(VOLTAGE_SET, voltage);
+        }
+        TPS55289Unlock(device);
+        return STATUS;
+    }
+
     // Disabling the output before changing parameters
-    printf("Disabling Output\n");
+    TPS55289_LOG(DISABLING_OUTPUT);
     if(disableDevice(device) != true){
-        printf("Failed to Disable Output\n");
+        TPS55289_LOG(FAILED_DISABLE_OUTPUT);
         STATUS = false;
+        TPS55289Unlock(device);
         return STATUS;
     }
-    printf("Disabled Output\n");
-    device->TPS55289_REF_VOLTAGE.VOUT = voltage;
-    float referenceVoltage = voltage*device->TPS55289_REF_VOLTAGE.CURRENT_INTFB; // in Volts
-    device->TPS55289_REF_VOLTAGE.regValue_16 = (uint16_t)(1.7715*((referenceVoltage*1000) - 45)+1); // Each step is 0.5645mV. 0x000 starts at 45mV
+    TPS55289_LOG(DISABLED_OUTPUT);
+
+    if(setReferenceCode(device, code) != true){
+        STATUS = false;
+        TPS55289Unlock(device);
+        return STATUS;
+    }
+
+    TPS55289_LOG_F32(VOLTAGE_SET, voltage);
+    TPS55289_LOG(ENABLING_OUTPUT);
+    if(enableDevice(device) != true){
+        TPS55289_LOG(FAILED_ENABLE_OUTPUT);
+        STATUS = false;
+        TPS55289Unlock(device);
+        return STATUS;
+    }
+    TPS55289_LOG(ENABLED_OUTPUT);
+
+    TPS55289Unlock(device);
+    return STATUS;
+}
+
+/*
+    Voltage to Reference Code
+
+    11-bit REF code for an output voltage at the present feedback ratio, through the calibration tables
+    when loaded. No range check; voltages below the 45mV REF floor give code 0.
+*/
+uint16_t TPS55289VoltageCode(TPS55289 *device, float voltage){
+    float referenceVoltage = voltage*device->settings.CURRENT_INTFB; // in Volts
+    if((referenceVoltage*1000) < 45){
+        referenceVoltage = 0.045;
+    }
+    uint16_t code = (uint16_t)(1.7715*((referenceVoltage*1000) - 45)+1); // Each step is 0.5645mV. 0x000 starts at 45mV
+    if(device->calibration != NULL){
+        code = TPS55289CalibrateVREF(device->calibration, device->TPS55289_VOUT_FS.INTFB, code);
+    }
+    return code;
+}
+
+/*
+    Raw Reference Code
+
+    Writes an 11-bit REF code as-is, without the range check, calibration or output toggle of
+    setOutputVoltage. Used by setOutputVoltage and by the calibration sweep.
+*/
+_Bool setReferenceCode(TPS55289 *device, uint16_t code){
+    _Bool STATUS = true;
+    TPS55289Lock(device);
+    device->TPS55289_REF_VOLTAGE.regValue_16 = code;
 
     // Update local register values with new reference voltage
     device->TPS55289_REF_VOLTAGE.VREF_LSB = device->TPS55289_REF_VOLTAGE.regValue_16 & 0xFF;
     device->TPS55289_REF_VOLTAGE.VREF_MSB = (device->TPS55289_REF_VOLTAGE.regValue_16>>8) & 0xFF;
 
     // Update registers on device
-    if(setRegister(TPS55289_REF_VOLTAGE_LSB_ADDR, (device->TPS55289_REF_VOLTAGE.VREF_LSB)) != 1){
+    if(setRegister(device, TPS55289_REF_VOLTAGE_LSB_ADDR, (device->TPS55289_REF_VOLTAGE.VREF_LSB)) != 1){
+        TPS55289_LOG(FAILED_SET_REFERENCE);
         STATUS = false;
-        return false;
+        TPS55289Unlock(device);
+        return STATUS;
     }
-    if(setRegister(TPS55289_REF_VOLTAGE_MSB_ADDR, device->TPS55289_REF_VOLTAGE.VREF_MSB) != 1){
-        STATUS = false;
-        return false;
-    }
-
-    printf("Voltage Set: %f mV\n", voltage);
-    printf("Enabling Output\n");
-    if(enableDevice(device) != true){
-        printf("Failed to enable Output\n");
+    if(setRegister(device, TPS55289_REF_VOLTAGE_MSB_ADDR, device->TPS55289_REF_VOLTAGE.VREF_MSB) != 1){
+        TPS55289_LOG(FAILED_SET_REFERENCE);
         STATUS = false;
+        TPS55289Unlock(device);
         return STATUS;
     }
-    printf("Enabled Output\n");
-
+    TPS55289Unlock(device);
     return STATUS;
 }
 
 _Bool enableOutputCurrentLimit(TPS55289 *device){
     _Bool STATUS = true;
     device->TPS55289_IOUT_LIMIT.Current_Limit_EN = 0b1;
-    if (setRegister(TPS55289_IOUT_LIMIT_ADDR,device->TPS55289_IOUT_LIMIT.regValue) != 1)
+    if (setRegister(device, TPS55289_IOUT_LIMIT_ADDR,device->TPS55289_IOUT_LIMIT.regValue) != 1)
     {
-        printf("Couldn't Enable Current Limit\n");
+        TPS55289_LOG(FAILED_ENABLE_CURRENT_LIMIT);
         STATUS = false;
         return STATUS;
     }
-    printf("Enabled Output Current Limit\n");
-    printf("Output Current Limit = %u A", device->TPS55289_IOUT_LIMIT.currentLimitAmp);   
+    TPS55289_LOG(ENABLED_OUTPUT_CURRENT_LIMIT);
+    TPS55289_LOG_F32(OUTPUT_CURRENT_LIMIT, device->settings.currentLimitAmp);   
     return STATUS;
 }
 
 _Bool disableOutputCurrentLimit(TPS55289 *device){
     _Bool STATUS = true;
     device->TPS55289_IOUT_LIMIT.Current_Limit_EN = 0b0;
-    if (setRegister(TPS55289_IOUT_LIMIT_ADDR,device->TPS55289_IOUT_LIMIT.regValue) != 1)
+    if (setRegister(device, TPS55289_IOUT_LIMIT_ADDR,device->TPS55289_IOUT_LIMIT.regValue) != 1)
     {
-        printf("Couldn't Disable Current Limit\n");
+        TPS55289_LOG(FAILED_DISABLE_CURRENT_LIMIT);
         STATUS = false;
         return STATUS;
     }
-    printf("Disabled Output Current Limit\n");   
+    TPS55289_LOG(DISABLED_OUTPUT_CURRENT_LIMIT);   
     return STATUS;
 }
 
 _Bool setOutputCurrentLimit(TPS55289 *device, float currentLimit){
     _Bool STATUS = true;
     // Check if requested current limit is valid
-    if((fmod(currentLimit, 0.05) != 0)|| (currentLimit >= 0.0) || (currentLimit <= 6.35)){
-        printf("Invalid Current Limit Selected\n");
-        printf("Current Limit needs to be between 0.0 and 6.35 and must be a mmultiple of 0.05A\n");;
+    if((currentLimit < 0.0) || (currentLimit > 6.35)){
+        TPS55289_LOG(INVALID_CURRENT_LIMIT_SELECTED);
+        TPS55289_LOG(CURRENT_LIMIT_RANGE);
         STATUS = false;
         return STATUS;
     }
-    device->TPS55289_IOUT_LIMIT.currentLimitAmp = currentLimit;
-    float Vdiff = (uint8_t)currentLimit*TPPS55289_SENSE_RESISTOR;       // This will give Vdiff in mV
-    device->TPS55289_IOUT_LIMIT.Current_Limit_Setting = Vdiff/(0.5);    // Step size is 0.5mV
-    if (setRegister(TPS55289_IOUT_LIMIT_ADDR,device->TPS55289_IOUT_LIMIT.regValue) != 1)
+    TPS55289Lock(device);
+    device->settings.currentLimitAmp = currentLimit;
+    float Vdiff = currentLimit*TPPS55289_SENSE_RESISTOR;                        // This will give Vdiff in mV
+    uint8_t setting = (uint8_t)(Vdiff/(0.5) + 0.5);                             // Step size is 0.5mV; round to nearest step
+    if(device->calibration != NULL){
+        setting = TPS55289CalibrateILIM(device->calibration, setting);
+    }
+    if (setCurrentLimitSetting(device, setting) != true)
     {
-        printf("Couldn't Set Ouput Current Limit\n");
+        STATUS = false;
+        TPS55289Unlock(device);
+        return STATUS;
+    }
+    TPS55289_LOG(OUTPUT_CURRENT_LIMIT_SET);
+    TPS55289_LOG_F32(OUTPUT_CURRENT_LIMIT, currentLimit);
+    TPS55289Unlock(device);
+    return STATUS;
+}
+
+/*
+    Raw Current Limit Setting
+
+    Writes the 7-bit IOUT_LIMIT setting as-is, keeping the enable bit. Used by setOutputCurrentLimit and
+    by the calibration sweep.
+*/
+_Bool setCurrentLimitSetting(TPS55289 *device, uint8_t setting){
+    _Bool STATUS = true;
+    device->TPS55289_IOUT_LIMIT.Current_Limit_Setting = setting;
+    if (setRegister(device, TPS55289_IOUT_LIMIT_ADDR,device->TPS55289_IOUT_LIMIT.regValue) != 1)
+    {
+        TPS55289_LOG(FAILED_SET_OUTPUT_CURRENT_LIMIT);
         STATUS = false;
         return STATUS;
     }
-    printf("Output Current Limit Set Succesfully!\n");
-    printf("Output Current Limit: %f A\n", currentLimit);
     return STATUS;
 }
 
 _Bool setOCPResponseTime(TPS55289 *device, uint8_t OCPResponseTime){
     _Bool STATUS = true;
+    TPS55289Lock(device);
     switch (OCPResponseTime)
     {
     case 0x00:
         device->TPS55289_VOUT_SR.OCP_DELAY = 0b00;
-        device->TPS55289_VOUT_SR.OCResponseTime = 0.128;    // in milliseconds
+        device->settings.OCResponseTime = 0.128;    // in milliseconds
         break;
     case 0x01:
         device->TPS55289_VOUT_SR.OCP_DELAY = 0b01;
-        device->TPS55289_VOUT_SR.OCResponseTime = 1.024*3;    // in milliseconds
+        device->settings.OCResponseTime = 1.024*3;    // in milliseconds
         break;
     case 0x02:
         device->TPS55289_VOUT_SR.OCP_DELAY = 0b10;
-        device->TPS55289_VOUT_SR.OCResponseTime = 1.024*6;    // in milliseconds
+        device->settings.OCResponseTime = 1.024*6;    // in milliseconds
         break;
     case 0x03:
         device->TPS55289_VOUT_SR.OCP_DELAY = 0b11;
-        device->TPS55289_VOUT_SR.OCResponseTime = 1.024*12;    // in milliseconds
+        device->settings.OCResponseTime = 1.024*12;    // in milliseconds
         break;
     default:
-        printf("Invalid Response Time Selected\n");
-        printf("Valid Response Time inputs are 0x00-0x03\n");
+        TPS55289_LOG(INVALID_RESPONSE_TIME_SELECTED);
+        TPS55289_LOG(RESPONSE_TIME_RANGE);
         break;
     }
-    if (setRegister(TPS55289_VOUT_SR_ADDR,device->TPS55289_VOUT_SR.regValue) != 1)
+    if (setRegister(device, TPS55289_VOUT_SR_ADDR,device->TPS55289_VOUT_SR.regValue) != 1)
     {
-        printf("Couldn't Set Overcurrent Protection Response Time\n");
+        TPS55289_LOG(FAILED_SET_OCP_RESPONSE_TIME);
         STATUS = false;
+        TPS55289Unlock(device);
         return STATUS;
     }
+    TPS55289Unlock(device);
     return STATUS;
 }
 
 _Bool setSlewRate(TPS55289 *device, uint8_t slewRate){
     _Bool STATUS = true;
+    TPS55289Lock(device);
     switch (slewRate)
     {
     case 0x00:
         device->TPS55289_VOUT_SR.SR = 0b00;
-        device->TPS55289_VOUT_SR.slewRate = 1.25;       // in mV/us
+        device->settings.slewRate = 1.25;       // in mV/us
         break;
     case 0x01:
         device->TPS55289_VOUT_SR.SR = 0b01;
-        device->TPS55289_VOUT_SR.slewRate = 2.5;
+        device->settings.slewRate = 2.5;
         break;
     case 0x02:
         device->TPS55289_VOUT_SR.SR = 0b10;
-        device->TPS55289_VOUT_SR.slewRate = 5.0;
+        device->settings.slewRate = 5.0;
         break;
     case 0x03:
         device->TPS55289_VOUT_SR.SR = 0b11;
-        device->TPS55289_VOUT_SR.slewRate = 10.0;
+        device->settings.slewRate = 10.0;
         break;
     default:
-        printf("Invalid Slew Rates Selected\n");
-        printf("Valid Slew Rate inputs are 0x00-0x03\n");
+        TPS55289_LOG(INVALID_SLEW_RATES_SELECTED);
+        TPS55289_LOG(SLEW_RATE_RANGE);
         break;
     }
-    if (setRegister(TPS55289_VOUT_SR_ADDR,device->TPS55289_VOUT_SR.regValue) != 1)
+    if (setRegister(device, TPS55289_VOUT_SR_ADDR,device->TPS55289_VOUT_SR.regValue) != 1)
     {
-        printf("Couldn't Set Output Voltage Slew Rate\n");
+        TPS55289_LOG(FAILED_SET_OUTPUT_VOLTAGE_SLEW_RATE);
         STATUS = false;
+        TPS55289Unlock(device);
         return STATUS;
     }
+    TPS55289Unlock(device);
     return STATUS;
 }
 
@@ -281,14 +482,14 @@ _Bool setFBMechanism(TPS55289 *device, uint8_t FB){
     _Bool STATUS = true;
     if(FB == 0){
         device->TPS55289_VOUT_FS.FB = 0;
-        printf("Feedback Mechanism set to Internal Feedback\n");
+        TPS55289_LOG(FB_INTERNAL_SET);
     } else {
         device->TPS55289_VOUT_FS.FB = 1;
-        printf("Feedback Mechanism set to External Feedback\n");
+        TPS55289_LOG(FB_EXTERNAL_SET);
     }
-    if (setRegister(TPS55289_VOUT_FS_ADDR,device->TPS55289_VOUT_FS.regValue) != 1)
+    if (setRegister(device, TPS55289_VOUT_FS_ADDR,device->TPS55289_VOUT_FS.regValue) != 1)
     {
-        printf("Couldn't Set Updated Feedback Mechanism\n");
+        TPS55289_LOG(FAILED_SET_FB_MECHANISM);
         STATUS = false;
         return STATUS;
     }
@@ -301,33 +502,33 @@ _Bool setStepSize(TPS55289 *device, uint8_t stepSize){
     {
     case 0x00:          // 2.5mV Step Size
         device->TPS55289_VOUT_FS.INTFB = 0b00;
-        device->TPS55289_REF_VOLTAGE.CURRENT_INTFB = 0.2256;
-        printf("Output Voltage Step Size: 2.5mV\n");
+        device->settings.CURRENT_INTFB = 0.2256;
+        TPS55289_LOG_F32(STEP_SIZE_SET, 2.5);
         break;
     case 0x01:          // 5mV Step Size
         device->TPS55289_VOUT_FS.INTFB = 0b01;
-        device->TPS55289_REF_VOLTAGE.CURRENT_INTFB = 0.1128;
-        printf("Output Voltage Step Size: 5mV\n");
+        device->settings.CURRENT_INTFB = 0.1128;
+        TPS55289_LOG_F32(STEP_SIZE_SET, 5.0);
         break;
     case 0x02:          // 7.5mV Step Size
         device->TPS55289_VOUT_FS.INTFB = 0b10;
-        device->TPS55289_REF_VOLTAGE.CURRENT_INTFB = 0.0752;
-        printf("Output Voltage Step Size: 7.5mV\n");
+        device->settings.CURRENT_INTFB = 0.0752;
+        TPS55289_LOG_F32(STEP_SIZE_SET, 7.5);
         break;
     case 0x03:          // 10mV Step Size
         device->TPS55289_VOUT_FS.INTFB = 0b11;
-        device->TPS55289_REF_VOLTAGE.CURRENT_INTFB = 0.0564;
-        printf("Output Voltage Step Size: 10mV\n");
+        device->settings.CURRENT_INTFB = 0.0564;
+        TPS55289_LOG_F32(STEP_SIZE_SET, 10.0);
         break;
     
     default:
-        printf("Invalid Step Size Requested\n");
-        printf("Valid Step Sizes are 0x00-0x03\n");
+        TPS55289_LOG(INVALID_STEP_SIZE_REQUESTED);
+        TPS55289_LOG(STEP_SIZE_RANGE);
         break;
     }
-    if (setRegister(TPS55289_VOUT_FS_ADDR,device->TPS55289_VOUT_FS.regValue) != 1)
+    if (setRegister(device, TPS55289_VOUT_FS_ADDR,device->TPS55289_VOUT_FS.regValue) != 1)
     {
-        printf("Couldn't Update Output Voltage Step Size\n");
+        TPS55289_LOG(FAILED_SET_STEP_SIZE);
         STATUS = false;
         return STATUS;
     }
@@ -337,78 +538,78 @@ _Bool setStepSize(TPS55289 *device, uint8_t stepSize){
 _Bool enableSCIndication(TPS55289 *device){
     _Bool STATUS = true;
     device->TPS55289_CDC.SC_MASK = 0b1;
-    if (setRegister(TPS55289_CDC_ADDR,device->TPS55289_CDC.regValue) != 1)
+    if (setRegister(device, TPS55289_CDC_ADDR,device->TPS55289_CDC.regValue) != 1)
     {
-        printf("Couldn't Enable Short Circuit Indication\n");
+        TPS55289_LOG(FAILED_ENABLE_SC_INDICATION);
         STATUS = false;
         return STATUS;
     }
-    printf("Enabled Short Circuit Indication\n");
+    TPS55289_LOG(ENABLED_SC_INDICATION);
     return STATUS;
 }
 
 _Bool disableSCIndication(TPS55289 *device){
     _Bool STATUS = true;
     device->TPS55289_CDC.SC_MASK = 0b0;
-    if (setRegister(TPS55289_CDC_ADDR,device->TPS55289_CDC.regValue) != 1)
+    if (setRegister(device, TPS55289_CDC_ADDR,device->TPS55289_CDC.regValue) != 1)
     {
-        printf("Couldn't Disable Short Circuit Indication\n");
+        TPS55289_LOG(FAILED_DISABLE_SC_INDICATION);
         STATUS = false;
         return STATUS;
     }
-    printf("Disabled Short Circuit Indication\n");
+    TPS55289_LOG(DISABLED_SC_INDICATION);
     return STATUS;
 }
 
 _Bool enableOCPIndication(TPS55289 *device){
     _Bool STATUS = true;
     device->TPS55289_CDC.OCP_MASK = 0b1;
-    if (setRegister(TPS55289_CDC_ADDR,device->TPS55289_CDC.regValue) != 1)
+    if (setRegister(device, TPS55289_CDC_ADDR,device->TPS55289_CDC.regValue) != 1)
     {
-        printf("Couldn't Enable OCP Indication\n");
+        TPS55289_LOG(FAILED_ENABLE_OCP_INDICATION);
         STATUS = false;
         return STATUS;
     }
-    printf("Enabled OCP Indication\n");
+    TPS55289_LOG(ENABLED_OCP_INDICATION);
     return STATUS;
 }
 
 _Bool disableOCPIndication(TPS55289 *device){
     _Bool STATUS = true;
     device->TPS55289_CDC.OCP_MASK = 0b0;
-    if (setRegister(TPS55289_CDC_ADDR,device->TPS55289_CDC.regValue) != 1)
+    if (setRegister(device, TPS55289_CDC_ADDR,device->TPS55289_CDC.regValue) != 1)
     {
-        printf("Couldn't Disable OCP Indication\n");
+        TPS55289_LOG(FAILED_DISABLE_OCP_INDICATION);
         STATUS = false;
         return STATUS;
     }
-    printf("Disabled OCP Indication\n");
+    TPS55289_LOG(DISABLED_OCP_INDICATION);
     return STATUS;
 }
 
 _Bool enableOVPIndication(TPS55289 *device){
     _Bool STATUS = true;
     device->TPS55289_CDC.OVP_MASK = 0b1;
-    if (setRegister(TPS55289_CDC_ADDR,device->TPS55289_CDC.regValue) != 1)
+    if (setRegister(device, TPS55289_CDC_ADDR,device->TPS55289_CDC.regValue) != 1)
     {
-        printf("Couldn't Enable OVP Indication\n");
+        TPS55289_LOG(FAILED_ENABLE_OVP_INDICATION);
         STATUS = false;
         return STATUS;
     }
-    printf("Enabled OVP Indication\n");
+    TPS55289_LOG(ENABLED_OVP_INDICATION);
     return STATUS;
 }
 
 _Bool disableOVPIndication(TPS55289 *device){
     _Bool STATUS = true;
     device->TPS55289_CDC.OVP_MASK = 0b0;
-    if (setRegister(TPS55289_CDC_ADDR,device->TPS55289_CDC.regValue) != 1)
+    if (setRegister(device, TPS55289_CDC_ADDR,device->TPS55289_CDC.regValue) != 1)
     {
-        printf("Couldn't Disable OVP Indication\n");
+        TPS55289_LOG(FAILED_DISABLE_OVP_INDICATION);
         STATUS = false;
         return STATUS;
     }
-    printf("Disabled OVP Indication\n");
+    TPS55289_LOG(DISABLED_OVP_INDICATION);
     return STATUS;
 }
 
@@ -419,17 +620,17 @@ _Bool setCDCOption(TPS55289 *device, uint8_t CDCOption){
     } else {
         device->TPS55289_CDC.CDC_OPTION = 0b1;
     }
-    if (setRegister(TPS55289_CDC_ADDR,device->TPS55289_CDC.regValue) != 1)
+    if (setRegister(device, TPS55289_CDC_ADDR,device->TPS55289_CDC.regValue) != 1)
     {
-        printf("Couldn't set CDC Option\n");
+        TPS55289_LOG(FAILED_SET_CDC_OPTION);
         STATUS = false;
         return STATUS;
     }
     if (CDCOption == 0)
     {
-        printf("Internal CDC Compensation Set\n");
+        TPS55289_LOG(INTERNAL_CDC_COMPENSATION_SET);
     } else {
-        printf("External CDC Compensation Set\n");
+        TPS55289_LOG(EXTERNAL_CDC_COMPENSATION_SET);
     }
     return STATUS;
 }
@@ -440,44 +641,44 @@ _Bool setCDCComp(TPS55289 *device, int compensation){
     {
     case 0x00:
         device->TPS55289_CDC.CDC = 0b000;
-        printf("Compensation set at 0V");
+        TPS55289_LOG_U32(CDC_COMP_SET, 0);
         break;
     case 0x01:
         device->TPS55289_CDC.CDC = 0b001;
-        printf("Compensation set at 0.1V");
+        TPS55289_LOG_U32(CDC_COMP_SET, 1);
         break;
     case 0x02:
         device->TPS55289_CDC.CDC = 0b010;
-        printf("Compensation set at 0.2V");
+        TPS55289_LOG_U32(CDC_COMP_SET, 2);
         break;
     case 0x03:
         device->TPS55289_CDC.CDC = 0b011;
-        printf("Compensation set at 0.3V");
+        TPS55289_LOG_U32(CDC_COMP_SET, 3);
         break;
     case 0x04:
         device->TPS55289_CDC.CDC = 0b100;
-        printf("Compensation set at 0.4V");
+        TPS55289_LOG_U32(CDC_COMP_SET, 4);
         break;
     case 0x05:
         device->TPS55289_CDC.CDC = 0b101;
-        printf("Compensation set at 0.5V");
+        TPS55289_LOG_U32(CDC_COMP_SET, 5);
         break;
     case 0x06:
         device->TPS55289_CDC.CDC = 0b110;
-        printf("Compensation set at 0.6V");
+        TPS55289_LOG_U32(CDC_COMP_SET, 6);
         break;
     case 0x07:
         device->TPS55289_CDC.CDC = 0b111;
-        printf("Compensation set at 0.7V");
+        TPS55289_LOG_U32(CDC_COMP_SET, 7);
         break;
     default:
-        printf("Invalid Compensation Requested\n");
-        printf("Valid Compensation Presets are 0x00-0x07\n");
+        TPS55289_LOG(INVALID_COMPENSATION_REQUESTED);
+        TPS55289_LOG(CDC_COMP_RANGE);
         break;
     }
-    if (setRegister(TPS55289_CDC_ADDR,device->TPS55289_CDC.regValue) != 1)
+    if (setRegister(device, TPS55289_CDC_ADDR,device->TPS55289_CDC.regValue) != 1)
     {
-        printf("Couldn't set CDC Compensation\n");
+        TPS55289_LOG(FAILED_SET_CDC_COMPENSATION);
         STATUS = false;
         return STATUS;
     }
@@ -486,27 +687,33 @@ _Bool setCDCComp(TPS55289 *device, int compensation){
 
 _Bool enableDevice(TPS55289 *device){
     _Bool STATUS = true;
+    if (device->output != NULL){
+        return TPS55289OutputRequest(device, TPS55289_OUTPUT_EVENT_ENABLE);
+    }
     device->TPS55289_MODE.OE = 0b1;     // Enable device
-    if (setRegister(TPS55289_MODE_ADDR,device->TPS55289_MODE.regValue) != 1)
+    if (setRegister(device, TPS55289_MODE_ADDR,device->TPS55289_MODE.regValue) != 1)
     {
-        printf("Couldn't Enable Device\n");
+        TPS55289_LOG(FAILED_ENABLE_DEVICE);
         STATUS = false;
         return STATUS;
     }
-    printf("Enabled Device\n");
+    TPS55289_LOG(ENABLED_DEVICE);
     return STATUS;
 }
 
 _Bool disableDevice(TPS55289 *device){
     _Bool STATUS = true;
+    if (device->output != NULL){
+        return TPS55289OutputRequest(device, TPS55289_OUTPUT_EVENT_DISABLE);
+    }
     device->TPS55289_MODE.OE = 0b0;     // Enable device
-    if (setRegister(TPS55289_MODE_ADDR,device->TPS55289_MODE.regValue) != 1)
+    if (setRegister(device, TPS55289_MODE_ADDR,device->TPS55289_MODE.regValue) != 1)
     {
-        printf("Couldn't Disable Device\n");
+        TPS55289_LOG(FAILED_DISABLE_DEVICE);
         STATUS = false;
         return STATUS;
     }
-    printf("Disabled Device\n");
+    TPS55289_LOG(DISABLED_DEVICE);
     return STATUS;
 }
 
@@ -519,65 +726,65 @@ _Bool FSWDoubling(TPS55289 *device, uint8_t input){
         device->TPS55289_MODE.FSWDBL = 0b1;     // Keepp same Freq in Buck-Boost Operating Mode
     }
     
-    if (setRegister(TPS55289_MODE_ADDR,device->TPS55289_MODE.regValue) != 1)
+    if (setRegister(device, TPS55289_MODE_ADDR,device->TPS55289_MODE.regValue) != 1)
     {
-        printf("Couldn't set FSWDBL Mode\n");
+        TPS55289_LOG(FAILED_SET_FSWDBL_MODE);
         STATUS = false;
         return STATUS;
     }
-    printf("Set FSWDBL Mode Successfully\n");
+    TPS55289_LOG(FSWDBL_MODE_SET);
     return STATUS;
 }
 
 _Bool enableHiccupMode(TPS55289 *device){
     _Bool STATUS = true;
     device->TPS55289_MODE.HICCUP = 0b1;     // Enable Hiccup Mode
-    if (setRegister(TPS55289_MODE_ADDR,device->TPS55289_MODE.regValue) != 1)
+    if (setRegister(device, TPS55289_MODE_ADDR,device->TPS55289_MODE.regValue) != 1)
     {
-        printf("Couldn't Enable Hiccup Mode\n");
+        TPS55289_LOG(FAILED_ENABLE_HICCUP_MODE);
         STATUS = false;
         return STATUS;
     }
-    printf("Enabled Hiccup Mode\n");
+    TPS55289_LOG(ENABLED_HICCUP_MODE);
     return STATUS;
 }
 
 _Bool disableHiccupMode(TPS55289 *device){
     _Bool STATUS = true;
     device->TPS55289_MODE.HICCUP = 0b1;     // Disable Hiccup Mode
-    if (setRegister(TPS55289_MODE_ADDR,device->TPS55289_MODE.regValue) != 1)
+    if (setRegister(device, TPS55289_MODE_ADDR,device->TPS55289_MODE.regValue) != 1)
     {
-        printf("Couldn't Disable Hiccup Mode\n");
+        TPS55289_LOG(FAILED_DISABLE_HICCUP_MODE);
         STATUS = false;
         return STATUS;
     }
-    printf("Disabled Hiccup Mode\n");
+    TPS55289_LOG(DISABLED_HICCUP_MODE);
     return STATUS;
 }
 
 _Bool enableVOUTDSCHG(TPS55289 *device){
     _Bool STATUS = true;
     device->TPS55289_MODE.DISCHG = 0b1;     // Enable VOUT Discharge Functionality
-    if (setRegister(TPS55289_MODE_ADDR,device->TPS55289_MODE.regValue) != 1)
+    if (setRegister(device, TPS55289_MODE_ADDR,device->TPS55289_MODE.regValue) != 1)
     {
-        printf("Couldn't Enable Discharge Mode\n");
+        TPS55289_LOG(FAILED_ENABLE_DISCHARGE_MODE);
         STATUS = false;
         return STATUS;
     }
-    printf("Enabled Discharge Mode\n");
+    TPS55289_LOG(ENABLED_DISCHARGE_MODE);
     return STATUS;
 }
 
 _Bool disableVOUTDSCHG(TPS55289 *device){
     _Bool STATUS = true;
     device->TPS55289_MODE.DISCHG = 0b0;     // Enable VOUT Discharge Functionality
-    if (setRegister(TPS55289_MODE_ADDR,device->TPS55289_MODE.regValue) != 1)
+    if (setRegister(device, TPS55289_MODE_ADDR,device->TPS55289_MODE.regValue) != 1)
     {
-        printf("Couldn't Disable Discharge Mode\n");
+        TPS55289_LOG(FAILED_DISABLE_DISCHARGE_MODE);
         STATUS = false;
         return STATUS;
     }
-    printf("Disabled Discharge Mode\n");
+    TPS55289_LOG(DISABLED_DISCHARGE_MODE);
     return STATUS;
 }
 
@@ -589,52 +796,83 @@ _Bool FSWOpMode(TPS55289 *device, uint8_t mode){
         device->TPS55289_MODE.FPWM = 0b1;     // Enable FPWM Operating Mode
     }
     
-    if (setRegister(TPS55289_MODE_ADDR,device->TPS55289_MODE.regValue) != 1)
+    if (setRegister(device, TPS55289_MODE_ADDR,device->TPS55289_MODE.regValue) != 1)
     {
-        printf("Couldn't set Light Load Operating Mode\n");
+        TPS55289_LOG(FAILED_SET_LIGHT_LOAD_MODE);
         STATUS = false;
         return STATUS;
     }
-    printf("Set Light Load Operating Mode Successfully\n");
+    TPS55289_LOG(LIGHT_LOAD_MODE_SET);
     return STATUS;    
 }
 
-_Bool readStatusRegister(TPS55289 *device){
+// Reads STATUS into the cache. The device clears the latched SCP/OCP/OVP flags on the read
+static _Bool readStatus(TPS55289 *device){
     _Bool STATUS = true;
-    if(getRegister(TPS55289_STATUS_ADDR, device->TPS55289_STATUS.regValue) != 1){
-        printf("Failed to read Status Register\n");
+    if(getRegister(device, TPS55289_STATUS_ADDR, &device->TPS55289_STATUS.regValue) != 1){
+        TPS55289_LOG(FAILED_READ_STATUS);
         STATUS = false;
         return STATUS;
     }
-    return STATUS; 
+    return STATUS;
+}
+
+static _Bool dispatchStatus(TPS55289 *device){
+    if(device->TPS55289_STATUS.SCP || device->TPS55289_STATUS.OCP || device->TPS55289_STATUS.OVP){
+        return TPS55289HandleStatus(device);
+    }
+    return true;
+}
+
+/*
+    Read Status Register
+
+    The read clears the latched flags on the device, so whoever reads STATUS acts on them: set flags go
+    through TPS55289HandleStatus here and are never left for a poll that would no longer see them.
+*/
+_Bool readStatusRegister(TPS55289 *device){
+    _Bool STATUS = true;
+    STATUS = readStatus(device);
+    if(STATUS != true){
+        return STATUS;
+    }
+    return dispatchStatus(device);
 }
 
 _Bool operateOnStatusRegister(TPS55289 *device){
     _Bool STATUS = true;
-    STATUS = readStatusRegister(device);
+    STATUS = readStatus(device);
+    return TPS55289HandleStatus(device) && STATUS;
+}
+
+/*
+    Status Handling
+
+    Acts on the cached STATUS value: logs every flagged fault and shuts the output down once, however
+    many flags are set. With the state machine attached the flags become events instead, and OCP only
+    limits rather than disabling. Shared by the STATUS reads above and the register scrubber, whose
+    burst read also clears the latched flags.
+*/
+_Bool TPS55289HandleStatus(TPS55289 *device){
+    _Bool STATUS = true;
     if(device->TPS55289_STATUS.SCP == 1){
-        STATUS = disableDevice(device);
-        printf("Short Circuit Condition Detected\n");
-        printf("Disabled Output Voltage\n");
-        /*
-            Add code to send info back to PC GUI
-        */
+        TPS55289_LOG(SHORT_CIRCUIT_DETECTED);
     }
     if(device->TPS55289_STATUS.OCP == 1){
-        STATUS = disableDevice(device);
-        printf("Overcurrent Condition Detected\n");
-        printf("Disabled Output Voltage\n");
-        /*
-            Add code to send info back to PC GUI
-        */
+        TPS55289_LOG(OVERCURRENT_DETECTED);
     }
     if(device->TPS55289_STATUS.OVP == 1){
+        TPS55289_LOG(OVERVOLTAGE_DETECTED);
+    }
+    /*
+        Add code to send info back to PC GUI
+    */
+    if(device->output != NULL){
+        return TPS55289OutputStatus(device, device->TPS55289_STATUS.regValue);
+    }
+    if(device->TPS55289_STATUS.SCP || device->TPS55289_STATUS.OCP || device->TPS55289_STATUS.OVP){
         STATUS = disableDevice(device);
-        printf("Overcurrent Condition Detected\n");
-        printf("Disabled Output Voltage\n");
-        /*
-            Add code to send info back to PC GUI
-        */
+        TPS55289_LOG(DISABLED_OUTPUT_VOLTAGE);
     }
     return STATUS;
-}
\ No newline at end of file
+}
@@ -0,0 +1,236 @@
+// Per-unit calibration of the TPS55289 output voltage and current limit
+#include <stddef.h>
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_calibration.h"
+#include "TPS55289_log.h"
+
+#define TPS55289_CAL_ONE                (1 << TPS55289_CAL_FRAC_BITS)
+
+/*
+    Reset
+
+    Identity tables: every lookup returns the nominal code unchanged. Neither table is marked valid.
+*/
+void TPS55289CalibrationReset(TPS55289_CALIBRATION *calibration){
+    calibration->magic   = TPS55289_CAL_MAGIC;
+    calibration->version = TPS55289_CAL_VERSION;
+    calibration->INTFB   = 0;
+    calibration->flags   = 0;
+    for (int i = 0; i < TPS55289_CAL_POINTS; i++){
+        calibration->voutCorrection[i] = 0;
+        calibration->ilimCorrection[i] = 0;
+    }
+    calibration->crc = TPS55289CalibrationCRC(calibration);
+}
+
+/*
+    CRC-32 (IEEE 802.3, reflected) over the record up to but excluding the crc field
+*/
+uint32_t TPS55289CalibrationCRC(const TPS55289_CALIBRATION *calibration){
+    const uint8_t *data = (const uint8_t *)calibration;
+    size_t length = offsetof(TPS55289_CALIBRATION, crc);
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (size_t i = 0; i < length; i++){
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++){
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+_Bool TPS55289CalibrationValid(const TPS55289_CALIBRATION *calibration){
+    return (calibration->magic == TPS55289_CAL_MAGIC) &&
+           (calibration->version == TPS55289_CAL_VERSION) &&
+           (calibration->crc == TPS55289CalibrationCRC(calibration));
+}
+
+/*
+    Table Lookup
+
+    Piecewise-linear interpolation of the correction at a nominal code; segment index and fraction are a
+    shift and a mask, so the whole lookup is one multiply. Result is in 1/16 code.
+*/
+static int32_t lookupCorrection(const int16_t *table, uint32_t code, uint32_t shift){
+    uint32_t index    = code >> shift;
+    int32_t  fraction = (int32_t)(code & ((1u << shift) - 1));
+    if (index >= (TPS55289_CAL_POINTS - 1)){
+        return table[TPS55289_CAL_POINTS - 1];
+    }
+    int32_t slope = table[index + 1] - table[index];
+    return table[index] + ((slope * fraction) >> shift);
+}
+
+static uint32_t applyCorrection(uint32_t code, int32_t correction, uint32_t max){
+    int32_t corrected = (int32_t)code + ((correction + (TPS55289_CAL_ONE / 2)) >> TPS55289_CAL_FRAC_BITS);
+    if (corrected < 0){
+        return 0;
+    }
+    return ((uint32_t)corrected > max) ? max : (uint32_t)corrected;
+}
+
+/*
+    Setpoint Correction
+
+    Map a nominal REF code / IOUT_LIMIT setting to the one that produces the requested output on this
+    unit. The voltage table only applies to the INTFB ratio it was measured with; anything without a
+    valid table passes through unchanged.
+*/
+uint16_t TPS55289CalibrateVREF(const TPS55289_CALIBRATION *calibration, uint8_t INTFB, uint16_t code){
+    if (code > TPS55289_CAL_VREF_MAX){
+        code = TPS55289_CAL_VREF_MAX;
+    }
+    if ((calibration == NULL) || ((calibration->flags & TPS55289_CAL_VOUT_VALID) == 0) ||
+        (calibration->INTFB != INTFB)){
+        return code;
+    }
+    int32_t correction = lookupCorrection(calibration->voutCorrection, code, TPS55289_CAL_VREF_SHIFT);
+    return (uint16_t)applyCorrection(code, correction, TPS55289_CAL_VREF_MAX);
+}
+
+uint8_t TPS55289CalibrateILIM(const TPS55289_CALIBRATION *calibration, uint8_t setting){
+    if (setting > TPS55289_CAL_ILIM_MAX){
+        setting = TPS55289_CAL_ILIM_MAX;
+    }
+    if ((calibration == NULL) || ((calibration->flags & TPS55289_CAL_ILIM_VALID) == 0)){
+        return setting;
+    }
+    int32_t correction = lookupCorrection(calibration->ilimCorrection, setting, TPS55289_CAL_ILIM_SHIFT);
+    return (uint8_t)applyCorrection(setting, correction, TPS55289_CAL_ILIM_MAX);
+}
+
+/*
+    Table Fit
+
+    The calibration sweep programs codes on the uniform grid (the top point one code below it) and measures
+    what each one produced. Converting the measurement back through the nominal formula gives the code the
+    driver would have asked for, so (nominal[k], programmed[k] - nominal[k]) are points of the correction
+    curve. They are resampled onto the uniform grid of nominal codes, extrapolating the end segments. All
+    values in 1/16 code.
+*/
+static _Bool fitCorrection(int16_t *table, const uint16_t *programmed, const int32_t *nominal, uint32_t shift){
+    for (int k = 1; k < TPS55289_CAL_POINTS; k++){
+        if (nominal[k] <= nominal[k - 1]){
+            TPS55289_LOG(CALIBRATION_NOT_MONOTONIC);
+            return false;
+        }
+    }
+
+    int k = 0;
+    for (int i = 0; i < TPS55289_CAL_POINTS; i++){
+        int32_t grid = (int32_t)(i << shift) * TPS55289_CAL_ONE;
+        while ((k < (TPS55289_CAL_POINTS - 2)) && (grid > nominal[k + 1])){
+            k++;
+        }
+        int32_t correction0 = (int32_t)programmed[k] * TPS55289_CAL_ONE - nominal[k];
+        int32_t correction1 = (int32_t)programmed[k + 1] * TPS55289_CAL_ONE - nominal[k + 1];
+        int64_t correction  = correction0 + ((int64_t)(correction1 - correction0) * (grid - nominal[k])) /
+                                            (nominal[k + 1] - nominal[k]);
+        if (correction > INT16_MAX){
+            correction = INT16_MAX;
+        } else if (correction < INT16_MIN){
+            correction = INT16_MIN;
+        }
+        table[i] = (int16_t)correction;
+    }
+    return true;
+}
+
+/*
+    Voltage Calibration
+
+    Sweeps the REF code across the full range with the output enabled (no load should be attached) and
+    measures VOUT through measureVOUT after settleMs. The top grid point is programmed as 0x7FF. Leaves
+    the output disabled.
+*/
+_Bool TPS55289CalibrationRunVOUT(TPS55289 *device, TPS55289_CALIBRATION *calibration, TPS55289_MEASURE measureVOUT,
+                                 void *context, uint32_t settleMs){
+    _Bool STATUS = true;
+    uint16_t programmed[TPS55289_CAL_POINTS];
+    int32_t nominal[TPS55289_CAL_POINTS];
+    float INTFB = device->settings.CURRENT_INTFB;
+
+    calibration->flags &= ~TPS55289_CAL_VOUT_VALID;
+    if(enableDevice(device) != true){
+        STATUS = false;
+        return STATUS;
+    }
+    for (int k = 0; k < TPS55289_CAL_POINTS; k++){
+        uint32_t code = (uint32_t)k << TPS55289_CAL_VREF_SHIFT;
+        programmed[k] = (code > TPS55289_CAL_VREF_MAX) ? TPS55289_CAL_VREF_MAX : code;
+        if(setReferenceCode(device, programmed[k]) != true){
+            STATUS = false;
+            break;
+        }
+        sleep_ms(settleMs);
+        uint32_t measured = measureVOUT(context);
+        TPS55289_LOG_U32(CALIBRATION_POINT, measured);
+        // Same conversion as setOutputVoltage, kept in 1/16 code
+        nominal[k] = (int32_t)((1.7715*((measured*INTFB) - 45)+1) * TPS55289_CAL_ONE);
+    }
+    disableDevice(device);
+    if(STATUS != true){
+        return STATUS;
+    }
+
+    if(fitCorrection(calibration->voutCorrection, programmed, nominal, TPS55289_CAL_VREF_SHIFT) != true){
+        STATUS = false;
+        return STATUS;
+    }
+    calibration->INTFB  = device->TPS55289_VOUT_FS.INTFB;
+    calibration->flags |= TPS55289_CAL_VOUT_VALID;
+    calibration->crc    = TPS55289CalibrationCRC(calibration);
+    return STATUS;
+}
+
+/*
+    Current Limit Calibration
+
+    Sweeps the IOUT_LIMIT setting with the output enabled into a load heavy enough to hold the converter in
+    current limit at every point, and measures IOUT through measureIOUT after settleMs. Leaves the output
+    disabled and the current limit at its last setting; callers reprogram both afterwards.
+*/
+_Bool TPS55289CalibrationRunILIM(TPS55289 *device, TPS55289_CALIBRATION *calibration, TPS55289_MEASURE measureIOUT,
+                                 void *context, uint32_t settleMs){
+    _Bool STATUS = true;
+    uint16_t programmed[TPS55289_CAL_POINTS];
+    int32_t nominal[TPS55289_CAL_POINTS];
+
+    calibration->flags &= ~TPS55289_CAL_ILIM_VALID;
+    if(enableOutputCurrentLimit(device) != true){
+        STATUS = false;
+        return STATUS;
+    }
+    if(enableDevice(device) != true){
+        STATUS = false;
+        return STATUS;
+    }
+    for (int k = 0; k < TPS55289_CAL_POINTS; k++){
+        uint32_t setting = (uint32_t)k << TPS55289_CAL_ILIM_SHIFT;
+        programmed[k] = (setting > TPS55289_CAL_ILIM_MAX) ? TPS55289_CAL_ILIM_MAX : setting;
+        if(setCurrentLimitSetting(device, (uint8_t)programmed[k]) != true){
+            STATUS = false;
+            break;
+        }
+        sleep_ms(settleMs);
+        uint32_t measured = measureIOUT(context);
+        TPS55289_LOG_U32(CALIBRATION_POINT, measured);
+        // Same conversion as setOutputCurrentLimit (0.5mV per setting across the sense resistor), in 1/16 setting
+        nominal[k] = (int32_t)((measured*TPPS55289_SENSE_RESISTOR*TPS55289_CAL_ONE*2 + 500) / 1000);
+    }
+    disableDevice(device);
+    if(STATUS != true){
+        return STATUS;
+    }
+
+    if(fitCorrection(calibration->ilimCorrection, programmed, nominal, TPS55289_CAL_ILIM_SHIFT) != true){
+        STATUS = false;
+        return STATUS;
+    }
+    calibration->flags |= TPS55289_CAL_ILIM_VALID;
+    calibration->crc    = TPS55289CalibrationCRC(calibration);
+    return STATUS;
+}
@@ -0,0 +1,73 @@
+// Flash storage of the TPS55289 calibration record (RP2040 only)
+#include <assert.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+
+#include "TPS55289_calibration.h"
+#include "TPS55289_log.h"
+
+// The record lives alone in the last sector of flash, well clear of the firmware image
+#define TPS55289_CAL_FLASH_OFFSET       (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+#define TPS55289_CAL_FLASH_TIMEOUT_MS   100
+
+static_assert(sizeof(TPS55289_CALIBRATION) <= FLASH_PAGE_SIZE, "Calibration record must fit one flash page");
+
+/*
+    Load
+
+    Copies the record out of XIP flash. On a blank or corrupt sector the record is reset to identity
+    tables and false is returned, so the caller can run the calibration or carry on uncalibrated.
+*/
+_Bool TPS55289CalibrationLoad(TPS55289_CALIBRATION *calibration){
+    _Bool STATUS = true;
+    const TPS55289_CALIBRATION *stored = (const TPS55289_CALIBRATION *)(XIP_BASE + TPS55289_CAL_FLASH_OFFSET);
+
+    memcpy(calibration, stored, sizeof(TPS55289_CALIBRATION));
+    if(TPS55289CalibrationValid(calibration) != true){
+        TPS55289_LOG(CALIBRATION_INVALID);
+        TPS55289CalibrationReset(calibration);
+        STATUS = false;
+        return STATUS;
+    }
+    TPS55289_LOG(CALIBRATION_LOADED);
+    return STATUS;
+}
+
+static void calibrationProgram(void *param){
+    const uint8_t *page = (const uint8_t *)param;
+    flash_range_erase(TPS55289_CAL_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+    flash_range_program(TPS55289_CAL_FLASH_OFFSET, page, FLASH_PAGE_SIZE);
+}
+
+/*
+    Save
+
+    Erases the calibration sector and programs the record. flash_safe_execute parks the other core and
+    disables interrupts for the duration, so this must not be called from the control path.
+*/
+_Bool TPS55289CalibrationSave(TPS55289_CALIBRATION *calibration){
+    _Bool STATUS = true;
+    static uint8_t page[FLASH_PAGE_SIZE];
+
+    calibration->magic   = TPS55289_CAL_MAGIC;
+    calibration->version = TPS55289_CAL_VERSION;
+    calibration->crc     = TPS55289CalibrationCRC(calibration);
+
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page, calibration, sizeof(TPS55289_CALIBRATION));
+    if(flash_safe_execute(calibrationProgram, page, TPS55289_CAL_FLASH_TIMEOUT_MS) != PICO_OK){
+        TPS55289_LOG(FAILED_SAVE_CALIBRATION);
+        STATUS = false;
+        return STATUS;
+    }
+    if(memcmp((const void *)(XIP_BASE + TPS55289_CAL_FLASH_OFFSET), page, sizeof(TPS55289_CALIBRATION)) != 0){
+        TPS55289_LOG(FAILED_SAVE_CALIBRATION);
+        STATUS = false;
+        return STATUS;
+    }
+    TPS55289_LOG(CALIBRATION_SAVED);
+    return STATUS;
+}
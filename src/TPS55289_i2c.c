@@ -0,0 +1,116 @@
+// Hardware I2C transport for the TPS55289 driver
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+
+#include "TPS55289_transport.h"
+
+static int hardwareI2CWrite(void *context, uint8_t address, const uint8_t *src, size_t len, _Bool nostop){
+    return i2c_write_blocking((i2c_inst_t *)context, address, src, len, nostop);
+}
+
+static int hardwareI2CRead(void *context, uint8_t address, uint8_t *dst, size_t len, _Bool nostop){
+    return i2c_read_blocking((i2c_inst_t *)context, address, dst, len, nostop);
+}
+
+#define I2C_TX_FIFO_DEPTH       16
+
+static size_t pendingLength[NUM_I2CS];
+static TPS55289_I2C_COMPLETION completionCallback;
+static recursive_mutex_t controllerLock[NUM_I2CS];
+
+void TPS55289I2CInit(void){
+    for (uint32_t i = 0; i < NUM_I2CS; i++){
+        recursive_mutex_init(&controllerLock[i]);
+    }
+}
+
+/*
+    Completion Interrupt
+
+    STOP_DET of a split write, when a callback is registered. Only masks the interrupt: the flag itself
+    is left for writePoll to consume.
+*/
+static void hardwareI2CIrq(void){
+    for (uint32_t i = 0; i < NUM_I2CS; i++){
+        i2c_hw_t *hw = i2c_get_hw(i2c_get_instance(i));
+        if (hw->intr_stat & I2C_IC_INTR_STAT_R_STOP_DET_BITS){
+            hw->intr_mask = 0;
+        }
+    }
+    completionCallback();
+}
+
+// Registers a callback run from the I2C interrupt when a split write finishes; NULL to poll only
+void TPS55289I2CSetCompletionCallback(TPS55289_I2C_COMPLETION callback){
+    completionCallback = callback;
+    for (uint32_t i = 0; i < NUM_I2CS; i++){
+        uint irq = I2C0_IRQ + i;
+        if (callback != NULL){
+            irq_set_exclusive_handler(irq, hardwareI2CIrq);
+        }
+        irq_set_enabled(irq, callback != NULL);
+    }
+}
+
+/*
+    Split Write
+
+    Loads the whole write, STOP included, into the TX FIFO and returns; the controller clocks it out on
+    its own. Completion is the STOP condition, which the controller also issues after an abort (NAK).
+*/
+static int hardwareI2CWriteStart(void *context, uint8_t address, const uint8_t *src, size_t len){
+    i2c_inst_t *i2c = (i2c_inst_t *)context;
+    i2c_hw_t *hw = i2c_get_hw(i2c);
+    if ((len == 0) || (len > I2C_TX_FIFO_DEPTH) || (hw->status & I2C_IC_STATUS_ACTIVITY_BITS)){
+        return PICO_ERROR_GENERIC;
+    }
+
+    hw->enable = 0;
+    hw->tar = address;
+    hw->enable = 1;
+    (void)hw->clr_tx_abrt;
+    (void)hw->clr_stop_det;
+    for (size_t i = 0; i < len; i++){
+        hw->data_cmd = (((i == 0) && i2c->restart_on_next) ? I2C_IC_DATA_CMD_RESTART_BITS : 0) |
+                       ((i == len - 1) ? I2C_IC_DATA_CMD_STOP_BITS : 0) | src[i];
+    }
+    i2c->restart_on_next = false;
+    pendingLength[i2c_hw_index(i2c)] = len;
+    if (completionCallback != NULL){
+        hw->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS;
+    }
+    return (int)len;
+}
+
+static int hardwareI2CWritePoll(void *context){
+    i2c_inst_t *i2c = (i2c_inst_t *)context;
+    i2c_hw_t *hw = i2c_get_hw(i2c);
+    if ((hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_STOP_DET_BITS) == 0){
+        return 0;
+    }
+    (void)hw->clr_stop_det;
+    if (hw->tx_abrt_source != 0){
+        (void)hw->clr_tx_abrt;
+        return PICO_ERROR_GENERIC;
+    }
+    return (int)pendingLength[i2c_hw_index(i2c)];
+}
+
+const TPS55289_TRANSPORT TPS55289_I2C0_TRANSPORT = {
+    .write      = hardwareI2CWrite,
+    .read       = hardwareI2CRead,
+    .context    = i2c0,
+    .writeStart = hardwareI2CWriteStart,
+    .writePoll  = hardwareI2CWritePoll,
+    .lock       = &controllerLock[0],
+};
+
+const TPS55289_TRANSPORT TPS55289_I2C1_TRANSPORT = {
+    .write      = hardwareI2CWrite,
+    .read       = hardwareI2CRead,
+    .context    = i2c1,
+    .writeStart = hardwareI2CWriteStart,
+    .writePoll  = hardwareI2CWritePoll,
+    .lock       = &controllerLock[1],
+};
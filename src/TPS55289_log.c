@@ -0,0 +1,162 @@
+// Compile-time filtered, deferred logging for the TPS55289 driver
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#include "TPS55289_log.h"
+#include <stdio.h>
+
+#if (TPS55289_LOG_BUFFER_SIZE & (TPS55289_LOG_BUFFER_SIZE - 1)) != 0
+#error "TPS55289_LOG_BUFFER_SIZE must be a power of two"
+#endif
+
+// Format strings and argument kinds live only here; call sites carry nothing but the message ID
+static const char *const TPS55289_LOG_FORMATS[TPS55289_MSG_COUNT] = {
+#define TPS55289_LOG_FMT(id, level, argument, format)  format,
+    TPS55289_LOG_MESSAGES(TPS55289_LOG_FMT)
+#undef TPS55289_LOG_FMT
+};
+
+static const uint8_t TPS55289_LOG_ARGS[TPS55289_MSG_COUNT] = {
+#define TPS55289_LOG_ARGKIND(id, level, argument, format)  TPS55289_LOG_ARG_##argument,
+    TPS55289_LOG_MESSAGES(TPS55289_LOG_ARGKIND)
+#undef TPS55289_LOG_ARGKIND
+};
+
+static TPS55289_LOG_RECORD logRing[TPS55289_LOG_BUFFER_SIZE];
+static volatile uint32_t logHead;       // Next slot to write
+static volatile uint32_t logTail;       // Next slot to read
+static volatile uint32_t logDropped;
+static uint16_t logSequence;
+static spin_lock_t *logLock;
+
+/*
+    Log Initialisation
+
+    Claims a hardware spin lock so both cores can log into the same ring. Must be called before the
+    scheduler starts; records written before this are still accepted but only protected against
+    interrupts on the calling core.
+*/
+void TPS55289LogInit(void){
+    logHead = 0;
+    logTail = 0;
+    logDropped = 0;
+    logSequence = 0;
+    logLock = spin_lock_instance(spin_lock_claim_unused(true));
+}
+
+/*
+    Deferred Write
+
+    Stores only the message ID, the raw argument and a timestamp. When the ring is full the newest
+    record is dropped and counted rather than blocking the caller.
+*/
+void TPS55289LogWrite(TPS55289_LOG_MSG id, uint32_t argument){
+    uint32_t timestamp = time_us_32();
+    uint32_t irq = (logLock != NULL) ? spin_lock_blocking(logLock) : save_and_disable_interrupts();
+
+    uint32_t head = logHead;
+    if ((head - logTail) >= TPS55289_LOG_BUFFER_SIZE){
+        logDropped++;
+    } else {
+        TPS55289_LOG_RECORD *record = &logRing[head & (TPS55289_LOG_BUFFER_SIZE - 1)];
+        record->timestamp = timestamp;
+        record->id        = (uint16_t)id;
+        record->sequence  = logSequence++;
+        record->argument  = argument;
+        logHead = head + 1;
+    }
+
+    if (logLock != NULL){
+        spin_unlock(logLock, irq);
+    } else {
+        restore_interrupts(irq);
+    }
+}
+
+/*
+    Formatter
+
+    The only place the format strings are expanded. Used inline in TPS55289_LOG_MODE_PRINTF and from
+    TPS55289LogFlush in TPS55289_LOG_MODE_DEFERRED.
+*/
+void TPS55289LogFormat(TPS55289_LOG_MSG id, uint32_t argument){
+    if (id >= TPS55289_MSG_COUNT){
+        return;
+    }
+    switch (TPS55289_LOG_ARGS[id])
+    {
+    case TPS55289_LOG_ARG_U32:
+        printf(TPS55289_LOG_FORMATS[id], (unsigned int)argument);
+        break;
+    case TPS55289_LOG_ARG_F32: {
+        union { uint32_t u; float f; } bits;
+        bits.u = argument;
+        printf(TPS55289_LOG_FORMATS[id], (double)bits.f);
+        break;
+    }
+    default:
+        printf("%s", TPS55289_LOG_FORMATS[id]);
+        break;
+    }
+}
+
+/*
+    Flush
+
+    Formats and prints up to maxRecords pending records (0 = all). Intended for a low priority task;
+    the lock is only held while a record is copied out, never while printing.
+    Returns the number of records printed.
+*/
+uint32_t TPS55289LogFlush(uint32_t maxRecords){
+    uint32_t printed = 0;
+    static uint32_t reportedDropped = 0;
+
+    while ((maxRecords == 0) || (printed < maxRecords)){
+        TPS55289_LOG_RECORD record;
+        uint32_t irq = (logLock != NULL) ? spin_lock_blocking(logLock) : save_and_disable_interrupts();
+        _Bool pending = (logTail != logHead);
+        if (pending){
+            record = logRing[logTail & (TPS55289_LOG_BUFFER_SIZE - 1)];
+            logTail = logTail + 1;
+        }
+        if (logLock != NULL){
+            spin_unlock(logLock, irq);
+        } else {
+            restore_interrupts(irq);
+        }
+        if (!pending){
+            break;
+        }
+        TPS55289LogFormat((TPS55289_LOG_MSG)record.id, record.argument);
+        printed++;
+    }
+
+    uint32_t dropped = logDropped;
+    if (dropped != reportedDropped){
+        printf("TPS55289 log dropped %u records\n", (unsigned int)(dropped - reportedDropped));
+        reportedDropped = dropped;
+    }
+    return printed;
+}
+
+/*
+    Discard
+
+    Drops all pending records without formatting them. Used by benchmarks to keep the ring in a steady state
+    without putting formatted text on the console. Returns the number of records discarded.
+*/
+uint32_t TPS55289LogDiscard(void){
+    uint32_t irq = (logLock != NULL) ? spin_lock_blocking(logLock) : save_and_disable_interrupts();
+    uint32_t discarded = logHead - logTail;
+    logTail = logHead;
+    if (logLock != NULL){
+        spin_unlock(logLock, irq);
+    } else {
+        restore_interrupts(irq);
+    }
+    return discarded;
+}
+
+uint32_t TPS55289LogDropped(void){
+    return logDropped;
+}
@@ -0,0 +1,381 @@
+// Output lifecycle state machine for the TPS55289 Buck-Boost Converter
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_log.h"
+#include "TPS55289_output.h"
+#include "TPS55289_state.h"
+
+#define OUTPUT_IGNORE                   0xFF        // No entry: the event is dropped in this state
+#define OUTPUT_KEEP                     0xFF        // Image field left as it is
+
+#define OFF                             TPS55289_OUTPUT_OFF
+#define SOFT                            TPS55289_OUTPUT_SOFT_START
+#define REG                             TPS55289_OUTPUT_REGULATING
+#define LIM                             TPS55289_OUTPUT_LIMITING
+#define FLT                             TPS55289_OUTPUT_FAULTED
+#define HIC                             TPS55289_OUTPUT_HICCUP
+#define DIS                             TPS55289_OUTPUT_DISCHARGE
+#define __                              OUTPUT_IGNORE
+
+/*
+    Transition Table
+
+    Next state for every (state, event). A self transition still re-applies the state's register image,
+    which writes nothing unless the registers have drifted from it.
+*/
+static const uint8_t transitions[TPS55289_OUTPUT_STATES][TPS55289_OUTPUT_EVENTS] = {
+    //          ENABLE DISABLE SETPNT SS_DONE OCP   OCP_CLR LIM_TO SCP   FAULT  RETRY  EXHAUST DISCHGD CLEAR
+    [OFF]  = {  SOFT,  OFF,    OFF,   __,     __,   __,     __,    __,   FLT,   __,    __,     __,     OFF },
+    [SOFT] = {  SOFT,  DIS,    SOFT,  REG,    LIM,  __,     __,    HIC,  FLT,   __,    __,     __,     __  },
+    [REG]  = {  REG,   DIS,    REG,   __,     LIM,  __,     __,    HIC,  FLT,   __,    __,     __,     __  },
+    [LIM]  = {  LIM,   DIS,    LIM,   __,     LIM,  REG,    HIC,   HIC,  FLT,   __,    __,     __,     __  },
+    [FLT]  = {  __,    FLT,    FLT,   __,     __,   __,     __,    __,   FLT,   __,    __,     __,     OFF },
+    [HIC]  = {  __,    DIS,    HIC,   __,     __,   __,     __,    __,   FLT,   SOFT,  FLT,    __,     __  },
+    [DIS]  = {  SOFT,  DIS,    DIS,   __,     __,   __,     __,    __,   FLT,   __,    __,     OFF,    __  },
+};
+
+// Register image of each state; SR is the soft-start rate, the user's rate, or left alone while off
+#define SR_SOFT                         0
+#define SR_USER                         1
+
+static const struct {
+    uint8_t OE;
+    uint8_t DISCHG;
+    uint8_t SR;
+} images[TPS55289_OUTPUT_STATES] = {
+    [OFF]  = { 0, 0, OUTPUT_KEEP },
+    [SOFT] = { 1, 0, SR_SOFT },
+    [REG]  = { 1, 0, SR_USER },
+    [LIM]  = { 1, 0, SR_USER },
+    [FLT]  = { 0, 1, OUTPUT_KEEP },         // Hold VOUT discharged while latched
+    [HIC]  = { 0, 0, OUTPUT_KEEP },
+    [DIS]  = { 0, 1, OUTPUT_KEEP },
+};
+
+static const float slewRates[] = { 1.25f, 2.5f, 5.0f, 10.0f };     // in mV/us, by VOUT_SR.SR
+
+static uint32_t outputLock(TPS55289_OUTPUT *output){
+    return (output->lock != NULL) ? spin_lock_blocking(output->lock) : save_and_disable_interrupts();
+}
+
+static void outputUnlock(TPS55289_OUTPUT *output, uint32_t irq){
+    if (output->lock != NULL){
+        spin_unlock(output->lock, irq);
+    } else {
+        restore_interrupts(irq);
+    }
+}
+
+/*
+    Output Initialisation
+
+    Attaches the machine to an initialised device. The starting state follows the cached MODE.OE, and the
+    cached slew rate becomes the rate restored after every soft start.
+*/
+void TPS55289OutputInit(TPS55289_OUTPUT *output, TPS55289 *device){
+    spin_lock_t *lock = output->lock;
+    memset(output, 0, sizeof(*output));
+    output->lock         = (lock != NULL) ? lock : spin_lock_instance(spin_lock_claim_unused(true));
+    output->state        = device->TPS55289_MODE.OE ? TPS55289_OUTPUT_REGULATING : TPS55289_OUTPUT_OFF;
+    output->userSlewRate = device->TPS55289_VOUT_SR.SR;
+    output->pendingCode  = device->TPS55289_REF_VOLTAGE.regValue_16;
+    device->output       = output;
+}
+
+/*
+    Post
+
+    Queues an event from any task, core or interrupt. A full queue drops the event and counts it.
+*/
+_Bool TPS55289OutputPost(TPS55289_OUTPUT *output, uint8_t event){
+    _Bool STATUS = true;
+    if (event >= TPS55289_OUTPUT_EVENTS){
+        STATUS = false;
+        return STATUS;
+    }
+    uint32_t irq = outputLock(output);
+    if (output->head - output->tail >= TPS55289_OUTPUT_QUEUE){
+        output->stats.dropped++;
+        STATUS = false;
+    } else {
+        output->queue[output->head & (TPS55289_OUTPUT_QUEUE - 1)] = event;
+        output->head++;
+    }
+    outputUnlock(output, irq);
+    if (!STATUS){
+        TPS55289_LOG(OUTPUT_EVENT_DROPPED);
+    }
+    return STATUS;
+}
+
+// Writes a register if the wanted value differs from the cache; the cache only follows a successful write
+static _Bool writeIfChanged(TPS55289 *device, TPS55289_OUTPUT *output, uint8_t address, uint8_t cached,
+                            uint8_t wanted, uint8_t *writes){
+    if (cached == wanted){
+        return true;
+    }
+    (*writes)++;
+    if (TPS55289WriteRegister(device, address, wanted) != true){
+        output->stats.failures++;
+        return false;
+    }
+    return true;
+}
+
+static _Bool applyReference(TPS55289 *device, TPS55289_OUTPUT *output, uint16_t code, uint8_t *writes){
+    _Bool STATUS = true;
+    TPS55289_REF_VOLTAGE_REG *ref = &device->TPS55289_REF_VOLTAGE;
+    uint8_t lsb = (uint8_t)(code & 0xFF);
+    uint8_t msb = (uint8_t)((code >> 8) & 0xFF);
+
+    if (writeIfChanged(device, output, TPS55289_REF_VOLTAGE_LSB_ADDR, ref->VREF_LSB, lsb, writes)){
+        ref->VREF_LSB = lsb;
+    } else {
+        STATUS = false;
+    }
+    if (writeIfChanged(device, output, TPS55289_REF_VOLTAGE_MSB_ADDR, ref->VREF_MSB, msb, writes)){
+        ref->VREF_MSB = msb;
+    } else {
+        STATUS = false;
+    }
+    if (STATUS){
+        ref->regValue_16 = code;
+    }
+    return STATUS;
+}
+
+/*
+    Apply Image
+
+    OE and DISCHG share MODE, so a state change costs at most one MODE write plus one VOUT_SR write.
+*/
+static _Bool applyImage(TPS55289 *device, TPS55289_OUTPUT *output, uint8_t state, uint8_t *writes){
+    _Bool STATUS = true;
+    TPS55289_MODE_REG mode = device->TPS55289_MODE;
+    mode.OE     = images[state].OE;
+    mode.DISCHG = images[state].DISCHG;
+    if (writeIfChanged(device, output, TPS55289_MODE_ADDR, device->TPS55289_MODE.regValue, mode.regValue, writes)){
+        device->TPS55289_MODE.regValue = mode.regValue;
+    } else {
+        STATUS = false;
+    }
+
+    if (images[state].SR != OUTPUT_KEEP){
+        TPS55289_VOUT_SR_REG sr = device->TPS55289_VOUT_SR;
+        sr.SR = (images[state].SR == SR_SOFT) ? TPS55289_OUTPUT_SOFT_START_SR : output->userSlewRate;
+        if (writeIfChanged(device, output, TPS55289_VOUT_SR_ADDR, device->TPS55289_VOUT_SR.regValue, sr.regValue, writes)){
+            device->TPS55289_VOUT_SR.regValue = sr.regValue;
+            device->settings.slewRate = slewRates[sr.SR];
+            output->softActive = (images[state].SR == SR_SOFT);
+        } else {
+            STATUS = false;
+        }
+    }
+    return STATUS;
+}
+
+// Time for VOUT to ramp from zero at the soft-start rate, plus settling
+static uint64_t softStartTime(TPS55289 *device){
+    float mV = device->settings.VOUT * 1000.0f;
+    return (uint64_t)(mV / slewRates[TPS55289_OUTPUT_SOFT_START_SR]) + TPS55289_OUTPUT_SOFT_START_MARGIN;
+}
+
+// Entry actions: arm the state's timer and keep the retry count
+static void enterState(TPS55289 *device, TPS55289_OUTPUT *output, uint8_t state, uint8_t event, uint64_t now){
+    switch (state){
+    case TPS55289_OUTPUT_SOFT_START:
+        if (!output->softActive){
+            output->userSlewRate = device->TPS55289_VOUT_SR.SR;
+        }
+        output->deadline = now + softStartTime(device);
+        break;
+    case TPS55289_OUTPUT_LIMITING:
+        output->deadline = now + TPS55289_OUTPUT_LIMIT_TIMEOUT;
+        break;
+    case TPS55289_OUTPUT_HICCUP:
+        output->retries++;
+        output->deadline = now + TPS55289_OUTPUT_RETRY_DELAY;
+        break;
+    case TPS55289_OUTPUT_DISCHARGE:
+        output->deadline = now + TPS55289_OUTPUT_DISCHARGE_TIME;
+        break;
+    default:
+        break;
+    }
+    // A deliberate enable or clear starts a fresh run of hiccup retries, and so does a soft start that
+    // reaches regulation: only consecutive failed retries count towards FAULTED
+    if ((event == TPS55289_OUTPUT_EVENT_ENABLE) || (event == TPS55289_OUTPUT_EVENT_CLEAR) ||
+        ((state == TPS55289_OUTPUT_REGULATING) && (event == TPS55289_OUTPUT_EVENT_SOFT_START_DONE))){
+        output->retries = 0;
+    }
+}
+
+static _Bool step(TPS55289 *device, TPS55289_OUTPUT *output, uint8_t event){
+    _Bool STATUS = true;
+    uint8_t state = output->state;
+    uint8_t next = transitions[state][event];
+    uint8_t writes = 0;
+
+    if (next == OUTPUT_IGNORE){
+        output->stats.ignored++;
+        return STATUS;
+    }
+
+    uint64_t now = time_us_64();
+    if (event == TPS55289_OUTPUT_EVENT_SETPOINT){
+        STATUS = applyReference(device, output, output->pendingCode, &writes);
+        if (state == TPS55289_OUTPUT_SOFT_START){
+            output->deadline = now + softStartTime(device);
+        }
+    }
+    if (next != state){
+        enterState(device, output, next, event, now);
+    }
+    STATUS = applyImage(device, output, next, &writes) && STATUS;
+    output->state = next;
+
+    output->stats.transitions++;
+    output->stats.writes += writes;
+    output->stats.lastWrites = writes;
+    TPS55289StatePublish(device);
+    if (!STATUS){
+        TPS55289_LOG(FAILED_OUTPUT_TRANSITION);
+    }
+    if (next != state){
+        TPS55289_LOG_U32(OUTPUT_STATE, next);
+    }
+    return STATUS;
+}
+
+// Applies every queued event in order; the caller holds the device lock
+static _Bool drain(TPS55289 *device, TPS55289_OUTPUT *output){
+    _Bool STATUS = true;
+    output->processing = true;
+    for (;;){
+        uint32_t irq = outputLock(output);
+        if (output->tail == output->head){
+            outputUnlock(output, irq);
+            break;
+        }
+        uint8_t event = output->queue[output->tail & (TPS55289_OUTPUT_QUEUE - 1)];
+        output->tail++;
+        outputUnlock(output, irq);
+        STATUS = step(device, output, event) && STATUS;
+    }
+    output->processing = false;
+    return STATUS;
+}
+
+/*
+    Process
+
+    Applies queued events in order. Events are taken off the queue and applied under the device lock, so
+    a transition's cache updates are published whole and a caller that returns has seen every event
+    posted before it applied, by itself or by the task that held the lock. A call from inside a transition
+    leaves its events to the drain already running. A failed write leaves the cache untouched, so the
+    next event re-applies the image and retries it.
+*/
+_Bool TPS55289OutputProcess(TPS55289 *device){
+    _Bool STATUS = true;
+    TPS55289_OUTPUT *output = device->output;
+    if (output == NULL){
+        STATUS = false;
+        return STATUS;
+    }
+
+    TPS55289Lock(device);
+    if (!output->processing){
+        STATUS = drain(device, output);
+    }
+    TPS55289Unlock(device);
+    return STATUS;
+}
+
+/*
+    Request
+
+    Applies an event at once, after the events already queued, and returns its own outcome: fails if the
+    event was refused in the current state (ENABLE while FAULTED, for instance) or its writes failed.
+    Earlier events' failures are not reported here. From inside a transition the event is only queued.
+*/
+_Bool TPS55289OutputRequest(TPS55289 *device, uint8_t event){
+    _Bool STATUS = true;
+    TPS55289_OUTPUT *output = device->output;
+    if (event >= TPS55289_OUTPUT_EVENTS){
+        STATUS = false;
+        return STATUS;
+    }
+
+    TPS55289Lock(device);
+    if (output->processing){
+        TPS55289Unlock(device);
+        return TPS55289OutputPost(output, event);
+    }
+    drain(device, output);
+    STATUS = (transitions[output->state][event] != OUTPUT_IGNORE);
+    STATUS = step(device, output, event) && STATUS;
+    TPS55289Unlock(device);
+    return STATUS;
+}
+
+// New REF code; the output is not cycled
+_Bool TPS55289OutputSetpoint(TPS55289 *device, uint16_t code){
+    device->output->pendingCode = code;
+    return TPS55289OutputRequest(device, TPS55289_OUTPUT_EVENT_SETPOINT);
+}
+
+/*
+    Status
+
+    Turns a STATUS value into events, most severe first, so a read with several flags set costs one
+    transition and the rest are ignored by the state it lands in.
+*/
+_Bool TPS55289OutputStatus(TPS55289 *device, uint8_t status){
+    TPS55289_OUTPUT *output = device->output;
+    TPS55289_STATUS_REG flags = { .regValue = status };
+
+    if (flags.OVP){
+        TPS55289OutputPost(output, TPS55289_OUTPUT_EVENT_FAULT);
+    }
+    if (flags.SCP){
+        TPS55289OutputPost(output, TPS55289_OUTPUT_EVENT_SCP);
+    }
+    TPS55289OutputPost(output, flags.OCP ? TPS55289_OUTPUT_EVENT_OCP : TPS55289_OUTPUT_EVENT_OCP_CLEAR);
+    return TPS55289OutputProcess(device);
+}
+
+/*
+    Tick
+
+    Raises the timer event of the current state once its deadline has passed. Call from the task that
+    polls STATUS; the timers only need that resolution.
+*/
+_Bool TPS55289OutputTick(TPS55289 *device){
+    TPS55289_OUTPUT *output = device->output;
+    if (output == NULL){
+        return false;
+    }
+    if (time_us_64() >= output->deadline){
+        switch (output->state){
+        case TPS55289_OUTPUT_SOFT_START:
+            TPS55289OutputPost(output, TPS55289_OUTPUT_EVENT_SOFT_START_DONE);
+            break;
+        case TPS55289_OUTPUT_LIMITING:
+            TPS55289OutputPost(output, TPS55289_OUTPUT_EVENT_LIMIT_TIMEOUT);
+            break;
+        case TPS55289_OUTPUT_HICCUP:
+            TPS55289OutputPost(output, (output->retries > TPS55289_OUTPUT_MAX_RETRIES) ?
+                               TPS55289_OUTPUT_EVENT_RETRIES_EXHAUSTED : TPS55289_OUTPUT_EVENT_RETRY);
+            break;
+        case TPS55289_OUTPUT_DISCHARGE:
+            TPS55289OutputPost(output, TPS55289_OUTPUT_EVENT_DISCHARGED);
+            break;
+        default:
+            break;
+        }
+    }
+    return TPS55289OutputProcess(device);
+}
@@ -0,0 +1,245 @@
+// PIO I2C master transport for the TPS55289 driver
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/pio.h"
+
+#include "TPS55289_pio_i2c.h"
+#include "TPS55289_pio_i2c.pio.h"
+
+// The TX FIFO must see halfword writes: the bus replicates them into both halves, so the left-shifting
+// OSR finds the command word in bits 31:16 (the DMA channel uses 16-bit transfers for the same reason)
+static inline void putWord(PIO_I2C *bus, uint16_t word){
+    while (pio_sm_is_tx_fifo_full(bus->pio, bus->sm)){
+        tight_loop_contents();
+    }
+    *(io_rw_16 *)&bus->pio->txf[bus->sm] = word;
+}
+
+static inline uint32_t txStallMask(PIO_I2C *bus){
+    return 1u << (PIO_FDEBUG_TXSTALL_LSB + bus->sm);
+}
+
+/*
+    PIO I2C Initialisation
+
+    SCL must be SDA + 1 (the program waits on SCL relative to the SDA input base). The clock divider is
+    derived from clk_sys at this point; if the power manager later clocks down, the bus runs
+    proportionally slower and stays inside the I2C timing limits.
+*/
+_Bool pioI2CInit(PIO_I2C *bus, PIO pio, uint sda, uint scl, uint32_t baudrate){
+    _Bool STATUS = true;
+    if ((scl != sda + 1) || (pio_can_add_program(pio, &tps55289_i2c_program) == false)){
+        STATUS = false;
+        return STATUS;
+    }
+
+    int sm = pio_claim_unused_sm(pio, false);
+    int txChannel = dma_claim_unused_channel(false);
+    int rxChannel = dma_claim_unused_channel(false);
+    if ((sm < 0) || (txChannel < 0) || (rxChannel < 0)){
+        if (sm >= 0){
+            pio_sm_unclaim(pio, (uint)sm);
+        }
+        if (txChannel >= 0){
+            dma_channel_unclaim((uint)txChannel);
+        }
+        if (rxChannel >= 0){
+            dma_channel_unclaim((uint)rxChannel);
+        }
+        STATUS = false;
+        return STATUS;
+    }
+
+    memset(bus, 0, sizeof(*bus));
+    bus->pio       = pio;
+    bus->sm        = (uint)sm;
+    bus->offset    = pio_add_program(pio, &tps55289_i2c_program);
+    bus->baudrate  = baudrate;
+    bus->txChannel = txChannel;
+    bus->rxChannel = rxChannel;
+    pioI2CStreamReset(&bus->stream);
+    recursive_mutex_init(&bus->lock);
+
+    pio_sm_config config = tps55289_i2c_program_get_default_config(bus->offset);
+    sm_config_set_out_pins(&config, sda, 1);
+    sm_config_set_set_pins(&config, sda, 1);
+    sm_config_set_in_pins(&config, sda);
+    sm_config_set_sideset_pins(&config, scl);
+    sm_config_set_jmp_pin(&config, sda);
+    sm_config_set_out_shift(&config, false, true, 16);
+    sm_config_set_in_shift(&config, false, true, 8);
+    sm_config_set_clkdiv(&config, (float)clock_get_hz(clk_sys) / ((float)PIO_I2C_CYCLES_PER_BIT * baudrate));
+
+    // Lines released before the pads are handed to the PIO, then output values parked at 0
+    uint32_t pins = (1u << sda) | (1u << scl);
+    gpio_pull_up(sda);
+    gpio_pull_up(scl);
+    pio_sm_set_pins_with_mask(pio, bus->sm, pins, pins);
+    pio_sm_set_pindirs_with_mask(pio, bus->sm, pins, pins);
+    pio_gpio_init(pio, sda);
+    gpio_set_oeover(sda, GPIO_OVERRIDE_INVERT);
+    pio_gpio_init(pio, scl);
+    gpio_set_oeover(scl, GPIO_OVERRIDE_INVERT);
+    pio_sm_set_pins_with_mask(pio, bus->sm, 0, pins);
+
+    pio_sm_init(pio, bus->sm, bus->offset + tps55289_i2c_offset_entry_point, &config);
+    pio_sm_set_enabled(pio, bus->sm, true);
+
+    dma_channel_config txConfig = dma_channel_get_default_config(bus->txChannel);
+    channel_config_set_transfer_data_size(&txConfig, DMA_SIZE_16);
+    channel_config_set_read_increment(&txConfig, true);
+    channel_config_set_write_increment(&txConfig, false);
+    channel_config_set_dreq(&txConfig, pio_get_dreq(pio, bus->sm, true));
+    dma_channel_configure(bus->txChannel, &txConfig, &pio->txf[bus->sm], NULL, 0, false);
+
+    dma_channel_config rxConfig = dma_channel_get_default_config(bus->rxChannel);
+    channel_config_set_transfer_data_size(&rxConfig, DMA_SIZE_8);
+    channel_config_set_read_increment(&rxConfig, false);
+    channel_config_set_write_increment(&rxConfig, true);
+    channel_config_set_dreq(&rxConfig, pio_get_dreq(pio, bus->sm, false));
+    dma_channel_configure(bus->rxChannel, &rxConfig, bus->rx, &pio->rxf[bus->sm], 0, false);
+
+    return STATUS;
+}
+
+// Waits for the state machine to drain the TX FIFO and stall at the next pull
+static _Bool waitIdle(PIO_I2C *bus, uint64_t deadline){
+    bus->pio->fdebug = txStallMask(bus);
+    while ((bus->pio->fdebug & txStallMask(bus)) == 0){
+        if (time_us_64() > deadline){
+            return false;
+        }
+        tight_loop_contents();
+    }
+    return true;
+}
+
+/*
+    Error Recovery
+
+    After an unexpected NAK the state machine sits in irq wait with SCL low. Flush both directions,
+    restart it at the entry point, release the IRQ and put a STOP on the bus.
+*/
+static void recoverBus(PIO_I2C *bus){
+    dma_channel_abort(bus->txChannel);
+    dma_channel_abort(bus->rxChannel);
+    pio_sm_set_enabled(bus->pio, bus->sm, false);
+    pio_sm_clear_fifos(bus->pio, bus->sm);
+    pio_sm_restart(bus->pio, bus->sm);
+    pio_sm_exec(bus->pio, bus->sm, pio_encode_jmp(bus->offset + tps55289_i2c_offset_entry_point));
+    pio_interrupt_clear(bus->pio, bus->sm);
+    pio_sm_set_enabled(bus->pio, bus->sm, true);
+
+    PIO_I2C_STREAM stop;
+    pioI2CStreamReset(&stop);
+    pioI2CEncodeStop(&stop);
+    for (uint16_t i = 0; i < stop.count; i++){
+        putWord(bus, stop.words[i]);
+    }
+    waitIdle(bus, time_us_64() + PIO_I2C_TIMEOUT_MARGIN_US);
+}
+
+/*
+    Run Stream
+
+    Hands the pre-assembled stream to DMA; the CPU is not involved again until the last byte. One byte
+    per data word lands in bus->rx. Returns the number of RX bytes, or PICO_ERROR_GENERIC on an
+    unexpected NAK and PICO_ERROR_TIMEOUT if the bus stalls (clock held low).
+*/
+int pioI2CRun(PIO_I2C *bus, PIO_I2C_STREAM *stream){
+    if (stream->overflow){
+        return PICO_ERROR_GENERIC;
+    }
+    if (stream->count == 0){
+        return 0;
+    }
+
+    uint64_t streamUs = ((uint64_t)pioI2CStreamCycles(stream) * 1000000) / ((uint64_t)PIO_I2C_CYCLES_PER_BIT * bus->baudrate);
+    uint64_t deadline = time_us_64() + 2 * streamUs + PIO_I2C_TIMEOUT_MARGIN_US;
+
+    if (stream->bytes > 0){
+        dma_channel_set_write_addr(bus->rxChannel, bus->rx, false);
+        dma_channel_set_trans_count(bus->rxChannel, stream->bytes, true);
+    }
+    dma_channel_set_read_addr(bus->txChannel, stream->words, false);
+    dma_channel_set_trans_count(bus->txChannel, stream->count, true);
+
+    // TX DMA done means every word is in the FIFO; only then is a TX stall the end of the stream
+    while (dma_channel_is_busy(bus->txChannel) || dma_channel_is_busy(bus->rxChannel)){
+        if (pio_interrupt_get(bus->pio, bus->sm)){
+            bus->naks++;
+            recoverBus(bus);
+            return PICO_ERROR_GENERIC;
+        }
+        if (time_us_64() > deadline){
+            bus->timeouts++;
+            recoverBus(bus);
+            return PICO_ERROR_TIMEOUT;
+        }
+        tight_loop_contents();
+    }
+    if (waitIdle(bus, deadline) == false){
+        bus->timeouts++;
+        recoverBus(bus);
+        return PICO_ERROR_TIMEOUT;
+    }
+    return stream->bytes;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Transport
+
+// Runs the pending stream; the bus stays claimed across runs if the last transaction had nostop set
+static int flushStream(PIO_I2C *bus){
+    int result = pioI2CRun(bus, &bus->stream);
+    _Bool claimed = (result >= 0) && bus->stream.claimed;
+    pioI2CStreamReset(&bus->stream);
+    bus->stream.claimed = claimed;
+    return result;
+}
+
+/*
+    A write with nostop only encodes; it goes out with the next transaction (normally the read of a
+    register pointer write). A NAK in that write is then reported by the read.
+*/
+static int pioI2CWrite(void *context, uint8_t address, const uint8_t *src, size_t len, _Bool nostop){
+    PIO_I2C *bus = (PIO_I2C *)context;
+    if (pioI2CEncodeWrite(&bus->stream, address, src, len, nostop) == false){
+        pioI2CStreamReset(&bus->stream);
+        return PICO_ERROR_GENERIC;
+    }
+    if (nostop){
+        return (int)len;
+    }
+    int result = flushStream(bus);
+    return (result < 0) ? result : (int)len;
+}
+
+static int pioI2CRead(void *context, uint8_t address, uint8_t *dst, size_t len, _Bool nostop){
+    PIO_I2C *bus = (PIO_I2C *)context;
+    if (pioI2CEncodeRead(&bus->stream, address, len, nostop) == false){
+        pioI2CStreamReset(&bus->stream);
+        return PICO_ERROR_GENERIC;
+    }
+    uint16_t offset = bus->stream.readOffset;
+    int result = flushStream(bus);
+    if (result < 0){
+        return result;
+    }
+    memcpy(dst, &bus->rx[offset], len);
+    return (int)len;
+}
+
+// Fills a transport for device.transport; selectable per device alongside TPS55289_I2C0_TRANSPORT
+void pioI2CTransportInit(TPS55289_TRANSPORT *transport, PIO_I2C *bus){
+    transport->write      = pioI2CWrite;
+    transport->read       = pioI2CRead;
+    transport->context    = bus;
+    transport->writeStart = NULL;       // Blocking only; the tracking coordinator falls back to write
+    transport->writePoll  = NULL;
+    transport->lock       = &bus->lock;
+}
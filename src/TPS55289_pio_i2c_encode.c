@@ -0,0 +1,142 @@
+// Command stream encoder for the PIO I2C master; no hardware access, builds on the host as well
+#include "pico/stdlib.h"
+
+#include "TPS55289_pio_i2c_encode.h"
+
+// Line sequences, one quarter SCL period per step, starting and ending with SCL low except from idle
+static const uint16_t startSequence[] = {
+    PIO_I2C_INSTR_SET(1, 0),            // SDA falls while SCL is high
+    PIO_I2C_INSTR_SET(0, 0),
+};
+
+static const uint16_t repeatedStartSequence[] = {
+    PIO_I2C_INSTR_SET(0, 1),
+    PIO_I2C_INSTR_SET(1, 1),
+    PIO_I2C_INSTR_SET(1, 0),            // SDA falls while SCL is high
+    PIO_I2C_INSTR_SET(0, 0),
+};
+
+static const uint16_t stopSequence[] = {
+    PIO_I2C_INSTR_SET(0, 0),
+    PIO_I2C_INSTR_SET(1, 0),
+    PIO_I2C_INSTR_SET(1, 1),            // SDA rises while SCL is high; bus idle
+};
+
+#define SEQUENCE(instructions)          (instructions), (uint16_t)(sizeof(instructions) / sizeof((instructions)[0]))
+
+static _Bool pushWord(PIO_I2C_STREAM *stream, uint16_t word){
+    if (stream->count >= PIO_I2C_MAX_WORDS){
+        stream->overflow = true;
+        return false;
+    }
+    stream->words[stream->count++] = word;
+    return true;
+}
+
+// Header word n, then n + 1 instructions; every sequence has at least two
+static _Bool pushSequence(PIO_I2C_STREAM *stream, const uint16_t *instructions, uint16_t count){
+    if (stream->count + 1 + count > PIO_I2C_MAX_WORDS){
+        stream->overflow = true;
+        return false;
+    }
+    stream->words[stream->count++] = (uint16_t)((count - 1) << PIO_I2C_WORD_COUNT_SHIFT);
+    for (uint16_t i = 0; i < count; i++){
+        stream->words[stream->count++] = instructions[i];
+    }
+    return true;
+}
+
+void pioI2CStreamReset(PIO_I2C_STREAM *stream){
+    stream->count      = 0;
+    stream->bytes      = 0;
+    stream->readOffset = 0;
+    stream->readLength = 0;
+    stream->claimed    = false;
+    stream->overflow   = false;
+}
+
+// START from idle, or repeated START if the previous transaction kept the bus
+_Bool pioI2CEncodeStart(PIO_I2C_STREAM *stream){
+    _Bool STATUS = true;
+    if (stream->claimed){
+        STATUS = pushSequence(stream, SEQUENCE(repeatedStartSequence));
+    } else {
+        STATUS = pushSequence(stream, SEQUENCE(startSequence));
+    }
+    stream->claimed = true;
+    return STATUS;
+}
+
+_Bool pioI2CEncodeStop(PIO_I2C_STREAM *stream){
+    stream->claimed = false;
+    return pushSequence(stream, SEQUENCE(stopSequence));
+}
+
+// Written byte: the target must ACK, so a NAK halts the state machine
+_Bool pioI2CEncodeByte(PIO_I2C_STREAM *stream, uint8_t data){
+    stream->bytes++;
+    return pushWord(stream, (uint16_t)((data << PIO_I2C_WORD_DATA_SHIFT) | PIO_I2C_WORD_ACK_RELEASE));
+}
+
+// Read byte: SDA released for the data bits; ACK from us, except NAK on the last byte
+_Bool pioI2CEncodeReadByte(PIO_I2C_STREAM *stream, _Bool last){
+    uint16_t word = (uint16_t)(0xFF << PIO_I2C_WORD_DATA_SHIFT);
+    if (last){
+        word |= PIO_I2C_WORD_FINAL | PIO_I2C_WORD_ACK_RELEASE;
+    }
+    stream->bytes++;
+    return pushWord(stream, word);
+}
+
+/*
+    Transactions
+
+    Same contract as i2c_write_blocking/i2c_read_blocking: 7-bit address, nostop leaves the bus claimed
+    so the next transaction in the stream opens with a repeated START.
+*/
+_Bool pioI2CEncodeWrite(PIO_I2C_STREAM *stream, uint8_t address, const uint8_t *src, size_t len, _Bool nostop){
+    _Bool STATUS = pioI2CEncodeStart(stream) && pioI2CEncodeByte(stream, (uint8_t)(address << 1));
+    for (size_t i = 0; (i < len) && STATUS; i++){
+        STATUS = pioI2CEncodeByte(stream, src[i]);
+    }
+    if (STATUS && !nostop){
+        STATUS = pioI2CEncodeStop(stream);
+    }
+    return STATUS;
+}
+
+_Bool pioI2CEncodeRead(PIO_I2C_STREAM *stream, uint8_t address, size_t len, _Bool nostop){
+    if (len == 0){
+        return false;
+    }
+    _Bool STATUS = pioI2CEncodeStart(stream) && pioI2CEncodeByte(stream, (uint8_t)((address << 1) | 1));
+    stream->readOffset = stream->bytes;
+    stream->readLength = (uint16_t)len;
+    for (size_t i = 0; (i < len) && STATUS; i++){
+        STATUS = pioI2CEncodeReadByte(stream, i == (len - 1));
+    }
+    if (STATUS && !nostop){
+        STATUS = pioI2CEncodeStop(stream);
+    }
+    return STATUS;
+}
+
+/*
+    Stream Duration
+
+    State machine cycles to run the stream, assuming the target never stretches SCL. The stream is fixed
+    once encoded, so this is also the bus time: cycles / (PIO_I2C_CYCLES_PER_BIT * baudrate).
+*/
+uint32_t pioI2CStreamCycles(const PIO_I2C_STREAM *stream){
+    uint32_t cycles = 0;
+    for (uint16_t i = 0; i < stream->count; i++){
+        uint16_t instructions = stream->words[i] >> PIO_I2C_WORD_COUNT_SHIFT;
+        if (instructions == 0){
+            cycles += PIO_I2C_CYCLES_PER_BYTE;
+        } else {
+            cycles += PIO_I2C_CYCLES_PER_SEQUENCE + (instructions + 1) * PIO_I2C_CYCLES_PER_INSTRUCTION;
+            i += instructions + 1;
+        }
+    }
+    return cycles;
+}
@@ -0,0 +1,243 @@
+// Safe Operating Area (SOA) and Over-Temperature Protection for the TPS55289 Buck-Boost Converter
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_protection.h"
+#include "TPS55289_log.h"
+#include "TPS55289_output.h"
+
+/*
+    SOA Table
+
+    Maximum continuous IOUT in mA at 25 degC ambient, indexed by [STATUS mode][VIN bin][VOUT bin].
+    Each entry is the lower of the switch current limit and the package dissipation limit:
+        Inductor current  I_L = k * IOUT      k = 1 (Buck), VOUT/VIN (Boost), (VIN+VOUT)/VIN (Buck-Boost)
+        Switch limit      I_L <= 14A          16.5A typical minus ripple margin
+        Dissipation       40mOhm * I_L^2 + 3% * VOUT * IOUT <= 3W
+    clamped to the 6.35A full scale of IOUT_LIMIT. VIN is clamped to 3V and VOUT to 0.8V when evaluating
+    the model, so the lowest bins repeat the first valid operating point.
+*/
+static const uint16_t TPS55289_SOA_TABLE[TPS55289_SOA_MODES][TPS55289_SOA_VIN_POINTS][TPS55289_SOA_VOUT_POINTS] = {
+    {   // Boost
+        {6350, 6350, 5572, 3714, 2786, 2228, 1857, 1592, 1393, 1238, 1114, 1013},   // VIN =  0.00 V
+        {6350, 6350, 5572, 3714, 2786, 2228, 1857, 1592, 1393, 1238, 1114, 1013},   // VIN =  2.05 V
+        {6350, 6350, 6350, 4839, 3629, 2903, 2419, 2074, 1814, 1613, 1451, 1319},   // VIN =  4.10 V
+        {6350, 6350, 6350, 6350, 4993, 3994, 3328, 2853, 2496, 2219, 1997, 1815},   // VIN =  6.14 V
+        {6350, 6350, 6350, 6350, 6116, 4893, 4077, 3495, 3058, 2718, 2446, 2224},   // VIN =  8.19 V
+        {6350, 6350, 6350, 6350, 6350, 5633, 4694, 4023, 3520, 3129, 2816, 2560},   // VIN = 10.24 V
+        {6350, 6350, 6350, 6350, 6350, 6242, 5201, 4458, 3901, 3467, 3121, 2837},   // VIN = 12.29 V
+        {6350, 6350, 6350, 6350, 6350, 6350, 5620, 4817, 4215, 3746, 3372, 3065},   // VIN = 14.34 V
+        {6350, 6350, 6350, 6350, 6350, 6350, 5965, 5113, 4474, 3977, 3579, 3254},   // VIN = 16.38 V
+        {6350, 6350, 6350, 6350, 6350, 6350, 6252, 5359, 4689, 4168, 3751, 3410},   // VIN = 18.43 V
+        {6350, 6350, 6350, 6350, 6350, 6350, 6350, 5564, 4868, 4327, 3895, 3540},   // VIN = 20.48 V
+        {6350, 6350, 6350, 6350, 6350, 6350, 6350, 5736, 5019, 4461, 4015, 3650},   // VIN = 22.53 V
+        {6350, 6350, 6350, 6350, 6350, 6350, 6350, 5880, 5145, 4574, 4116, 3742},   // VIN = 24.58 V
+        {6350, 6350, 6350, 6350, 6350, 6350, 6350, 6003, 5253, 4669, 4202, 3820},   // VIN = 26.62 V
+        {6350, 6350, 6350, 6350, 6350, 6350, 6350, 6107, 5344, 4750, 4275, 3886},   // VIN = 28.67 V
+        {6350, 6350, 6350, 6350, 6350, 6350, 6350, 6197, 5422, 4820, 4338, 3943},   // VIN = 30.72 V
+    },
+    {   // Buck
+        {6350, 6350, 6350, 6350, 6116, 5633, 5201, 4817, 4474, 4168, 3895, 3650},   // VIN =  0.00 V
+        {6350, 6350, 6350, 6350, 6116, 5633, 5201, 4817, 4474, 4168, 3895, 3650},   // VIN =  2.05 V
+        {6350, 6350, 6350, 6350, 6116, 5633, 5201, 4817, 4474, 4168, 3895, 3650},   // VIN =  4.10 V
+        {6350, 6350, 6350, 6350, 6116, 5633, 5201, 4817, 4474, 4168, 3895, 3650},   // VIN =  6.14 V
+        {6350, 6350, 6350, 6350, 6116, 5633, 5201, 4817, 4474, 4168, 3895, 3650},   // VIN =  8.19 V
+        {6350, 6350, 6350, 6350, 6116, 5633, 5201, 4817, 4474, 4168, 3895, 3650},   // VIN = 10.24 V
+        {6350, 6350, 6350, 6350, 6116, 5633, 5201, 4817, 4474, 4168, 3895, 3650},   // VIN = 12.29 V
+        {6350, 6350, 6350, 6350, 6116, 5633, 5201, 4817, 4474, 4168, 3895, 3650},   // VIN = 14.34 V
+        {6350, 6350, 6350, 6350, 6116, 5633, 5201, 4817, 4474, 4168, 3895, 3650},   // VIN = 16.38 V
+        {6350, 6350, 6350, 6350, 6116, 5633, 5201, 4817, 4474, 4168, 3895, 3650},   // VIN = 18.43 V
+        {6350, 6350, 6350, 6350, 6116, 5633, 5201, 4817, 4474, 4168, 3895, 3650},   // VIN = 20.48 V
+        {6350, 6350, 6350, 6350, 6116, 5633, 5201, 4817, 4474, 4168, 3895, 3650},   // VIN = 22.53 V
+        {6350, 6350, 6350, 6350, 6116, 5633, 5201, 4817, 4474, 4168, 3895, 3650},   // VIN = 24.58 V
+        {6350, 6350, 6350, 6350, 6116, 5633, 5201, 4817, 4474, 4168, 3895, 3650},   // VIN = 26.62 V
+        {6350, 6350, 6350, 6350, 6116, 5633, 5201, 4817, 4474, 4168, 3895, 3650},   // VIN = 28.67 V
+        {6350, 6350, 6350, 6350, 6116, 5633, 5201, 4817, 4474, 4168, 3895, 3650},   // VIN = 30.72 V
+    },
+    {   // Buck-Boost
+        {6350, 4882, 3397, 2604, 2111, 1775, 1531, 1346, 1201, 1084,  988,  907},   // VIN =  0.00 V
+        {6350, 4882, 3397, 2604, 2111, 1775, 1531, 1346, 1201, 1084,  988,  907},   // VIN =  2.05 V
+        {6350, 5442, 3963, 3115, 2565, 2180, 1896, 1677, 1503, 1362, 1245, 1147},   // VIN =  4.10 V
+        {6350, 6077, 4672, 3792, 3189, 2752, 2419, 2158, 1948, 1775, 1630, 1507},   // VIN =  6.14 V
+        {6350, 6350, 5131, 4253, 3629, 3164, 2804, 2517, 2283, 2089, 1925, 1785},   // VIN =  8.19 V
+        {6350, 6350, 5451, 4586, 3955, 3475, 3097, 2793, 2543, 2334, 2156, 2004},   // VIN = 10.24 V
+        {6350, 6350, 5688, 4839, 4206, 3717, 3328, 3012, 2750, 2530, 2342, 2180},   // VIN = 12.29 V
+        {6350, 6350, 5870, 5037, 4405, 3911, 3514, 3189, 2919, 2690, 2494, 2324},   // VIN = 14.34 V
+        {6350, 6350, 6014, 5196, 4567, 4070, 3667, 3336, 3058, 2822, 2620, 2444},   // VIN = 16.38 V
+        {6350, 6350, 6131, 5327, 4701, 4202, 3795, 3458, 3175, 2934, 2726, 2545},   // VIN = 18.43 V
+        {6350, 6350, 6228, 5436, 4814, 4313, 3904, 3563, 3275, 3029, 2816, 2631},   // VIN = 20.48 V
+        {6350, 6350, 6310, 5529, 4910, 4409, 3997, 3652, 3360, 3110, 2894, 2705},   // VIN = 22.53 V
+        {6350, 6350, 6350, 5608, 4993, 4492, 4077, 3730, 3435, 3182, 2962, 2770},   // VIN = 24.58 V
+        {6350, 6350, 6350, 5677, 5065, 4564, 4148, 3798, 3500, 3244, 3021, 2826},   // VIN = 26.62 V
+        {6350, 6350, 6350, 5738, 5129, 4628, 4211, 3859, 3558, 3299, 3074, 2876},   // VIN = 28.67 V
+        {6350, 6350, 6350, 5792, 5185, 4684, 4266, 3912, 3610, 3348, 3121, 2921},   // VIN = 30.72 V
+    },
+};
+
+/*
+    NTC Thermistor Table
+
+    Temperature in 0.1 degC for a 10k B3950 NTC on the low side of a 10k divider from 3V3, sampled at
+    ADC codes 0, 256, 512 ... 4096. Codes are interpolated linearly between entries.
+*/
+static const int16_t TPS55289_THERMISTOR_TABLE[(4096 >> TPS55289_THERMISTOR_SHIFT) + 1] = {
+    1500, 1016,  763,  621,  520,  439,  370,  308,  250,  194,  139,   83,   22,  -47, -132, -256, -400
+};
+
+void TPS55289ProtectionInit(TPS55289_PROTECTION *protection, uint16_t userCurrentLimit){
+    if (userCurrentLimit > TPS55289_CURRENT_LIMIT_MAX){
+        userCurrentLimit = TPS55289_CURRENT_LIMIT_MAX;
+    }
+    protection->userCurrentLimit    = userCurrentLimit;
+    protection->appliedCurrentLimit = userCurrentLimit;
+    protection->targetCurrentLimit  = userCurrentLimit;
+    protection->soaCurrentLimit     = TPS55289_CURRENT_LIMIT_MAX;
+    protection->temperature         = 250;
+    protection->overSOASamples      = 0;
+    protection->derateEvents        = 0;
+    protection->soaTrips            = 0;
+    protection->overTempTrips       = 0;
+}
+
+/*
+    SOA Lookup
+
+    Bilinear interpolation over the SOA table using integer math only. The bin index is the top bits of the
+    millivolt value and the fraction the low TPS55289_SOA_BIN_SHIFT bits, so no division is needed.
+*/
+uint16_t TPS55289SOALimit(uint8_t mode, uint16_t VIN, uint16_t VOUT){
+    const uint32_t vinMax  = ((TPS55289_SOA_VIN_POINTS - 1) << TPS55289_SOA_BIN_SHIFT) - 1;
+    const uint32_t voutMax = ((TPS55289_SOA_VOUT_POINTS - 1) << TPS55289_SOA_BIN_SHIFT) - 1;
+    const int32_t  fracMask = (1 << TPS55289_SOA_BIN_SHIFT) - 1;
+
+    if (mode >= TPS55289_SOA_MODES){
+        mode = 2;           // Reserved status; use the Buck-Boost row which is the most conservative
+    }
+    uint32_t vin  = (VIN > vinMax) ? vinMax : VIN;
+    uint32_t vout = (VOUT > voutMax) ? voutMax : VOUT;
+
+    uint32_t i = vin >> TPS55289_SOA_BIN_SHIFT;
+    uint32_t j = vout >> TPS55289_SOA_BIN_SHIFT;
+    int32_t  fi = vin & fracMask;
+    int32_t  fj = vout & fracMask;
+
+    const uint16_t *row0 = TPS55289_SOA_TABLE[mode][i];
+    const uint16_t *row1 = TPS55289_SOA_TABLE[mode][i + 1];
+
+    int32_t lo = row0[j] + (((row0[j + 1] - row0[j]) * fj) >> TPS55289_SOA_BIN_SHIFT);
+    int32_t hi = row1[j] + (((row1[j + 1] - row1[j]) * fj) >> TPS55289_SOA_BIN_SHIFT);
+
+    return (uint16_t)(lo + (((hi - lo) * fi) >> TPS55289_SOA_BIN_SHIFT));
+}
+
+int16_t TPS55289ThermistorTemperature(uint16_t thermistor){
+    const int32_t fracMask = (1 << TPS55289_THERMISTOR_SHIFT) - 1;
+
+    if (thermistor > 4095){
+        thermistor = 4095;
+    }
+    uint32_t i = thermistor >> TPS55289_THERMISTOR_SHIFT;
+    int32_t  f = thermistor & fracMask;
+    int32_t  t0 = TPS55289_THERMISTOR_TABLE[i];
+    int32_t  t1 = TPS55289_THERMISTOR_TABLE[i + 1];
+
+    return (int16_t)(t0 + (((t1 - t0) * f) >> TPS55289_THERMISTOR_SHIFT));
+}
+
+/*
+    Thermal Derating
+
+    Linear derating from the full SOA limit at TPS55289_DERATE_START_TEMP down to zero at TPS55289_SHUTDOWN_TEMP
+*/
+uint16_t TPS55289ThermalDerate(uint16_t currentLimit, int16_t temperature){
+    if (temperature <= TPS55289_DERATE_START_TEMP){
+        return currentLimit;
+    }
+    if (temperature >= TPS55289_SHUTDOWN_TEMP){
+        return 0;
+    }
+    return (uint16_t)(((uint32_t)currentLimit * (uint32_t)(TPS55289_SHUTDOWN_TEMP - temperature)) /
+                      (TPS55289_SHUTDOWN_TEMP - TPS55289_DERATE_START_TEMP));
+}
+
+/*
+    Protection Evaluation
+
+    Pure computation on one sample; no bus traffic. Meant to be called every control tick.
+    Returns the action the caller must take. For DERATE/RESTORE the new limit is in targetCurrentLimit.
+*/
+TPS55289_PROTECTION_ACTION TPS55289ProtectionEvaluate(TPS55289_PROTECTION *protection, uint8_t mode, const TPS55289_PROTECTION_SAMPLE *sample){
+    uint16_t limit = TPS55289SOALimit(mode, sample->VIN, sample->VOUT);
+
+    if (sample->thermistorValid){
+        protection->temperature = TPS55289ThermistorTemperature(sample->thermistor);
+        if (protection->temperature >= TPS55289_SHUTDOWN_TEMP){
+            protection->soaCurrentLimit = 0;
+            protection->overTempTrips++;
+            return TPS55289_PROTECTION_OVERTEMP;
+        }
+        limit = TPS55289ThermalDerate(limit, protection->temperature);
+    }
+    protection->soaCurrentLimit = limit;
+
+    // IOUT beyond the SOA means the current limit did not hold (or is disabled); trip after a short filter
+    if (sample->IOUT > limit){
+        if (++protection->overSOASamples >= TPS55289_SOA_TRIP_SAMPLES){
+            protection->overSOASamples = 0;
+            protection->soaTrips++;
+            return TPS55289_PROTECTION_SOA_TRIP;
+        }
+    } else {
+        protection->overSOASamples = 0;
+    }
+
+    // Current limit follows the lower of the user setting and the derated SOA, in whole IOUT_LIMIT codes
+    uint16_t target = (limit < protection->userCurrentLimit) ? limit : protection->userCurrentLimit;
+    target = (target / TPS55289_CURRENT_LIMIT_STEP) * TPS55289_CURRENT_LIMIT_STEP;
+
+    if (target < protection->appliedCurrentLimit){
+        protection->targetCurrentLimit = target;
+        protection->derateEvents++;
+        return TPS55289_PROTECTION_DERATE;
+    }
+    if ((target > protection->appliedCurrentLimit) &&
+        (limit >= protection->appliedCurrentLimit + TPS55289_RESTORE_HYSTERESIS)){
+        protection->targetCurrentLimit = target;
+        return TPS55289_PROTECTION_RESTORE;
+    }
+    return TPS55289_PROTECTION_NONE;
+}
+
+/*
+    Protection Tick
+
+    Evaluates one sample against the operating mode last read from STATUS and applies the result on the device.
+    Only issues bus writes when the current limit actually changes or the output has to be shut down.
+    With the output state machine attached a shutdown latches FAULTED until cleared.
+*/
+_Bool TPS55289ProtectionTick(TPS55289 *device, TPS55289_PROTECTION *protection, const TPS55289_PROTECTION_SAMPLE *sample){
+    _Bool STATUS = true;
+    switch (TPS55289ProtectionEvaluate(protection, device->TPS55289_STATUS.STATUS, sample))
+    {
+    case TPS55289_PROTECTION_DERATE:
+    case TPS55289_PROTECTION_RESTORE:
+        STATUS = setOutputCurrentLimit(device, protection->targetCurrentLimit / 1000.0f);
+        if (STATUS){
+            protection->appliedCurrentLimit = protection->targetCurrentLimit;
+        }
+        break;
+    case TPS55289_PROTECTION_SOA_TRIP:
+        TPS55289_LOG(SOA_VIOLATION_DETECTED);
+        STATUS = (device->output != NULL) ? TPS55289OutputRequest(device, TPS55289_OUTPUT_EVENT_FAULT) :
+                                            disableDevice(device);
+        break;
+    case TPS55289_PROTECTION_OVERTEMP:
+        TPS55289_LOG(OVER_TEMPERATURE_DETECTED);
+        STATUS = (device->output != NULL) ? TPS55289OutputRequest(device, TPS55289_OUTPUT_EVENT_FAULT) :
+                                            disableDevice(device);
+        break;
+    default:
+        break;
+    }
+    return STATUS;
+}
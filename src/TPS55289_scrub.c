@@ -0,0 +1,124 @@
+// Register scrubber for the TPS55289 Buck-Boost Converter: read-back of the register map against the driver cache
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_log.h"
+#include "TPS55289_scrub.h"
+#include "TPS55289_state.h"
+
+/*
+    Scrubber Initialisation
+
+    Builds the compare masks from the register structures, so only defined fields count as drift and
+    reserved bits may read back as the part pleases.
+*/
+void TPS55289ScrubInit(TPS55289_SCRUB *scrub){
+    memset(scrub, 0, sizeof(*scrub));
+
+    TPS55289_VOUT_SR_REG sr  = { .regValue = 0 };
+    TPS55289_VOUT_FS_REG fs  = { .regValue = 0 };
+    TPS55289_CDC_REG cdc     = { .regValue = 0 };
+    TPS55289_MODE_REG mode   = { .regValue = 0 };
+    sr.OCP_DELAY   = 0b11;
+    sr.SR          = 0b11;
+    fs.FB          = 0b1;
+    fs.INTFB       = 0b11;
+    cdc.SC_MASK    = 0b1;
+    cdc.OCP_MASK   = 0b1;
+    cdc.OVP_MASK   = 0b1;
+    cdc.CDC_OPTION = 0b1;
+    cdc.CDC        = 0b111;
+    mode.OE        = 0b1;
+    mode.FSWDBL    = 0b1;
+    mode.HICCUP    = 0b1;
+    mode.DISCHG    = 0b1;
+    mode.FPWM      = 0b1;
+
+    scrub->mask[TPS55289_REF_VOLTAGE_LSB_ADDR] = 0xFF;
+    scrub->mask[TPS55289_REF_VOLTAGE_MSB_ADDR] = 0x07;      // 11-bit REF code
+    scrub->mask[TPS55289_IOUT_LIMIT_ADDR]      = 0xFF;
+    scrub->mask[TPS55289_VOUT_SR_ADDR]         = sr.regValue;
+    scrub->mask[TPS55289_VOUT_FS_ADDR]         = fs.regValue;
+    scrub->mask[TPS55289_CDC_ADDR]             = cdc.regValue;
+    scrub->mask[TPS55289_MODE_ADDR]            = mode.regValue;
+}
+
+// Register map the driver believes is in the device, indexed by address
+void TPS55289ScrubShadow(const TPS55289 *device, uint8_t *shadow){
+    shadow[TPS55289_REF_VOLTAGE_LSB_ADDR] = device->TPS55289_REF_VOLTAGE.VREF_LSB;
+    shadow[TPS55289_REF_VOLTAGE_MSB_ADDR] = device->TPS55289_REF_VOLTAGE.VREF_MSB;
+    shadow[TPS55289_IOUT_LIMIT_ADDR]      = device->TPS55289_IOUT_LIMIT.regValue;
+    shadow[TPS55289_VOUT_SR_ADDR]         = device->TPS55289_VOUT_SR.regValue;
+    shadow[TPS55289_VOUT_FS_ADDR]         = device->TPS55289_VOUT_FS.regValue;
+    shadow[TPS55289_CDC_ADDR]             = device->TPS55289_CDC.regValue;
+    shadow[TPS55289_MODE_ADDR]            = device->TPS55289_MODE.regValue;
+}
+
+/*
+    Scrub
+
+    One burst read of 0x00 - 0x07, then a write for each register whose defined bits differ from the
+    cache, in address order so MODE (and with it OE) is restored last, all under one hold of the device
+    lock. The cache is never changed: a register another task is updating at the same time can only be
+    rewritten with its new value.
+    STATUS goes into the cache; reading it cleared the latched fault flags, so any that were set are
+    handled here rather than lost. Drift that leaves every register at TPS55289DefaultValues, the values
+    TPS55289Init writes, is counted as a chip reset.
+*/
+TPS55289_SCRUB_RESULT TPS55289Scrub(TPS55289 *device, TPS55289_SCRUB *scrub){
+    TPS55289_SCRUB_RESULT result = TPS55289_SCRUB_CLEAN;
+    uint8_t shadow[TPS55289_SCRUB_WRITABLE];
+    uint32_t drifted = 0;
+    _Bool reset = true;
+
+    scrub->scrubs++;
+    TPS55289Lock(device);
+    if (TPS55289ReadRegisters(device, TPS55289_REF_VOLTAGE_LSB_ADDR, scrub->lastRead, TPS55289_SCRUB_REGISTERS) != true){
+        TPS55289Unlock(device);
+        scrub->readFailures++;
+        TPS55289_LOG(FAILED_SCRUB_READ);
+        return TPS55289_SCRUB_FAILED;
+    }
+    device->TPS55289_STATUS.regValue = scrub->lastRead[TPS55289_STATUS_ADDR];
+    TPS55289StatePublish(device);
+
+    TPS55289ScrubShadow(device, shadow);
+    for (uint32_t i = 0; i < TPS55289_SCRUB_WRITABLE; i++){
+        if ((scrub->lastRead[i] ^ shadow[i]) & scrub->mask[i]){
+            drifted |= 1u << i;
+            scrub->drift[i]++;
+        }
+        reset = reset && !((scrub->lastRead[i] ^ TPS55289DefaultValues[i]) & scrub->mask[i]);
+    }
+
+    if (drifted != 0){
+        scrub->driftEvents++;
+        result = TPS55289_SCRUB_REPAIRED;
+        if (reset){
+            scrub->resets++;
+            result = TPS55289_SCRUB_RESET;
+            TPS55289_LOG(DEVICE_RESET_DETECTED);
+        } else {
+            TPS55289_LOG_U32(REGISTER_DRIFT_REPAIRED, drifted);
+        }
+        for (uint32_t i = 0; i < TPS55289_SCRUB_WRITABLE; i++){
+            if ((drifted & (1u << i)) == 0){
+                continue;
+            }
+            scrub->repairs++;
+            if (TPS55289WriteRegister(device, (uint8_t)i, shadow[i]) != true){
+                scrub->repairFailures++;
+                result = TPS55289_SCRUB_FAILED;
+                TPS55289_LOG(FAILED_REGISTER_REPAIR);
+            }
+        }
+    }
+
+    if (device->TPS55289_STATUS.SCP || device->TPS55289_STATUS.OCP || device->TPS55289_STATUS.OVP){
+        TPS55289HandleStatus(device);
+    }
+    TPS55289Unlock(device);
+    return result;
+}
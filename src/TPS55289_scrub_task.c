@@ -0,0 +1,38 @@
+// Background task that scrubs the TPS55289 register map at a low rate
+#include "pico/stdlib.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "TPS55289.h"
+#include "TPS55289_scrub.h"
+#include "power_manager.h"
+
+static TPS55289_SCRUB scrubState;
+static TPS55289 *scrubDevice;
+
+/*
+    Scrub Task Initialisation
+
+    device may be NULL: the task then only sleeps until a converter is attached.
+*/
+void TPS55289ScrubTaskInit(TPS55289 *device){
+    TPS55289ScrubInit(&scrubState);
+    scrubDevice = device;
+}
+
+/*
+    Scrub Task
+
+    Just above idle: one burst read per period costs well under a millisecond of bus time, and nothing
+    waits on it. The period stretches while the power manager has clocked down.
+*/
+void TPS55289ScrubTask(void *param){
+    (void)param;
+    for (;;){
+        if (scrubDevice != NULL){
+            TPS55289Scrub(scrubDevice, &scrubState);
+        }
+        vTaskDelay(powerManagerIsIdle() ? TPS55289_SCRUB_IDLE_PERIOD : TPS55289_SCRUB_PERIOD);
+    }
+}
@@ -0,0 +1,366 @@
+// Stackless driver sequences for the TPS55289 Buck-Boost Converter: many operations in flight on one task
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#include "TPS55289.h"
+#include "TPS55289_log.h"
+#include "TPS55289_seq.h"
+#include "TPS55289_state.h"
+#include "TPS55289_trace.h"
+
+void TPS55289SeqInit(TPS55289_SEQ *seq){
+    spin_lock_t *lock = seq->lock;
+    memset(seq, 0, sizeof(*seq));
+    seq->lock = (lock != NULL) ? lock : spin_lock_instance(spin_lock_claim_unused(true));
+}
+
+/*
+    Start
+
+    Adds an operation to the scheduler from any task; the body first runs on the next TPS55289SeqRun.
+    op must stay valid until it reports DONE or FAILED.
+*/
+void TPS55289SeqStart(TPS55289_SEQ *seq, TPS55289_SEQ_OP *op, TPS55289 *device, TPS55289_SEQ_BODY body){
+    op->line   = 0;
+    op->state  = TPS55289_SEQ_READY;
+    op->result = 0;
+    op->device = device;
+    op->body   = body;
+
+    uint32_t irq = spin_lock_blocking(seq->lock);
+    op->next  = seq->head;
+    seq->head = op;
+    spin_unlock(seq->lock, irq);
+}
+
+void TPS55289SeqQueueWrite(TPS55289_SEQ_OP *op, uint8_t address, uint8_t value){
+    op->buffer[0] = address;
+    op->buffer[1] = value;
+    op->read      = false;
+    op->result    = 0;
+    op->state     = TPS55289_SEQ_WAIT_BUS;
+}
+
+void TPS55289SeqQueueRead(TPS55289_SEQ_OP *op, uint8_t address){
+    op->buffer[0] = address;
+    op->buffer[1] = 0;
+    op->read      = true;
+    op->result    = 0;
+    op->state     = TPS55289_SEQ_WAIT_BUS;
+}
+
+void TPS55289SeqQueueSleep(TPS55289_SEQ_OP *op, uint32_t us){
+    op->wakeAt = time_us_64() + us;
+    op->state  = TPS55289_SEQ_WAIT_TIME;
+}
+
+void TPS55289SeqQueueLock(TPS55289_SEQ_OP *op){
+    op->state = TPS55289_SEQ_WAIT_LOCK;
+}
+
+_Bool TPS55289SeqWriteOK(const TPS55289_SEQ_OP *op){
+    return op->result == (int)sizeof(op->buffer);
+}
+
+_Bool TPS55289SeqReadOK(const TPS55289_SEQ_OP *op){
+    return op->result == 1;
+}
+
+// One write at a time per controller among the operations; the controller lock keeps other tasks off it
+static _Bool seqBusFree(const TPS55289_SEQ *seq, const TPS55289_TRANSPORT *transport){
+    for (const TPS55289_SEQ_OP *op = seq->head; op != NULL; op = op->next){
+        if ((op->state == TPS55289_SEQ_WAIT_WRITE) && (TPS55289Transport(op->device)->context == transport->context)){
+            return false;
+        }
+    }
+    return true;
+}
+
+// Moves a waiting operation on if what it waits for has happened
+static void seqAdvance(TPS55289_SEQ *seq, TPS55289_SEQ_OP *op){
+    const TPS55289_TRANSPORT *transport = TPS55289Transport(op->device);
+    switch (op->state){
+        case TPS55289_SEQ_WAIT_BUS:
+            // Never blocks on another task: an operation whose controller is busy waits for the next pass
+            if (!seqBusFree(seq, transport)){
+                break;
+            }
+            if (!TPS55289TransportTryLock(transport)){
+                seq->lockBusy = true;
+                break;
+            }
+            if (op->read){
+                // Reads block, but only once no split write is on the controller to be cut into
+                op->result = TPS55289ReadRegisters(op->device, op->buffer[0], &op->buffer[1], 1) ? 1 : 0;
+                op->state  = TPS55289_SEQ_READY;
+                TPS55289TransportUnlock(transport);
+                break;
+            }
+            seq->writes++;
+            op->startedAt = time_us_32();
+            if (transport->writeStart == NULL){
+                op->result = transport->write(transport->context, op->device->I2C_ADDRESS, op->buffer,
+                                              sizeof(op->buffer), false);
+                op->state  = TPS55289_SEQ_READY;
+                TPS55289_TRACE_ON_WRITE(op->device, op->buffer[0], &op->buffer[1], 1, op->startedAt,
+                                        TPS55289SeqWriteOK(op));
+                TPS55289TransportUnlock(transport);
+                break;
+            }
+            op->result = transport->writeStart(transport->context, op->device->I2C_ADDRESS, op->buffer,
+                                               sizeof(op->buffer));
+            op->state  = (op->result == (int)sizeof(op->buffer)) ? TPS55289_SEQ_WAIT_WRITE : TPS55289_SEQ_READY;
+            if (op->state == TPS55289_SEQ_READY){
+                TPS55289_TRACE_ON_WRITE(op->device, op->buffer[0], &op->buffer[1], 1, op->startedAt, false);
+                TPS55289TransportUnlock(transport);
+            }
+            break;
+        case TPS55289_SEQ_WAIT_WRITE: {
+            // The lock taken at the start is held until the write completes
+            int result = transport->writePoll(transport->context);
+            if (result != 0){
+                op->result = result;
+                op->state  = TPS55289_SEQ_READY;
+                TPS55289_TRACE_ON_WRITE(op->device, op->buffer[0], &op->buffer[1], 1, op->startedAt,
+                                        TPS55289SeqWriteOK(op));
+                TPS55289TransportUnlock(transport);
+            }
+            break;
+        }
+        case TPS55289_SEQ_WAIT_LOCK:
+            if (!seqBusFree(seq, transport)){
+                break;
+            }
+            if (!TPS55289TransportTryLock(transport)){
+                seq->lockBusy = true;
+                break;
+            }
+            op->state = TPS55289_SEQ_READY;
+            break;
+        case TPS55289_SEQ_WAIT_TIME:
+            if (time_us_64() >= op->wakeAt){
+                op->state = TPS55289_SEQ_READY;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+    Run
+
+    One pass over the operations: completed writes and expired sleeps make an operation ready, and every
+    ready body runs to its next wait. Finished operations leave the list. Only this task removes, and
+    other tasks only push at the head, so the list is walked without the lock; an operation started
+    during the pass runs on the next one. Returns the number still in flight; the caller sleeps until
+    an I2C completion, a sleep deadline (TPS55289SeqNextWake) or a new operation, and with lockBusy set
+    retries soon, since nothing signals another task letting go of a controller.
+*/
+uint32_t TPS55289SeqRun(TPS55289_SEQ *seq){
+    uint32_t active = 0;
+    TPS55289_SEQ_OP **link = &seq->head;
+    seq->lockBusy = false;
+
+    while (*link != NULL){
+        TPS55289_SEQ_OP *op = *link;
+        seqAdvance(seq, op);
+        while (op->state == TPS55289_SEQ_READY){
+            seq->resumes++;
+            if (op->body(op) == TPS55289_SEQ_ENDED){
+                break;
+            }
+            seqAdvance(seq, op);            // Start the write just queued; a blocking one is ready at once
+        }
+        if ((op->state == TPS55289_SEQ_DONE) || (op->state == TPS55289_SEQ_FAILED)){
+            seq->failures += (op->state == TPS55289_SEQ_FAILED) ? 1 : 0;
+            // Another task may have pushed a new head since link was read; find the predecessor again
+            uint32_t irq = spin_lock_blocking(seq->lock);
+            link = &seq->head;
+            while (*link != op){
+                link = &(*link)->next;
+            }
+            *link = op->next;
+            spin_unlock(seq->lock, irq);
+            continue;
+        }
+        active++;
+        link = &op->next;
+    }
+    return active;
+}
+
+// Earliest sleep deadline among the operations; false if none is sleeping
+_Bool TPS55289SeqNextWake(const TPS55289_SEQ *seq, uint64_t *wakeAt){
+    _Bool found = false;
+    for (const TPS55289_SEQ_OP *op = seq->head; op != NULL; op = op->next){
+        if ((op->state == TPS55289_SEQ_WAIT_TIME) && (!found || (op->wakeAt < *wakeAt))){
+            *wakeAt = op->wakeAt;
+            found = true;
+        }
+    }
+    return found;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sequences
+
+/*
+    Initialisation
+
+    The writes of TPS55289Init: output off, the default register image in address order, output on, then
+    STATUS read once as a queued step and any flags it holds acted on. The device lock is held throughout,
+    so the cache only ever changes under it and no other task sees the image half written.
+*/
+static TPS55289_SEQ_RESULT seqInit(TPS55289_SEQ_OP *op){
+    TPS55289 *device = op->device;
+    TPS55289_SEQ_BEGIN(op);
+    TPS55289_SEQ_LOCK(op);
+    if (device->I2C_ADDRESS == 0){
+        device->I2C_ADDRESS = TPS55289_I2C_ADDR;
+    }
+    device->TPS55289_MODE.OE = 0b0;
+    TPS55289_SEQ_WRITE(op, TPS55289_MODE_ADDR, device->TPS55289_MODE.regValue);
+    if (!TPS55289SeqWriteOK(op)){
+        TPS55289Unlock(device);
+        TPS55289_SEQ_EXIT(op, false);
+    }
+
+    TPS55289LoadDefaults(device);
+    for (op->index = TPS55289_REF_VOLTAGE_LSB_ADDR; op->index <= TPS55289_MODE_ADDR; op->index++){
+        TPS55289_SEQ_WRITE(op, (uint8_t)op->index, TPS55289DefaultValues[op->index]);
+        if (!TPS55289SeqWriteOK(op)){
+            TPS55289Unlock(device);
+            TPS55289_SEQ_EXIT(op, false);
+        }
+    }
+
+    device->TPS55289_MODE.OE = 0b1;
+    TPS55289_SEQ_WRITE(op, TPS55289_MODE_ADDR, device->TPS55289_MODE.regValue);
+    if (!TPS55289SeqWriteOK(op)){
+        TPS55289Unlock(device);
+        TPS55289_SEQ_EXIT(op, false);
+    }
+
+    TPS55289_SEQ_READ(op, TPS55289_STATUS_ADDR);
+    if (!TPS55289SeqReadOK(op)){
+        TPS55289_LOG(FAILED_READ_STATUS);
+        TPS55289Unlock(device);
+        TPS55289_SEQ_EXIT(op, false);
+    }
+    device->TPS55289_STATUS.regValue = op->buffer[1];
+    TPS55289StatePublish(device);
+    if (device->TPS55289_STATUS.SCP || device->TPS55289_STATUS.OCP || device->TPS55289_STATUS.OVP){
+        // The controller is ours until the next wait, so handling may write synchronously
+        if (!TPS55289HandleStatus(device)){
+            TPS55289Unlock(device);
+            TPS55289_SEQ_EXIT(op, false);
+        }
+    }
+    TPS55289Unlock(device);
+    TPS55289_SEQ_END(op);
+}
+
+/*
+    Output Voltage
+
+    setOutputVoltage without the state machine: output off, REF LSB then MSB, output on, all under the
+    device lock. A device with the state machine attached is refused; its output goes through the machine.
+*/
+static TPS55289_SEQ_RESULT seqVoltage(TPS55289_SEQ_OP *op){
+    TPS55289 *device = op->device;
+    TPS55289_SEQ_BEGIN(op);
+    if (device->output != NULL){
+        TPS55289_SEQ_EXIT(op, false);
+    }
+    TPS55289_SEQ_LOCK(op);
+    device->TPS55289_MODE.OE = 0b0;
+    TPS55289_SEQ_WRITE(op, TPS55289_MODE_ADDR, device->TPS55289_MODE.regValue);
+    if (!TPS55289SeqWriteOK(op)){
+        TPS55289Unlock(device);
+        TPS55289_SEQ_EXIT(op, false);
+    }
+    TPS55289_SEQ_WRITE(op, TPS55289_REF_VOLTAGE_LSB_ADDR, op->code & 0xFF);
+    if (!TPS55289SeqWriteOK(op)){
+        TPS55289Unlock(device);
+        TPS55289_SEQ_EXIT(op, false);
+    }
+    TPS55289_SEQ_WRITE(op, TPS55289_REF_VOLTAGE_MSB_ADDR, (op->code >> 8) & 0xFF);
+    if (!TPS55289SeqWriteOK(op)){
+        TPS55289Unlock(device);
+        TPS55289_SEQ_EXIT(op, false);
+    }
+    device->TPS55289_REF_VOLTAGE.regValue_16 = op->code;
+    device->TPS55289_REF_VOLTAGE.VREF_LSB    = op->code & 0xFF;
+    device->TPS55289_REF_VOLTAGE.VREF_MSB    = (op->code >> 8) & 0xFF;
+    device->settings.VOUT                    = op->to;
+    device->TPS55289_MODE.OE = 0b1;
+    TPS55289_SEQ_WRITE(op, TPS55289_MODE_ADDR, device->TPS55289_MODE.regValue);
+    if (!TPS55289SeqWriteOK(op)){
+        TPS55289Unlock(device);
+        TPS55289_SEQ_EXIT(op, false);
+    }
+    TPS55289StatePublish(device);
+    TPS55289Unlock(device);
+    TPS55289_SEQ_END(op);
+}
+
+/*
+    Ramp
+
+    Steps REF from the present setpoint to the target with the output on, one LSB/MSB pair per step
+    and intervalUs between steps. Each step holds the device lock; the sleeps between them do not.
+*/
+static TPS55289_SEQ_RESULT seqRamp(TPS55289_SEQ_OP *op){
+    TPS55289 *device = op->device;
+    TPS55289_SEQ_BEGIN(op);
+    for (op->index = 1; op->index <= op->count; op->index++){
+        TPS55289_SEQ_LOCK(op);
+        op->code = TPS55289VoltageCode(device, op->from + (op->to - op->from) * op->index / op->count);
+        TPS55289_SEQ_WRITE(op, TPS55289_REF_VOLTAGE_LSB_ADDR, op->code & 0xFF);
+        if (!TPS55289SeqWriteOK(op)){
+            TPS55289Unlock(device);
+            TPS55289_SEQ_EXIT(op, false);
+        }
+        TPS55289_SEQ_WRITE(op, TPS55289_REF_VOLTAGE_MSB_ADDR, (op->code >> 8) & 0xFF);
+        if (!TPS55289SeqWriteOK(op)){
+            TPS55289Unlock(device);
+            TPS55289_SEQ_EXIT(op, false);
+        }
+        device->TPS55289_REF_VOLTAGE.regValue_16 = op->code;
+        device->TPS55289_REF_VOLTAGE.VREF_LSB    = op->code & 0xFF;
+        device->TPS55289_REF_VOLTAGE.VREF_MSB    = (op->code >> 8) & 0xFF;
+        device->settings.VOUT                    = op->from + (op->to - op->from) * op->index / op->count;
+        TPS55289StatePublish(device);
+        TPS55289Unlock(device);
+        if (op->index < op->count){
+            TPS55289_SEQ_SLEEP(op, op->intervalUs);
+        }
+    }
+    TPS55289_SEQ_END(op);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Starting Sequences
+
+void TPS55289SeqStartInit(TPS55289_SEQ *seq, TPS55289_SEQ_OP *op, TPS55289 *device){
+    TPS55289SeqStart(seq, op, device, seqInit);
+}
+
+// Without the output state machine only; with it attached the operation fails at once
+void TPS55289SeqStartVoltage(TPS55289_SEQ *seq, TPS55289_SEQ_OP *op, TPS55289 *device, float voltage){
+    op->to   = voltage;
+    op->code = TPS55289VoltageCode(device, voltage);
+    TPS55289SeqStart(seq, op, device, seqVoltage);
+}
+
+void TPS55289SeqStartRamp(TPS55289_SEQ *seq, TPS55289_SEQ_OP *op, TPS55289 *device, float voltage,
+                          uint16_t steps, uint32_t intervalUs){
+    op->from       = device->settings.VOUT;
+    op->to         = voltage;
+    op->count      = (steps > 0) ? steps : 1;
+    op->intervalUs = intervalUs;
+    TPS55289SeqStart(seq, op, device, seqRamp);
+}
@@ -0,0 +1,80 @@
+// FreeRTOS task that runs every in-flight TPS55289 driver sequence
+#include "pico/stdlib.h"
+#include "pico/time.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "TPS55289_seq.h"
+#include "TPS55289_transport.h"
+
+static TPS55289_SEQ seqScheduler;
+static TaskHandle_t seqTaskHandle;
+static alarm_id_t seqAlarmId;
+
+// I2C interrupt at the end of a split write
+static void seqI2CComplete(void){
+    BaseType_t woken = pdFALSE;
+    if (seqTaskHandle != NULL){
+        vTaskNotifyGiveFromISR(seqTaskHandle, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+// Timer IRQ at the earliest sleep deadline
+static int64_t seqAlarm(alarm_id_t id, void *userData){
+    (void)id; (void)userData;
+    BaseType_t woken = pdFALSE;
+    seqAlarmId = 0;
+    vTaskNotifyGiveFromISR(seqTaskHandle, &woken);
+    portYIELD_FROM_ISR(woken);
+    return 0;
+}
+
+void TPS55289SeqTaskInit(void){
+    TPS55289SeqInit(&seqScheduler);
+    TPS55289I2CSetCompletionCallback(seqI2CComplete);
+}
+
+TPS55289_SEQ *TPS55289SeqTaskScheduler(void){
+    return &seqScheduler;
+}
+
+// Called after TPS55289SeqStart from another task
+void TPS55289SeqTaskWake(void){
+    if (seqTaskHandle != NULL){
+        xTaskNotifyGive(seqTaskHandle);
+    }
+}
+
+/*
+    Sequence Task
+
+    One stack for every driver sequence in flight. Sleeps between passes until an I2C write completes, a
+    sequence's sleep deadline passes or a new sequence is started; while a write waits for a controller
+    another task holds, for one tick at most. Writes on a transport without split writes block the pass
+    they are issued in.
+*/
+void TPS55289SeqTask(void *param){
+    (void)param;
+    seqTaskHandle = xTaskGetCurrentTaskHandle();
+    for(;;){
+        TPS55289SeqRun(&seqScheduler);
+
+        uint64_t wakeAt;
+        if (TPS55289SeqNextWake(&seqScheduler, &wakeAt)){
+            if (seqAlarmId > 0){
+                cancel_alarm(seqAlarmId);
+            }
+            seqAlarmId = add_alarm_at(from_us_since_boot(wakeAt), seqAlarm, NULL, false);
+            if (seqAlarmId == 0){
+                continue;                   // Deadline already passed
+            }
+            if (seqAlarmId < 0){
+                vTaskDelay(1);              // No alarm slot free; fall back to the tick
+                continue;
+            }
+        }
+        ulTaskNotifyTake(pdTRUE, seqScheduler.lockBusy ? 1 : portMAX_DELAY);
+    }
+}
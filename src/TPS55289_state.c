@@ -0,0 +1,121 @@
+// Published snapshot of the TPS55289 driver state, readable from any task or core without locking
+#include <assert.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#include "TPS55289.h"
+#include "TPS55289_state.h"
+
+static_assert(sizeof(TPS55289_SNAPSHOT) % sizeof(uint32_t) == 0, "Snapshot is copied as whole words");
+
+// Snapshot of the cache as it is now; consistent only under the device lock
+static void stateCapture(const TPS55289 *device, TPS55289_SNAPSHOT *snapshot){
+    snapshot->VOUT            = device->settings.VOUT;
+    snapshot->slewRate        = device->settings.slewRate;
+    snapshot->currentLimitAmp = device->settings.currentLimitAmp;
+    snapshot->refCode         = device->TPS55289_REF_VOLTAGE.regValue_16 & 0x07FF;
+    snapshot->currentLimit    = device->TPS55289_IOUT_LIMIT.regValue;
+    snapshot->voutSR          = device->TPS55289_VOUT_SR.regValue;
+    snapshot->voutFS          = device->TPS55289_VOUT_FS.regValue;
+    snapshot->cdc             = device->TPS55289_CDC.regValue;
+    snapshot->mode            = device->TPS55289_MODE.regValue;
+    snapshot->status          = device->TPS55289_STATUS.regValue;
+}
+
+/*
+    State Initialisation
+
+    Attaches the publisher to a device and publishes the cache as it stands.
+*/
+void TPS55289StateInit(TPS55289_STATE *state, TPS55289 *device){
+    spin_lock_t *lock = state->lock;
+    memset(state, 0, sizeof(*state));
+    state->lock   = (lock != NULL) ? lock : spin_lock_instance(spin_lock_claim_unused(true));
+    device->state = state;
+    TPS55289StatePublish(device);
+}
+
+/*
+    Publish
+
+    Called by the driver after each register access, from whichever task made it. The cache is captured
+    under the device lock, which every multi-field update of the cache holds, so no task can publish
+    another's update half done. The words are stored one at a time through a volatile pointer, so a
+    reader racing the copy sees each word either old or new, and the sequence check throws the mix away.
+*/
+void TPS55289StatePublish(TPS55289 *device){
+    TPS55289_STATE *state = device->state;
+    if (state == NULL){
+        return;
+    }
+    TPS55289_SNAPSHOT snapshot;
+    uint32_t words[TPS55289_STATE_WORDS];
+
+    TPS55289Lock(device);
+    uint32_t irq = spin_lock_blocking(state->lock);
+    state->publishes++;
+    stateCapture(device, &snapshot);
+    snapshot.version = state->publishes;
+    memcpy(words, &snapshot, sizeof(words));
+
+    uint32_t sequence = state->sequence;
+    state->sequence = sequence + 1;
+    __dmb();
+    volatile uint32_t *target = state->data.words;
+    for (uint32_t i = 0; i < TPS55289_STATE_WORDS; i++){
+        target[i] = words[i];
+    }
+    __dmb();
+    state->sequence = sequence + 2;
+    spin_unlock(state->lock, irq);
+    TPS55289Unlock(device);
+}
+
+/*
+    Read
+
+    Copies the latest snapshot. Returns the number of retries it took: non-zero only when a publish on
+    the other core overlapped the copy.
+*/
+uint32_t TPS55289StateRead(const TPS55289_STATE *state, TPS55289_SNAPSHOT *snapshot){
+    uint32_t words[TPS55289_STATE_WORDS];
+    const volatile uint32_t *source = state->data.words;
+    uint32_t retries = 0;
+
+    for (;;){
+        uint32_t before = state->sequence;
+        __dmb();
+        if ((before & 1) == 0){
+            for (uint32_t i = 0; i < TPS55289_STATE_WORDS; i++){
+                words[i] = source[i];
+            }
+            __dmb();
+            if (state->sequence == before){
+                break;
+            }
+        }
+        retries++;
+        tight_loop_contents();
+    }
+    memcpy(snapshot, words, sizeof(*snapshot));
+    return retries;
+}
+
+/*
+    Snapshot
+
+    What other tasks should use in place of reading the device structure: the published snapshot when
+    a publisher is attached, otherwise a copy of the cache taken under the device lock.
+*/
+void TPS55289Snapshot(TPS55289 *device, TPS55289_SNAPSHOT *snapshot){
+    if (device->state != NULL){
+        TPS55289StateRead(device->state, snapshot);
+        return;
+    }
+    TPS55289Lock(device);
+    stateCapture(device, snapshot);
+    TPS55289Unlock(device);
+    snapshot->version = 0;
+}
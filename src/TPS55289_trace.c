@@ -0,0 +1,139 @@
+// Register transaction trace for the TPS55289 driver: a compact ring drained to the host for offline replay
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#include "TPS55289.h"
+#include "TPS55289_trace.h"
+
+#if (TPS55289_TRACE_BUFFER_SIZE & (TPS55289_TRACE_BUFFER_SIZE - 1)) != 0
+#error "TPS55289_TRACE_BUFFER_SIZE must be a power of two"
+#endif
+
+static TPS55289_TRACE_RECORD traceRing[TPS55289_TRACE_BUFFER_SIZE];
+static volatile uint32_t traceHead;     // Next slot to write
+static volatile uint32_t traceTail;     // Next slot to read
+static volatile uint32_t traceDropped;
+static uint32_t traceReported;          // Drops already carried by a marker
+static uint32_t traceDropAt;            // Ring position of the first unreported drop
+static uint32_t traceDropStamp;         // and when it happened
+static uint32_t traceLastStamp;         // Timestamp of the newest record or marker
+static spin_lock_t *traceLock;
+
+static inline uint32_t traceLockAcquire(void){
+    return (traceLock != NULL) ? spin_lock_blocking(traceLock) : save_and_disable_interrupts();
+}
+
+static inline void traceLockRelease(uint32_t irq){
+    if (traceLock != NULL){
+        spin_unlock(traceLock, irq);
+    } else {
+        restore_interrupts(irq);
+    }
+}
+
+/*
+    Trace Initialisation
+
+    Claims a hardware spin lock so drivers on both cores can trace into the same ring. Must be called
+    before the scheduler starts.
+*/
+void TPS55289TraceInit(void){
+    traceHead      = 0;
+    traceTail      = 0;
+    traceDropped   = 0;
+    traceReported  = 0;
+    traceDropAt    = 0;
+    traceLastStamp = time_us_32();
+    if (traceLock == NULL){
+        traceLock = spin_lock_instance(spin_lock_claim_unused(true));
+    }
+}
+
+// Devices are not traced until attached; channel tells devices apart in the trace
+void TPS55289TraceAttach(TPS55289 *device, uint8_t channel){
+    device->traceChannel = (channel < TPS55289_TRACE_CHANNELS) ? channel + 1 : 0;
+}
+
+/*
+    Record
+
+    Called once a transaction has completed, with the time it started. Stores one record per register;
+    when the ring is full the whole transaction is dropped and counted rather than blocking the caller.
+*/
+void TPS55289TraceRecord(const TPS55289 *device, uint8_t flags, uint8_t address, const uint8_t *data,
+                         size_t count, uint32_t startUs){
+    if (device->traceChannel == 0){
+        return;
+    }
+    uint32_t duration = time_us_32() - startUs;
+    flags |= (uint8_t)((device->traceChannel - 1) << TPS55289_TRACE_CHANNEL_SHIFT);
+    uint32_t irq = traceLockAcquire();
+
+    uint32_t head = traceHead;
+    if ((count > TPS55289_TRACE_BUFFER_SIZE) || ((head - traceTail) > (TPS55289_TRACE_BUFFER_SIZE - count))){
+        if (traceDropped == traceReported){
+            traceDropAt    = head;
+            traceDropStamp = startUs;
+        }
+        traceDropped += (uint32_t)count;
+    } else {
+        for (size_t i = 0; i < count; i++){
+            TPS55289_TRACE_RECORD *record = &traceRing[(head + i) & (TPS55289_TRACE_BUFFER_SIZE - 1)];
+            record->timestamp  = startUs;
+            record->durationUs = (duration > 0xFFFF) ? 0xFFFF : (uint16_t)duration;
+            record->value      = data[i];
+            record->flags      = flags | ((address + i) & TPS55289_TRACE_REGISTER_MASK);
+        }
+        traceHead      = head + (uint32_t)count;
+        traceLastStamp = startUs;
+    }
+
+    traceLockRelease(irq);
+}
+
+/*
+    Drain
+
+    Copies up to maxRecords pending records out, oldest first, for the host (TRACE_READ). A marker is put
+    where records were dropped, stamped with the time of the first drop, and one is added to anchor the
+    timestamps once nothing has been traced for a long time. Returns the number of records copied,
+    markers included.
+*/
+static void traceMarker(TPS55289_TRACE_RECORD *record, uint32_t timestamp, uint32_t dropped){
+    record->timestamp  = timestamp;
+    record->durationUs = (uint16_t)dropped;
+    record->value      = 0;
+    record->flags      = TPS55289_TRACE_MARKER;
+}
+
+uint32_t TPS55289TraceDrain(TPS55289_TRACE_RECORD *records, uint32_t maxRecords){
+    uint32_t copied = 0;
+    uint32_t now = time_us_32();
+    uint32_t irq = traceLockAcquire();
+
+    while (copied < maxRecords){
+        uint32_t dropped = traceDropped - traceReported;
+        if ((dropped > 0) && (traceTail == traceDropAt)){
+            dropped = (dropped > 0xFFFF) ? 0xFFFF : dropped;    // The rest goes in the next marker
+            traceMarker(&records[copied++], traceDropStamp, dropped);
+            traceReported += dropped;
+            continue;
+        }
+        if (traceTail == traceHead){
+            break;
+        }
+        records[copied++] = traceRing[traceTail & (TPS55289_TRACE_BUFFER_SIZE - 1)];
+        traceTail = traceTail + 1;
+    }
+    if ((copied < maxRecords) && (traceTail == traceHead) && (now - traceLastStamp >= TPS55289_TRACE_ANCHOR_US)){
+        traceMarker(&records[copied++], now, 0);
+        traceLastStamp = now;
+    }
+
+    traceLockRelease(irq);
+    return copied;
+}
+
+uint32_t TPS55289TraceDropped(void){
+    return traceDropped;
+}
@@ -0,0 +1,256 @@
+// Multi-channel tracking for TPS55289 Buck-Boost Converters: rails ramped together, REF writes issued in parallel
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "TPS55289_log.h"
+#include "TPS55289_state.h"
+#include "TPS55289_trace.h"
+#include "TPS55289_tracking.h"
+
+enum {
+    TPS55289_TRACKING_IDLE = 0,
+    TPS55289_TRACKING_QUEUED,           // Code computed, write not started yet
+    TPS55289_TRACKING_PENDING,          // Split write on the wire
+    TPS55289_TRACKING_DONE,
+    TPS55289_TRACKING_FAILED
+};
+
+void TPS55289TrackingInit(TPS55289_TRACKING *tracking, TPS55289_TRACKING_MODE mode, uint32_t skewBoundUs){
+    memset(tracking, 0, sizeof(*tracking));
+    tracking->mode        = mode;
+    tracking->skewBoundUs = skewBoundUs;
+}
+
+_Bool TPS55289TrackingAdd(TPS55289_TRACKING *tracking, TPS55289 *device){
+    _Bool STATUS = true;
+    if (tracking->channels >= TPS55289_TRACKING_CHANNELS){
+        STATUS = false;
+        return STATUS;
+    }
+    tracking->channel[tracking->channels].device = device;
+    tracking->channels++;
+    return STATUS;
+}
+
+/*
+    Start a Ramp
+
+    targets holds one output voltage per channel, in the order the channels were added. Every channel
+    ramps from its present setpoint and arrives at the last of the steps.
+*/
+_Bool TPS55289TrackingStart(TPS55289_TRACKING *tracking, const float *targets, uint32_t steps){
+    _Bool STATUS = true;
+    if (steps == 0){
+        STATUS = false;
+        return STATUS;
+    }
+    for (uint32_t i = 0; i < tracking->channels; i++){
+        if (((targets[i] >= 0.8) && (targets[i] <= 22)) == 0){
+            TPS55289_LOG(VOUT_INVALID);
+            STATUS = false;
+            return STATUS;
+        }
+    }
+    for (uint32_t i = 0; i < tracking->channels; i++){
+        tracking->channel[i].start  = tracking->channel[i].device->settings.VOUT;
+        tracking->channel[i].target = targets[i];
+    }
+    tracking->step       = 0;
+    tracking->totalSteps = steps;
+    return STATUS;
+}
+
+_Bool TPS55289TrackingDone(const TPS55289_TRACKING *tracking){
+    return tracking->step >= tracking->totalSteps;
+}
+
+// Setpoint of one channel at the current step
+static float trackingVoltage(const TPS55289_TRACKING *tracking, const TPS55289_TRACKING_CHANNEL *channel){
+    float fraction = (float)tracking->step / (float)tracking->totalSteps;
+    float span = channel->target - channel->start;
+    if (tracking->mode == TPS55289_TRACKING_RATIOMETRIC){
+        return channel->start + span * fraction;
+    }
+
+    float widest = 0;
+    for (uint32_t i = 0; i < tracking->channels; i++){
+        float width = tracking->channel[i].target - tracking->channel[i].start;
+        width = (width < 0) ? -width : width;
+        widest = (width > widest) ? width : widest;
+    }
+    float delta = widest * fraction;
+    if (span >= 0){
+        return channel->start + ((delta < span) ? delta : span);
+    }
+    return channel->start - ((delta < -span) ? delta : -span);
+}
+
+// A controller carries one write at a time; channels sharing it wait their turn
+static _Bool trackingBusFree(const TPS55289_TRACKING *tracking, const TPS55289_TRANSPORT *transport){
+    for (uint32_t i = 0; i < tracking->channels; i++){
+        if ((tracking->channel[i].state == TPS55289_TRACKING_PENDING) &&
+            (TPS55289Transport(tracking->channel[i].device)->context == transport->context)){
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+    Controller Locks
+
+    Every controller the ramp uses is held for the whole step, so no other task's access can land
+    between the channels' writes. All or none: if one is busy, those already taken are given back before
+    waiting, so the step never waits for a controller while holding another and cannot deadlock with
+    the sequence task, which may.
+*/
+static void trackingLock(const TPS55289_TRACKING *tracking){
+    for (;;){
+        uint32_t taken = 0;
+        while ((taken < tracking->channels) &&
+               TPS55289TransportTryLock(TPS55289Transport(tracking->channel[taken].device))){
+            taken++;
+        }
+        if (taken == tracking->channels){
+            return;
+        }
+        while (taken > 0){
+            taken--;
+            TPS55289TransportUnlock(TPS55289Transport(tracking->channel[taken].device));
+        }
+        sleep_us(TPS55289_TRACKING_LOCK_RETRY);
+    }
+}
+
+static void trackingUnlock(const TPS55289_TRACKING *tracking){
+    for (uint32_t i = 0; i < tracking->channels; i++){
+        TPS55289TransportUnlock(TPS55289Transport(tracking->channel[i].device));
+    }
+}
+
+static void trackingFinish(TPS55289_TRACKING_CHANNEL *channel, int result){
+    channel->doneAt = time_us_64();
+    channel->state  = (result == (int)sizeof(channel->buffer)) ? TPS55289_TRACKING_DONE : TPS55289_TRACKING_FAILED;
+    TPS55289_TRACE_ON_WRITE(channel->device, channel->buffer[0], &channel->buffer[1], sizeof(channel->buffer) - 1,
+                            channel->startedAt, channel->state == TPS55289_TRACKING_DONE);
+}
+
+/*
+    Tracking Step
+
+    Holds the controller locks, starts every split write it can, then runs any blocking-only channels,
+    then polls until all have finished. A channel's write is complete when its poll says so; the spread
+    of those times is the skew reported for the step. Returns false once the ramp is over or if any channel failed; a failed channel
+    keeps its old cached REF and catches up with the next step's write.
+*/
+_Bool TPS55289TrackingStep(TPS55289_TRACKING *tracking){
+    _Bool STATUS = true;
+    if (TPS55289TrackingDone(tracking)){
+        STATUS = false;
+        return STATUS;
+    }
+    tracking->step++;
+
+    // All codes before the first write, so the conversion does not spread the writes out
+    for (uint32_t i = 0; i < tracking->channels; i++){
+        TPS55289_TRACKING_CHANNEL *channel = &tracking->channel[i];
+        channel->code      = TPS55289VoltageCode(channel->device, trackingVoltage(tracking, channel));
+        channel->buffer[0] = TPS55289_REF_VOLTAGE_LSB_ADDR;
+        channel->buffer[1] = channel->code & 0xFF;
+        channel->buffer[2] = (channel->code >> 8) & 0xFF;
+        channel->state     = TPS55289_TRACKING_QUEUED;
+        channel->startedAt = time_us_32();
+    }
+
+    trackingLock(tracking);
+    uint64_t deadline = time_us_64() + TPS55289_TRACKING_TIMEOUT;
+    uint32_t remaining = tracking->channels;
+    while (remaining > 0){
+        for (uint32_t i = 0; i < tracking->channels; i++){
+            TPS55289_TRACKING_CHANNEL *channel = &tracking->channel[i];
+            const TPS55289_TRANSPORT *transport = TPS55289Transport(channel->device);
+            if (transport->writeStart == NULL){
+                continue;
+            }
+            if (channel->state == TPS55289_TRACKING_PENDING){
+                int result = transport->writePoll(transport->context);
+                if (result != 0){
+                    trackingFinish(channel, result);
+                    remaining--;
+                }
+            }
+            if ((channel->state == TPS55289_TRACKING_QUEUED) && trackingBusFree(tracking, transport)){
+                channel->startedAt = time_us_32();
+                int result = transport->writeStart(transport->context, channel->device->I2C_ADDRESS,
+                                                   channel->buffer, sizeof(channel->buffer));
+                channel->state = TPS55289_TRACKING_PENDING;
+                if (result != (int)sizeof(channel->buffer)){
+                    trackingFinish(channel, result);
+                    remaining--;
+                }
+            }
+        }
+
+        // Blocking-only channels go once the split writes are under way
+        for (uint32_t i = 0; i < tracking->channels; i++){
+            TPS55289_TRACKING_CHANNEL *channel = &tracking->channel[i];
+            const TPS55289_TRANSPORT *transport = TPS55289Transport(channel->device);
+            if ((channel->state == TPS55289_TRACKING_QUEUED) && (transport->writeStart == NULL) &&
+                trackingBusFree(tracking, transport)){
+                channel->startedAt = time_us_32();
+                trackingFinish(channel, transport->write(transport->context, channel->device->I2C_ADDRESS,
+                                                         channel->buffer, sizeof(channel->buffer), false));
+                remaining--;
+            }
+        }
+
+        if ((remaining > 0) && (time_us_64() >= deadline)){
+            for (uint32_t i = 0; i < tracking->channels; i++){
+                if ((tracking->channel[i].state == TPS55289_TRACKING_QUEUED) ||
+                    (tracking->channel[i].state == TPS55289_TRACKING_PENDING)){
+                    trackingFinish(&tracking->channel[i], PICO_ERROR_TIMEOUT);
+                }
+            }
+            remaining = 0;
+        }
+        if (remaining > 0){
+            busy_wait_us_32(1);
+        }
+    }
+
+    // Skew over the channels that were written; update their caches
+    uint64_t first = UINT64_MAX;
+    uint64_t last  = 0;
+    for (uint32_t i = 0; i < tracking->channels; i++){
+        TPS55289_TRACKING_CHANNEL *channel = &tracking->channel[i];
+        if (channel->state != TPS55289_TRACKING_DONE){
+            tracking->stats.failures++;
+            TPS55289_LOG(FAILED_TRACKING_WRITE);
+            STATUS = false;
+            continue;
+        }
+        first = (channel->doneAt < first) ? channel->doneAt : first;
+        last  = (channel->doneAt > last) ? channel->doneAt : last;
+
+        TPS55289 *device = channel->device;
+        device->TPS55289_REF_VOLTAGE.regValue_16 = channel->code;
+        device->TPS55289_REF_VOLTAGE.VREF_LSB    = channel->buffer[1];
+        device->TPS55289_REF_VOLTAGE.VREF_MSB    = channel->buffer[2];
+        device->settings.VOUT                    = trackingVoltage(tracking, channel);
+        TPS55289StatePublish(device);
+    }
+    trackingUnlock(tracking);
+
+    uint32_t skew = (last > first) ? (uint32_t)(last - first) : 0;
+    tracking->stats.steps++;
+    tracking->stats.lastSkewUs   = skew;
+    tracking->stats.totalSkewUs += skew;
+    tracking->stats.maxSkewUs    = (skew > tracking->stats.maxSkewUs) ? skew : tracking->stats.maxSkewUs;
+    if (skew > tracking->skewBoundUs){
+        tracking->stats.overBound++;
+        TPS55289_LOG_U32(TRACKING_SKEW_EXCEEDED, skew);
+    }
+    return STATUS;
+}
@@ -8,6 +8,16 @@
 #include "task.h"
 
 #include "TPS55289.h"
+#include "TPS55289_calibration.h"
+#include "TPS55289_log.h"
+#include "TPS55289_scrub.h"
+#include "TPS55289_seq.h"
+#include "TPS55289_trace.h"
+#include "panel.h"
+#include "power_manager.h"
+#include "rtos_static.h"
+#include "script_vm.h"
+#include "usb_device.h"
 
 #define LED_PIN 25
 #define RED_LED 0
@@ -15,6 +25,31 @@
 #define GPIO_ON     1
 #define GPIO_OFF    0
 
+// Task stack depths in words
+#define LED_TASK_STACK_SIZE     128
+#define LOG_TASK_STACK_SIZE     512
+#define USB_TASK_STACK_SIZE     512
+#define SCRIPT_TASK_STACK_SIZE  512
+#define PANEL_TASK_STACK_SIZE   512
+#define SCRUB_TASK_STACK_SIZE   256
+#define SEQ_TASK_STACK_SIZE     256
+
+// Log flush period in ticks; stretched while the power manager has clocked down
+#define LOG_PERIOD              10
+#define LOG_IDLE_PERIOD         250
+
+RTOS_TASK_MEMORY(greenLED, LED_TASK_STACK_SIZE);
+RTOS_TASK_MEMORY(redLED, LED_TASK_STACK_SIZE);
+RTOS_TASK_MEMORY(logger, LOG_TASK_STACK_SIZE);
+RTOS_TASK_MEMORY(usbDevice, USB_TASK_STACK_SIZE);
+RTOS_TASK_MEMORY(script, SCRIPT_TASK_STACK_SIZE);
+RTOS_TASK_MEMORY(frontPanel, PANEL_TASK_STACK_SIZE);
+RTOS_TASK_MEMORY(registerScrub, SCRUB_TASK_STACK_SIZE);
+RTOS_TASK_MEMORY(driverSequences, SEQ_TASK_STACK_SIZE);
+
+// Per-unit correction tables from flash; identity tables if the board was never calibrated
+static TPS55289_CALIBRATION calibration;
+
 void GreenLEDTask(void *param)
 {
     for (;;)
@@ -37,9 +72,29 @@ void RedLEDTask(void *param)
     }
 }
 
+// Formats deferred TPS55289 log records off the control path
+void LogTask(void *param)
+{
+    for(;;){
+        TPS55289LogFlush(0);
+        vTaskDelay(powerManagerIsIdle() ? LOG_IDLE_PERIOD : LOG_PERIOD);
+    }
+}
+
 int main() 
 {
+    powerPlatformInit();        // Before any peripheral: moves clk_peri off clk_sys
     stdio_init_all();
+    TPS55289LogInit();
+    TPS55289TraceInit();
+    TPS55289CalibrationLoad(&calibration);
+    powerManagerInit(powerPlatformSetClock);
+    TPS55289I2CInit();          // Controller locks: before anything that can reach the bus is set up
+    usbDeviceInit(NULL);        // No TPS55289 attached yet; device commands answer USB_STATUS_NO_DEVICE
+    scriptTaskInit(NULL);
+    panelTaskInit(NULL, NULL, NULL);    // No ADC yet: VIN/VOUT/IOUT readouts stay dashed
+    TPS55289ScrubTaskInit(NULL);
+    TPS55289SeqTaskInit();
 
     gpio_init(LED_PIN);
     gpio_set_dir(LED_PIN, GPIO_OUT);
@@ -49,30 +104,100 @@ int main()
 
     TaskHandle_t gLEDtask = NULL;
     TaskHandle_t rLEDtask = NULL;
+    TaskHandle_t logTask = NULL;
+    TaskHandle_t usbTask = NULL;
+    TaskHandle_t scriptVmTask = NULL;
+    TaskHandle_t panelUiTask = NULL;
+    TaskHandle_t scrubTask = NULL;
+    TaskHandle_t seqTask = NULL;
 
     // TPS55289 device;
 
+    // device.calibration = &calibration;
+    // TPS55289TraceAttach(&device, 0);
     // TPS55289Init(&device);
 
     // uint8_t registe = device.TPS55289_IOUT_LIMIT.regValue;
 
 
 
-    uint32_t status = xTaskCreate(
+    gLEDtask = rtosCreateTask(
                     GreenLEDTask,
                     "Green LED",
-                    1024,
+                    LED_TASK_STACK_SIZE,
                     NULL,
                     tskIDLE_PRIORITY,
-                    &gLEDtask);
+                    RTOS_TASK_STACK(greenLED),
+                    RTOS_TASK_TCB(greenLED));
 
-    status = xTaskCreate(
+    rLEDtask = rtosCreateTask(
                     RedLEDTask,
                     "Red LED",
-                    1024,
+                    LED_TASK_STACK_SIZE,
                     NULL,
                     tskIDLE_PRIORITY,
-                    &rLEDtask);
+                    RTOS_TASK_STACK(redLED),
+                    RTOS_TASK_TCB(redLED));
+
+    logTask = rtosCreateTask(
+                    LogTask,
+                    "Log",
+                    LOG_TASK_STACK_SIZE,
+                    NULL,
+                    tskIDLE_PRIORITY,
+                    RTOS_TASK_STACK(logger),
+                    RTOS_TASK_TCB(logger));
+
+    usbTask = rtosCreateTask(
+                    usbDeviceTask,
+                    "USB",
+                    USB_TASK_STACK_SIZE,
+                    NULL,
+                    tskIDLE_PRIORITY + 2,
+                    RTOS_TASK_STACK(usbDevice),
+                    RTOS_TASK_TCB(usbDevice));
+    vTaskCoreAffinitySet(usbTask, (1 << 0));    // Same core as the USB controller interrupt
+
+    // Above USB so a script's WAIT deadlines are met while commands are being processed; it blocks a
+    // tick between instruction slices, so a long run cannot starve USB
+    scriptVmTask = rtosCreateTask(
+                    scriptTask,
+                    "Script",
+                    SCRIPT_TASK_STACK_SIZE,
+                    NULL,
+                    tskIDLE_PRIORITY + 3,
+                    RTOS_TASK_STACK(script),
+                    RTOS_TASK_TCB(script));
+
+    // Below everything but idle: the panel sleeps on its DMA transfers and only redraws what changed
+    panelUiTask = rtosCreateTask(
+                    panelTask,
+                    "Panel",
+                    PANEL_TASK_STACK_SIZE,
+                    NULL,
+                    tskIDLE_PRIORITY + 1,
+                    RTOS_TASK_STACK(frontPanel),
+                    RTOS_TASK_TCB(frontPanel));
+
+    // Background read-back of the converter's registers against the driver cache
+    scrubTask = rtosCreateTask(
+                    TPS55289ScrubTask,
+                    "Scrub",
+                    SCRUB_TASK_STACK_SIZE,
+                    NULL,
+                    tskIDLE_PRIORITY + 1,
+                    RTOS_TASK_STACK(registerScrub),
+                    RTOS_TASK_TCB(registerScrub));
+
+    // Every multi-step driver operation in flight, on one stack; woken by I2C completions and its alarm
+    seqTask = rtosCreateTask(
+                    TPS55289SeqTask,
+                    "Sequences",
+                    SEQ_TASK_STACK_SIZE,
+                    NULL,
+                    tskIDLE_PRIORITY + 2,
+                    RTOS_TASK_STACK(driverSequences),
+                    RTOS_TASK_TCB(driverSequences));
 
     vTaskStartScheduler();
 
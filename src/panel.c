@@ -0,0 +1,339 @@
+// Front panel model, damage tracking and text renderer
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "panel.h"
+
+/*
+    Font
+
+    5x8 column-major glyphs for ' ' to 'Z', bit 0 at the top. Lower case is drawn as upper case.
+*/
+static const uint8_t font[][5] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5F, 0x00, 0x00 }, { 0x00, 0x07, 0x00, 0x07, 0x00 },
+    { 0x14, 0x7F, 0x14, 0x7F, 0x14 }, { 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 },
+    { 0x36, 0x49, 0x56, 0x20, 0x50 }, { 0x00, 0x08, 0x07, 0x03, 0x00 }, { 0x00, 0x1C, 0x22, 0x41, 0x00 },
+    { 0x00, 0x41, 0x22, 0x1C, 0x00 }, { 0x2A, 0x1C, 0x7F, 0x1C, 0x2A }, { 0x08, 0x08, 0x3E, 0x08, 0x08 },
+    { 0x00, 0x80, 0x70, 0x30, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 }, { 0x00, 0x00, 0x60, 0x60, 0x00 },
+    { 0x20, 0x10, 0x08, 0x04, 0x02 }, { 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 },
+    { 0x72, 0x49, 0x49, 0x49, 0x46 }, { 0x21, 0x41, 0x49, 0x4D, 0x33 }, { 0x18, 0x14, 0x12, 0x7F, 0x10 },
+    { 0x27, 0x45, 0x45, 0x45, 0x39 }, { 0x3C, 0x4A, 0x49, 0x49, 0x31 }, { 0x41, 0x21, 0x11, 0x09, 0x07 },
+    { 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x46, 0x49, 0x49, 0x29, 0x1E }, { 0x00, 0x00, 0x14, 0x00, 0x00 },
+    { 0x00, 0x40, 0x34, 0x00, 0x00 }, { 0x00, 0x08, 0x14, 0x22, 0x41 }, { 0x14, 0x14, 0x14, 0x14, 0x14 },
+    { 0x00, 0x41, 0x22, 0x14, 0x08 }, { 0x02, 0x01, 0x59, 0x09, 0x06 }, { 0x3E, 0x41, 0x5D, 0x59, 0x4E },
+    { 0x7C, 0x12, 0x11, 0x12, 0x7C }, { 0x7F, 0x49, 0x49, 0x49, 0x36 }, { 0x3E, 0x41, 0x41, 0x41, 0x22 },
+    { 0x7F, 0x41, 0x41, 0x41, 0x3E }, { 0x7F, 0x49, 0x49, 0x49, 0x41 }, { 0x7F, 0x09, 0x09, 0x09, 0x01 },
+    { 0x3E, 0x41, 0x41, 0x51, 0x73 }, { 0x7F, 0x08, 0x08, 0x08, 0x7F }, { 0x00, 0x41, 0x7F, 0x41, 0x00 },
+    { 0x20, 0x40, 0x41, 0x3F, 0x01 }, { 0x7F, 0x08, 0x14, 0x22, 0x41 }, { 0x7F, 0x40, 0x40, 0x40, 0x40 },
+    { 0x7F, 0x02, 0x1C, 0x02, 0x7F }, { 0x7F, 0x04, 0x08, 0x10, 0x7F }, { 0x3E, 0x41, 0x41, 0x41, 0x3E },
+    { 0x7F, 0x09, 0x09, 0x09, 0x06 }, { 0x3E, 0x41, 0x51, 0x21, 0x5E }, { 0x7F, 0x09, 0x19, 0x29, 0x46 },
+    { 0x26, 0x49, 0x49, 0x49, 0x32 }, { 0x03, 0x01, 0x7F, 0x01, 0x03 }, { 0x3F, 0x40, 0x40, 0x40, 0x3F },
+    { 0x1F, 0x20, 0x40, 0x20, 0x1F }, { 0x3F, 0x40, 0x38, 0x40, 0x3F }, { 0x63, 0x14, 0x08, 0x14, 0x63 },
+    { 0x03, 0x04, 0x78, 0x04, 0x03 }, { 0x61, 0x59, 0x49, 0x4D, 0x43 },
+};
+
+static const uint8_t *glyph(char c){
+    if ((c >= 'a') && (c <= 'z')){
+        c = (char)(c - 'a' + 'A');
+    }
+    if ((c < ' ') || (c > 'Z')){
+        c = '?';
+    }
+    return font[c - ' '];
+}
+
+/*
+    Layout
+
+    Fixed character grid per field: text is padded to chars, so a field never moves or changes size and
+    damage can be computed per character cell.
+*/
+static const struct {
+    uint16_t x;
+    uint16_t y;
+    uint8_t  scale;
+    uint8_t  chars;
+} layout[PANEL_FIELDS] = {
+    [PANEL_FIELD_VOUT]   = { 4,   4,   4, 7 },      // "12.000V"
+    [PANEL_FIELD_MODE]   = { 180, 24,  2, 5 },      // "BOOST"
+    [PANEL_FIELD_OUTPUT] = { 180, 4,   2, 5 },      // "  OFF"
+    [PANEL_FIELD_IOUT]   = { 4,   44,  3, 6 },      // "1.234A"
+    [PANEL_FIELD_POWER]  = { 124, 44,  3, 6 },      // "12.34W"
+    [PANEL_FIELD_VIN]    = { 4,   76,  2, 10 },     // "VIN 12.00V"
+    [PANEL_FIELD_FAULT]  = { 130, 76,  2, 9 },      // " OC SC OV"
+    [PANEL_FIELD_SET]    = { 4,   100, 2, 10 },     // "SET 12.00V"
+    [PANEL_FIELD_ILIM]   = { 130, 100, 2, 9 },      // "LIM 6.35A"
+};
+
+static inline uint16_t cellWidth(uint32_t field){
+    return (uint16_t)(PANEL_FONT_WIDTH * layout[field].scale);
+}
+
+/*
+    Panel Initialisation
+
+    Everything is damaged, so the first render clears the screen and draws every field.
+*/
+void panelInit(PANEL *panel){
+    memset(panel, 0, sizeof(*panel));
+    panelInvalidate(panel);
+}
+
+// Forgets what the display holds: next update redraws every field over a cleared background
+void panelInvalidate(PANEL *panel){
+    for (uint32_t f = 0; f < PANEL_FIELDS; f++){
+        memset(panel->shown[f].text, 0, sizeof(panel->shown[f].text));
+    }
+    panel->damage[PANEL_FIELDS] = (PANEL_RECT){ 0, 0, PANEL_WIDTH, PANEL_HEIGHT };
+    panel->damaged |= 1u << PANEL_FIELDS;
+}
+
+static void damage(PANEL *panel, uint32_t index, PANEL_RECT rect){
+    if (panel->damaged & (1u << index)){
+        PANEL_RECT *old = &panel->damage[index];
+        uint16_t left  = (old->x < rect.x) ? old->x : rect.x;
+        uint16_t right = ((old->x + old->width) > (rect.x + rect.width)) ? (old->x + old->width) : (rect.x + rect.width);
+        rect.x     = left;
+        rect.width = (uint16_t)(right - left);
+    }
+    panel->damage[index] = rect;
+    panel->damaged |= 1u << index;
+}
+
+// Compares with what is shown and damages only the character cells that differ
+static void setField(PANEL *panel, uint32_t field, const char *text, uint16_t fg, uint16_t bg){
+    PANEL_CELL *shown = &panel->shown[field];
+    uint8_t chars = layout[field].chars;
+    char padded[PANEL_MAX_TEXT + 1];
+    snprintf(padded, sizeof(padded), "%*.*s", chars, chars, text);
+
+    int first = 0;
+    int last = chars - 1;
+    if ((shown->fg == fg) && (shown->bg == bg) && (shown->text[0] != '\0')){
+        while ((first < chars) && (padded[first] == shown->text[first])){
+            first++;
+        }
+        if (first == chars){
+            return;
+        }
+        while (padded[last] == shown->text[last]){
+            last--;
+        }
+    }
+
+    memcpy(shown->text, padded, sizeof(shown->text));
+    shown->fg = fg;
+    shown->bg = bg;
+    damage(panel, field, (PANEL_RECT){
+        .x      = (uint16_t)(layout[field].x + first * cellWidth(field)),
+        .y      = layout[field].y,
+        .width  = (uint16_t)((last - first + 1) * cellWidth(field)),
+        .height = (uint16_t)(PANEL_FONT_HEIGHT * layout[field].scale),
+    });
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Formatting (integer only: no float printf on the target)
+
+static void formatMilli(char *out, size_t size, const char *label, uint32_t milli, uint32_t decimals,
+                        char unit, _Bool valid){
+    static const uint32_t divisors[] = { 1000, 100, 10, 1 };
+    uint32_t whole = milli / 1000;
+    uint32_t fraction = (milli % 1000) / divisors[decimals];
+    if (valid){
+        snprintf(out, size, "%s%u.%0*u%c", label, (unsigned int)whole, (int)decimals, (unsigned int)fraction, unit);
+    } else {
+        snprintf(out, size, "%s--.%.*s%c", label, (int)decimals, "---", unit);
+    }
+}
+
+static const char *modeName(uint8_t status){
+    TPS55289_STATUS_REG reg = { .regValue = status };
+    switch (reg.STATUS){
+        case 0b00:  return "BOOST";
+        case 0b01:  return "BUCK";
+        case 0b10:  return "B-B";
+        default:    return "?";
+    }
+}
+
+/*
+    Update
+
+    Formats a reading into the fields and records damage. Cheap enough to call every frame: nothing is
+    rendered here, and unchanged fields cost one string compare.
+*/
+void panelUpdate(PANEL *panel, const PANEL_READING *reading){
+    char text[PANEL_MAX_TEXT + 1];
+    _Bool status = (reading->valid & PANEL_VALID_STATUS) != 0;
+    uint16_t selectedFg = PANEL_BLACK;
+    uint16_t selectedBg = PANEL_CYAN;
+
+    formatMilli(text, sizeof(text), "", reading->VOUT, 3, 'V', (reading->valid & PANEL_VALID_VOUT) != 0);
+    setField(panel, PANEL_FIELD_VOUT, text, reading->output ? PANEL_WHITE : PANEL_GREY, PANEL_BLACK);
+
+    setField(panel, PANEL_FIELD_OUTPUT, reading->output ? "ON" : "OFF",
+             (reading->selected == PANEL_SELECT_OUTPUT) ? selectedFg : (reading->output ? PANEL_GREEN : PANEL_GREY),
+             (reading->selected == PANEL_SELECT_OUTPUT) ? selectedBg : PANEL_BLACK);
+
+    setField(panel, PANEL_FIELD_MODE, status ? modeName(reading->status) : "-", PANEL_CYAN, PANEL_BLACK);
+
+    formatMilli(text, sizeof(text), "", reading->IOUT, 3, 'A', (reading->valid & PANEL_VALID_IOUT) != 0);
+    setField(panel, PANEL_FIELD_IOUT, text, PANEL_AMBER, PANEL_BLACK);
+
+    uint32_t mW = (uint32_t)reading->VOUT * reading->IOUT / 1000;
+    _Bool power = (reading->valid & (PANEL_VALID_VOUT | PANEL_VALID_IOUT)) == (PANEL_VALID_VOUT | PANEL_VALID_IOUT);
+    formatMilli(text, sizeof(text), "", mW, (mW < 100000) ? 2 : 1, 'W', power);
+    setField(panel, PANEL_FIELD_POWER, text, PANEL_WHITE, PANEL_BLACK);
+
+    formatMilli(text, sizeof(text), "VIN ", reading->VIN, 2, 'V', (reading->valid & PANEL_VALID_VIN) != 0);
+    setField(panel, PANEL_FIELD_VIN, text, PANEL_WHITE, PANEL_BLACK);
+
+    TPS55289_STATUS_REG faults = { .regValue = status ? reading->status : 0 };
+    if (faults.SCP || faults.OCP || faults.OVP){
+        snprintf(text, sizeof(text), "%s%s%s", faults.OCP ? " OC" : "", faults.SCP ? " SC" : "", faults.OVP ? " OV" : "");
+        setField(panel, PANEL_FIELD_FAULT, text, PANEL_RED, PANEL_BLACK);
+    } else {
+        setField(panel, PANEL_FIELD_FAULT, status ? "OK" : "", PANEL_GREEN, PANEL_BLACK);
+    }
+
+    formatMilli(text, sizeof(text), "SET ", reading->setVOUT, 2, 'V', true);
+    setField(panel, PANEL_FIELD_SET, text,
+             (reading->selected == PANEL_SELECT_VOUT) ? selectedFg : PANEL_WHITE,
+             (reading->selected == PANEL_SELECT_VOUT) ? selectedBg : PANEL_BLACK);
+
+    formatMilli(text, sizeof(text), "LIM ", reading->setILIM, 2, 'A', true);
+    setField(panel, PANEL_FIELD_ILIM, text,
+             (reading->selected == PANEL_SELECT_ILIM) ? selectedFg : PANEL_WHITE,
+             (reading->selected == PANEL_SELECT_ILIM) ? selectedBg : PANEL_BLACK);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Rendering
+
+typedef struct {
+    const PANEL_DISPLAY *display;
+    uint16_t *strip[2];
+    uint32_t next;                      // Strip to fill next
+    _Bool    ok;
+} PANEL_BLITTER;
+
+static void blit(PANEL *panel, PANEL_BLITTER *blitter, const PANEL_RECT *rect){
+    if (blitter->display->blit(blitter->display->context, rect, blitter->strip[blitter->next]) == false){
+        blitter->ok = false;
+    }
+    panel->stats.blits++;
+    panel->stats.pixels += (uint32_t)rect->width * rect->height;
+    blitter->next ^= 1;
+}
+
+static void renderFill(PANEL *panel, PANEL_BLITTER *blitter, const PANEL_RECT *rect, uint16_t colour){
+    uint16_t rows = (uint16_t)(PANEL_STRIP_PIXELS / rect->width);
+    for (uint16_t y = 0; y < rect->height; y += rows){
+        PANEL_RECT band = { rect->x, (uint16_t)(rect->y + y), rect->width,
+                            (uint16_t)((rect->height - y < rows) ? rect->height - y : rows) };
+        uint16_t *p = blitter->strip[blitter->next];
+        for (uint32_t i = 0; i < (uint32_t)band.width * band.height; i++){
+            p[i] = colour;
+        }
+        blit(panel, blitter, &band);
+    }
+}
+
+/*
+    Text Rectangle
+
+    rect is character-aligned (setField only damages whole cells), so each pixel row is built one glyph
+    column at a time and every column bit fans out to scale pixels.
+*/
+static void renderText(PANEL *panel, PANEL_BLITTER *blitter, uint32_t field, const PANEL_RECT *rect){
+    const PANEL_CELL *cell = &panel->shown[field];
+    uint8_t scale = layout[field].scale;
+    uint16_t first = (uint16_t)((rect->x - layout[field].x) / cellWidth(field));
+    uint16_t chars = (uint16_t)(rect->width / cellWidth(field));
+    uint16_t rows = (uint16_t)(PANEL_STRIP_PIXELS / rect->width);
+
+    for (uint16_t y = 0; y < rect->height; y += rows){
+        PANEL_RECT band = { rect->x, (uint16_t)(rect->y + y), rect->width,
+                            (uint16_t)((rect->height - y < rows) ? rect->height - y : rows) };
+        uint16_t *p = blitter->strip[blitter->next];
+        for (uint16_t row = 0; row < band.height; row++){
+            uint8_t bit = (uint8_t)(1u << ((y + row) / scale));
+            for (uint16_t c = 0; c < chars; c++){
+                const uint8_t *columns = glyph(cell->text[first + c]);
+                for (uint32_t col = 0; col < PANEL_FONT_WIDTH; col++){
+                    uint16_t colour = ((col < 5) && (columns[col] & bit)) ? cell->fg : cell->bg;
+                    for (uint8_t s = 0; s < scale; s++){
+                        *p++ = colour;
+                    }
+                }
+            }
+        }
+        blit(panel, blitter, &band);
+    }
+}
+
+/*
+    Render
+
+    Sends every damaged rectangle, background first. Strips alternate so the CPU fills one while the
+    display backend is still sending the other. Returns false if the backend reported an error; the
+    damage is consumed either way and the caller should panelInvalidate to recover.
+*/
+_Bool panelRender(PANEL *panel, const PANEL_DISPLAY *display){
+    PANEL_BLITTER blitter = { .display = display, .strip = { panel->strip[0], panel->strip[1] }, .ok = true };
+
+    if (panel->damaged & (1u << PANEL_FIELDS)){
+        renderFill(panel, &blitter, &panel->damage[PANEL_FIELDS], PANEL_BLACK);
+    }
+    for (uint32_t f = 0; f < PANEL_FIELDS; f++){
+        if (panel->damaged & (1u << f)){
+            renderText(panel, &blitter, f, &panel->damage[f]);
+        }
+    }
+    panel->damaged = 0;
+    panel->stats.frames++;
+    if (display->wait != NULL){
+        display->wait(display->context);
+    }
+    return blitter.ok;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Rotary Encoder
+
+// Indexed by (previous << 2) | current with state = (A << 1) | B; invalid double steps count as 0
+static const int8_t quadrature[16] = { 0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0 };
+
+void panelEncoderInit(PANEL_ENCODER *encoder, _Bool a, _Bool b){
+    encoder->state   = (uint8_t)((a << 1) | b);
+    encoder->steps   = 0;
+    encoder->detents = 0;
+    encoder->taken   = 0;
+}
+
+// Called from the GPIO interrupt on any edge of A or B
+void panelEncoderEdge(PANEL_ENCODER *encoder, _Bool a, _Bool b){
+    uint8_t state = (uint8_t)((a << 1) | b);
+    encoder->steps = (int8_t)(encoder->steps + quadrature[(encoder->state << 2) | state]);
+    encoder->state = state;
+    if (encoder->steps >= PANEL_ENCODER_STEPS){
+        encoder->steps = 0;
+        encoder->detents++;
+    } else if (encoder->steps <= -PANEL_ENCODER_STEPS){
+        encoder->steps = 0;
+        encoder->detents--;
+    }
+}
+
+// Detents since the last call, positive clockwise. detents is only written by the interrupt and read
+// with one aligned load, so no lock is needed even with the interrupt on the other core.
+int32_t panelEncoderTake(PANEL_ENCODER *encoder){
+    int32_t detents = encoder->detents;
+    int32_t delta = detents - encoder->taken;
+    encoder->taken = detents;
+    return delta;
+}
@@ -0,0 +1,156 @@
+// ST7789 display backend for the front panel: SPI with DMA pixel transfers
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/spi.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "panel.h"
+#include "pindefinitions.h"
+
+// clk_peri runs from PLL_USB (power_rp2040.c), so this is capped at 24 MHz by the SPI clock divider
+#define ST7789_BAUD                     62500000
+#define ST7789_DMA_TIMEOUT_MS           50
+
+// 240x135 glass in a 320x240 controller, landscape
+#define ST7789_COLUMN_OFFSET            40
+#define ST7789_ROW_OFFSET               53
+
+#define ST7789_SWRESET                  0x01
+#define ST7789_SLPOUT                   0x11
+#define ST7789_NORON                    0x13
+#define ST7789_INVON                    0x21
+#define ST7789_DISPON                   0x29
+#define ST7789_CASET                    0x2A
+#define ST7789_RASET                    0x2B
+#define ST7789_RAMWR                    0x2C
+#define ST7789_MADCTL                   0x36
+#define ST7789_COLMOD                   0x3A
+
+static int dmaChannel = -1;
+static volatile _Bool busy;
+static volatile TaskHandle_t waiter;
+
+static void command(uint8_t cmd, const uint8_t *data, size_t len){
+    gpio_put(PANEL_PIN_DC, 0);
+    spi_write_blocking(PANEL_SPI, &cmd, 1);
+    gpio_put(PANEL_PIN_DC, 1);
+    if (len > 0){
+        spi_write_blocking(PANEL_SPI, data, len);
+    }
+}
+
+// DMA done means the last pixel is in the SPI FIFO; the few frames still shifting out take under 2 us
+static void st7789DmaHandler(void){
+    if ((dmaChannel < 0) || !dma_channel_get_irq1_status((uint)dmaChannel)){
+        return;
+    }
+    dma_channel_acknowledge_irq1((uint)dmaChannel);
+    while (spi_is_busy(PANEL_SPI)){
+        tight_loop_contents();
+    }
+    gpio_put(PANEL_PIN_CS, 1);
+    busy = false;
+
+    BaseType_t woken = pdFALSE;
+    if (waiter != NULL){
+        vTaskNotifyGiveFromISR(waiter, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+// Sleeps the calling task until the pixel transfer in flight has finished
+static void st7789Wait(void *context){
+    (void)context;
+    while (busy){
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ST7789_DMA_TIMEOUT_MS)) == 0 && busy){
+            dma_channel_abort((uint)dmaChannel);
+            gpio_put(PANEL_PIN_CS, 1);
+            busy = false;
+        }
+    }
+}
+
+/*
+    Blit
+
+    Sets the address window with blocking 8-bit writes, then switches the SPI to 16-bit frames so the
+    RGB565 buffer goes out MSB first straight from memory, and returns with the DMA running.
+*/
+static _Bool st7789Blit(void *context, const PANEL_RECT *rect, const uint16_t *pixels){
+    _Bool STATUS = true;
+    st7789Wait(context);
+
+    uint16_t x0 = (uint16_t)(rect->x + ST7789_COLUMN_OFFSET);
+    uint16_t x1 = (uint16_t)(x0 + rect->width - 1);
+    uint16_t y0 = (uint16_t)(rect->y + ST7789_ROW_OFFSET);
+    uint16_t y1 = (uint16_t)(y0 + rect->height - 1);
+    uint8_t columns[4] = { (uint8_t)(x0 >> 8), (uint8_t)x0, (uint8_t)(x1 >> 8), (uint8_t)x1 };
+    uint8_t rows[4]    = { (uint8_t)(y0 >> 8), (uint8_t)y0, (uint8_t)(y1 >> 8), (uint8_t)y1 };
+
+    spi_set_format(PANEL_SPI, 8, SPI_CPOL_1, SPI_CPHA_1, SPI_MSB_FIRST);
+    gpio_put(PANEL_PIN_CS, 0);
+    command(ST7789_CASET, columns, sizeof(columns));
+    command(ST7789_RASET, rows, sizeof(rows));
+    command(ST7789_RAMWR, NULL, 0);
+    spi_set_format(PANEL_SPI, 16, SPI_CPOL_1, SPI_CPHA_1, SPI_MSB_FIRST);
+
+    waiter = xTaskGetCurrentTaskHandle();
+    busy = true;
+    dma_channel_transfer_from_buffer_now((uint)dmaChannel, pixels, (uint32_t)rect->width * rect->height);
+    return STATUS;
+}
+
+/*
+    ST7789 Initialisation
+
+    Runs before the scheduler starts (blocking delays). Claims one DMA channel and shares DMA_IRQ_1.
+*/
+_Bool panelST7789Init(PANEL_DISPLAY *display){
+    _Bool STATUS = true;
+    dmaChannel = dma_claim_unused_channel(false);
+    if (dmaChannel < 0){
+        STATUS = false;
+        return STATUS;
+    }
+
+    spi_init(PANEL_SPI, ST7789_BAUD);
+    spi_set_format(PANEL_SPI, 8, SPI_CPOL_1, SPI_CPHA_1, SPI_MSB_FIRST);
+    gpio_set_function(PANEL_PIN_SCK, GPIO_FUNC_SPI);
+    gpio_set_function(PANEL_PIN_MOSI, GPIO_FUNC_SPI);
+    uint32_t outputs = (1u << PANEL_PIN_CS) | (1u << PANEL_PIN_DC) | (1u << PANEL_PIN_BACKLIGHT);
+    gpio_init_mask(outputs);
+    gpio_set_dir_out_masked(outputs);
+    gpio_put(PANEL_PIN_CS, 1);
+
+    dma_channel_config config = dma_channel_get_default_config((uint)dmaChannel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+    channel_config_set_dreq(&config, spi_get_dreq(PANEL_SPI, true));
+    dma_channel_configure((uint)dmaChannel, &config, &spi_get_hw(PANEL_SPI)->dr, NULL, 0, false);
+    dma_channel_set_irq1_enabled((uint)dmaChannel, true);
+    irq_add_shared_handler(DMA_IRQ_1, st7789DmaHandler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+
+    static const uint8_t colmod = 0x55;             // 16 bits per pixel
+    static const uint8_t madctl = 0x70;             // Landscape, RGB
+    gpio_put(PANEL_PIN_CS, 0);
+    command(ST7789_SWRESET, NULL, 0);
+    sleep_ms(150);
+    command(ST7789_SLPOUT, NULL, 0);
+    sleep_ms(10);
+    command(ST7789_COLMOD, &colmod, 1);
+    command(ST7789_MADCTL, &madctl, 1);
+    command(ST7789_INVON, NULL, 0);
+    command(ST7789_NORON, NULL, 0);
+    command(ST7789_DISPON, NULL, 0);
+    gpio_put(PANEL_PIN_CS, 1);
+    gpio_put(PANEL_PIN_BACKLIGHT, 1);
+
+    display->blit    = st7789Blit;
+    display->wait    = st7789Wait;
+    display->context = NULL;
+    return STATUS;
+}
@@ -0,0 +1,187 @@
+// Front panel task: samples the converter, handles the encoder and redraws what changed
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "TPS55289.h"
+#include "TPS55289_state.h"
+#include "panel.h"
+#include "pindefinitions.h"
+#include "power_manager.h"
+
+// Frame period in ticks; stretched while the power manager has clocked down. Input wakes the task early.
+#define PANEL_FRAME_PERIOD              50
+#define PANEL_IDLE_PERIOD               250
+
+#define PANEL_VOUT_STEP_MV              100
+#define PANEL_VOUT_MIN_MV               800
+#define PANEL_VOUT_MAX_MV               22000
+#define PANEL_ILIM_STEP_MA              50
+#define PANEL_ILIM_MAX_MA               6350
+#define PANEL_BUTTON_DEBOUNCE_US        30000
+
+static PANEL panel;
+static PANEL_DISPLAY display;
+static _Bool displayReady;
+static PANEL_ENCODER encoder;
+static volatile uint32_t presses;
+static uint32_t pressesTaken;
+static uint64_t lastPress;
+static volatile TaskHandle_t panelTaskHandle;
+
+static TPS55289 *panelDevice;
+static PANEL_SAMPLE panelSample;
+static void *panelContext;
+static uint16_t setVOUT;                // in mV
+static uint16_t setILIM;                // in mA
+static uint8_t selected;                // PANEL_SELECT
+
+// Encoder edges and button presses; wakes the task so the display follows the knob without waiting a frame
+static void panelGpioCallback(uint gpio, uint32_t events){
+    if (gpio == PANEL_PIN_ENC_BUTTON){
+        uint64_t now = time_us_64();
+        if ((events & GPIO_IRQ_EDGE_FALL) && (now - lastPress > PANEL_BUTTON_DEBOUNCE_US)){
+            presses++;
+        }
+        lastPress = now;
+    } else {
+        panelEncoderEdge(&encoder, gpio_get(PANEL_PIN_ENC_A), gpio_get(PANEL_PIN_ENC_B));
+    }
+
+    BaseType_t woken = pdFALSE;
+    if (panelTaskHandle != NULL){
+        vTaskNotifyGiveFromISR(panelTaskHandle, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+/*
+    Panel Task Initialisation
+
+    device may be NULL: the panel then shows dashes and the encoder edits nothing. sample supplies
+    VIN/VOUT/IOUT; without it those readouts stay dashed and only setpoints, output state and STATUS are
+    live.
+*/
+void panelTaskInit(TPS55289 *device, PANEL_SAMPLE sample, void *context){
+    panelDevice  = device;
+    panelSample  = sample;
+    panelContext = context;
+    if (device != NULL){
+        TPS55289_SNAPSHOT snapshot;
+        TPS55289_IOUT_LIMIT_REG limit;
+        TPS55289Snapshot(device, &snapshot);
+        limit.regValue = snapshot.currentLimit;
+        setVOUT = (uint16_t)(snapshot.VOUT * 1000.0f + 0.5f);
+        setILIM = (uint16_t)(limit.Current_Limit_Setting * 500 / TPPS55289_SENSE_RESISTOR);
+    }
+
+    panelInit(&panel);
+    displayReady = panelST7789Init(&display);
+
+    uint32_t inputs = (1u << PANEL_PIN_ENC_A) | (1u << PANEL_PIN_ENC_B) | (1u << PANEL_PIN_ENC_BUTTON);
+    gpio_init_mask(inputs);
+    gpio_pull_up(PANEL_PIN_ENC_A);
+    gpio_pull_up(PANEL_PIN_ENC_B);
+    gpio_pull_up(PANEL_PIN_ENC_BUTTON);
+    panelEncoderInit(&encoder, gpio_get(PANEL_PIN_ENC_A), gpio_get(PANEL_PIN_ENC_B));
+    gpio_set_irq_enabled_with_callback(PANEL_PIN_ENC_A, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true, panelGpioCallback);
+    gpio_set_irq_enabled(PANEL_PIN_ENC_B, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true);
+    gpio_set_irq_enabled(PANEL_PIN_ENC_BUTTON, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true);
+}
+
+static int32_t clamp(int32_t value, int32_t min, int32_t max){
+    return (value < min) ? min : ((value > max) ? max : value);
+}
+
+/*
+    Input
+
+    A press cycles the selection (none, VOUT, ILIM, output); detents adjust the selected setpoint and are
+    applied to the converter at once. A setpoint the driver refuses is left unchanged on screen.
+*/
+static void panelInput(void){
+    int32_t detents = panelEncoderTake(&encoder);
+    uint32_t count = presses;
+    if (count != pressesTaken){
+        selected = (uint8_t)((selected + (count - pressesTaken)) % PANEL_SELECTS);
+        pressesTaken = count;
+        powerManagerActivity();
+    }
+    if ((detents == 0) || (selected == PANEL_SELECT_NONE) || (panelDevice == NULL)){
+        return;
+    }
+    powerManagerActivity();
+
+    switch (selected){
+        case PANEL_SELECT_VOUT: {
+            int32_t mV = clamp(setVOUT + detents * PANEL_VOUT_STEP_MV, PANEL_VOUT_MIN_MV, PANEL_VOUT_MAX_MV);
+            if (setOutputVoltage(panelDevice, mV / 1000.0f) == true){
+                setVOUT = (uint16_t)mV;
+            }
+            break;
+        }
+        case PANEL_SELECT_ILIM: {
+            int32_t mA = clamp(setILIM + detents * PANEL_ILIM_STEP_MA, 0, PANEL_ILIM_MAX_MA);
+            if (setOutputCurrentLimit(panelDevice, mA / 1000.0f) == true){
+                setILIM = (uint16_t)mA;
+            }
+            break;
+        }
+        case PANEL_SELECT_OUTPUT:
+            if (detents > 0){
+                enableDevice(panelDevice);
+            } else {
+                disableDevice(panelDevice);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void panelRead(PANEL_READING *reading){
+    memset(reading, 0, sizeof(*reading));
+    reading->setVOUT  = setVOUT;
+    reading->setILIM  = setILIM;
+    reading->selected = selected;
+    if (panelDevice != NULL){
+        TPS55289_SNAPSHOT snapshot;
+        TPS55289_MODE_REG mode;
+        _Bool statusRead = readStatusRegister(panelDevice);
+        TPS55289Snapshot(panelDevice, &snapshot);
+        mode.regValue   = snapshot.mode;
+        reading->output = mode.OE;
+        if (statusRead){
+            reading->status = snapshot.status;
+            reading->valid |= PANEL_VALID_STATUS;
+        }
+    }
+    if (panelSample != NULL){
+        panelSample(panelContext, reading);
+    }
+}
+
+/*
+    Panel Task
+
+    Lowest priority above idle: rendering only fills strip buffers while the DMA sends the previous one,
+    and the task sleeps on the DMA interrupt, so it never holds the CPU from the power-control tasks.
+*/
+void panelTask(void *param){
+    (void)param;
+    panelTaskHandle = xTaskGetCurrentTaskHandle();
+    for (;;){
+        PANEL_READING reading;
+        panelInput();
+        panelRead(&reading);
+        panelUpdate(&panel, &reading);
+        if (displayReady && (panelRender(&panel, &display) == false)){
+            panelInvalidate(&panel);
+        }
+        ulTaskNotifyTake(pdTRUE, powerManagerIsIdle() ? PANEL_IDLE_PERIOD : PANEL_FRAME_PERIOD);
+    }
+}
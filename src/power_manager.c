@@ -0,0 +1,210 @@
+// Idle power management: MCU clock-down and TPS55289 PFM/FPWM selection
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#include "TPS55289.h"
+#include "TPS55289_state.h"
+#include "power_manager.h"
+
+static POWER_SET_CLOCK powerSetClock;
+static POWER_MANAGER_STATS stats;
+static volatile uint32_t pendingWork;
+static volatile uint64_t lastActivity;
+static volatile uint32_t sleepingCores;        // Bit per core inside tickless sleep
+static uint8_t  currentClock;
+static uint64_t clockSince;
+static spin_lock_t *powerLock;
+
+static inline uint32_t lockPower(void){
+    return (powerLock != NULL) ? spin_lock_blocking(powerLock) : save_and_disable_interrupts();
+}
+
+static inline void unlockPower(uint32_t irq){
+    if (powerLock != NULL){
+        spin_unlock(powerLock, irq);
+    } else {
+        restore_interrupts(irq);
+    }
+}
+
+// Caller holds powerLock
+static void switchClock(POWER_CLOCK target, uint64_t now){
+    stats.residency[currentClock] += now - clockSince;
+    clockSince = now;
+    if (currentClock == target){
+        return;
+    }
+    currentClock = target;
+    stats.clockSwitches++;
+    if (powerSetClock != NULL){
+        powerSetClock(target);
+    }
+}
+
+/*
+    Power Manager Initialisation
+
+    setClock is the platform hook that moves the system clock between full speed and the low-power
+    clock (power_rp2040.c on target). Starts at full clock with nothing pending.
+*/
+void powerManagerInit(POWER_SET_CLOCK setClock){
+    uint64_t now = time_us_64();
+    powerSetClock = setClock;
+    pendingWork   = 0;
+    sleepingCores = 0;
+    lastActivity  = now;
+    currentClock  = POWER_CLOCK_FULL;
+    clockSince    = now;
+    stats         = (POWER_MANAGER_STATS){ .since = now };
+    if (powerLock == NULL){
+        powerLock = spin_lock_instance(spin_lock_claim_unused(true));
+    }
+}
+
+/*
+    Activity
+
+    Called for every host command. Restores the full clock immediately and restarts the idle holdoff.
+*/
+void powerManagerActivity(void){
+    uint64_t now = time_us_64();
+    uint32_t irq = lockPower();
+    lastActivity = now;
+    switchClock(POWER_CLOCK_FULL, now);
+    unlockPower(irq);
+}
+
+void powerManagerSetPending(uint32_t pending){
+    uint32_t irq = lockPower();
+    pendingWork |= pending;
+    switchClock(POWER_CLOCK_FULL, time_us_64());
+    unlockPower(irq);
+}
+
+void powerManagerClearPending(uint32_t pending){
+    uint32_t irq = lockPower();
+    pendingWork &= ~pending;
+    unlockPower(irq);
+}
+
+/*
+    Evaluate
+
+    Clocks down once nothing is pending and no command has arrived for POWER_IDLE_HOLDOFF_US.
+    Returns true if the MCU is (now) in the low-power clock.
+*/
+_Bool powerManagerEvaluate(void){
+    uint64_t now = time_us_64();
+    uint32_t irq = lockPower();
+    if ((pendingWork == 0) && ((now - lastActivity) >= POWER_IDLE_HOLDOFF_US)){
+        switchClock(POWER_CLOCK_LOW, now);
+    }
+    _Bool idle = (currentClock == POWER_CLOCK_LOW);
+    unlockPower(irq);
+    return idle;
+}
+
+// Tasks use this to stretch their periods while idle; it never changes the clock
+_Bool powerManagerIsIdle(void){
+    return currentClock == POWER_CLOCK_LOW;
+}
+
+/*
+    Tickless Idle Hooks
+
+    configPRE_SLEEP_PROCESSING / configPOST_SLEEP_PROCESSING. The SMP kernel calls these per core, so one
+    core reaching tickless idle says nothing about the other. clk_sys is shared by both cores, so the idle
+    policy is only evaluated once every core is inside its sleep; a core that never enters tickless idle
+    keeps the full clock. The sleep itself is never vetoed.
+*/
+void powerManagerPreSleep(uint32_t *expectedIdleTicks){
+    (void)expectedIdleTicks;
+    uint32_t irq = lockPower();
+    sleepingCores |= 1u << get_core_num();
+    _Bool allAsleep = (sleepingCores == ((1u << POWER_CORES) - 1));
+    unlockPower(irq);
+    if (allAsleep){
+        powerManagerEvaluate();
+    }
+}
+
+void powerManagerPostSleep(uint32_t *expectedIdleTicks){
+    (void)expectedIdleTicks;
+    uint32_t irq = lockPower();
+    sleepingCores &= ~(1u << get_core_num());
+    stats.wakeups++;
+    unlockPower(irq);
+}
+
+// Residency is brought up to date on every call
+const POWER_MANAGER_STATS *powerManagerStats(void){
+    uint32_t irq = lockPower();
+    switchClock(currentClock, time_us_64());
+    unlockPower(irq);
+    return &stats;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Converter Light-Load Mode
+
+static void accountConverter(POWER_CONVERTER *converter){
+    uint64_t now = time_us_64();
+    converter->residency[converter->mode] += now - converter->lastUpdate;
+    converter->lastUpdate = now;
+}
+
+// Starts the converter in FPWM, the mode that is always safe at any load
+_Bool powerConverterInit(POWER_CONVERTER *converter, TPS55289 *device){
+    *converter = (POWER_CONVERTER){ .mode = POWER_MODE_FPWM, .lastUpdate = time_us_64() };
+    return FSWOpMode(device, POWER_MODE_FPWM);
+}
+
+/*
+    Converter Update
+
+    Called with every IOUT measurement (mA). Drops to PFM only after POWER_PFM_ENTER_SAMPLES consecutive
+    samples below POWER_PFM_ENTER_CURRENT and returns to FPWM on the first sample above
+    POWER_PFM_EXIT_CURRENT, so load noise around a single threshold cannot make the mode chatter.
+    Latched SCP/OCP/OVP flags in the last STATUS read are reported as pending work to the idle policy.
+    Inert on target until an ADC supplies IOUT: nothing in the firmware calls it yet.
+*/
+_Bool powerConverterUpdate(POWER_CONVERTER *converter, TPS55289 *device, uint16_t IOUT){
+    _Bool STATUS = true;
+    uint8_t target = converter->mode;
+
+    TPS55289_SNAPSHOT snapshot;
+    TPS55289_STATUS_REG status;
+    TPS55289Snapshot(device, &snapshot);
+    status.regValue = snapshot.status;
+
+    accountConverter(converter);
+    if ((status.SCP | status.OCP | status.OVP) != 0){
+        powerManagerSetPending(POWER_PENDING_FAULT);
+    } else {
+        powerManagerClearPending(POWER_PENDING_FAULT);
+    }
+
+    if (IOUT > POWER_PFM_EXIT_CURRENT){
+        converter->lightLoadSamples = 0;
+        target = POWER_MODE_FPWM;
+    } else if (IOUT < POWER_PFM_ENTER_CURRENT){
+        if (converter->lightLoadSamples < POWER_PFM_ENTER_SAMPLES){
+            converter->lightLoadSamples++;
+        }
+        if (converter->lightLoadSamples >= POWER_PFM_ENTER_SAMPLES){
+            target = POWER_MODE_PFM;
+        }
+    } else {
+        converter->lightLoadSamples = 0;
+    }
+
+    if (target != converter->mode){
+        if (FSWOpMode(device, target) != true){
+            STATUS = false;
+            return STATUS;
+        }
+        converter->mode = target;
+        converter->switches++;
+    }
+    return STATUS;
+}
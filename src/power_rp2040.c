@@ -0,0 +1,35 @@
+// RP2040 clock control for the power manager
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+
+#include "power_manager.h"
+
+#define POWER_LOW_CLOCK_HZ              (48 * MHZ)  // PLL_USB; keeps running for USB in every mode
+
+static uint32_t fullClockHz;
+
+/*
+    Platform Initialisation
+
+    clk_peri follows clk_sys after clocks_init. Moving it onto PLL_USB keeps the I2C/UART/SPI baud rates
+    fixed while clk_sys changes, so this must run before any peripheral is initialised. The FreeRTOS tick
+    already runs from the 1 MHz reference tick (configSYSTICK_CLOCK_HZ) and is unaffected.
+*/
+void powerPlatformInit(void){
+    fullClockHz = clock_get_hz(clk_sys);
+    clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB, 48 * MHZ, 48 * MHZ);
+}
+
+/*
+    Switch clk_sys between PLL_SYS and PLL_USB. Both PLLs stay locked, so the switch is a glitchless mux
+    change rather than a PLL relock and takes a few microseconds.
+*/
+void powerPlatformSetClock(POWER_CLOCK clock){
+    if (clock == POWER_CLOCK_LOW){
+        clock_configure(clk_sys, CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX,
+                        CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB, 48 * MHZ, POWER_LOW_CLOCK_HZ);
+    } else {
+        clock_configure(clk_sys, CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX,
+                        CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS, fullClockHz, fullClockHz);
+    }
+}
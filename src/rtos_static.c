@@ -0,0 +1,72 @@
+// Static allocation helpers for FreeRTOS objects
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+#include "rtos_static.h"
+
+TaskHandle_t rtosCreateTask(TaskFunction_t function, const char *name, uint32_t stackDepth, void *param,
+                            UBaseType_t priority, StackType_t *stack, StaticTask_t *tcb){
+#if USBPD_STATIC_ALLOCATION
+    return xTaskCreateStatic(function, name, stackDepth, param, priority, stack, tcb);
+#else
+    TaskHandle_t handle = NULL;
+    (void)stack;
+    (void)tcb;
+    if (xTaskCreate(function, name, stackDepth, param, priority, &handle) != pdPASS){
+        return NULL;
+    }
+    return handle;
+#endif
+}
+
+QueueHandle_t rtosCreateQueue(UBaseType_t length, UBaseType_t itemSize, uint8_t *storage, StaticQueue_t *buffer){
+#if USBPD_STATIC_ALLOCATION
+    return xQueueCreateStatic(length, itemSize, storage, buffer);
+#else
+    (void)storage;
+    (void)buffer;
+    return xQueueCreate(length, itemSize);
+#endif
+}
+
+#if USBPD_STATIC_ALLOCATION
+/*
+    Kernel Task Memory
+
+    Required by FreeRTOS when configSUPPORT_STATIC_ALLOCATION is 1. The idle and timer task stacks are
+    sized from FreeRTOSConfig.h and land in .bss like every other task.
+*/
+static StaticTask_t idleTaskTCB;
+static StackType_t idleTaskStack[configMINIMAL_STACK_SIZE];
+
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer,
+                                   uint32_t *pulIdleTaskStackSize){
+    *ppxIdleTaskTCBBuffer   = &idleTaskTCB;
+    *ppxIdleTaskStackBuffer = idleTaskStack;
+    *pulIdleTaskStackSize   = configMINIMAL_STACK_SIZE;
+}
+
+#if (tskKERNEL_VERSION_MAJOR >= 11) && (configNUMBER_OF_CORES > 1)
+// V11 SMP kernels ask for one passive idle task per additional core
+static StaticTask_t passiveIdleTaskTCB[configNUMBER_OF_CORES - 1];
+static StackType_t passiveIdleTaskStack[configNUMBER_OF_CORES - 1][configMINIMAL_STACK_SIZE];
+
+void vApplicationGetPassiveIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer,
+                                          uint32_t *pulIdleTaskStackSize, BaseType_t xPassiveIdleTaskIndex){
+    *ppxIdleTaskTCBBuffer   = &passiveIdleTaskTCB[xPassiveIdleTaskIndex];
+    *ppxIdleTaskStackBuffer = passiveIdleTaskStack[xPassiveIdleTaskIndex];
+    *pulIdleTaskStackSize   = configMINIMAL_STACK_SIZE;
+}
+#endif
+
+static StaticTask_t timerTaskTCB;
+static StackType_t timerTaskStack[configTIMER_TASK_STACK_DEPTH];
+
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer,
+                                    uint32_t *pulTimerTaskStackSize){
+    *ppxTimerTaskTCBBuffer   = &timerTaskTCB;
+    *ppxTimerTaskStackBuffer = timerTaskStack;
+    *pulTimerTaskStackSize   = configTIMER_TASK_STACK_DEPTH;
+}
+#endif
@@ -0,0 +1,75 @@
+// FreeRTOS task that runs uploaded scripts on the hardware timer
+#include "pico/stdlib.h"
+#include "pico/time.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "script_vm.h"
+#include "usb_protocol.h"
+
+static SCRIPT_VM scriptVm;
+static TaskHandle_t scriptTaskHandle;
+static alarm_id_t scriptAlarmId;
+
+// Timer IRQ at the WAIT deadline
+static int64_t scriptAlarm(alarm_id_t id, void *userData){
+    (void)id; (void)userData;
+    BaseType_t woken = pdFALSE;
+    scriptAlarmId = 0;
+    vTaskNotifyGiveFromISR(scriptTaskHandle, &woken);
+    portYIELD_FROM_ISR(woken);
+    return 0;
+}
+
+/*
+    Script Task Initialisation
+
+    No ADC is wired to the interpreter yet, so MEASURE only supports the STATUS channel on target.
+    Must be called after usbDeviceInit.
+*/
+void scriptTaskInit(TPS55289 *device){
+    scriptVmInit(&scriptVm, device, NULL, NULL);
+    usbProtocolSetScript(&scriptVm, scriptTaskWake);
+}
+
+// Called by the protocol after RUN and STOP
+void scriptTaskWake(void){
+    if (scriptTaskHandle != NULL){
+        xTaskNotifyGive(scriptTaskHandle);
+    }
+}
+
+/*
+    Script Task
+
+    WAIT deadlines go to a hardware alarm, which notifies the task from the timer interrupt; nothing in
+    the schedule depends on the tick or on when the USB task runs. Long instruction runs block for a
+    tick every SCRIPT_VM_SLICE instructions: the task sits above USB, so a bare yield would hand the
+    core straight back to it and a script without WAITs would starve the USB task.
+*/
+void scriptTask(void *param){
+    (void)param;
+    scriptTaskHandle = xTaskGetCurrentTaskHandle();
+    for(;;){
+        SCRIPT_STATE state = scriptVmStep(&scriptVm);
+        if (state == SCRIPT_STATE_RUNNING){
+            vTaskDelay(1);
+            continue;
+        }
+        if (state == SCRIPT_STATE_WAITING){
+            if (scriptAlarmId > 0){
+                cancel_alarm(scriptAlarmId);
+            }
+            scriptAlarmId = add_alarm_at(from_us_since_boot(scriptVm.wakeAt), scriptAlarm, NULL, false);
+            if (scriptAlarmId == 0){
+                continue;                   // Deadline already passed
+            }
+            if (scriptAlarmId < 0){
+                vTaskDelay(1);              // No alarm slot free; fall back to the tick
+                continue;
+            }
+        }
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
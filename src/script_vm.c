@@ -0,0 +1,361 @@
+// Bytecode interpreter for uploaded DUT power sequence scripts
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+#include "TPS55289.h"
+#include "script_vm.h"
+
+// Encoded size of each instruction; 0 for opcodes that do not exist
+static uint8_t instructionLength(uint8_t opcode){
+    switch (opcode){
+        case SCRIPT_OP_END:     return 1;
+        case SCRIPT_OP_FAIL:    return 2;
+        case SCRIPT_OP_WAIT:    return 5;
+        case SCRIPT_OP_SYNC:    return 1;
+        case SCRIPT_OP_VOUT:    return 3;
+        case SCRIPT_OP_VOUT_R:  return 2;
+        case SCRIPT_OP_ILIM:    return 3;
+        case SCRIPT_OP_ILIM_R:  return 2;
+        case SCRIPT_OP_OUTPUT:  return 2;
+        case SCRIPT_OP_MEASURE: return 3;
+        case SCRIPT_OP_LOAD:    return 6;
+        case SCRIPT_OP_ADD:     return 6;
+        case SCRIPT_OP_MOV:     return 3;
+        case SCRIPT_OP_SUB:     return 3;
+        case SCRIPT_OP_JMP:     return 3;
+        case SCRIPT_OP_DJNZ:    return 4;
+        case SCRIPT_OP_JLT:     return 8;
+        case SCRIPT_OP_JGT:     return 8;
+        case SCRIPT_OP_JSET:    return 4;
+        case SCRIPT_OP_JCLR:    return 4;
+        case SCRIPT_OP_REPORT:  return 3;
+        default:                return 0;
+    }
+}
+
+static inline uint16_t read16(const uint8_t *src){
+    uint16_t value;
+    memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+static inline int32_t read32(const uint8_t *src){
+    int32_t value;
+    memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+// Offset of the jump operand within a branch instruction, 0 if the instruction does not branch
+static uint8_t jumpOperand(uint8_t opcode){
+    switch (opcode){
+        case SCRIPT_OP_JMP:     return 1;
+        case SCRIPT_OP_DJNZ:    return 2;
+        case SCRIPT_OP_JLT:
+        case SCRIPT_OP_JGT:     return 6;
+        case SCRIPT_OP_JSET:
+        case SCRIPT_OP_JCLR:    return 2;
+        default:                return 0;
+    }
+}
+
+/*
+    Program Validation
+
+    First pass: every opcode exists, fits in the program and has in-range register/slot/channel operands;
+    instruction starts are recorded. Second pass: every jump lands on an instruction start or exactly at
+    the end of the program (an implicit END).
+*/
+SCRIPT_ERROR scriptVmValidate(const uint8_t *program, uint16_t length){
+    uint8_t starts[SCRIPT_VM_MAX_PROGRAM / 8];
+    uint16_t pc = 0;
+
+    if (length > SCRIPT_VM_MAX_PROGRAM){
+        return SCRIPT_ERROR_TOO_LARGE;
+    }
+    memset(starts, 0, sizeof(starts));
+    while (pc < length){
+        const uint8_t *ip = &program[pc];
+        uint8_t size = instructionLength(ip[0]);
+        if ((size == 0) || (pc + size > length)){
+            return SCRIPT_ERROR_BAD_OPCODE;
+        }
+        switch (ip[0]){
+            case SCRIPT_OP_VOUT_R:
+            case SCRIPT_OP_ILIM_R:
+            case SCRIPT_OP_LOAD:
+            case SCRIPT_OP_ADD:
+            case SCRIPT_OP_DJNZ:
+            case SCRIPT_OP_JLT:
+            case SCRIPT_OP_JGT:
+                if (ip[1] >= SCRIPT_VM_REGISTERS){
+                    return SCRIPT_ERROR_BAD_OPERAND;
+                }
+                break;
+            case SCRIPT_OP_MEASURE:
+                if ((ip[1] >= SCRIPT_VM_REGISTERS) || (ip[2] >= SCRIPT_CHANNELS)){
+                    return SCRIPT_ERROR_BAD_OPERAND;
+                }
+                break;
+            case SCRIPT_OP_MOV:
+            case SCRIPT_OP_SUB:
+                if ((ip[1] >= SCRIPT_VM_REGISTERS) || (ip[2] >= SCRIPT_VM_REGISTERS)){
+                    return SCRIPT_ERROR_BAD_OPERAND;
+                }
+                break;
+            case SCRIPT_OP_REPORT:
+                if ((ip[1] >= SCRIPT_VM_RESULTS) || (ip[2] >= SCRIPT_VM_REGISTERS)){
+                    return SCRIPT_ERROR_BAD_OPERAND;
+                }
+                break;
+            default:
+                break;
+        }
+        starts[pc / 8] |= (uint8_t)(1u << (pc % 8));
+        pc += size;
+    }
+
+    for (pc = 0; pc < length; pc += instructionLength(program[pc])){
+        uint8_t operand = jumpOperand(program[pc]);
+        if (operand == 0){
+            continue;
+        }
+        int32_t target = pc + instructionLength(program[pc]) + (int16_t)read16(&program[pc + operand]);
+        if ((target < 0) || (target > length)){
+            return SCRIPT_ERROR_BAD_JUMP;
+        }
+        if ((target < length) && ((starts[target / 8] & (1u << (target % 8))) == 0)){
+            return SCRIPT_ERROR_BAD_JUMP;
+        }
+    }
+    return SCRIPT_ERROR_NONE;
+}
+
+/*
+    Script VM Initialisation
+
+    device may be NULL, in which case setpoint instructions fail the script. measure supplies VIN/VOUT/IOUT
+    (and optionally STATUS); without it STATUS comes from readStatusRegister and the other channels fail.
+*/
+void scriptVmInit(SCRIPT_VM *vm, TPS55289 *device, SCRIPT_MEASURE measure, void *context){
+    memset(vm, 0, sizeof(*vm));
+    vm->state   = SCRIPT_STATE_IDLE;
+    vm->device  = device;
+    vm->measure = measure;
+    vm->context = context;
+}
+
+_Bool scriptVmBusy(const SCRIPT_VM *vm){
+    return (vm->state == SCRIPT_STATE_RUNNING) || (vm->state == SCRIPT_STATE_WAITING);
+}
+
+/*
+    Program Upload
+
+    Chunks may arrive in any order; a chunk at offset 0 starts a new program. Refused while a script runs.
+*/
+_Bool scriptVmLoad(SCRIPT_VM *vm, uint16_t offset, const uint8_t *data, uint16_t length){
+    _Bool STATUS = true;
+    if (scriptVmBusy(vm) || ((uint32_t)offset + length > SCRIPT_VM_MAX_PROGRAM)){
+        STATUS = false;
+        return STATUS;
+    }
+    if (offset == 0){
+        vm->length = 0;
+    }
+    memcpy(&vm->program[offset], data, length);
+    if (offset + length > vm->length){
+        vm->length = (uint16_t)(offset + length);
+    }
+    vm->state = SCRIPT_STATE_IDLE;
+    return STATUS;
+}
+
+// Validates the loaded program and starts it with the schedule time base at now
+_Bool scriptVmStart(SCRIPT_VM *vm){
+    _Bool STATUS = true;
+    if (scriptVmBusy(vm)){
+        STATUS = false;
+        return STATUS;
+    }
+    SCRIPT_ERROR error = scriptVmValidate(vm->program, vm->length);
+    if (error != SCRIPT_ERROR_NONE){
+        vm->error = (uint8_t)error;
+        vm->state = SCRIPT_STATE_ERROR;
+        STATUS = false;
+        return STATUS;
+    }
+
+    memset(vm->registers, 0, sizeof(vm->registers));
+    memset(vm->results, 0, sizeof(vm->results));
+    vm->pc           = 0;
+    vm->error        = SCRIPT_ERROR_NONE;
+    vm->failCode     = 0;
+    vm->instructions = 0;
+    vm->overruns     = 0;
+    vm->stopRequest  = false;
+    vm->started      = time_us_64();
+    vm->deadline     = vm->started;
+    vm->finished     = vm->started;
+    vm->state        = SCRIPT_STATE_RUNNING;
+    return STATUS;
+}
+
+// Takes effect at the next instruction boundary, including from a WAIT
+void scriptVmStop(SCRIPT_VM *vm){
+    if (scriptVmBusy(vm)){
+        vm->stopRequest = true;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Interpreter
+
+static SCRIPT_STATE finish(SCRIPT_VM *vm, SCRIPT_STATE state, SCRIPT_ERROR error){
+    vm->error    = (uint8_t)error;
+    vm->finished = time_us_64();
+    vm->state    = (uint8_t)state;
+    return state;
+}
+
+static _Bool measureChannel(SCRIPT_VM *vm, uint8_t channel, int32_t *value){
+    if (vm->measure != NULL){
+        return vm->measure(vm->context, channel, value);
+    }
+    if ((channel == SCRIPT_CHANNEL_STATUS) && (vm->device != NULL) && (readStatusRegister(vm->device) == true)){
+        *value = vm->device->TPS55289_STATUS.regValue;
+        return true;
+    }
+    return false;
+}
+
+/*
+    Step
+
+    Runs up to SCRIPT_VM_SLICE instructions. Returns WAITING with wakeAt set when the script sleeps,
+    RUNNING when the slice ran out (call again after yielding), or the final state.
+*/
+SCRIPT_STATE scriptVmStep(SCRIPT_VM *vm){
+    if (vm->state == SCRIPT_STATE_WAITING){
+        if ((time_us_64() < vm->wakeAt) && !vm->stopRequest){
+            return SCRIPT_STATE_WAITING;
+        }
+        vm->state = SCRIPT_STATE_RUNNING;
+    }
+    if (vm->state != SCRIPT_STATE_RUNNING){
+        return (SCRIPT_STATE)vm->state;
+    }
+
+    for (uint32_t n = 0; n < SCRIPT_VM_SLICE; n++){
+        if (vm->stopRequest){
+            return finish(vm, SCRIPT_STATE_ERROR, SCRIPT_ERROR_STOPPED);
+        }
+        if (vm->pc >= vm->length){
+            return finish(vm, SCRIPT_STATE_DONE, SCRIPT_ERROR_NONE);
+        }
+
+        // Operands were range-checked by scriptVmValidate
+        const uint8_t *ip = &vm->program[vm->pc];
+        uint16_t next = (uint16_t)(vm->pc + instructionLength(ip[0]));
+        int32_t value;
+        _Bool ok = true;
+        vm->instructions++;
+
+        switch (ip[0]){
+            case SCRIPT_OP_END:
+                vm->pc = next;
+                return finish(vm, SCRIPT_STATE_DONE, SCRIPT_ERROR_NONE);
+            case SCRIPT_OP_FAIL:
+                vm->pc = next;
+                vm->failCode = ip[1];
+                return finish(vm, SCRIPT_STATE_ERROR, SCRIPT_ERROR_FAILED);
+            case SCRIPT_OP_WAIT: {
+                uint64_t now = time_us_64();
+                vm->deadline += (uint32_t)read32(&ip[1]);
+                vm->pc = next;
+                if (vm->deadline > now){
+                    vm->wakeAt = vm->deadline;
+                    vm->state  = SCRIPT_STATE_WAITING;
+                    return SCRIPT_STATE_WAITING;
+                }
+                if (vm->deadline < now){
+                    vm->overruns++;
+                }
+                continue;
+            }
+            case SCRIPT_OP_SYNC:
+                vm->deadline = time_us_64();
+                break;
+            case SCRIPT_OP_VOUT:
+                ok = (vm->device != NULL) && setOutputVoltage(vm->device, read16(&ip[1]) / 1000.0f);
+                break;
+            case SCRIPT_OP_VOUT_R:
+                ok = (vm->device != NULL) && setOutputVoltage(vm->device, vm->registers[ip[1]] / 1000.0f);
+                break;
+            case SCRIPT_OP_ILIM:
+                ok = (vm->device != NULL) && setOutputCurrentLimit(vm->device, read16(&ip[1]) / 1000.0f);
+                break;
+            case SCRIPT_OP_ILIM_R:
+                ok = (vm->device != NULL) && setOutputCurrentLimit(vm->device, vm->registers[ip[1]] / 1000.0f);
+                break;
+            case SCRIPT_OP_OUTPUT:
+                ok = (vm->device != NULL) && ((ip[1] != 0) ? enableDevice(vm->device) : disableDevice(vm->device));
+                break;
+            case SCRIPT_OP_MEASURE:
+                if (measureChannel(vm, ip[2], &vm->registers[ip[1]]) == false){
+                    return finish(vm, SCRIPT_STATE_ERROR, SCRIPT_ERROR_MEASURE);
+                }
+                break;
+            case SCRIPT_OP_LOAD:
+                vm->registers[ip[1]] = read32(&ip[2]);
+                break;
+            case SCRIPT_OP_ADD:
+                vm->registers[ip[1]] = (int32_t)((uint32_t)vm->registers[ip[1]] + (uint32_t)read32(&ip[2]));
+                break;
+            case SCRIPT_OP_MOV:
+                vm->registers[ip[1]] = vm->registers[ip[2]];
+                break;
+            case SCRIPT_OP_SUB:
+                vm->registers[ip[1]] = (int32_t)((uint32_t)vm->registers[ip[1]] - (uint32_t)vm->registers[ip[2]]);
+                break;
+            case SCRIPT_OP_JMP:
+                next = (uint16_t)(next + (int16_t)read16(&ip[1]));
+                break;
+            case SCRIPT_OP_DJNZ:
+                vm->registers[ip[1]] = (int32_t)((uint32_t)vm->registers[ip[1]] - 1u);
+                if (vm->registers[ip[1]] != 0){
+                    next = (uint16_t)(next + (int16_t)read16(&ip[2]));
+                }
+                break;
+            case SCRIPT_OP_JLT:
+                if (vm->registers[ip[1]] < read32(&ip[2])){
+                    next = (uint16_t)(next + (int16_t)read16(&ip[6]));
+                }
+                break;
+            case SCRIPT_OP_JGT:
+                if (vm->registers[ip[1]] > read32(&ip[2])){
+                    next = (uint16_t)(next + (int16_t)read16(&ip[6]));
+                }
+                break;
+            case SCRIPT_OP_JSET:
+            case SCRIPT_OP_JCLR:
+                if (measureChannel(vm, SCRIPT_CHANNEL_STATUS, &value) == false){
+                    return finish(vm, SCRIPT_STATE_ERROR, SCRIPT_ERROR_MEASURE);
+                }
+                if (((value & ip[1]) != 0) == (ip[0] == SCRIPT_OP_JSET)){
+                    next = (uint16_t)(next + (int16_t)read16(&ip[2]));
+                }
+                break;
+            case SCRIPT_OP_REPORT:
+                vm->results[ip[1]] = vm->registers[ip[2]];
+                break;
+            default:
+                return finish(vm, SCRIPT_STATE_ERROR, SCRIPT_ERROR_BAD_OPCODE);
+        }
+        if (ok == false){
+            return finish(vm, SCRIPT_STATE_ERROR, SCRIPT_ERROR_DEVICE);
+        }
+        vm->pc = next;
+    }
+    return SCRIPT_STATE_RUNNING;
+}
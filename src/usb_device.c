@@ -0,0 +1,327 @@
+// Composite USB device: CDC console and vendor bulk control interface
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "pico/stdio/driver.h"
+#include "pico/mutex.h"
+#include "pico/unique_id.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "tusb.h"
+#include "device/usbd_pvt.h"
+
+#include "power_manager.h"
+#include "usb_device.h"
+#include "usb_protocol.h"
+
+#define USB_CONSOLE_TIMEOUT_MS          50      // Longest a printf waits for the console before dropping output
+#define USB_TASK_POLL_TICKS             1       // Fallback poll period if no event wakes the USB task
+#define USB_TASK_IDLE_POLL_TICKS        100     // Same while the power manager has clocked down
+
+// Guards TinyUSB: held by the USB task around tud_task and by the console around the CDC FIFOs
+static recursive_mutex_t usbMutex;
+static TaskHandle_t usbTaskHandle;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Descriptors
+
+enum {
+    USB_STR_LANGID = 0,
+    USB_STR_MANUFACTURER,
+    USB_STR_PRODUCT,
+    USB_STR_SERIAL,
+    USB_STR_CONSOLE,
+    USB_STR_CONTROL,
+    USB_STR_COUNT
+};
+
+static const tusb_desc_device_t usbDeviceDescriptor = {
+    .bLength            = sizeof(tusb_desc_device_t),
+    .bDescriptorType    = TUSB_DESC_DEVICE,
+    .bcdUSB             = 0x0200,
+    .bDeviceClass       = TUSB_CLASS_MISC,          // IAD: the CDC interfaces are grouped as one function
+    .bDeviceSubClass    = MISC_SUBCLASS_COMMON,
+    .bDeviceProtocol    = MISC_PROTOCOL_IAD,
+    .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+    .idVendor           = USB_DEVICE_VID,
+    .idProduct          = USB_DEVICE_PID,
+    .bcdDevice          = USB_DEVICE_BCD,
+    .iManufacturer      = USB_STR_MANUFACTURER,
+    .iProduct           = USB_STR_PRODUCT,
+    .iSerialNumber      = USB_STR_SERIAL,
+    .bNumConfigurations = 1,
+};
+
+#define USB_CONFIG_TOTAL_LEN            (TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN + TUD_VENDOR_DESC_LEN)
+
+static const uint8_t usbConfigDescriptor[] = {
+    TUD_CONFIG_DESCRIPTOR(1, USB_ITF_COUNT, 0, USB_CONFIG_TOTAL_LEN, 0, 100),
+    TUD_CDC_DESCRIPTOR(USB_ITF_CDC, USB_STR_CONSOLE, USB_EP_CDC_NOTIFY, 8, USB_EP_CDC_OUT, USB_EP_CDC_IN,
+                       USB_FS_PACKET_SIZE),
+    TUD_VENDOR_DESCRIPTOR(USB_ITF_VENDOR, USB_STR_CONTROL, USB_EP_VENDOR_OUT, USB_EP_VENDOR_IN, USB_FS_PACKET_SIZE),
+};
+
+static const char *const usbStrings[USB_STR_COUNT] = {
+    [USB_STR_MANUFACTURER] = "USBPD",
+    [USB_STR_PRODUCT]      = "USBPD Power Supply",
+    [USB_STR_CONSOLE]      = "Console",
+    [USB_STR_CONTROL]      = "Control",
+};
+
+const uint8_t *tud_descriptor_device_cb(void){
+    return (const uint8_t *)&usbDeviceDescriptor;
+}
+
+const uint8_t *tud_descriptor_configuration_cb(uint8_t index){
+    (void)index;
+    return usbConfigDescriptor;
+}
+
+const uint16_t *tud_descriptor_string_cb(uint8_t index, uint16_t langid){
+    static uint16_t descriptor[33];
+    static char serial[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
+    const char *text;
+    (void)langid;
+
+    if (index == USB_STR_LANGID){
+        descriptor[0] = (TUSB_DESC_STRING << 8) | 4;
+        descriptor[1] = 0x0409;                     // English (US)
+        return descriptor;
+    }
+    if (index >= USB_STR_COUNT){
+        return NULL;
+    }
+    if (index == USB_STR_SERIAL){
+        pico_get_unique_board_id_string(serial, sizeof(serial));
+        text = serial;
+    } else {
+        text = usbStrings[index];
+    }
+
+    size_t length = strlen(text);
+    if (length > 32){
+        length = 32;
+    }
+    for (size_t i = 0; i < length; i++){
+        descriptor[1 + i] = (uint8_t)text[i];
+    }
+    descriptor[0] = (uint16_t)((TUSB_DESC_STRING << 8) | (2 * length + 2));
+    return descriptor;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Vendor Class Driver
+//
+// OUT transfers land directly in a protocol frame buffer and IN transfers are started on the frame the
+// reply was built in, so the only copy is the controller's own move between its DPRAM and the buffer.
+
+static uint8_t  vendorOutEp;
+static uint8_t  vendorInEp;
+static uint8_t *vendorRxFrame;          // Frame armed on the OUT endpoint
+static uint8_t *vendorTxFrame;          // Frame in flight on the IN endpoint
+static _Bool    vendorZlpPending;
+
+static void vendorArmRx(uint8_t rhport){
+    if ((vendorOutEp == 0) || (vendorRxFrame != NULL)){
+        return;
+    }
+    vendorRxFrame = usbProtocolAcquire();
+    if (vendorRxFrame == NULL){
+        return;                         // Retried from the USB task once a frame is released
+    }
+    usbd_edpt_xfer(rhport, vendorOutEp, vendorRxFrame, USB_PROTOCOL_FRAME_SIZE);
+}
+
+static void vendorStartTx(uint8_t rhport){
+    uint32_t length;
+    if ((vendorInEp == 0) || (vendorTxFrame != NULL)){
+        return;
+    }
+    vendorTxFrame = usbProtocolNextTx(&length);
+    if (vendorTxFrame == NULL){
+        return;
+    }
+    // A transfer ending on a full packet needs a ZLP unless it fills the host's frame-sized read
+    vendorZlpPending = ((length % USB_FS_PACKET_SIZE) == 0) && (length < USB_PROTOCOL_FRAME_SIZE);
+    usbd_edpt_xfer(rhport, vendorInEp, vendorTxFrame, (uint16_t)length);
+}
+
+static void vendorReset(uint8_t rhport){
+    (void)rhport;
+    if (vendorRxFrame != NULL){
+        usbProtocolRelease(vendorRxFrame);
+    }
+    if (vendorTxFrame != NULL){
+        usbProtocolRelease(vendorTxFrame);
+    }
+    vendorRxFrame    = NULL;
+    vendorTxFrame    = NULL;
+    vendorOutEp      = 0;
+    vendorInEp       = 0;
+    vendorZlpPending = false;
+}
+
+static void vendorInit(void){
+    vendorReset(0);
+}
+
+static uint16_t vendorOpen(uint8_t rhport, const tusb_desc_interface_t *itf, uint16_t maxLength){
+    uint16_t length = sizeof(tusb_desc_interface_t) + 2 * sizeof(tusb_desc_endpoint_t);
+    if ((itf->bInterfaceClass != TUSB_CLASS_VENDOR_SPECIFIC) || (itf->bInterfaceNumber != USB_ITF_VENDOR) ||
+        (maxLength < length)){
+        return 0;
+    }
+    if (!usbd_open_edpt_pair(rhport, tu_desc_next(itf), 2, TUSB_XFER_BULK, &vendorOutEp, &vendorInEp)){
+        return 0;
+    }
+    vendorArmRx(rhport);
+    return length;
+}
+
+static bool vendorControl(uint8_t rhport, uint8_t stage, const tusb_control_request_t *request){
+    (void)rhport; (void)stage; (void)request;
+    return false;                       // Everything goes over the bulk endpoints
+}
+
+static bool vendorXfer(uint8_t rhport, uint8_t ep, xfer_result_t result, uint32_t bytes){
+    if (ep == vendorOutEp){
+        uint8_t *frame = vendorRxFrame;
+        vendorRxFrame = NULL;
+        if (result == XFER_RESULT_SUCCESS){
+            powerManagerActivity();
+            usbProtocolReceive(frame, bytes);
+        } else {
+            usbProtocolRelease(frame);
+        }
+        vendorArmRx(rhport);
+        vendorStartTx(rhport);
+    } else if (ep == vendorInEp){
+        if (vendorZlpPending && (result == XFER_RESULT_SUCCESS)){
+            vendorZlpPending = false;
+            usbd_edpt_xfer(rhport, vendorInEp, NULL, 0);
+            return true;
+        }
+        usbProtocolRelease(vendorTxFrame);
+        vendorTxFrame = NULL;
+        vendorArmRx(rhport);
+        vendorStartTx(rhport);
+    }
+    return true;
+}
+
+static const usbd_class_driver_t vendorDriver = {
+    .init            = vendorInit,
+    .reset           = vendorReset,
+    .open            = vendorOpen,
+    .control_xfer_cb = vendorControl,
+    .xfer_cb         = vendorXfer,
+    .sof             = NULL,
+};
+
+const usbd_class_driver_t *usbd_app_driver_get_cb(uint8_t *driverCount){
+    *driverCount = 1;
+    return &vendorDriver;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Console (stdio over CDC)
+
+static void usbConsoleOutChars(const char *buffer, int length){
+    absolute_time_t deadline = make_timeout_time_ms(USB_CONSOLE_TIMEOUT_MS);
+    while ((length > 0) && !time_reached(deadline)){
+        if (!recursive_mutex_enter_timeout_ms(&usbMutex, USB_CONSOLE_TIMEOUT_MS)){
+            return;
+        }
+        // Nothing listening: drop the output rather than stall the caller
+        int written = tud_cdc_connected() ? (int)tud_cdc_write(buffer, (uint32_t)length) : length;
+        tud_cdc_write_flush();
+        recursive_mutex_exit(&usbMutex);
+
+        buffer += written;
+        length -= written;
+        if (length > 0){
+            usbDeviceWake();
+            vTaskDelay(1);
+        }
+    }
+}
+
+static int usbConsoleInChars(char *buffer, int length){
+    int read = PICO_ERROR_NO_DATA;
+    if (recursive_mutex_enter_timeout_ms(&usbMutex, USB_CONSOLE_TIMEOUT_MS)){
+        if (tud_cdc_available()){
+            read = (int)tud_cdc_read(buffer, (uint32_t)length);
+        }
+        recursive_mutex_exit(&usbMutex);
+    }
+    return read;
+}
+
+static stdio_driver_t usbConsole = {
+    .out_chars    = usbConsoleOutChars,
+    .in_chars     = usbConsoleInChars,
+#if PICO_STDIO_ENABLE_CRLF_SUPPORT
+    .crlf_enabled = PICO_STDIO_DEFAULT_CRLF,
+#endif
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Device Task
+
+/*
+    USB Initialisation
+
+    Starts TinyUSB and routes stdio to the CDC interface. Call on core 0 before the scheduler starts;
+    the controller interrupt stays on the calling core, so usbDeviceTask should be pinned to it.
+*/
+void usbDeviceInit(TPS55289 *device){
+    recursive_mutex_init(&usbMutex);
+    usbProtocolInit(device);
+    tusb_init();
+    stdio_set_driver_enabled(&usbConsole, true);
+}
+
+// Wakes the USB task, e.g. after queuing telemetry from another task
+void usbDeviceWake(void){
+    if (usbTaskHandle != NULL){
+        xTaskNotifyGive(usbTaskHandle);
+    }
+}
+
+// Called by TinyUSB whenever it queues an event, usually from the controller interrupt
+void tud_event_hook_cb(uint8_t rhport, uint32_t eventid, bool in_isr){
+    (void)rhport; (void)eventid;
+    if (usbTaskHandle == NULL){
+        return;
+    }
+    if (in_isr){
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(usbTaskHandle, &woken);
+        portYIELD_FROM_ISR(woken);
+    } else {
+        xTaskNotifyGive(usbTaskHandle);
+    }
+}
+
+/*
+    USB Task
+
+    Runs the TinyUSB device stack and the vendor protocol (commands are executed here), then sleeps until
+    the controller interrupt or usbDeviceWake signals more work.
+*/
+void usbDeviceTask(void *param){
+    (void)param;
+    usbTaskHandle = xTaskGetCurrentTaskHandle();
+    for(;;){
+        recursive_mutex_enter_blocking(&usbMutex);
+        tud_task();
+        if (tud_mounted()){
+            vendorArmRx(0);
+            vendorStartTx(0);
+        }
+        recursive_mutex_exit(&usbMutex);
+        ulTaskNotifyTake(pdTRUE, powerManagerIsIdle() ? USB_TASK_IDLE_POLL_TICKS : USB_TASK_POLL_TICKS);
+    }
+}
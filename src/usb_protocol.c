@@ -0,0 +1,404 @@
+// Framed command and telemetry protocol carried on the vendor bulk interface
+#include <assert.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#include "TPS55289.h"
+#include "TPS55289_state.h"
+#include "TPS55289_trace.h"
+#include "script_vm.h"
+#include "usb_protocol.h"
+
+#if USB_PROTOCOL_BUFFERS > 32
+#error "USB_PROTOCOL_BUFFERS must fit the 32-bit free mask"
+#endif
+
+static_assert(sizeof(USB_PROTOCOL_HEADER) == USB_PROTOCOL_HEADER_SIZE, "Header layout is part of the wire format");
+
+/*
+    Frame Pool
+
+    Every frame lives in one of these buffers from the OUT transfer that fills it to the IN transfer that
+    sends the reply: requests are parsed and answered in place, so nothing is copied between the USB
+    controller and the command handlers. Telemetry samples are written straight into a pool frame.
+*/
+static uint8_t  frames[USB_PROTOCOL_BUFFERS][USB_PROTOCOL_FRAME_SIZE] __attribute__((aligned(4)));
+static uint32_t freeMask;
+
+// Frames waiting for the IN endpoint, oldest first; each frame can be queued at most once
+static struct {
+    uint8_t  *frame;
+    uint32_t length;
+} txQueue[USB_PROTOCOL_BUFFERS];
+static uint32_t txHead;
+static uint32_t txTail;
+
+static uint8_t  *telemetryFrame;
+static uint32_t telemetryCount;
+static uint16_t telemetrySequence;
+
+static TPS55289 *protocolDevice;
+static SCRIPT_VM *protocolScript;
+static void (*protocolScriptWake)(void);
+static USB_PROTOCOL_STATS stats;
+static spin_lock_t *protocolLock;
+
+static inline uint32_t lockProtocol(void){
+    return (protocolLock != NULL) ? spin_lock_blocking(protocolLock) : save_and_disable_interrupts();
+}
+
+static inline void unlockProtocol(uint32_t irq){
+    if (protocolLock != NULL){
+        spin_unlock(protocolLock, irq);
+    } else {
+        restore_interrupts(irq);
+    }
+}
+
+/*
+    Protocol Initialisation
+
+    device may be NULL; commands that need the converter then answer USB_STATUS_NO_DEVICE. Must be
+    called before the USB stack is started.
+*/
+void usbProtocolInit(TPS55289 *device){
+    protocolDevice = device;
+    freeMask = (USB_PROTOCOL_BUFFERS == 32) ? 0xFFFFFFFF : ((1u << USB_PROTOCOL_BUFFERS) - 1);
+    txHead = 0;
+    txTail = 0;
+    telemetryFrame = NULL;
+    telemetryCount = 0;
+    telemetrySequence = 0;
+    memset(&stats, 0, sizeof(stats));
+    if (protocolLock == NULL){
+        protocolLock = spin_lock_instance(spin_lock_claim_unused(true));
+    }
+}
+
+// Attaches the script interpreter and the function that wakes the task running it
+void usbProtocolSetScript(SCRIPT_VM *vm, void (*wake)(void)){
+    protocolScript     = vm;
+    protocolScriptWake = wake;
+}
+
+uint8_t *usbProtocolAcquire(void){
+    uint8_t *frame = NULL;
+    uint32_t irq = lockProtocol();
+    if (freeMask != 0){
+        uint32_t index = __builtin_ctz(freeMask);
+        freeMask &= ~(1u << index);
+        frame = frames[index];
+    } else {
+        stats.noBuffer++;
+    }
+    unlockProtocol(irq);
+    return frame;
+}
+
+void usbProtocolRelease(uint8_t *frame){
+    uint32_t index = (uint32_t)(frame - frames[0]) / USB_PROTOCOL_FRAME_SIZE;
+    uint32_t irq = lockProtocol();
+    freeMask |= (1u << index);
+    unlockProtocol(irq);
+}
+
+static void queueTx(uint8_t *frame, uint32_t length){
+    uint32_t irq = lockProtocol();
+    txQueue[txHead % USB_PROTOCOL_BUFFERS].frame  = frame;
+    txQueue[txHead % USB_PROTOCOL_BUFFERS].length = length;
+    txHead++;
+    unlockProtocol(irq);
+}
+
+/*
+    Next Frame to Send
+
+    Hands the oldest queued frame to the IN endpoint. The caller owns it until the transfer completes
+    and returns it with usbProtocolRelease.
+*/
+uint8_t *usbProtocolNextTx(uint32_t *length){
+    uint8_t *frame = NULL;
+    uint32_t irq = lockProtocol();
+    if (txTail != txHead){
+        frame   = txQueue[txTail % USB_PROTOCOL_BUFFERS].frame;
+        *length = txQueue[txTail % USB_PROTOCOL_BUFFERS].length;
+        txTail++;
+        stats.txFrames++;
+    }
+    unlockProtocol(irq);
+    return frame;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Command Handlers
+// Each handler reads its request from payload and writes its reply over it, setting *length to the reply size.
+// Replies to failed commands carry no payload.
+
+#define USB_ANY_LENGTH                  0xFFFF
+
+static USB_PROTOCOL_STATUS commandPing(uint8_t *payload, uint16_t *length){
+    USB_PING_PAYLOAD reply = { USB_PROTOCOL_VERSION, USB_PROTOCOL_FRAME_SIZE };
+    memcpy(payload, &reply, sizeof(reply));
+    *length = sizeof(reply);
+    return USB_STATUS_OK;
+}
+
+static USB_PROTOCOL_STATUS commandEcho(uint8_t *payload, uint16_t *length){
+    (void)payload; (void)length;
+    return USB_STATUS_OK;
+}
+
+static USB_PROTOCOL_STATUS commandGetStatus(uint8_t *payload, uint16_t *length){
+    if (protocolDevice == NULL){
+        return USB_STATUS_NO_DEVICE;
+    }
+    if (readStatusRegister(protocolDevice) != true){
+        return USB_STATUS_DEVICE_ERROR;
+    }
+    TPS55289_SNAPSHOT snapshot;
+    TPS55289Snapshot(protocolDevice, &snapshot);
+    USB_STATUS_PAYLOAD reply = {
+        .refCode      = snapshot.refCode,
+        .status       = snapshot.status,
+        .mode         = snapshot.mode,
+        .currentLimit = snapshot.currentLimit,
+        .reserved     = 0,
+    };
+    memcpy(payload, &reply, sizeof(reply));
+    *length = sizeof(reply);
+    return USB_STATUS_OK;
+}
+
+static USB_PROTOCOL_STATUS commandSetVOUT(uint8_t *payload, uint16_t *length){
+    uint32_t mV;
+    if (protocolDevice == NULL){
+        return USB_STATUS_NO_DEVICE;
+    }
+    memcpy(&mV, payload, sizeof(mV));
+    *length = 0;
+    return (setOutputVoltage(protocolDevice, mV / 1000.0f) == true) ? USB_STATUS_OK : USB_STATUS_DEVICE_ERROR;
+}
+
+static USB_PROTOCOL_STATUS commandSetILIM(uint8_t *payload, uint16_t *length){
+    uint32_t mA;
+    if (protocolDevice == NULL){
+        return USB_STATUS_NO_DEVICE;
+    }
+    memcpy(&mA, payload, sizeof(mA));
+    *length = 0;
+    return (setOutputCurrentLimit(protocolDevice, mA / 1000.0f) == true) ? USB_STATUS_OK : USB_STATUS_DEVICE_ERROR;
+}
+
+static USB_PROTOCOL_STATUS commandOutput(uint8_t *payload, uint16_t *length){
+    if (protocolDevice == NULL){
+        return USB_STATUS_NO_DEVICE;
+    }
+    _Bool ok = (payload[0] != 0) ? enableDevice(protocolDevice) : disableDevice(protocolDevice);
+    *length = 0;
+    return (ok == true) ? USB_STATUS_OK : USB_STATUS_DEVICE_ERROR;
+}
+
+static USB_PROTOCOL_STATUS commandScriptLoad(uint8_t *payload, uint16_t *length){
+    uint16_t offset;
+    if (protocolScript == NULL){
+        return USB_STATUS_NO_SCRIPT;
+    }
+    if (*length < sizeof(offset)){
+        return USB_STATUS_BAD_LENGTH;
+    }
+    memcpy(&offset, payload, sizeof(offset));
+    uint16_t chunk = (uint16_t)(*length - sizeof(offset));
+    *length = 0;
+    if (scriptVmBusy(protocolScript)){
+        return USB_STATUS_BUSY;
+    }
+    return (scriptVmLoad(protocolScript, offset, payload + sizeof(offset), chunk) == true) ? USB_STATUS_OK
+                                                                                           : USB_STATUS_BAD_LENGTH;
+}
+
+static USB_PROTOCOL_STATUS commandScriptRun(uint8_t *payload, uint16_t *length){
+    (void)payload;
+    if (protocolScript == NULL){
+        return USB_STATUS_NO_SCRIPT;
+    }
+    if (scriptVmBusy(protocolScript)){
+        return USB_STATUS_BUSY;
+    }
+    if (scriptVmStart(protocolScript) != true){
+        return USB_STATUS_SCRIPT_ERROR;
+    }
+    if (protocolScriptWake != NULL){
+        protocolScriptWake();
+    }
+    *length = 0;
+    return USB_STATUS_OK;
+}
+
+static USB_PROTOCOL_STATUS commandScriptStop(uint8_t *payload, uint16_t *length){
+    (void)payload;
+    if (protocolScript == NULL){
+        return USB_STATUS_NO_SCRIPT;
+    }
+    scriptVmStop(protocolScript);
+    if (protocolScriptWake != NULL){
+        protocolScriptWake();
+    }
+    *length = 0;
+    return USB_STATUS_OK;
+}
+
+static USB_PROTOCOL_STATUS commandScriptStatus(uint8_t *payload, uint16_t *length){
+    if (protocolScript == NULL){
+        return USB_STATUS_NO_SCRIPT;
+    }
+    const SCRIPT_VM *vm = protocolScript;
+    uint64_t end = scriptVmBusy(vm) ? time_us_64() : vm->finished;
+    USB_SCRIPT_STATUS_PAYLOAD reply = {
+        .state        = vm->state,
+        .error        = vm->error,
+        .failCode     = vm->failCode,
+        .reserved     = 0,
+        .pc           = vm->pc,
+        .length       = vm->length,
+        .instructions = vm->instructions,
+        .overruns     = vm->overruns,
+        .elapsedUs    = (uint32_t)(end - vm->started),
+    };
+    memcpy(reply.results, vm->results, sizeof(reply.results));
+    memcpy(payload, &reply, sizeof(reply));
+    *length = sizeof(reply);
+    return USB_STATUS_OK;
+}
+
+// Drained straight into the reply frame (word aligned past the header); the host appends the payloads to a
+// trace file
+static USB_PROTOCOL_STATUS commandTraceRead(uint8_t *payload, uint16_t *length){
+    uint32_t count = TPS55289TraceDrain((TPS55289_TRACE_RECORD *)payload, USB_TRACE_RECORDS_PER_FRAME);
+    *length = (uint16_t)(count * sizeof(TPS55289_TRACE_RECORD));
+    return USB_STATUS_OK;
+}
+
+typedef USB_PROTOCOL_STATUS (*usbCommandHandler)(uint8_t *payload, uint16_t *length);
+
+static const struct {
+    uint8_t           command;
+    uint16_t          requestLength;
+    usbCommandHandler handler;
+} usbCommands[] = {
+    { USB_CMD_PING,         0,                  commandPing },
+    { USB_CMD_ECHO,         USB_ANY_LENGTH,     commandEcho },
+    { USB_CMD_GET_STATUS,   0,                  commandGetStatus },
+    { USB_CMD_SET_VOUT,     sizeof(uint32_t),   commandSetVOUT },
+    { USB_CMD_SET_ILIM,     sizeof(uint32_t),   commandSetILIM },
+    { USB_CMD_OUTPUT,       sizeof(uint8_t),    commandOutput },
+    { USB_CMD_TRACE_READ,   0,                  commandTraceRead },
+    { USB_CMD_SCRIPT_LOAD,  USB_ANY_LENGTH,     commandScriptLoad },
+    { USB_CMD_SCRIPT_RUN,   0,                  commandScriptRun },
+    { USB_CMD_SCRIPT_STOP,  0,                  commandScriptStop },
+    { USB_CMD_SCRIPT_STATUS, 0,                 commandScriptStatus },
+};
+
+static USB_PROTOCOL_STATUS dispatch(uint8_t command, uint8_t *payload, uint16_t *length){
+    for (uint32_t i = 0; i < sizeof(usbCommands) / sizeof(usbCommands[0]); i++){
+        if (usbCommands[i].command != command){
+            continue;
+        }
+        if ((usbCommands[i].requestLength != USB_ANY_LENGTH) && (usbCommands[i].requestLength != *length)){
+            *length = 0;
+            return USB_STATUS_BAD_LENGTH;
+        }
+        USB_PROTOCOL_STATUS status = usbCommands[i].handler(payload, length);
+        if (status != USB_STATUS_OK){
+            *length = 0;
+        }
+        return status;
+    }
+    *length = 0;
+    return USB_STATUS_UNKNOWN_COMMAND;
+}
+
+/*
+    Receive
+
+    Takes ownership of a frame filled by an OUT transfer of length bytes. The reply is built over the
+    request in the same buffer and queued for the IN endpoint; runts too short to carry a header are
+    dropped.
+*/
+void usbProtocolReceive(uint8_t *frame, uint32_t length){
+    USB_PROTOCOL_HEADER *header = (USB_PROTOCOL_HEADER *)frame;
+    USB_PROTOCOL_STATUS status;
+    uint16_t payloadLength;
+
+    stats.rxFrames++;
+    if ((length < USB_PROTOCOL_HEADER_SIZE) || (length > USB_PROTOCOL_FRAME_SIZE)){
+        stats.badFrames++;
+        usbProtocolRelease(frame);
+        return;
+    }
+    payloadLength = (uint16_t)(length - USB_PROTOCOL_HEADER_SIZE);
+    if ((header->sync != USB_PROTOCOL_SYNC) || (header->length != payloadLength)){
+        stats.badFrames++;
+        payloadLength = 0;
+        status = USB_STATUS_BAD_FRAME;
+    } else {
+        status = dispatch(header->command, frame + USB_PROTOCOL_HEADER_SIZE, &payloadLength);
+    }
+
+    header->sync     = USB_PROTOCOL_SYNC;
+    header->command |= USB_PROTOCOL_RESPONSE;
+    header->length   = payloadLength;
+    header->status   = (uint8_t)status;
+    header->reserved = 0;
+    queueTx(frame, USB_PROTOCOL_HEADER_SIZE + payloadLength);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Telemetry
+
+/*
+    Telemetry Sample
+
+    Appends one sample to the open telemetry frame, which is queued as soon as it is full. Single producer:
+    call from one task only. Returns false (and counts the sample as dropped) if no frame buffer is free.
+*/
+_Bool usbProtocolTelemetry(const USB_TELEMETRY_SAMPLE *sample){
+    if (telemetryFrame == NULL){
+        telemetryFrame = usbProtocolAcquire();
+        if (telemetryFrame == NULL){
+            stats.telemetryDropped++;
+            return false;
+        }
+        telemetryCount = 0;
+    }
+    memcpy(telemetryFrame + USB_PROTOCOL_HEADER_SIZE + telemetryCount * sizeof(USB_TELEMETRY_SAMPLE),
+           sample, sizeof(USB_TELEMETRY_SAMPLE));
+    telemetryCount++;
+    stats.telemetrySamples++;
+    if (telemetryCount == USB_TELEMETRY_SAMPLES_PER_FRAME){
+        usbProtocolTelemetryFlush();
+    }
+    return true;
+}
+
+// Queues the open telemetry frame even if it is not full
+void usbProtocolTelemetryFlush(void){
+    if (telemetryFrame == NULL){
+        return;
+    }
+    USB_PROTOCOL_HEADER *header = (USB_PROTOCOL_HEADER *)telemetryFrame;
+    uint16_t payloadLength = (uint16_t)(telemetryCount * sizeof(USB_TELEMETRY_SAMPLE));
+    header->sync     = USB_PROTOCOL_SYNC;
+    header->command  = USB_CMD_TELEMETRY | USB_PROTOCOL_RESPONSE;
+    header->sequence = telemetrySequence++;
+    header->length   = payloadLength;
+    header->status   = USB_STATUS_OK;
+    header->reserved = 0;
+    queueTx(telemetryFrame, USB_PROTOCOL_HEADER_SIZE + payloadLength);
+    telemetryFrame = NULL;
+}
+
+const USB_PROTOCOL_STATS *usbProtocolStats(void){
+    return &stats;
+}